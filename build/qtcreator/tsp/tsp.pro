@@ -7,6 +7,7 @@ SOURCES += \
     ../../../src/tstools/tspJointTermination.cpp \
     ../../../src/tstools/tspOptions.cpp \
     ../../../src/tstools/tspOutputExecutor.cpp \
+    ../../../src/tstools/tspPipelineMonitor.cpp \
     ../../../src/tstools/tspPluginExecutor.cpp \
     ../../../src/tstools/tspProcessorExecutor.cpp
 
@@ -15,5 +16,6 @@ HEADERS += \
     ../../../src/tstools/tspJointTermination.h \
     ../../../src/tstools/tspOptions.h \
     ../../../src/tstools/tspOutputExecutor.h \
+    ../../../src/tstools/tspPipelineMonitor.h \
     ../../../src/tstools/tspPluginExecutor.h \
     ../../../src/tstools/tspProcessorExecutor.h
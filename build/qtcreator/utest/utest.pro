@@ -14,14 +14,17 @@ HEADERS += \
 
 SOURCES += \
     ../../../src/utest/utest.cpp \
+    ../../../src/utest/utestAbstractDescrambler.cpp \
     ../../../src/utest/utestAlgorithm.cpp \
     ../../../src/utest/utestArgs.cpp \
     ../../../src/utest/utestBitStream.cpp \
     ../../../src/utest/utestByteBlock.cpp \
+    ../../../src/utest/utestCRC32.cpp \
     ../../../src/utest/utestCppUnitMain.cpp \
     ../../../src/utest/utestCppUnitTest.cpp \
     ../../../src/utest/utestCrypto.cpp \
     ../../../src/utest/utestDemux.cpp \
+    ../../../src/utest/utestDescriptorList.cpp \
     ../../../src/utest/utestDirectShow.cpp \
     ../../../src/utest/utestDoubleCheckLock.cpp \
     ../../../src/utest/utestDVB.cpp \
@@ -32,12 +35,15 @@ SOURCES += \
     ../../../src/utest/utestGuard.cpp \
     ../../../src/utest/utestInterrupt.cpp \
     ../../../src/utest/utestJSON.cpp \
+    ../../../src/utest/utestMemoryUtils.cpp \
     ../../../src/utest/utestMessageQueue.cpp \
     ../../../src/utest/utestMonotonic.cpp \
     ../../../src/utest/utestMutex.cpp \
     ../../../src/utest/utestNames.cpp \
     ../../../src/utest/utestNetworking.cpp \
     ../../../src/utest/utestPacketizer.cpp \
+    ../../../src/utest/utestPESDemux.cpp \
+    ../../../src/utest/utestPIDContextTable.cpp \
     ../../../src/utest/utestPlatform.cpp \
     ../../../src/utest/utestPlugin.cpp \
     ../../../src/utest/utestReport.cpp \
@@ -56,6 +62,7 @@ SOURCES += \
     ../../../src/utest/utestThread.cpp \
     ../../../src/utest/utestThreadAttributes.cpp \
     ../../../src/utest/utestTime.cpp \
+    ../../../src/utest/utestTSAnalyzer.cpp \
     ../../../src/utest/utestTSPacket.cpp \
     ../../../src/utest/utestUString.cpp \
     ../../../src/utest/utestVariable.cpp \
@@ -0,0 +1,40 @@
+#!/bin/bash
+# Measure the tsp throughput (packets/second) against the length of the
+# chain of packet processors, with and without --lock-free-buffer.
+#
+# Usage: tsp-chain-benchmark.sh [max-plugins [packets [extra-tsp-options]]]
+#
+# The input is a generated stream of null packets and the output drops all
+# packets. Each packet processor is "count", which only counts packets. This
+# way, the measured throughput is dominated by the cost of passing packets
+# from one plugin thread to the next one.
+
+MAXPLUGINS=${1:-12}
+PACKETS=${2:-2000000}
+shift 2 2>/dev/null
+EXTRA="$*"
+
+group_digits() { sed <<<$1 -r ':L;s=\b([0-9]+)([0-9]{3})\b=\1,\2=g;t L'; }
+
+# Run tsp once, return the throughput in packets/second.
+run_tsp()
+{
+    local count=$1; shift
+    local procs=""
+    for ((i = 0; i < count; i++)); do
+        procs="$procs -P count"
+    done
+    local start=$(date +%s%N)
+    tsp "$@" $EXTRA -I null $PACKETS $procs -O drop >/dev/null 2>&1
+    local end=$(date +%s%N)
+    echo $(( PACKETS * 1000000000 / (end - start + 1) ))
+}
+
+echo "Plugins     Global mutex (pkt/s)     Lock-free (pkt/s)"
+echo "-------     --------------------     -----------------"
+
+for ((n = 0; n <= MAXPLUGINS; n++)); do
+    mutex=$(run_tsp $n)
+    lockfree=$(run_tsp $n --lock-free-buffer)
+    printf '%7d %24s %21s\n' $n $(group_digits $mutex) $(group_digits $lockfree)
+done
@@ -18,6 +18,20 @@ TSDUCK_SOURCE;
 
 #define BYTE(x,n) (((x) >> (8 * (n))) & 255)
 
+// AES instructions (AES-NI) are used on x86-64 when supported by the CPU.
+// The compiled code is selected at runtime, no specific compilation option is required.
+
+#if defined(TS_X86_64) && (defined(TS_GCC) || defined(TS_MSC))
+    #define TS_AES_HARDWARE 1
+    #if defined(TS_MSC)
+        #include <intrin.h>
+        #define TS_AESNI_TARGET
+    #else
+        #include <immintrin.h>
+        #define TS_AESNI_TARGET __attribute__((target("aes,sse2")))
+    #endif
+#endif
+
 namespace {
 
     // The precomputed tables for AES:
@@ -1165,10 +1179,151 @@ bool ts::AES::setKey(const void* key_, size_t key_length, size_t rounds)
     *rk++ = *rrk++;
     *rk   = *rrk;
 
+    // Round keys as byte sequences, for AES instructions.
+    // The decryption keys are already in the order of the "equivalent inverse cipher".
+    for (i = 0; i < 4 * (_Nr + 1); i++) {
+        PutUInt32(_eKb + 4 * i, _eK[i]);
+        PutUInt32(_dKb + 4 * i, _dK[i]);
+    }
+
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Implementation using AES instructions.
+//----------------------------------------------------------------------------
+
+namespace {
+#if defined(TS_AES_HARDWARE)
+
+    bool CPUHasAESNI()
+    {
+    #if defined(TS_MSC)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 25)) != 0;
+    #else
+        return __builtin_cpu_supports("aes") != 0;
+    #endif
+    }
+
+    const bool UseAESNI = CPUHasAESNI();
+
+    // Number of independent blocks which are processed together. The latency
+    // of one AES round instruction is 4 to 7 cycles but a new one can start on
+    // each cycle. Interleaving the rounds of 8 blocks keeps the pipeline busy.
+    const size_t AESNI_PARALLEL = 8;
+
+    // One round and last round, encryption or decryption.
+    template <bool ENCRYPT> struct AESNIRound;
+
+    template <> struct AESNIRound<true>
+    {
+        static TS_AESNI_TARGET inline __m128i round(__m128i b, __m128i k) {return _mm_aesenc_si128(b, k);}
+        static TS_AESNI_TARGET inline __m128i last(__m128i b, __m128i k) {return _mm_aesenclast_si128(b, k);}
+    };
+
+    template <> struct AESNIRound<false>
+    {
+        static TS_AESNI_TARGET inline __m128i round(__m128i b, __m128i k) {return _mm_aesdec_si128(b, k);}
+        static TS_AESNI_TARGET inline __m128i last(__m128i b, __m128i k) {return _mm_aesdeclast_si128(b, k);}
+    };
+
+    // Process count independent blocks, in place or not.
+    template <bool ENCRYPT>
+    TS_AESNI_TARGET void AESNIBlocks(const uint8_t* keys, int rounds, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        typedef AESNIRound<ENCRYPT> R;
+
+        __m128i rk[ts::AES::MAX_ROUNDS + 1];
+        for (int r = 0; r <= rounds; ++r) {
+            rk[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + r * ts::AES::BLOCK_SIZE));
+        }
+
+        const __m128i* src = reinterpret_cast<const __m128i*>(in);
+        __m128i* dst = reinterpret_cast<__m128i*>(out);
+
+        for (; count >= AESNI_PARALLEL; count -= AESNI_PARALLEL, src += AESNI_PARALLEL, dst += AESNI_PARALLEL) {
+            __m128i b0 = _mm_xor_si128(_mm_loadu_si128(src + 0), rk[0]);
+            __m128i b1 = _mm_xor_si128(_mm_loadu_si128(src + 1), rk[0]);
+            __m128i b2 = _mm_xor_si128(_mm_loadu_si128(src + 2), rk[0]);
+            __m128i b3 = _mm_xor_si128(_mm_loadu_si128(src + 3), rk[0]);
+            __m128i b4 = _mm_xor_si128(_mm_loadu_si128(src + 4), rk[0]);
+            __m128i b5 = _mm_xor_si128(_mm_loadu_si128(src + 5), rk[0]);
+            __m128i b6 = _mm_xor_si128(_mm_loadu_si128(src + 6), rk[0]);
+            __m128i b7 = _mm_xor_si128(_mm_loadu_si128(src + 7), rk[0]);
+            for (int r = 1; r < rounds; ++r) {
+                const __m128i k = rk[r];
+                b0 = R::round(b0, k);
+                b1 = R::round(b1, k);
+                b2 = R::round(b2, k);
+                b3 = R::round(b3, k);
+                b4 = R::round(b4, k);
+                b5 = R::round(b5, k);
+                b6 = R::round(b6, k);
+                b7 = R::round(b7, k);
+            }
+            const __m128i k = rk[rounds];
+            _mm_storeu_si128(dst + 0, R::last(b0, k));
+            _mm_storeu_si128(dst + 1, R::last(b1, k));
+            _mm_storeu_si128(dst + 2, R::last(b2, k));
+            _mm_storeu_si128(dst + 3, R::last(b3, k));
+            _mm_storeu_si128(dst + 4, R::last(b4, k));
+            _mm_storeu_si128(dst + 5, R::last(b5, k));
+            _mm_storeu_si128(dst + 6, R::last(b6, k));
+            _mm_storeu_si128(dst + 7, R::last(b7, k));
+        }
+
+        for (; count > 0; --count, ++src, ++dst) {
+            __m128i b = _mm_xor_si128(_mm_loadu_si128(src), rk[0]);
+            for (int r = 1; r < rounds; ++r) {
+                b = R::round(b, rk[r]);
+            }
+            _mm_storeu_si128(dst, R::last(b, rk[rounds]));
+        }
+    }
+
+#endif
+}
+
+bool ts::AES::HardwareSupport()
+{
+#if defined(TS_AES_HARDWARE)
+    return UseAESNI;
+#else
+    return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption and decryption of several blocks in ECB mode.
+//----------------------------------------------------------------------------
+
+bool ts::AES::encryptBlocks(const void* plain, void* cipher, size_t count)
+{
+#if defined(TS_AES_HARDWARE)
+    if (UseAESNI) {
+        AESNIBlocks<true>(_eKb, _Nr, reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), count);
+        return true;
+    }
+#endif
+    return BlockCipher::encryptBlocks(plain, cipher, count);
+}
+
+bool ts::AES::decryptBlocks(const void* cipher, void* plain, size_t count)
+{
+#if defined(TS_AES_HARDWARE)
+    if (UseAESNI) {
+        AESNIBlocks<false>(_dKb, _Nr, reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), count);
+        return true;
+    }
+#endif
+    return BlockCipher::decryptBlocks(cipher, plain, count);
+}
+
+
 //----------------------------------------------------------------------------
 // Encryption in ECB mode.
 // Return true on success, false on error.
@@ -1182,9 +1337,20 @@ bool ts::AES::encrypt(const void* plain, size_t plain_length,
         return false;
     }
 
+    if (cipher_length != 0) {
+        *cipher_length = BLOCK_SIZE;
+    }
+
     const uint8_t* pt = reinterpret_cast<const uint8_t*> (plain);
     uint8_t* ct = reinterpret_cast<uint8_t*> (cipher);
 
+#if defined(TS_AES_HARDWARE)
+    if (UseAESNI) {
+        AESNIBlocks<true>(_eKb, _Nr, pt, ct, 1);
+        return true;
+    }
+#endif
+
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1289,10 +1455,6 @@ bool ts::AES::encrypt(const void* plain, size_t plain_length,
         rk[3];
     PutUInt32 (ct+12, s3);
 
-    if (cipher_length != 0) {
-        *cipher_length = BLOCK_SIZE;
-    }
-
     return true;
 }
 
@@ -1310,9 +1472,20 @@ bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
         return false;
     }
 
+    if (plain_length != 0) {
+        *plain_length = BLOCK_SIZE;
+    }
+
     const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
 
+#if defined(TS_AES_HARDWARE)
+    if (UseAESNI) {
+        AESNIBlocks<false>(_dKb, _Nr, ct, pt, 1);
+        return true;
+    }
+#endif
+
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1418,10 +1591,6 @@ bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
         rk[3];
     PutUInt32 (pt+12, s3);
 
-    if (plain_length != 0) {
-        *plain_length = BLOCK_SIZE;
-    }
-
     return true;
 }
 
@@ -1431,6 +1600,10 @@ bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
 //----------------------------------------------------------------------------
 
 ts::AES::AES() :
-    _Nr(0)
+    _Nr(0),
+    _eK(),
+    _dK(),
+    _eKb(),
+    _dKb()
 {
 }
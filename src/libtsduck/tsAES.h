@@ -67,10 +67,21 @@ namespace ts {
         virtual bool decrypt(const void* cipher, size_t cipher_length,
                              void* plain, size_t plain_maxsize,
                              size_t* plain_length = 0) override;
+        virtual bool encryptBlocks(const void* plain, void* cipher, size_t count) override;
+        virtual bool decryptBlocks(const void* cipher, void* plain, size_t count) override;
+
+        //!
+        //! Check if AES instructions are supported by the CPU.
+        //! When supported, they are automatically used instead of the portable implementation.
+        //! @return True if AES instructions are supported by the CPU.
+        //!
+        static bool HardwareSupport();
 
     private:
         int      _Nr;     //!< Number of rounds
         uint32_t _eK[60]; //!< Scheduled encryption keys
         uint32_t _dK[60]; //!< Scheduled decryption keys
+        uint8_t  _eKb[(MAX_ROUNDS + 1) * BLOCK_SIZE]; //!< Encryption keys as bytes, for AES instructions
+        uint8_t  _dKb[(MAX_ROUNDS + 1) * BLOCK_SIZE]; //!< Decryption keys as bytes, for AES instructions
     };
 }
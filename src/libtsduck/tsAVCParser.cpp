@@ -32,9 +32,23 @@
 //----------------------------------------------------------------------------
 
 #include "tsAVCParser.h"
+#include "tsMemoryUtils.h"
 TSDUCK_SOURCE;
 
 
+//----------------------------------------------------------------------------
+// Locate the next emulation prevention byte, starting at current byte.
+//----------------------------------------------------------------------------
+
+void ts::AVCParser::locateEPB()
+{
+    // The emulation prevention byte is the 03 in 00 00 03. The 00 00 may be before the current byte.
+    const uint8_t* const start = _byte - std::min<size_t>(_byte - _base, 2);
+    const uint8_t* const seq = LocateZeroZero(start, _end - start, 0x03);
+    _epb = seq == 0 ? _end : seq + 2;
+}
+
+
 //----------------------------------------------------------------------------
 // Skip an rbsp_trailing_bits() as defined by ISO/EIC 14496-10 7.3.2.11
 // Return true if one was found and skipped.
@@ -43,6 +57,7 @@ TSDUCK_SOURCE;
 bool ts::AVCParser::rbspTrailingBits()
 {
     const uint8_t* saved_byte = _byte;
+    const uint8_t* saved_epb = _epb;
     size_t saved_bit = _bit;
     uint8_t bit;
     bool valid = readBits (bit, 1) && bit == 1;
@@ -51,6 +66,7 @@ bool ts::AVCParser::rbspTrailingBits()
     }
     if (!valid) {
         _byte = saved_byte;
+        _epb = saved_epb;
         _bit = saved_bit;
     }
     return valid;
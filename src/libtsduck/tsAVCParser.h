@@ -58,8 +58,10 @@ namespace ts {
             _end(_base + size_in_bytes),
             _total_size(size_in_bytes),
             _byte(_base),
-            _bit(0)
+            _bit(0),
+            _epb(_end)
         {
+            locateEPB();
         }
 
         //!
@@ -75,6 +77,7 @@ namespace ts {
             _total_size = size_in_bytes;
             _byte = _base;
             _bit = 0;
+            locateEPB();
         }
 
         //!
@@ -87,6 +90,7 @@ namespace ts {
         {
             _byte = _base + std::min(byte_offset + bit_offset / 8, _total_size);
             _bit = bit_offset % 8;
+            locateEPB();
         }
 
         //!
@@ -223,6 +227,10 @@ namespace ts {
         size_t         _total_size;
         const uint8_t* _byte;         // Byte pointer
         size_t         _bit;          // Bit offset into *_byte
+        const uint8_t* _epb;          // Next emulation prevention byte at or after _byte, _end if none
+
+        // Locate the next emulation prevention byte, starting at current byte.
+        void locateEPB();
 
         // Advance pointer to next byte boundary.
         void nextByte()
@@ -235,10 +243,14 @@ namespace ts {
             // Process start code emulation prevention: sequences 00 00 03
             // are used when 00 00 00 or 00 00 01 would be present. In that
             // case, the 00 00 is part of the raw byte sequence payload (rbsp)
-            // but the 03 shall be discarded.
-            if (_byte < _end && *_byte == 0x03 && _byte > _base+1 && _byte[-1] == 0x00 && _byte[-2] == 0x00) {
+            // but the 03 shall be discarded. The sequences are located in advance.
+            if (_byte > _epb) {
+                locateEPB();
+            }
+            if (_byte == _epb && _epb < _end) {
                 // Skip 03 after 00 00
                 ++_byte;
+                locateEPB();
             }
         }
 
@@ -38,9 +38,11 @@ template <typename INT, typename std::enable_if<std::is_integral<INT>::value>::t
 bool ts::AVCParser::nextBits (INT& val, size_t n)
 {
     const uint8_t* saved_byte = _byte;
+    const uint8_t* saved_epb = _epb;
     size_t saved_bit = _bit;
     bool result = readBits (val, n);
     _byte = saved_byte;
+    _epb = saved_epb;
     _bit = saved_bit;
     return result;
 }
@@ -33,10 +33,64 @@
 
 #include "tsAbstractDescrambler.h"
 #include "tsGuardCondition.h"
+#include "tsCRC32.h"
 TSDUCK_SOURCE;
 
 #define ECM_THREAD_STACK_OVERHEAD (16  * 1024)  // Stack usage in this module
 #define ECM_THREAD_STACK_USAGE    (128 * 1024)  // Default stack usage for CAS
+#define ECM_QUEUE_MAX_SIZE        4             // Max number of queued ECM's per PID
+#define ECM_RESULTS_MAX_SIZE      16            // Max number of recently deciphered ECM's
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::AbstractDescrambler::MAX_ECM_THREADS;
+#endif
+
+
+//----------------------------------------------------------------------------
+// An ECM deciphering thread.
+//----------------------------------------------------------------------------
+
+class ts::AbstractDescrambler::ECMThread: public Thread
+{
+public:
+    ECMThread(AbstractDescrambler* descrambler, const ThreadAttributes& attributes) :
+        Thread(attributes),
+        _descrambler(descrambler)
+    {
+    }
+
+    virtual ~ECMThread() { waitForTermination(); }
+
+private:
+    AbstractDescrambler* _descrambler;
+
+    virtual void main() override { _descrambler->processECMQueues(); }
+
+    // Inaccessible operations.
+    ECMThread() = delete;
+    ECMThread(const ECMThread&) = delete;
+    ECMThread& operator=(const ECMThread&) = delete;
+};
+
+
+//----------------------------------------------------------------------------
+// Received and deciphered ECM's.
+//----------------------------------------------------------------------------
+
+ts::AbstractDescrambler::ECMData::ECMData(const uint8_t* data, size_t size) :
+    ecm(data, size),
+    hash(CRC32(data, size).value()),
+    received()
+{
+    received.getSystemTime();
+}
+
+ts::AbstractDescrambler::ECMResult::ECMResult(const ECMData& data, const uint8_t* even, const uint8_t* odd) :
+    ecm(data)
+{
+    ::memcpy(cw_even, even, CW_BYTES);  // Flawfinder: ignore: memcpy()
+    ::memcpy(cw_odd, odd, CW_BYTES);    // Flawfinder: ignore: memcpy()
+}
 
 
 //----------------------------------------------------------------------------
@@ -49,19 +103,31 @@ ts::AbstractDescrambler::AbstractDescrambler(TSP* tsp_,
                                              const UString& help_) :
     ProcessorPlugin(tsp_, description_, syntax_, help_),
     _cw_mode(Scrambling::REDUCE_ENTROPY),
+    _keys(),
     _packet_count(0),
     _abort(false),
     _synchronous(false),
     _aes128_dvs042(false),
+    _batch_mode(false),
+    _batch_keys(),
+    _batch_data(),
+    _batch_size(),
+    _flush_data(),
+    _flush_size(),
     _iv(),
     _service(),
     _stack_usage(ECM_THREAD_STACK_USAGE),
     _demux(this),
     _ecm_streams(),
     _scrambled_streams(),
+    _ecm_threads(),
     _mutex(),
     _ecm_to_do(),
-    _stop_thread(false)
+    _stop_thread(false),
+    _ecm_ready(),
+    _ecm_waiting(),
+    _ecm_deciphering(),
+    _ecm_results()
 {
 }
 
@@ -77,7 +143,7 @@ ts::AbstractDescrambler::ECMStreamPtr ts::AbstractDescrambler::getOrCreateECMStr
         return ecm_it->second;
     }
     else {
-        ECMStreamPtr p (new ECMStream());
+        ECMStreamPtr p (new ECMStream(ecm_pid));
         _ecm_streams.insert(std::make_pair(ecm_pid, p));
         return p;
     }
@@ -91,7 +157,8 @@ ts::AbstractDescrambler::ECMStreamPtr ts::AbstractDescrambler::getOrCreateECMStr
 bool ts::AbstractDescrambler::startDescrambler(bool           synchronous,
                                                bool           reduce_entropy,
                                                const Service& service,
-                                               size_t         stack_usage)
+                                               size_t         stack_usage,
+                                               size_t         ecm_threads)
 {
     // Get descrambler parameters
     _cw_mode = reduce_entropy ? Scrambling::REDUCE_ENTROPY : Scrambling::FULL_CW;
@@ -99,48 +166,85 @@ bool ts::AbstractDescrambler::startDescrambler(bool           synchronous,
     _service = service;
     _stack_usage = stack_usage > 0 ? stack_usage : ECM_THREAD_STACK_USAGE;
 
+    // Stop the ECM processing threads from a previous start.
+    stopECMThreads();
+
     // Reset descrambler state
     _abort = false;
     _ecm_streams.clear();
     _scrambled_streams.clear();
+    _ecm_ready.clear();
+    _ecm_waiting.clear();
+    _ecm_deciphering.clear();
+    _ecm_results.clear();
 
     // Initialize the section demux.
     // If the service is known by name, filter the SDT, otherwise filter the PAT.
     _demux.reset();
     _demux.addPID(PID(_service.hasName() ? PID_SDT : PID_PAT));
 
-    // In asynchronous mode, create a thread for ECM processing
+    // In asynchronous mode, create the threads for ECM processing
     if (!_synchronous) {
         _stop_thread = false;
         ThreadAttributes attr;
-        Thread::getAttributes(attr);
         attr.setStackSize(ECM_THREAD_STACK_OVERHEAD + _stack_usage);
-        Thread::setAttributes(attr);
-        Thread::start();
+        const size_t count = ecm_threads == 0 ? 1 : std::min(ecm_threads, MAX_ECM_THREADS);
+        for (size_t i = 0; i < count; ++i) {
+            _ecm_threads.push_back(new ECMThread(this, attr));
+            if (!_ecm_threads.back()->start()) {
+                tsp->error(u"cannot start ECM deciphering thread");
+                stopECMThreads();
+                return false;
+            }
+        }
     }
 
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Destructor.
+//----------------------------------------------------------------------------
+
+ts::AbstractDescrambler::~AbstractDescrambler()
+{
+    stopECMThreads();
+}
+
+
 //----------------------------------------------------------------------------
 // Stop abstract descrambler.
 //----------------------------------------------------------------------------
 
 bool ts::AbstractDescrambler::stop()
 {
-    // In asynchronous mode, notify the ECM processing thread to terminate
-    // and wait for its actual termination.
-    if (!_synchronous) {
+    stopECMThreads();
+    reportECMStatistics();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Terminate the ECM processing threads.
+//----------------------------------------------------------------------------
+
+void ts::AbstractDescrambler::stopECMThreads()
+{
+    // In asynchronous mode, notify the ECM processing threads to terminate
+    // and wait for their actual termination.
+    if (!_ecm_threads.empty()) {
         {
             GuardCondition lock(_mutex, _ecm_to_do);
             _stop_thread = true;
             lock.signal();
         }
-        Thread::waitForTermination();
+        // The destructor of the threads waits for their termination.
+        for (size_t i = 0; i < _ecm_threads.size(); ++i) {
+            delete _ecm_threads[i];
+        }
+        _ecm_threads.clear();
     }
-
-    return true;
 }
 
 
@@ -303,8 +407,8 @@ void ts::AbstractDescrambler::analyzeCADescriptors(const DescriptorList& dlist,
     for (size_t index = dlist.search(DID_CA); index < dlist.count(); index = dlist.search(DID_CA, index + 1)) {
 
         // Descriptor payload
-        const uint8_t* desc = dlist[index]->payload();
-        size_t size = dlist[index]->payloadSize();
+        const uint8_t* desc = dlist.payload(index);
+        size_t size = dlist.payloadSize(index);
 
         // The fixed part of a CA descriptor is 4 bytes long.
         if (size < 4) {
@@ -372,52 +476,57 @@ void ts::AbstractDescrambler::processCMT(const Section& sect)
         return;
     }
 
-    if (sect.payloadSize() > sizeof(estream->ecm)) {
-        tsp->error(u"ECM too long (%d bytes) on PID %d (0x%X)", {sect.payloadSize(), ecm_pid, ecm_pid});
-        return;
-    }
-
     tsp->debug(u"new ECM (TID 0x%X) on PID %d (0x%X)", {sect.tableId(), ecm_pid, ecm_pid});
 
+    const ECMData data(sect.payload(), sect.payloadSize());
+
     // In asynchronous mode, the CW are accessed under mutex protection.
     if (!_synchronous) {
         _mutex.acquire();
     }
 
-    // Copy the ECM into the PID context.
-    // Flawfinder: ignore: memcpy()
-    ::memcpy(estream->ecm, sect.payload(), sect.payloadSize());
-    estream->ecm_size = sect.payloadSize();
-    estream->new_ecm = true;
+    estream->ecm_count++;
 
-    // Decipher the ECM.
-    if (_synchronous) {
+    // Decipher the ECM, unless it was recently deciphered. The shortcut is not possible
+    // when older ECM's from this stream are queued or deciphered, this would reorder the CW.
+    if (!estream->busy && estream->ecm_queue.empty() && reuseECM(*estream, data)) {
+        if (!_synchronous) {
+            _mutex.release();
+        }
+    }
+    else if (_synchronous) {
         // Synchronous mode: directly decipher the ECM
-        processECM(*estream);
+        processECM(*estream, data);
     }
     else {
-        // Asynchronous mode: signal the ECM to the ECM processing thread.
-        _ecm_to_do.signal();
+        // Asynchronous mode: queue the ECM in the stream. When the queue is full,
+        // the oldest ECM is obsolete, the new one contains the most recent CW.
+        if (estream->ecm_queue.size() >= ECM_QUEUE_MAX_SIZE) {
+            estream->ecm_queue.pop_front();
+            estream->drop_count++;
+        }
+        estream->ecm_queue.push_back(data);
+        // Signal the stream to the ECM processing threads, unless it is already
+        // in the ready list or an ECM from this stream is being deciphered.
+        if (!estream->busy && estream->ecm_queue.size() == 1) {
+            _ecm_ready.push_back(estream.pointer());
+            _ecm_to_do.signal();
+        }
         _mutex.release();
     }
 }
 
 
 //----------------------------------------------------------------------------
-// Process one ECM (the one in ECMStream::ecm).
+// Process one ECM.
 // In asynchronous mode, this method must be invoked with the mutex held.
 // Release the mutex while deciphering the ECM and relock it before exiting.
 //----------------------------------------------------------------------------
 
-void ts::AbstractDescrambler::processECM(ECMStream& estream)
+void ts::AbstractDescrambler::processECM(ECMStream& estream, const ECMData& data)
 {
-    // Copy the ECM out of the protected area into local data
-
-    uint8_t ecm[MAX_PSI_SECTION_SIZE];
-    size_t ecm_size = estream.ecm_size;
-    assert(estream.ecm_size <= sizeof(ecm));
-    ::memcpy(ecm, estream.ecm, estream.ecm_size);  // Flawfinder: ignore: memcpy()
-    estream.new_ecm = false;
+    const uint8_t* const ecm = data.ecm.data();
+    const size_t ecm_size = data.ecm.size();
 
     // In asynchronous mode, release the mutex.
 
@@ -427,8 +536,8 @@ void ts::AbstractDescrambler::processECM(ECMStream& estream)
 
     // Here, we have an ECM to decipher.
 
-    tsp->debug(u"packet %d, decipher ECM, %d bytes: %X %X %X %X %X %X %X %X ...",
-               {_packet_count - 1, ecm_size, ecm[0], ecm[1], ecm[2], ecm[3], ecm[4], ecm[5], ecm[6], ecm[7]});
+    tsp->debug(u"PID %d (0x%X), decipher ECM, %d bytes: %s ...",
+               {estream.pid, estream.pid, ecm_size, UString::Dump(ecm, std::min<size_t>(ecm_size, 8), UString::SINGLE_LINE)});
 
     // Submit the ECM to the CAS (subclass)
 
@@ -436,11 +545,21 @@ void ts::AbstractDescrambler::processECM(ECMStream& estream)
     uint8_t cw_odd[CW_BYTES];
     bool ok = decipherECM(ecm, ecm_size, cw_even, cw_odd);
 
+    // With DVB-CSA, preprocess the control words now, out of the packet processing path.
+    // Most of the time, one of them is unchanged and is found in the cache.
+
+    ScramblingPtr key_even;
+    ScramblingPtr key_odd;
+
     if (ok) {
         tsp->debug(u"even CW: %X %X %X %X %X %X %X %X",
                    {cw_even[0], cw_even[1], cw_even[2], cw_even[3], cw_even[4], cw_even[5], cw_even[6], cw_even[7]});
         tsp->debug(u"odd CW:  %X %X %X %X %X %X %X %X",
                    {cw_odd[0], cw_odd[1], cw_odd[2], cw_odd[3], cw_odd[4], cw_odd[5], cw_odd[6], cw_odd[7]});
+        if (!_aes128_dvs042) {
+            key_even = _keys.get(cw_even, _cw_mode);
+            key_odd = _keys.get(cw_odd, _cw_mode);
+        }
     }
 
     // In asynchronous mode, relock the mutex.
@@ -449,6 +568,57 @@ void ts::AbstractDescrambler::processECM(ECMStream& estream)
         _mutex.acquire();
     }
 
+    // Keep the control words for identical ECM's on any PID.
+
+    if (ok) {
+        _ecm_results.push_front(ECMResult(data, cw_even, cw_odd));
+        if (_ecm_results.size() > ECM_RESULTS_MAX_SIZE) {
+            _ecm_results.pop_back();
+        }
+    }
+
+    setCW(estream, data, ok, cw_even, cw_odd, key_even, key_odd);
+}
+
+
+//----------------------------------------------------------------------------
+// Look for an identical ECM in recently deciphered ones and reuse its CW.
+// In asynchronous mode, this method must be invoked with the mutex held.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDescrambler::reuseECM(ECMStream& estream, const ECMData& data)
+{
+    for (ECMResultList::iterator it = _ecm_results.begin(); it != _ecm_results.end(); ++it) {
+        if (it->ecm.hash == data.hash && it->ecm.ecm == data.ecm) {
+            tsp->debug(u"PID %d (0x%X), ECM already deciphered", {estream.pid, estream.pid});
+            ScramblingPtr key_even;
+            ScramblingPtr key_odd;
+            if (!_aes128_dvs042) {
+                key_even = _keys.get(it->cw_even, _cw_mode);
+                key_odd = _keys.get(it->cw_odd, _cw_mode);
+            }
+            estream.duplicate_count++;
+            setCW(estream, data, true, it->cw_even, it->cw_odd, key_even, key_odd);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Set the CW from an ECM and update the statistics of the ECM stream.
+// In asynchronous mode, this method must be invoked with the mutex held.
+//----------------------------------------------------------------------------
+
+void ts::AbstractDescrambler::setCW(ECMStream& estream,
+                                    const ECMData& data,
+                                    bool ok,
+                                    const uint8_t* cw_even,
+                                    const uint8_t* cw_odd,
+                                    const ScramblingPtr& key_even,
+                                    const ScramblingPtr& key_odd)
+{
     // Copy the control words in the protected area.
     // Normally, only one CW is modified for each new ECM.
     // Compare extracted CW with previous ones to avoid signaling a new
@@ -459,12 +629,30 @@ void ts::AbstractDescrambler::processECM(ECMStream& estream)
             // Previous even CW was either invalid or different from new one
             estream.new_cw_even = true;
             ::memcpy(estream.cw_even, cw_even, CW_BYTES);  // Flawfinder: ignore: memcpy()
+            estream.next_key_even = key_even;
         }
         if (!estream.cw_valid || ::memcmp(estream.cw_odd, cw_odd, CW_BYTES) != 0) {
             // Previous odd CW was either invalid or different from new one
             estream.new_cw_odd = true;
             ::memcpy(estream.cw_odd, cw_odd, CW_BYTES);  // Flawfinder: ignore: memcpy()
+            estream.next_key_odd = key_odd;
         }
+
+        // ECM-to-CW latency statistics.
+        Monotonic now;
+        now.getSystemTime();
+        const MilliSecond latency = (now - data.received) / NanoSecPerMilliSec;
+        if (estream.cw_count == 0 || latency < estream.min_latency) {
+            estream.min_latency = latency;
+        }
+        if (estream.cw_count == 0 || latency > estream.max_latency) {
+            estream.max_latency = latency;
+        }
+        estream.total_latency += latency;
+        estream.cw_count++;
+    }
+    else {
+        estream.error_count++;
     }
 
     estream.cw_valid = ok;
@@ -472,10 +660,30 @@ void ts::AbstractDescrambler::processECM(ECMStream& estream)
 
 
 //----------------------------------------------------------------------------
-// ECM deciphering thread
+// Report ECM statistics of all ECM streams.
 //----------------------------------------------------------------------------
 
-void ts::AbstractDescrambler::main()
+void ts::AbstractDescrambler::reportECMStatistics()
+{
+    for (ECMStreamMap::const_iterator it = _ecm_streams.begin(); it != _ecm_streams.end(); ++it) {
+        const ECMStream& es(*it->second);
+        if (es.ecm_count > 0) {
+            tsp->verbose(u"ECM PID %d (0x%X): %'d ECM, %'d deciphered, %'d duplicates, %'d dropped, %'d errors",
+                         {es.pid, es.pid, es.ecm_count, es.cw_count - es.duplicate_count, es.duplicate_count, es.drop_count, es.error_count});
+        }
+        if (es.cw_count > 0) {
+            tsp->verbose(u"ECM PID %d (0x%X): ECM-to-CW latency: min: %'d ms, average: %'d ms, max: %'d ms",
+                         {es.pid, es.pid, es.min_latency, es.total_latency / MilliSecond(es.cw_count), es.max_latency});
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// ECM deciphering threads main code.
+//----------------------------------------------------------------------------
+
+void ts::AbstractDescrambler::processECMQueues()
 {
     tsp->debug(u"ECM processing thread started");
 
@@ -488,51 +696,81 @@ void ts::AbstractDescrambler::main()
 
     for (;;) {
 
-        // Look for an ECM to decipher. Loop as long as ECM's are
-        // found (or a terminate request is encountered). We loop
-        // again if at least an ECM was found since the mutex was
-        // released during the ECM processing and a new ECM may
-        // have been added at the beginning of the list.
-
-        bool got_ecm, terminate;
-
-        do {
-            got_ecm = false;
-            terminate = _stop_thread;
-
-            // Decipher ECM's on all ECM PID's.
-            for (ECMStreamMap::iterator it = _ecm_streams.begin(); !terminate && it != _ecm_streams.end(); ++it) {
-                ECMStreamPtr& estream(it->second);
-                if (estream->new_ecm) {
+        // Wait for an ECM stream with queued ECM's or a terminate request.
+        while (!_stop_thread && _ecm_ready.empty()) {
+            lock.waitCondition();
+        }
 
-                    // Found an ECM, decipher it. Note that the mutex is
-                    // released while deciphering the ECM.
-                    got_ecm = true;
-                    processECM(*estream);
+        // The condition wakes up only one thread. If there is more work or
+        // a terminate request, wake up another thread.
+        if (_stop_thread) {
+            lock.signal();
+            break;
+        }
+        ECMStream* const estream = _ecm_ready.front();
+        _ecm_ready.pop_front();
+        if (!_ecm_ready.empty()) {
+            lock.signal();
+        }
 
-                    // Look for termination request while deciphering
-                    terminate = _stop_thread;
-                }
+        // Process the oldest ECM from the stream. No other thread can process
+        // an ECM from this stream until it is no longer busy, this preserves
+        // the order of ECM's in each stream. Note that the mutex is released
+        // while deciphering the ECM.
+        assert(!estream->busy);
+        assert(!estream->ecm_queue.empty());
+        const ECMData data(estream->ecm_queue.front());
+        if (reuseECM(*estream, data)) {
+            estream->ecm_queue.pop_front();
+        }
+        else if (isDeciphering(data)) {
+            // An identical ECM is being deciphered in another thread, probably from
+            // another PID. Leave the ECM in the queue until the other one completes.
+            _ecm_waiting.push_back(estream);
+            continue;
+        }
+        else {
+            estream->ecm_queue.pop_front();
+            estream->busy = true;
+            _ecm_deciphering.push_back(&data);
+            processECM(*estream, data);
+            _ecm_deciphering.remove(&data);
+            estream->busy = false;
+
+            // Streams which were waiting for an identical ECM can reuse the result.
+            if (!_ecm_waiting.empty()) {
+                _ecm_ready.insert(_ecm_ready.end(), _ecm_waiting.begin(), _ecm_waiting.end());
+                _ecm_waiting.clear();
+                lock.signal();
             }
-        } while (!terminate && got_ecm);
-
-        // Check if a terminate request is found
-        if (terminate) {
-            break;
         }
 
-        // We have accomplished a full scan of all ECM PID's and found no ECM.
-        // The mutex was consequently not released during the loop and we are
-        // now sure that there is nothing to do. The mutex is implicitely
-        // released and we wait for the condition 'ecm_to_do' and, once we
-        // get it, implicitely relock the mutex.
-        lock.waitCondition();
+        // Other ECM's may have been queued in the stream while deciphering.
+        if (!estream->ecm_queue.empty()) {
+            _ecm_ready.push_back(estream);
+            lock.signal();
+        }
     }
 
     tsp->debug(u"ECM processing thread terminated");
 }
 
 
+//----------------------------------------------------------------------------
+// Check if an identical ECM is being deciphered.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDescrambler::isDeciphering(const ECMData& data) const
+{
+    for (std::list<const ECMData*>::const_iterator it = _ecm_deciphering.begin(); it != _ecm_deciphering.end(); ++it) {
+        if ((*it)->hash == data.hash && (*it)->ecm == data.ecm) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processing method
 //----------------------------------------------------------------------------
@@ -588,13 +826,17 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     // We found a valid CW, check if new CW were deciphered
     if ((scv == SC_EVEN_KEY && pecm->new_cw_even) || (scv == SC_ODD_KEY && pecm->new_cw_odd)) {
 
-        // A new CW was deciphered. Convert it into a DVB-CSA key context.
+        // A new CW was deciphered. With DVB-CSA, the key context was already
+        // prepared by processECM(), we just switch to it.
         // In asynchronous mode, the CW are accessed under mutex protection.
 
         if (!_synchronous) {
             _mutex.acquire();
         }
 
+        // Queued payloads must be descrambled with the previous keys.
+        flushBatch();
+
         if (_aes128_dvs042) {
             if (!pecm->dvs042.setIV(_iv.data(), _iv.size())) {
                 tsp->error(u"error setting initialization vector in AES-128/DVS042 engine");
@@ -613,11 +855,11 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
             pecm->new_cw_odd = false;
         }
         else if (scv == SC_EVEN_KEY) {
-            pecm->key_even.init(pecm->cw_even, _cw_mode);
+            pecm->key_even = pecm->next_key_even;
             pecm->new_cw_even = false;
         }
         else {
-            pecm->key_odd.init(pecm->cw_odd, _cw_mode);
+            pecm->key_odd = pecm->next_key_odd;
             pecm->new_cw_odd = false;
         }
 
@@ -639,8 +881,15 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
         ::memcpy(pl, tmp, pl_size);  // Flawfinder: ignore: memcpy()
     }
     else {
-        Scrambling& scr(scv == SC_EVEN_KEY ? pecm->key_even : pecm->key_odd);
-        scr.decrypt(pl, pl_size);
+        Scrambling& scr(scv == SC_EVEN_KEY ? *pecm->key_even : *pecm->key_odd);
+        if (_batch_mode) {
+            _batch_keys.push_back(&scr);
+            _batch_data.push_back(pl);
+            _batch_size.push_back(pl_size);
+        }
+        else {
+            scr.decrypt(pl, pl_size);
+        }
 
         // Trace CW change in PIDs
         if (scv != ss.last_scv) {
@@ -659,3 +908,50 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method.
+//----------------------------------------------------------------------------
+
+size_t ts::AbstractDescrambler::processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
+{
+    // The packets are processed by the virtual processPacket() since it may be overridden by the subclass.
+    _batch_mode = !_aes128_dvs042;
+    const size_t processed = ProcessorPlugin::processPacketBatch(pkt, status, count, flush, bitrate_changed);
+    flushBatch();
+    _batch_mode = false;
+    return processed;
+}
+
+
+//----------------------------------------------------------------------------
+// Descramble all queued payloads, grouped by key.
+//----------------------------------------------------------------------------
+
+void ts::AbstractDescrambler::flushBatch()
+{
+    // There are usually one or two distinct keys in a batch (even and odd).
+    while (!_batch_keys.empty()) {
+        Scrambling* const key = _batch_keys.front();
+        size_t next = 0;
+        _flush_data.clear();
+        _flush_size.clear();
+        for (size_t i = 0; i < _batch_keys.size(); ++i) {
+            if (_batch_keys[i] == key) {
+                _flush_data.push_back(_batch_data[i]);
+                _flush_size.push_back(_batch_size[i]);
+            }
+            else {
+                _batch_keys[next] = _batch_keys[i];
+                _batch_data[next] = _batch_data[i];
+                _batch_size[next] = _batch_size[i];
+                next++;
+            }
+        }
+        _batch_keys.resize(next);
+        _batch_data.resize(next);
+        _batch_size.resize(next);
+        key->decryptBatch(&_flush_data[0], &_flush_size[0], _flush_data.size());
+    }
+}
@@ -36,7 +36,7 @@
 #include "tsPlugin.h"
 #include "tsSafePtr.h"
 #include "tsService.h"
-#include "tsScrambling.h"
+#include "tsScramblingCache.h"
 #include "tsSectionDemux.h"
 #include "tsCondition.h"
 #include "tsMutex.h"
@@ -44,6 +44,7 @@
 #include "tsPAT.h"
 #include "tsPMT.h"
 #include "tsSDT.h"
+#include "tsMonotonic.h"
 #include "tsMemoryUtils.h"
 #include "tsAES.h"
 #include "tsDVS042.h"
@@ -53,10 +54,19 @@ namespace ts {
     //!
     //! Abstract base class for DVB descrambler plugins.
     //!
+    //! In asynchronous mode, the ECM's are deciphered by a pool of threads. Each ECM PID has
+    //! its own queue of ECM's. The ECM's of a given PID are deciphered one at a time, in order.
+    //! ECM's of distinct PID's may be deciphered in parallel when there are several threads.
+    //! An ECM which is identical to a recently deciphered one, possibly on another PID, is not
+    //! submitted again to the CAS, the previous control words are reused. This is also true
+    //! for an ECM which is identical to one being deciphered in another thread.
+    //!
+    //! When the plugin stops, ECM statistics and ECM-to-CW latency are reported per ECM PID
+    //! in verbose mode.
+    //!
     class TSDUCKDLL AbstractDescrambler:
         public ProcessorPlugin,
-        protected TableHandlerInterface,
-        private Thread
+        protected TableHandlerInterface
     {
     public:
         //!
@@ -71,12 +81,30 @@ namespace ts {
                             const UString& syntax = UString(),
                             const UString& help = UString());
 
+        //!
+        //! Destructor.
+        //!
+        virtual ~AbstractDescrambler();
+
         // Implementation of ProcessorPlugin interface.
         // If overridden by descrambler subclass, superclass must be explicitly invoked.
         virtual bool stop() override;
         virtual BitRate getBitrate() override {return 0;}
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
 
+        //!
+        //! Process a batch of packets.
+        //! In DVB-CSA mode, the payloads are queued by processPacket() and descrambled
+        //! together at the end of the batch or before any control word change.
+        //! @param [in,out] pkt Address of the first TS packet to process.
+        //! @param [out] status Address of an array of @a count processing status.
+        //! @param [in] count Number of packets to process.
+        //! @param [in,out] flush Set to true if a packet requests a flush.
+        //! @param [in,out] bitrate_changed Set to true if a packet signals a bitrate change.
+        //! @return The number of processed packets.
+        //!
+        virtual size_t processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed) override;
+
     protected:
         //!
         //! Specify to use DVB-CSA descrambling (the default).
@@ -99,18 +127,28 @@ namespace ts {
 
         //!
         //! Start the abstract descrambler.
-        //! Should be invoked from the plugin's start() method.
+        //! Should be invoked from the plugin's start() method. When the plugin is restarted,
+        //! the ECM deciphering threads from the previous start are terminated first.
         //! @param [in] synchronous Synchronous ECM deciphering when true.
         //! Otherwise, the method decipherECM() is invoked into another thread.
         //! @param [in] reduce_entropy Perform entropy reduction on CW.
         //! @param [in] service Service to descramble (by name, id or none).
         //! @param [in] stack_usage Stack usage for asynchronous ECM deciphering (0 for default).
+        //! @param [in] ecm_threads Number of threads for asynchronous ECM deciphering (0 for default,
+        //! one thread). With more than one thread, decipherECM() may be invoked concurrently for
+        //! distinct ECM PID's and must be thread-safe.
         //! @return True on success, false on error.
         //!
         bool startDescrambler(bool           synchronous,
                               bool           reduce_entropy,
                               const Service& service,
-                              size_t         stack_usage = 0);
+                              size_t         stack_usage = 0,
+                              size_t         ecm_threads = 0);
+
+        //!
+        //! Maximum number of threads for asynchronous ECM deciphering.
+        //!
+        static const size_t MAX_ECM_THREADS = 32;
 
         //!
         //! Check a CA_descriptor from a PMT.
@@ -151,28 +189,66 @@ namespace ts {
         virtual void handleTable (SectionDemux&, const BinaryTable&) override;
 
     private:
+        class ECMThread;
         struct ScrambledStream;
         struct ECMStream;
+        struct ECMData;
+        struct ECMResult;
         typedef SafePtr <ECMStream, NullMutex> ECMStreamPtr;
         typedef std::map <PID, ScrambledStream> ScrambledStreamMap;
         typedef std::map <PID, ECMStreamPtr> ECMStreamMap;
+        typedef std::list <ECMResult> ECMResultList;
 
         // Abstract descrambler private data
         Scrambling::EntropyMode _cw_mode;
+        ScramblingCache    _keys;              // Cache of preprocessed DVB-CSA control words
         PacketCounter      _packet_count;      // Packet counter in TS
         bool               _abort;             // Error, abort asap
         bool               _synchronous;       // Synchronous ECM deciphering
         bool               _aes128_dvs042;     // Use AES-128 in DVS 042 mode instead of DVB-CSA
+        bool               _batch_mode;        // DVB-CSA payloads are queued, see processPacketBatch()
+        std::vector<Scrambling*> _batch_keys;  // Key of each queued payload
+        std::vector<uint8_t*> _batch_data;     // Queued payloads
+        std::vector<size_t> _batch_size;       // Sizes of queued payloads
+        std::vector<uint8_t*> _flush_data;     // Work area for flushBatch()
+        std::vector<size_t> _flush_size;       // Work area for flushBatch()
         ByteBlock          _iv;                // Initialization vector if chained mode (not DVB-CSA)
         Service            _service;           // Service to descramble (by name, id or none)
         size_t             _stack_usage;       // Stack usage for ECM deciphering
         SectionDemux       _demux;             // Section demux
         ECMStreamMap       _ecm_streams;       // ECM streams, indexed by PID
         ScrambledStreamMap _scrambled_streams; // ECM streams, indexed by PID
+        std::vector<ECMThread*> _ecm_threads;  // ECM deciphering threads
         Mutex              _mutex;             // Exclusive access to protected areas
-        Condition          _ecm_to_do;         // Notify thread to process ECM
+        Condition          _ecm_to_do;         // Notify threads to process ECM
         // -- start of protected area --
-        bool               _stop_thread;       // Terminate ECM processing thread
+        bool               _stop_thread;       // Terminate ECM processing threads
+        std::deque<ECMStream*> _ecm_ready;     // ECM streams with queued ECM's and no ECM being deciphered
+        std::deque<ECMStream*> _ecm_waiting;   // ECM streams waiting for an identical ECM being deciphered
+        std::list<const ECMData*> _ecm_deciphering; // ECM's being deciphered
+        ECMResultList      _ecm_results;       // Recently deciphered ECM's, most recent first
+
+        // An ECM, as received in a CMT section.
+        struct ECMData
+        {
+            ByteBlock ecm;       // CMT section payload
+            uint32_t  hash;      // CRC32 of ECM, for duplicate detection
+            Monotonic received;  // Reception time of the ECM
+
+            // Constructor:
+            ECMData(const uint8_t* data, size_t size);
+        };
+
+        // A recently deciphered ECM.
+        struct ECMResult
+        {
+            ECMData ecm;                // The deciphered ECM
+            uint8_t cw_even[CW_BYTES];  // Corresponding CW (even)
+            uint8_t cw_odd[CW_BYTES];   // Corresponding CW (odd)
+
+            // Constructor:
+            ECMResult(const ECMData& data, const uint8_t* even, const uint8_t* odd);
+        };
 
         // Description of a scrambled stream
         struct ScrambledStream
@@ -187,23 +263,35 @@ namespace ts {
         // Description of an ECM stream
         struct ECMStream
         {
+            PID         pid;                   // ECM PID
             TID         last_tid;              // Last table id (0x80 or 0x81)
-            Scrambling  key_even;              // DVB-CSA preprocessed CW (even)
-            Scrambling  key_odd;               // DVB-CSA preprocessed CW (odd)
+            ScramblingPtr key_even;            // DVB-CSA preprocessed CW (even)
+            ScramblingPtr key_odd;             // DVB-CSA preprocessed CW (odd)
             DVS042<AES> dvs042;                // AES cipher in DVS 042 mode (not DVB-CSA)
             // -- start of write-protected, read-volative area --
             volatile bool cw_valid;            // CW's are valid
             volatile bool new_cw_even;         // New CW available (even)
             volatile bool new_cw_odd;          // New CW available (odd)
             // -- start of protected area --
-            bool    new_ecm;                   // New ECM available
-            size_t  ecm_size;                  // Used size in ECM
-            uint8_t ecm[MAX_PSI_SECTION_SIZE]; // Last received ECM
+            std::deque<ECMData> ecm_queue;     // Received ECM's, not yet deciphered
+            bool    busy;                      // An ECM from this stream is being deciphered
             uint8_t cw_even[CW_BYTES];         // Last valid CW (even)
             uint8_t cw_odd[CW_BYTES];          // Last valid CW (odd)
+            ScramblingPtr next_key_even;       // DVB-CSA preprocessed cw_even, prepared by ECM thread
+            ScramblingPtr next_key_odd;        // DVB-CSA preprocessed cw_odd, prepared by ECM thread
+            // Statistics, in protected area:
+            PacketCounter ecm_count;           // Number of received ECM's
+            PacketCounter cw_count;            // Number of ECM's with control words
+            PacketCounter duplicate_count;     // Number of ECM's found in recent results
+            PacketCounter drop_count;          // Number of obsolete ECM's dropped from the queue
+            PacketCounter error_count;         // Number of ECM deciphering errors
+            MilliSecond   min_latency;         // Minimum ECM-to-CW latency
+            MilliSecond   max_latency;         // Maximum ECM-to-CW latency
+            MilliSecond   total_latency;       // Cumulated ECM-to-CW latency
 
             // Constructor:
-            ECMStream() :
+            ECMStream(PID ecm_pid) :
+                pid (ecm_pid),
                 last_tid (TID_NULL),
                 key_even (),
                 key_odd (),
@@ -211,10 +299,19 @@ namespace ts {
                 cw_valid (false),
                 new_cw_even (false),
                 new_cw_odd (false),
-                new_ecm (false),
-                ecm_size (0)
+                ecm_queue (),
+                busy (false),
+                next_key_even (),
+                next_key_odd (),
+                ecm_count (0),
+                cw_count (0),
+                duplicate_count (0),
+                drop_count (0),
+                error_count (0),
+                min_latency (0),
+                max_latency (0),
+                total_latency (0)
             {
-                TS_ZERO (ecm);
                 TS_ZERO (cw_even);
                 TS_ZERO (cw_odd);
             }
@@ -223,16 +320,36 @@ namespace ts {
         // Get the ECM stream for a PID, create it if non existent
         ECMStreamPtr getOrCreateECMStream (PID);
 
-        // Process one ECM (the one in ECMStream::ecm).
+        // Process one ECM.
         // In asynchronous mode, this method must be invoked with the mutex held. The method
         // releases the mutex while deciphering the ECM and relocks it before exiting.
-        void processECM (ECMStream&);
+        void processECM (ECMStream&, const ECMData&);
+
+        // Look for an identical ECM in recently deciphered ones and reuse its CW.
+        // In asynchronous mode, this method must be invoked with the mutex held.
+        bool reuseECM (ECMStream&, const ECMData&);
+
+        // Set the CW from an ECM and update the statistics of the ECM stream.
+        // In asynchronous mode, this method must be invoked with the mutex held.
+        void setCW (ECMStream&, const ECMData&, bool ok, const uint8_t* cw_even, const uint8_t* cw_odd, const ScramblingPtr& key_even, const ScramblingPtr& key_odd);
+
+        // Terminate the ECM processing threads.
+        void stopECMThreads ();
+
+        // Report ECM statistics of all ECM streams.
+        void reportECMStatistics ();
+
+        // Descramble all queued payloads. Must be invoked before any change of key.
+        void flushBatch();
 
         // Analyze a list of descriptors, looking for ECM PID's
         void analyzeCADescriptors (const DescriptorList& dlist, std::set<PID>& ecm_pids);
 
-        // ECM deciphering thread
-        virtual void main() override;
+        // ECM deciphering threads main code.
+        void processECMQueues();
+
+        // Check if an identical ECM is being deciphered. Must be invoked with the mutex held.
+        bool isDeciphering(const ECMData&) const;
 
         // Process specific tables
         void processPAT (const PAT&);
@@ -136,6 +136,30 @@ namespace ts {
                              void* plain, size_t plain_maxsize,
                              size_t* plain_length = 0) = 0;
 
+        //!
+        //! Encrypt several independent blocks of data (ECB mode).
+        //! The default implementation invokes encrypt() on each block. Subclasses
+        //! may override it to process several blocks in parallel.
+        //! @param [in] plain Address of plain text, @a count blocks of blockSize() bytes.
+        //! @param [out] cipher Address of buffer for cipher text, @a count blocks of blockSize()
+        //! bytes. It may be identical to @a plain (in place encryption) but shall not partially overlap.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptBlocks(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several independent blocks of data (ECB mode).
+        //! The default implementation invokes decrypt() on each block. Subclasses
+        //! may override it to process several blocks in parallel.
+        //! @param [in] cipher Address of cipher text, @a count blocks of blockSize() bytes.
+        //! @param [out] plain Address of buffer for plain text, @a count blocks of blockSize()
+        //! bytes. It may be identical to @a cipher (in place decryption) but shall not partially overlap.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool decryptBlocks(const void* cipher, void* plain, size_t count);
+
         //!
         //! Virtual destructor.
         //!
@@ -113,9 +113,8 @@ void ts::CASMapper::handleTable(SectionDemux&, const BinaryTable& table)
 void ts::CASMapper::analyzeCADescriptors(const DescriptorList& descs, bool is_ecm)
 {
     for (size_t i = 0; i < descs.count(); ++i) {
-        const DescriptorPtr& desc(descs[i]);
-        if (!desc.isNull() && desc->tag() == DID_CA) {
-            const CADescriptorPtr cadesc(new CADescriptor(*desc));
+        if (descs.tag(i) == DID_CA) {
+            const CADescriptorPtr cadesc(new CADescriptor(*descs[i]));
             if (!cadesc.isNull() && cadesc->isValid()) {
                 const std::string cas_name(names::CASId(cadesc->cas_id).toUTF8());
                 _pids[cadesc->ca_pid] = PIDDescription(cadesc->cas_id, is_ecm, cadesc);
@@ -220,8 +220,8 @@ size_t ts::CASSelectionArgs::addMatchingPIDs(PIDSet& pids, const DescriptorList&
     else {
         // No filtering by operator, loop on all CA descriptors.
         for (size_t index = dlist.search(DID_CA); index < dlist.count(); index = dlist.search(DID_CA, index + 1)) {
-            const uint8_t* desc = dlist[index]->payload();
-            const size_t size = dlist[index]->payloadSize();
+            const uint8_t* desc = dlist.payload(index);
+            const size_t size = dlist.payloadSize(index);
             if (size >= 4) {
                 // Get CA_system_id and ECM/EMM PID
                 const uint16_t sysid = GetUInt16(desc);
@@ -51,7 +51,7 @@ namespace ts {
         //!
         //! Constructor.
         //!
-        CBC() : CipherChainingTemplate<CIPHER>(1, 1, 1) {}
+        CBC() : CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS + 1) {}
 
         // Implementation of CipherChaining interface.
         virtual size_t minMessageSize() const override {return this->block_size;}
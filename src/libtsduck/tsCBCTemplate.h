@@ -91,7 +91,6 @@ bool ts::CBC<CIPHER>::decrypt(const void* cipher, size_t cipher_length,
 {
     if (this->algo == 0 ||
         this->iv.size() != this->block_size ||
-        this->work.size() < this->block_size ||
         cipher_length % this->block_size != 0 ||
         plain_maxsize < cipher_length) {
         return false;
@@ -100,26 +99,8 @@ bool ts::CBC<CIPHER>::decrypt(const void* cipher, size_t cipher_length,
         *plain_length = cipher_length;
     }
 
-    const uint8_t* previous = this->iv.data();
+    // Unlike encryption, the decryption of all blocks is independent: plain-text = previous-cipher XOR decrypt(cipher-text)
     const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
-
-    while (cipher_length > 0) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
-            return false;
-        }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
-    }
-
-    return true;
+    return this->decryptCBC(ct, pt, cipher_length / this->block_size);
 }
@@ -34,6 +34,19 @@
 #include "tsCRC32.h"
 TSDUCK_SOURCE;
 
+// Carry-less multiplication is used on x86-64 processors with PCLMULQDQ.
+#if defined(TS_X86_64) && (defined(TS_GCC) || defined(TS_MSC))
+    #define TS_CRC32_CLMUL 1
+    #if defined(TS_MSC)
+        #include <intrin.h>
+        #define TS_CLMUL_TARGET
+    #else
+        #include <cpuid.h>
+        #include <immintrin.h>
+        #define TS_CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+    #endif
+#endif
+
 
 // The FCS-32 generator polynomial:
 //     x**0 + x**1 + x**2 + x**4 + x**5 +
@@ -109,13 +122,190 @@ namespace {
     };
 }
 
+
+
+//----------------------------------------------------------------------------
+// Slicing-by-8: process 8 bytes at a time using 8 tables. Table 0 is the
+// standard one-byte table. Table k gives the contribution of a byte which
+// is followed by k other bytes in the 8-byte block.
+//----------------------------------------------------------------------------
+
+namespace {
+    class SliceTables
+    {
+    public:
+        uint32_t t[8][256];
+        SliceTables();
+    };
+
+    SliceTables::SliceTables()
+    {
+        for (size_t b = 0; b < 256; ++b) {
+            t[0][b] = fcstab_32[b];
+        }
+        for (size_t k = 1; k < 8; ++k) {
+            for (size_t b = 0; b < 256; ++b) {
+                t[k][b] = (t[k-1][b] << 8) ^ fcstab_32[t[k-1][b] >> 24];
+            }
+        }
+    }
+
+    // Built on first use, independently of static initialization order.
+    const SliceTables& GetSliceTables()
+    {
+        static const SliceTables tables;
+        return tables;
+    }
+
+    uint32_t AddSlice8(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        if (size >= 8) {
+            const SliceTables& st(GetSliceTables());
+            while (size >= 8) {
+                const uint32_t w1 = ts::GetUInt32(cp) ^ fcs;
+                const uint32_t w2 = ts::GetUInt32(cp + 4);
+                fcs = st.t[7][w1 >> 24] ^ st.t[6][(w1 >> 16) & 0xFF] ^ st.t[5][(w1 >> 8) & 0xFF] ^ st.t[4][w1 & 0xFF] ^
+                      st.t[3][w2 >> 24] ^ st.t[2][(w2 >> 16) & 0xFF] ^ st.t[1][(w2 >> 8) & 0xFF] ^ st.t[0][w2 & 0xFF];
+                cp += 8;
+                size -= 8;
+            }
+        }
+        while (size-- > 0) {
+            fcs = (fcs << 8) ^ fcstab_32[((fcs >> 24) ^ (*cp++)) & 0xFF];
+        }
+        return fcs;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Carry-less multiplication (see Intel white paper "Fast CRC Computation for
+// Generic Polynomials Using PCLMULQDQ Instruction").
+//
+// The data are folded by blocks of 128 bits, interpreted as big-endian
+// polynomials. Folding a 128-bit value X = Xh.x^64 + Xl over N bits gives
+// Xh.(x^(N+64) mod P) + Xl.(x^N mod P), a 96-bit value which is congruent
+// to X.x^N modulo P. The final 128-bit remainder is reduced using tables.
+//----------------------------------------------------------------------------
+
+#if defined(TS_CRC32_CLMUL)
+namespace {
+
+    // Minimum size of data to use carry-less multiplication.
+    const size_t CLMUL_MIN_SIZE = 64;
+
+    bool CPUHasCLMUL()
+    {
+        // CPUID function 1, ECX bit 1 = PCLMULQDQ, bit 9 = SSSE3
+    #if defined(TS_MSC)
+        int info[4];
+        __cpuid(info, 1);
+        const unsigned int ecx = static_cast<unsigned int>(info[2]);
+    #else
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+            return false;
+        }
+    #endif
+        return (ecx & (1 << 1)) != 0 && (ecx & (1 << 9)) != 0;
+    }
+
+    TS_CLMUL_TARGET inline __m128i Fold(__m128i x, __m128i k, __m128i data)
+    {
+        return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00)), data);
+    }
+
+    // Process all 16-byte blocks, at least CLMUL_MIN_SIZE bytes. Update cp and size.
+    TS_CLMUL_TARGET uint32_t AddCLMUL(uint32_t fcs, const uint8_t*& cp, size_t& size)
+    {
+        // Reverse bytes order in 128-bit values.
+        const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+        // Folding constants, high part: x^(N+64) mod P, low part: x^N mod P.
+        const __m128i k512 = _mm_set_epi64x(0x8833794C, 0xE6228B11);
+        const __m128i k128 = _mm_set_epi64x(0xC5B9CD4C, 0xE8A45605);
+
+        #define TS_CLMUL_LOAD(index) _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp + 16 * (index))), bswap)
+
+        // The current CRC value is added to the first 32 bits of data.
+        __m128i x0 = _mm_xor_si128(TS_CLMUL_LOAD(0), _mm_set_epi32(int(fcs), 0, 0, 0));
+        __m128i x1 = TS_CLMUL_LOAD(1);
+        __m128i x2 = TS_CLMUL_LOAD(2);
+        __m128i x3 = TS_CLMUL_LOAD(3);
+        cp += 64;
+        size -= 64;
+
+        // Fold 4 blocks in parallel.
+        while (size >= 64) {
+            x0 = Fold(x0, k512, TS_CLMUL_LOAD(0));
+            x1 = Fold(x1, k512, TS_CLMUL_LOAD(1));
+            x2 = Fold(x2, k512, TS_CLMUL_LOAD(2));
+            x3 = Fold(x3, k512, TS_CLMUL_LOAD(3));
+            cp += 64;
+            size -= 64;
+        }
+
+        // Reduce to one block.
+        x1 = Fold(x0, k128, x1);
+        x2 = Fold(x1, k128, x2);
+        x3 = Fold(x2, k128, x3);
+
+        // Fold remaining blocks, one at a time.
+        while (size >= 16) {
+            x3 = Fold(x3, k128, TS_CLMUL_LOAD(0));
+            cp += 16;
+            size -= 16;
+        }
+
+        #undef TS_CLMUL_LOAD
+
+        // The remainder is congruent to the data. Its CRC is the CRC of the data.
+        uint8_t rem[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rem), _mm_shuffle_epi8(x3, bswap));
+        return AddSlice8(0, rem, sizeof(rem));
+    }
+
+    // Use carry-less multiplication when supported by the CPU.
+    bool UseCLMUL = CPUHasCLMUL();
+}
+#endif
+
+
+//----------------------------------------------------------------------------
+// Check or select the use of carry-less multiplication.
+//----------------------------------------------------------------------------
+
+bool ts::CRC32::IsAccelerated()
+{
+#if defined(TS_CRC32_CLMUL)
+    return UseCLMUL;
+#else
+    return false;
+#endif
+}
+
+bool ts::CRC32::SetAccelerated(bool on)
+{
+#if defined(TS_CRC32_CLMUL)
+    UseCLMUL = on && CPUHasCLMUL();
+#endif
+    return IsAccelerated();
+}
+
+
+//----------------------------------------------------------------------------
 // Continue the computation of a data area, following a previous CRC32
+//----------------------------------------------------------------------------
 
-void ts::CRC32::add (const void* data, size_t size)
+void ts::CRC32::add(const void* data, size_t size)
 {
-    const uint8_t* cp = static_cast <const uint8_t*> (data);
+    const uint8_t* cp = static_cast<const uint8_t*>(data);
 
-    while (size-- > 0) {
-        _fcs = (_fcs << 8) ^ fcstab_32 [((_fcs >> 24) ^ (*cp++)) & 0xFF];
+#if defined(TS_CRC32_CLMUL)
+    if (UseCLMUL && size >= CLMUL_MIN_SIZE) {
+        _fcs = AddCLMUL(_fcs, cp, size);
     }
+#endif
+
+    _fcs = AddSlice8(_fcs, cp, size);
 }
@@ -150,6 +150,24 @@ namespace ts {
             _fcs = 0xFFFFFFFF;
         }
 
+        //!
+        //! Check if the computation of CRC32 uses specialized instructions of the CPU.
+        //! On x86-64 processors with PCLMULQDQ, carry-less multiplication is used.
+        //! Otherwise, a portable table-driven method processes 8 bytes at a time.
+        //! The results are identical in all cases.
+        //! @return True if the CRC32 computation uses specialized instructions.
+        //!
+        static bool IsAccelerated();
+
+        //!
+        //! Enable or disable the use of specialized instructions of the CPU.
+        //! They are used by default when supported by the CPU. Disabling them
+        //! is useful only for tests and benchmarks.
+        //! @param [in] on If true, use specialized instructions when supported by the CPU.
+        //! @return True if the CRC32 computation uses specialized instructions.
+        //!
+        static bool SetAccelerated(bool on);
+
         //!
         //! What to do with a CRC32.
         //! Used when building MPEG sections.
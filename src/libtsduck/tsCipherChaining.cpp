@@ -28,8 +28,13 @@
 //----------------------------------------------------------------------------
 
 #include "tsCipherChaining.h"
+#include "tsMemoryUtils.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::CipherChaining::PARALLEL_BLOCKS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor for subclasses
@@ -110,3 +115,58 @@ bool ts::CipherChaining::setIV(const void* iv_data, size_t iv_length)
         return true;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Decrypt complete blocks in CBC mode, several blocks at a time.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Xor a memory area into another one, 8 bytes at a time when possible.
+    void XorBytes(uint8_t* dest, const uint8_t* src, size_t size)
+    {
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            ts::PutUInt64LE(dest + i, ts::GetUInt64LE(dest + i) ^ ts::GetUInt64LE(src + i));
+        }
+        for (; i < size; ++i) {
+            dest[i] ^= src[i];
+        }
+    }
+}
+
+bool ts::CipherChaining::decryptCBC(const uint8_t* cipher, uint8_t* plain, size_t count)
+{
+    if (algo == 0 || iv.size() != block_size || work.size() < (PARALLEL_BLOCKS + 1) * block_size) {
+        return false;
+    }
+
+    // Work buffer: previous cipher block, followed by PARALLEL_BLOCKS deciphered blocks.
+    const size_t bsize = block_size;
+    uint8_t* const previous = work.data();
+    uint8_t* const deciphered = previous + bsize;
+    ::memcpy(previous, iv.data(), bsize);  // Flawfinder: ignore: memcpy()
+
+    while (count > 0) {
+        const size_t blocks = std::min(count, PARALLEL_BLOCKS);
+        const size_t size = blocks * bsize;
+
+        // work = decrypt(cipher-text), all blocks are independent.
+        if (!algo->decryptBlocks(cipher, deciphered, blocks)) {
+            return false;
+        }
+
+        // work = previous-cipher XOR work. The cipher text is not yet modified.
+        XorBytes(deciphered, previous, bsize);
+        XorBytes(deciphered + bsize, cipher, size - bsize);
+
+        // Keep last cipher block for next iteration, before overwriting it when decrypting in place.
+        ::memcpy(previous, cipher + size - bsize, bsize);  // Flawfinder: ignore: memcpy()
+        ::memcpy(plain, deciphered, size);  // Flawfinder: ignore: memcpy()
+
+        cipher += size;
+        plain += size;
+        count -= blocks;
+    }
+    return true;
+}
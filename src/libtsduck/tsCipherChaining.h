@@ -97,6 +97,23 @@ namespace ts {
         ByteBlock    iv;          //!< Current initialization vector.
         ByteBlock    work;        //!< Temporary working buffer.
 
+        //!
+        //! Number of blocks which are decrypted together by decryptCBC().
+        //!
+        static const size_t PARALLEL_BLOCKS = 8;
+
+        //!
+        //! Decrypt complete blocks in CBC mode, starting from the current IV.
+        //! The blocks are deciphered PARALLEL_BLOCKS at a time using BlockCipher::decryptBlocks().
+        //! The @a work buffer must contain at least PARALLEL_BLOCKS + 1 blocks.
+        //! @param [in] cipher Address of cipher text.
+        //! @param [out] plain Address of plain text. It may be identical to @a cipher (in place
+        //! decryption) but shall not partially overlap.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        bool decryptCBC(const uint8_t* cipher, uint8_t* plain, size_t count);
+
         //!
         //! Constructor for subclasses.
         //! @param [in,out] cipher An instance of block cipher.
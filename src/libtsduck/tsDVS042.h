@@ -65,7 +65,7 @@ namespace ts {
         //!
         //! Constructor.
         //!
-        DVS042() : CipherChainingTemplate<CIPHER>(1, 1, 1) {}
+        DVS042() : CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS + 1) {}
 
         // Implementation of CipherChaining interface.
         virtual size_t minMessageSize() const override {return this->block_size;}
@@ -115,40 +115,26 @@ bool ts::DVS042<CIPHER>::decrypt(const void* cipher, size_t cipher_length,
         *plain_length = cipher_length;
     }
 
-    // Decrypt all blocks in CBC mode, except the last one if partial
-
-    const uint8_t* previous = this->iv.data();
     const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
+    const size_t blocks = cipher_length / this->block_size;
+    const size_t residue = cipher_length % this->block_size;
 
-    while (cipher_length >= this->block_size) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
-            return false;
-        }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
-    }
+    // Process final block first if incomplete, while Cn-1 is not yet overwritten (in place decryption).
 
-    // Process final block if incomplete
-
-    if (cipher_length > 0) {
+    if (residue > 0) {
+        const uint8_t* const previous = ct + (blocks - 1) * this->block_size;
+        const size_t last = blocks * this->block_size;
         // work = encrypt (Cn-1)
         if (!this->algo->encrypt(previous, this->block_size, this->work.data(), this->block_size)) {
             return false;
         }
         // Pn = work XOR Cn, truncated
-        for (size_t i = 0; i < cipher_length; ++i) {
-            pt[i] = this->work[i] ^ ct[i];
+        for (size_t i = 0; i < residue; ++i) {
+            pt[last + i] = this->work[i] ^ ct[last + i];
         }
     }
-    return true;
+
+    // Decrypt all complete blocks in CBC mode.
+    return this->decryptCBC(ct, pt, blocks);
 }
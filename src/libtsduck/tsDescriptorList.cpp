@@ -45,13 +45,15 @@ TSDUCK_SOURCE;
 
 ts::DescriptorList::DescriptorList(const AbstractTable* table) :
     _table(table),
-    _list()
+    _list(),
+    _raw()
 {
 }
 
 ts::DescriptorList::DescriptorList(const AbstractTable* table, const DescriptorList& dl) :
     _table(table),
-    _list(dl._list)
+    _list(dl._list),
+    _raw(dl._raw)
 {
 }
 
@@ -59,12 +61,61 @@ ts::DescriptorList& ts::DescriptorList::operator=(const DescriptorList& dl)
 {
     if (&dl != this) {
         // Copy the list of descriptors but preserve the parent table.
+        // The compact buffer is shared, it is duplicated on next append.
         _list = dl._list;
+        _raw = dl._raw;
     }
     return *this;
 }
 
 
+//----------------------------------------------------------------------------
+// Get a reference to the descriptor at a specified index.
+//----------------------------------------------------------------------------
+
+const ts::DescriptorPtr& ts::DescriptorList::operator[](size_t index) const
+{
+    assert(index < _list.size());
+    const Element& elem(_list[index]);
+
+    // Build the Descriptor object on first access.
+    if (elem.desc.isNull()) {
+        elem.desc = new Descriptor(_raw->data() + elem.offset, contentSize(elem));
+        CheckNonNull(elem.desc.pointer());
+    }
+    return elem.desc;
+}
+
+
+//----------------------------------------------------------------------------
+// Append binary data at end of the compact buffer.
+//----------------------------------------------------------------------------
+
+size_t ts::DescriptorList::appendRaw(const void* data, size_t size)
+{
+    if (_raw.isNull()) {
+        _raw = new ByteBlock;
+        CheckNonNull(_raw.pointer());
+    }
+    else if (_raw.count() > 1) {
+        // Shared with another list, copy on write.
+        _raw = new ByteBlock(*_raw);
+        CheckNonNull(_raw.pointer());
+    }
+
+    const size_t offset = _raw->size();
+    const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+    if (bytes >= _raw->data() && bytes < _raw->data() + offset) {
+        // Appending part of the buffer into itself, the buffer may be reallocated.
+        _raw->append(ByteBlock(bytes, size));
+    }
+    else {
+        _raw->append(bytes, size);
+    }
+    return offset;
+}
+
+
 //----------------------------------------------------------------------------
 // Get the table id of the parent table.
 //----------------------------------------------------------------------------
@@ -85,9 +136,8 @@ bool ts::DescriptorList::operator==(const DescriptorList& other) const
         return false;
     }
     for (size_t i = 0; i < _list.size(); ++i) {
-        const DescriptorPtr& desc1 (_list[i].desc);
-        const DescriptorPtr& desc2 (other._list[i].desc);
-        if (desc1.isNull() || desc2.isNull() || *desc1 != *desc2) {
+        const size_t size = contentSize(_list[i]);
+        if (size != other.contentSize(other._list[i]) || (size > 0 && ::memcmp(content(_list[i]), other.content(other._list[i]), size) != 0)) {
             return false;
         }
     }
@@ -99,27 +149,30 @@ bool ts::DescriptorList::operator==(const DescriptorList& other) const
 // Add one descriptor at end of list
 //----------------------------------------------------------------------------
 
-void ts::DescriptorList::add(const DescriptorPtr& desc)
+ts::PDS ts::DescriptorList::nextPDS(const uint8_t* data, size_t size) const
 {
-    PDS pds;
-
-    // Determine which PDS to associate with the descriptor
-    if (desc->tag() == DID_PRIV_DATA_SPECIF) {
+    if (data != 0 && size >= 2 && data[0] == DID_PRIV_DATA_SPECIF) {
         // This descriptor defines a new "private data specifier".
         // The PDS is the only thing in the descriptor payload.
-        pds = desc->payloadSize() < 4 ? 0 : GetUInt32 (desc->payload());
+        return size < 6 ? 0 : GetUInt32(data + 2);
     }
     else if (_list.empty()) {
         // First descriptor in the list
-        pds = 0;
+        return 0;
     }
     else {
         // Use same PDS as previous descriptor
-        pds = _list[_list.size()-1].pds;
+        return _list[_list.size()-1].pds;
     }
+}
+
+void ts::DescriptorList::add(const DescriptorPtr& desc)
+{
+    // Determine which PDS to associate with the descriptor
+    const PDS pds = desc->isValid() ? nextPDS(desc->content(), desc->size()) : nextPDS(0, 0);
 
     // Add the descriptor in the list
-    _list.push_back (Element (desc, pds));
+    _list.push_back(Element(desc, pds));
 }
 
 
@@ -144,13 +197,54 @@ void ts::DescriptorList::add(const AbstractDescriptor& desc)
 
 void ts::DescriptorList::add(const void* data, size_t size)
 {
-    const uint8_t* desc = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* const desc = reinterpret_cast<const uint8_t*>(data);
+
+    // Locate the complete descriptors in the memory area.
+    size_t total = 0;
+    size_t count = 0;
     size_t length;
+    while (size - total >= 2 && (length = size_t(desc[total + 1]) + 2) <= size - total) {
+        total += length;
+        count++;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // Copy the descriptor loop at once in the compact buffer, the Descriptor objects are built on demand.
+    size_t offset = appendRaw(desc, total);
+    _list.reserve(_list.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* const d = _raw->data() + offset;
+        length = size_t(d[1]) + 2;
+        _list.push_back(Element(DescriptorPtr(), nextPDS(d, length), offset));
+        offset += length;
+    }
+}
 
-    while (size >= 2 && (length = size_t(desc[1]) + 2) <= size) {
-        add(DescriptorPtr(new Descriptor(desc, length)));
-        desc += length;
-        size -= length;
+
+//----------------------------------------------------------------------------
+// Add another list of descriptors at end of list.
+//----------------------------------------------------------------------------
+
+void ts::DescriptorList::add(const DescriptorList& dl)
+{
+    if (&dl == this) {
+        // Same compact buffer, avoid inserting a vector into itself.
+        const ElementVector elems(_list);
+        _list.insert(_list.end(), elems.begin(), elems.end());
+    }
+    else if (dl._raw.isNull() || dl._raw == _raw) {
+        // No compact buffer in the other list or same buffer, offsets are unchanged.
+        _list.insert(_list.end(), dl._list.begin(), dl._list.end());
+    }
+    else {
+        // Append the other compact buffer at end of ours and adjust the offsets.
+        const size_t base = appendRaw(dl._raw->data(), dl._raw->size());
+        _list.reserve(_list.size() + dl._list.size());
+        for (ElementVector::const_iterator it = dl._list.begin(); it != dl._list.end(); ++it) {
+            _list.push_back(Element(it->desc, it->pds, it->desc.isNull() ? base + it->offset : 0));
+        }
     }
 }
 
@@ -162,14 +256,15 @@ void ts::DescriptorList::add(const void* data, size_t size)
 bool ts::DescriptorList::prepareRemovePDS (const ElementVector::iterator& it)
 {
     // Eliminate invalid cases
-    if (it == _list.end() || it->desc->tag() != DID_PRIV_DATA_SPECIF) {
+    if (it == _list.end() || content(*it) == 0 || content(*it)[0] != DID_PRIV_DATA_SPECIF) {
         return false;
     }
 
     // Search for private descriptors ahead.
     ElementVector::iterator end;
     for (end = it + 1; end != _list.end(); ++end) {
-        DID tag = end->desc->tag();
+        const uint8_t* const data = content(*end);
+        const DID tag = data == 0 ? 0 : data[0];
         if (tag >= 0x80) {
             // This is a private descriptor, the private_data_specifier descriptor
             // is necessary and cannot be removed.
@@ -215,7 +310,7 @@ size_t ts::DescriptorList::removeInvalidPrivateDescriptors()
     size_t count = 0;
 
     for (size_t n = 0; n < _list.size(); n++) {
-        if (_list[n].pds == 0 && !_list[n].desc.isNull() && _list[n].desc->isValid() && _list[n].desc->tag() >= 0x80) {
+        if (_list[n].pds == 0 && content(_list[n]) != 0 && content(_list[n])[0] >= 0x80) {
             _list.erase (_list.begin() + n);
             count++;
         }
@@ -237,7 +332,7 @@ bool ts::DescriptorList::removeByIndex (size_t index)
     }
 
     // Private_data_specifier descriptor can be removed under certain conditions only
-    if (_list[index].desc->tag() == DID_PRIV_DATA_SPECIF && !prepareRemovePDS (_list.begin() + index)) {
+    if (tag(index) == DID_PRIV_DATA_SPECIF && !prepareRemovePDS (_list.begin() + index)) {
         return false;
     }
 
@@ -257,7 +352,8 @@ size_t ts::DescriptorList::removeByTag (DID tag, PDS pds)
     size_t removed_count = 0;
 
     for (ElementVector::iterator it = _list.begin(); it != _list.end(); ) {
-        const DID itag = it->desc->tag();
+        const uint8_t* const data = content(*it);
+        const DID itag = data == 0 ? 0 : data[0];
         if (itag == tag && (!check_pds || it->pds == pds) && (itag != DID_PRIV_DATA_SPECIF || prepareRemovePDS (it))) {
             it = _list.erase (it);
             ++removed_count;
@@ -280,7 +376,7 @@ size_t ts::DescriptorList::binarySize() const
     size_t size = 0;
 
     for (int i = 0; i < int (_list.size()); ++i) {
-        size += _list[i].desc->size();
+        size += contentSize(_list[i]);
     }
 
     return size;
@@ -295,11 +391,14 @@ size_t ts::DescriptorList::serialize(uint8_t*& addr, size_t& size, size_t start)
 {
     size_t i;
 
-    for (i = start; i < _list.size() && _list[i].desc->size() <= size; ++i) {
-        // Flawfinder: ignore: memcpy()
-        ::memcpy(addr, _list[i].desc->content(), _list[i].desc->size());
-        addr += _list[i].desc->size();
-        size -= _list[i].desc->size();
+    for (i = start; i < _list.size() && contentSize(_list[i]) <= size; ++i) {
+        const size_t dsize = contentSize(_list[i]);
+        if (dsize > 0) {
+            // Flawfinder: ignore: memcpy()
+            ::memcpy(addr, content(_list[i]), dsize);
+        }
+        addr += dsize;
+        size -= dsize;
     }
 
     return i;
@@ -343,7 +442,7 @@ size_t ts::DescriptorList::search (DID tag, size_t start_index, PDS pds) const
     bool check_pds = pds != 0 && tag >= 0x80;
     size_t index = start_index;
 
-    while (index < _list.size() && (_list[index].desc->tag() != tag || (check_pds && _list[index].pds != pds))) {
+    while (index < _list.size() && (this->tag(index) != tag || (check_pds && _list[index].pds != pds))) {
         index++;
     }
 
@@ -360,10 +459,10 @@ size_t ts::DescriptorList::search (DID tag, size_t start_index, PDS pds) const
 size_t ts::DescriptorList::searchLanguage(const UString& language, size_t start_index) const
 {
     for (size_t index = start_index; index < _list.size(); index++) {
-        if (_list[index].desc->tag() == DID_LANGUAGE) {
+        if (tag(index) == DID_LANGUAGE) {
             // Got a language descriptor
-            const uint8_t* desc = _list[index].desc->payload();
-            size_t size = _list[index].desc->payloadSize();
+            const uint8_t* desc = payload(index);
+            size_t size = payloadSize(index);
             // The language code uses 3 bytes after the size
             if (size >= 3 && language.similar(desc, 3)) {
                 return index;
@@ -393,9 +492,9 @@ size_t ts::DescriptorList::searchSubtitle(const UString& language, size_t start_
 
     for (size_t index = start_index; index < _list.size(); index++) {
 
-        const DID tag =_list[index].desc->tag();
-        const uint8_t* desc = _list[index].desc->payload();
-        size_t size = _list[index].desc->payloadSize();
+        const DID tag = this->tag(index);
+        const uint8_t* desc = payload(index);
+        size_t size = payloadSize(index);
 
         if (tag == DID_SUBTITLING) {
             // DVB Subtitling Descriptor, always contain subtitles
@@ -450,8 +549,14 @@ bool ts::DescriptorList::toXML(xml::Element* parent, const DVBCharset* charset)
 {
     bool success = true;
     for (size_t index = 0; index < _list.size(); ++index) {
-        if (_list[index].desc.isNull() || _list[index].desc->toXML(parent, _list[index].pds, tableId() , false, charset) == 0) {
-            success = false;
+        // Do not use operator[], do not build a Descriptor object in the list.
+        const Element& elem(_list[index]);
+        if (!elem.desc.isNull()) {
+            success = elem.desc->toXML(parent, elem.pds, tableId(), false, charset) != 0 && success;
+        }
+        else {
+            const Descriptor bin(content(elem), contentSize(elem));
+            success = bin.toXML(parent, elem.pds, tableId(), false, charset) != 0 && success;
         }
     }
     return success;
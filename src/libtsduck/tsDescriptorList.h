@@ -42,6 +42,17 @@ namespace ts {
     //!
     //! List of MPEG PSI/SI descriptors.
     //!
+    //! Descriptors which are loaded from a binary descriptor loop (typically when
+    //! a table is deserialized) are kept in one single compact buffer. A Descriptor
+    //! object is built only when the descriptor is accessed through operator[].
+    //! The methods tag(), content(), payload() and their sizes give a direct access
+    //! to the binary descriptors without allocation.
+    //!
+    //! Thread safety: operator[] stores the Descriptor object it builds in the list.
+    //! Although it is a const method, it modifies the list and must not be called while
+    //! another thread accesses the same list. All other const methods, including search()
+    //! and toXML(), do not modify the list and can be used by concurrent readers.
+    //!
     class TSDUCKDLL DescriptorList
     {
     public:
@@ -58,7 +69,9 @@ namespace ts {
         //! Basic copy-like constructor.
         //! We forbid a real copy constructor because we want to copy the descriptors only,
         //! while the parent table is usually different.
-        //! The descriptors objects are shared between the two lists.
+        //! The compact binary buffer and the descriptors objects which were already built
+        //! are shared between the two lists. The descriptors which are still in the compact
+        //! buffer are built independently in each list, on first access through operator[].
         //! @param [in] table Parent table. A descriptor list is always attached to a table it is part of.
         //! Use zero for a descriptor list object outside a table.
         //! @param [in] dl Another instance to copy.
@@ -67,7 +80,9 @@ namespace ts {
 
         //!
         //! Assignment operator.
-        //! The descriptors objects are shared between the two lists.
+        //! The compact binary buffer and the descriptors objects which were already built
+        //! are shared between the two lists. The descriptors which are still in the compact
+        //! buffer are built independently in each list, on first access through operator[].
         //! The parent table remains unchanged.
         //! @param [in] dl Another instance to copy.
         //! @return A reference to this object.
@@ -132,13 +147,71 @@ namespace ts {
 
         //!
         //! Get a reference to the descriptor at a specified index.
+        //! If the descriptor is still in the compact binary buffer, a Descriptor object
+        //! is built on first access and kept in the list. This is not thread-safe, see
+        //! the class description. Use tag(), content() or payload() to inspect the
+        //! descriptor without allocation.
         //! @param [in] index Index in the list. Valid index are 0 to count()-1.
         //! @return A reference to the descriptor at @a index.
         //!
-        const DescriptorPtr& operator[](size_t index) const
+        const DescriptorPtr& operator[](size_t index) const;
+
+        //!
+        //! Get the tag of the descriptor at a specified index.
+        //! @param [in] index Index in the list. Valid index are 0 to count()-1.
+        //! @return The descriptor tag or the reserved value 0 if the descriptor is invalid.
+        //!
+        DID tag(size_t index) const
+        {
+            assert(index < _list.size());
+            const uint8_t* data = content(_list[index]);
+            return data == 0 ? 0 : data[0];
+        }
+
+        //!
+        //! Access to the full binary content of the descriptor at a specified index.
+        //! @param [in] index Index in the list. Valid index are 0 to count()-1.
+        //! @return Address of the full binary content of the descriptor or zero if the descriptor is invalid.
+        //!
+        const uint8_t* content(size_t index) const
         {
             assert(index < _list.size());
-            return _list[index].desc;
+            return content(_list[index]);
+        }
+
+        //!
+        //! Size of the binary content of the descriptor at a specified index.
+        //! @param [in] index Index in the list. Valid index are 0 to count()-1.
+        //! @return Size of the binary content of the descriptor or zero if the descriptor is invalid.
+        //!
+        size_t contentSize(size_t index) const
+        {
+            assert(index < _list.size());
+            return contentSize(_list[index]);
+        }
+
+        //!
+        //! Access to the payload of the descriptor at a specified index.
+        //! @param [in] index Index in the list. Valid index are 0 to count()-1.
+        //! @return Address of the payload of the descriptor or zero if the descriptor is invalid.
+        //!
+        const uint8_t* payload(size_t index) const
+        {
+            assert(index < _list.size());
+            const uint8_t* data = content(_list[index]);
+            return data == 0 ? 0 : data + 2;
+        }
+
+        //!
+        //! Size of the payload of the descriptor at a specified index.
+        //! @param [in] index Index in the list. Valid index are 0 to count()-1.
+        //! @return Size in bytes of the payload of the descriptor or zero if the descriptor is invalid.
+        //!
+        size_t payloadSize(size_t index) const
+        {
+            assert(index < _list.size());
+            const size_t size = contentSize(_list[index]);
+            return size < 2 ? 0 : size - 2;
         }
 
         //!
@@ -166,13 +239,11 @@ namespace ts {
 
         //!
         //! Add another list of descriptors at end of list.
-        //! The descriptors objects are shared between the two lists.
+        //! The descriptors objects which were already built are shared between the two lists.
+        //! The other descriptors are built independently in each list, on first access.
         //! @param [in] dl The descriptor list to add.
         //!
-        void add(const DescriptorList& dl)
-        {
-            _list.insert(_list.end(), dl._list.begin(), dl._list.end());
-        }
+        void add(const DescriptorList& dl);
 
         //!
         //! Add descriptors from a memory area at end of list
@@ -235,6 +306,7 @@ namespace ts {
         void clear()
         {
             _list.clear();
+            _raw.clear();
         }
 
         //!
@@ -366,20 +438,40 @@ namespace ts {
 
     private:
         // Each entry contains a descriptor and its corresponding private data specifier.
+        // When desc is null, the binary descriptor is located at the given offset in _raw.
+        // The Descriptor object is built on demand by operator[] const, hence mutable.
         struct Element
         {
             // Public members:
-            DescriptorPtr desc;
+            mutable DescriptorPtr desc;
             PDS pds;
+            size_t offset;
 
             // Constructor:
-            Element(const DescriptorPtr& desc_ = 0, PDS pds_ = 0) : desc(desc_), pds(pds_) {}
+            Element(const DescriptorPtr& desc_ = 0, PDS pds_ = 0, size_t offset_ = 0) : desc(desc_), pds(pds_), offset(offset_) {}
         };
         typedef std::vector <Element> ElementVector;
 
         // Private members
         const AbstractTable* const _table;  // Parent table (zero for descriptor list object outside a table).
         ElementVector              _list;   // Vector of smart pointers to descriptors.
+        ByteBlockPtr               _raw;    // Compact buffer of binary descriptors, shared between copies.
+
+        // Binary content of an element, either from its Descriptor object or from _raw.
+        const uint8_t* content(const Element& elem) const
+        {
+            return !elem.desc.isNull() ? (elem.desc->isValid() ? elem.desc->content() : 0) : _raw->data() + elem.offset;
+        }
+        size_t contentSize(const Element& elem) const
+        {
+            return !elem.desc.isNull() ? (elem.desc->isValid() ? elem.desc->size() : 0) : size_t(_raw->data()[elem.offset + 1]) + 2;
+        }
+
+        // Compute the PDS to associate with a new descriptor at end of list.
+        PDS nextPDS(const uint8_t* data, size_t size) const;
+
+        // Append binary data at end of the compact buffer (copy on write) and return its offset.
+        size_t appendRaw(const void* data, size_t size);
 
         // Prepare removal of a private_data_specifier descriptor.
         // Return true if can be removed, false if it cannot (private descriptors ahead).
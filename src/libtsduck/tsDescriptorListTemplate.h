@@ -43,7 +43,15 @@ size_t ts::DescriptorList::search (DID tag, DESC& desc, size_t start_index, PDS
 {
     // Repeatedly search for a descriptor until one is successfully deserialized
     for (size_t index = search (tag, start_index, pds); index < _list.size(); index = search (tag, index + 1, pds)) {
-        desc.deserialize (*(_list[index].desc));
+        // Do not use operator[], do not build a Descriptor object in the list.
+        const Element& elem(_list[index]);
+        if (!elem.desc.isNull()) {
+            desc.deserialize(*elem.desc);
+        }
+        else {
+            const Descriptor bin(content(elem), contentSize(elem));
+            desc.deserialize(bin);
+        }
         if (desc.isValid()) {
             return index;
         }
@@ -34,6 +34,18 @@
 #include "tsMemoryUtils.h"
 TSDUCK_SOURCE;
 
+// SSE2 is always present on x86-64. AVX2 is used when supported by the CPU.
+#if defined(TS_X86_64) && (defined(TS_GCC) || defined(TS_MSC))
+    #define TS_MEMORY_SIMD 1
+    #if defined(TS_MSC)
+        #include <intrin.h>
+        #define TS_AVX2_TARGET
+    #else
+        #include <immintrin.h>
+        #define TS_AVX2_TARGET __attribute__((target("avx2")))
+    #endif
+#endif
+
 
 //----------------------------------------------------------------------------
 // Check if a memory area starts with the specified prefix
@@ -70,6 +82,130 @@ const void* ts::LocatePattern (const void* area, size_t area_size, const void* p
     return 0; // not found
 }
 
+
+//----------------------------------------------------------------------------
+// Locate a 3-byte sequence 00 00 xx into a memory area.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Portable version. Skip as many bytes as possible when a byte cannot be part of a sequence.
+    const uint8_t* ScalarZeroZero(const uint8_t* p, const uint8_t* end, uint8_t third)
+    {
+        while (end - p > 2) {
+            if (p[2] != 0x00 && p[2] != third) {
+                p += 3;
+            }
+            else if (p[1] != 0x00) {
+                p += 2;
+            }
+            else if (p[0] == 0x00 && p[2] == third) {
+                return p;
+            }
+            else {
+                p += 1;
+            }
+        }
+        return 0;
+    }
+
+#if defined(TS_MEMORY_SIMD)
+
+    // Index of the lowest bit set in a non-zero mask.
+    inline size_t LowestBit(uint32_t mask)
+    {
+    #if defined(TS_MSC)
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return size_t(index);
+    #else
+        return size_t(__builtin_ctz(mask));
+    #endif
+    }
+
+    // Check if the CPU and the operating system support AVX2.
+    bool CPUHasAVX2()
+    {
+    #if defined(TS_MSC)
+        int info[4];
+        __cpuid(info, 1);
+        // OSXSAVE (ECX bit 27) and AVX (ECX bit 28) are required to check the OS support.
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x06) != 0x06) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2") != 0;
+    #endif
+    }
+
+    const bool UseAVX2 = CPUHasAVX2();
+
+    // Search by blocks of 16 positions (SSE2). Stop when less than 18 bytes remain.
+    // Return the address of the sequence or the address where to continue the search.
+    inline const uint8_t* SSE2ZeroZero(const uint8_t* p, const uint8_t* end, uint8_t third, bool& found)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i last = _mm_set1_epi8(char(third));
+        for (; end - p >= 18; p += 16) {
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+            const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2));
+            const uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)), _mm_cmpeq_epi8(b2, last))));
+            if (mask != 0) {
+                found = true;
+                return p + LowestBit(mask);
+            }
+        }
+        found = false;
+        return p;
+    }
+
+    // Search by blocks of 32 positions (AVX2). Stop when less than 34 bytes remain.
+    TS_AVX2_TARGET const uint8_t* AVX2ZeroZero(const uint8_t* p, const uint8_t* end, uint8_t third, bool& found)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i last = _mm256_set1_epi8(char(third));
+        for (; end - p >= 34; p += 32) {
+            const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+            const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 2));
+            const uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)), _mm256_cmpeq_epi8(b2, last))));
+            if (mask != 0) {
+                found = true;
+                return p + LowestBit(mask);
+            }
+        }
+        found = false;
+        return p;
+    }
+
+#endif
+}
+
+const uint8_t* ts::LocateZeroZero(const void* area, size_t area_size, uint8_t third)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(area);
+    const uint8_t* const end = p + area_size;
+
+#if defined(TS_MEMORY_SIMD)
+    bool found = false;
+    if (UseAVX2) {
+        p = AVX2ZeroZero(p, end, third, found);
+    }
+    if (!found) {
+        p = SSE2ZeroZero(p, end, third, found);
+    }
+    if (found) {
+        return p;
+    }
+#endif
+
+    return ScalarZeroZero(p, end, third);
+}
+
+
 //----------------------------------------------------------------------------
 // Check if a memory area contains all identical byte values.
 //----------------------------------------------------------------------------
@@ -45,8 +45,12 @@ namespace {
     // Start code prefix for ISO 11172-2 (MPEG-1 video) and ISO 13818-2 (MPEG-2 video)
     const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
 
-    // End of AVC NALunit delimiter
-    const uint8_t Zero3[] = {0x00, 0x00, 0x00};
+    // In streaming mode, number of bytes to keep at the start of MPEG-1/2 video units.
+    // Must be large enough to contain a sequence header (12 bytes) or extension (10 bytes).
+    const size_t MPEG2_UNIT_HEAD = 16;
+
+    // Unlimited end of data to keep in a video unit.
+    const size_t UNLIMITED_END = std::numeric_limits<size_t>::max();
 }
 
 
@@ -57,7 +61,8 @@ namespace {
 ts::PESDemux::PESDemux(PESHandlerInterface* pes_handler, const PIDSet& pid_filter) :
     SuperClass(pid_filter),
     _pes_handler(pes_handler),
-    _pids()
+    _pids(),
+    _streaming(false)
 {
 }
 
@@ -86,8 +91,234 @@ ts::PESDemux::PIDContext::PIDContext() :
     video(),
     avc(),
     ac3(),
-    ac3_count(0)
+    ac3_count(0),
+    state(SS_PENDING),
+    es_size(0),
+    es_tail(),
+    in_unit(false),
+    unit_start(0),
+    unit_data(0),
+    collect_pos(0),
+    collect_end(0),
+    units(),
+    unit_list()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Reset the streaming state at the beginning of a PES packet.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::resetStreaming()
+{
+    state = SS_PENDING;
+    es_size = 0;
+    es_tail[0] = es_tail[1] = 0;
+    in_unit = false;
+    unit_start = unit_data = collect_pos = collect_end = 0;
+    units.clear();
+    unit_list.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the current PES packet can be analyzed on the fly.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::checkStreaming()
+{
+    const uint8_t* const data = ts->data();
+    const size_t size = ts->size();
+
+    // Need the complete PES header. Same checks as in PESPacket.
+    if (size < 6) {
+        return;
+    }
+    if (!IsVideoSID(data[3])) {
+        // Only video PES packets are large enough to be worth the effort.
+        state = SS_FULL;
+        return;
+    }
+    size_t header_size = 6;
+    if (IsLongHeaderSID(data[3])) {
+        if (size < 9) {
+            return;
+        }
+        header_size = 9 + size_t(data[8]);
+        if (size < header_size) {
+            return;
+        }
+    }
+
+    // Locate the first non-zero byte in the payload. Same checks as
+    // PESPacket::isMPEG2Video() and PESPacket::isAVC(), in that order.
+    size_t index = header_size;
+    while (index < size && data[index] == 0x00) {
+        ++index;
+    }
+    if (index >= size) {
+        // Only zeroes so far, wait for more data.
+        return;
+    }
+    else if (data[index] == 0x01 && index - header_size == 2) {
+        state = SS_MPEG2;
+    }
+    else if (data[index] == 0x01 && index - header_size > 2) {
+        state = SS_AVC;
+    }
+    else {
+        state = SS_FULL;
+        return;
+    }
+
+    // Scan the payload we already have. Subsequent TS payloads will be scanned directly.
+    scanES(data + header_size, size - header_size);
+}
+
+
+//----------------------------------------------------------------------------
+// Scan a chunk of ES data in streaming mode.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::scanES(const uint8_t* data, size_t size)
+{
+    // ES offset of the chunk.
+    const size_t base = es_size;
+
+    // Look for 00 00 01 or 00 00 00 sequences which start in the previous chunk.
+    const size_t tail = std::min<size_t>(es_size, 2);
+    if (tail > 0 && size > 0) {
+        uint8_t buf[4];
+        size_t len = 0;
+        for (size_t i = 0; i < tail; ++i) {
+            buf[len++] = es_tail[2 - tail + i];
+        }
+        for (size_t i = 0; i < size && i < 2; ++i) {
+            buf[len++] = data[i];
+        }
+        for (size_t i = 0; i < tail && i + 2 < len; ++i) {
+            if (buf[i] == 0x00 && buf[i+1] == 0x00 && buf[i+2] <= 0x01) {
+                startCode(base - tail + i, buf[i+2] == 0x00, data, base);
+            }
+        }
+    }
+
+    // Look for 00 00 01 sequences inside the chunk, and 00 00 00 sequences for AVC.
+    const uint8_t* const end = data + size;
+    const uint8_t* sc = LocateZeroZero(data, size, 0x01);
+    const uint8_t* z3 = state == SS_AVC ? LocateZeroZero(data, size, 0x00) : 0;
+    while (sc != 0 || z3 != 0) {
+        if (z3 == 0 || (sc != 0 && sc < z3)) {
+            startCode(base + (sc - data), false, data, base);
+            sc = LocateZeroZero(sc + 1, end - sc - 1, 0x01);
+        }
+        else {
+            startCode(base + (z3 - data), true, data, base);
+            z3 = LocateZeroZero(z3 + 1, end - z3 - 1, 0x00);
+        }
+    }
+
+    // Keep the rest of the chunk if needed.
+    collectUnit(data, base, base + size);
+
+    // Remember the last two bytes for the next chunk.
+    if (size >= 2) {
+        es_tail[0] = data[size - 2];
+        es_tail[1] = data[size - 1];
+    }
+    else if (size == 1) {
+        es_tail[0] = es_tail[1];
+        es_tail[1] = data[0];
+    }
+    es_size += size;
+}
+
+
+//----------------------------------------------------------------------------
+// Process a 00 00 01 or 00 00 00 sequence at ES offset pos, in streaming mode.
+// Same unit boundaries as processPESPacket() on a complete PES packet.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::startCode(size_t pos, bool zero3, const uint8_t* data, size_t base)
+{
+    if (state == SS_MPEG2) {
+        // MPEG-1/2 video units start at each start code, including the prefix.
+        if (!zero3) {
+            collectUnit(data, base, pos);
+            closeUnit(pos);
+            in_unit = true;
+            unit_start = pos;
+            unit_data = units.size();
+            units.append(StartCodePrefix, sizeof(StartCodePrefix));
+            collect_pos = pos + sizeof(StartCodePrefix);
+            collect_end = pos + MPEG2_UNIT_HEAD;
+        }
+    }
+    else if (state == SS_AVC) {
+        // AVC access units start after 00 00 01 and end at 00 00 01 or 00 00 00.
+        if (in_unit) {
+            if (pos < unit_start) {
+                return;
+            }
+            collectUnit(data, base, pos);
+            closeUnit(pos);
+        }
+        if (!zero3) {
+            // Keep the NALunit type only, until we know if this is a sequence parameter set.
+            in_unit = true;
+            unit_start = pos + sizeof(StartCodePrefix);
+            unit_data = units.size();
+            collect_pos = unit_start;
+            collect_end = unit_start + 1;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Keep data from the current unit, up to ES offset end.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::collectUnit(const uint8_t* data, size_t base, size_t end)
 {
+    while (in_unit) {
+        const size_t last = std::min(collect_end, end);
+        if (collect_pos < last) {
+            units.append(data + collect_pos - base, last - collect_pos);
+            collect_pos = last;
+        }
+        // AVC sequence parameter sets are kept entirely.
+        if (state == SS_AVC && collect_end == unit_start + 1 && units.size() > unit_data && (units[unit_data] & 0x1F) == AVC_AUT_SEQPARAMS) {
+            collect_end = UNLIMITED_END;
+        }
+        else {
+            break;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Terminate the current unit at ES offset end.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::closeUnit(size_t end)
+{
+    if (in_unit) {
+        in_unit = false;
+        // We may have kept a few bytes after the end of the unit.
+        const size_t unit_size = end - unit_start;
+        const size_t size = std::min(unit_size, units.size() - unit_data);
+        if (state == SS_AVC && (size == 0 || size < unit_size || (units[unit_data] & 0x1F) != AVC_AUT_SEQPARAMS)) {
+            // Not a complete sequence parameter set, useless for AVC attributes.
+            units.resize(unit_data);
+        }
+        else {
+            units.resize(unit_data + size);
+            unit_list.push_back(UnitLocation(unit_data, size));
+        }
+    }
 }
 
 
@@ -228,6 +459,10 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
             pc.ts->copy(pl, pl_size);
             pc.first_pkt = _packet_count;
             pc.last_pkt = _packet_count;
+            pc.resetStreaming();
+            if (_streaming) {
+                pc.checkStreaming();
+            }
         }
         else if (pc_exists) {
             // This PID does not contain PES packet, reset context
@@ -256,6 +491,13 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
     }
     pc.continuity = pkt.getCC();
 
+    // In streaming mode, video data are analyzed on the fly and not reassembled.
+    if (pc.state == SS_MPEG2 || pc.state == SS_AVC) {
+        pc.scanES(pl, pl_size);
+        pc.last_pkt = _packet_count;
+        return;
+    }
+
     // Append the TS payload in PID context.
     size_t capacity = pc.ts->capacity();
     if (pc.ts->size() + pl_size > capacity) {
@@ -275,6 +517,9 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
         }
     }
     pc.ts->append(pl, pl_size);
+    if (_streaming && pc.state == SS_PENDING) {
+        pc.checkStreaming();
+    }
 
     // Last TS packet containing actual data for this PES packet
     pc.last_pkt = _packet_count;
@@ -324,14 +569,19 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
         const uint8_t* const pdata = pp.payload();
         const size_t psize = pp.payloadSize();
 
+        // Process video units which were located on the fly in streaming mode.
+        if (pc.state == SS_MPEG2 || pc.state == SS_AVC) {
+            processStreamingUnits(pp, pc);
+        }
+
         // Process MPEG-1 (ISO 11172-2) and MPEG-2 (ISO 13818-2) video start codes
-        if (pp.isMPEG2Video()) {
+        else if (pp.isMPEG2Video()) {
             // Locate all start codes and invoke handler.
             // The beginning of the payload is already a start code prefix.
             for (size_t offset = 0; offset < psize; ) {
                 // Look for next start code
-                const void* pnext = LocatePattern (pdata + offset + 1, psize - offset - 1, StartCodePrefix, sizeof(StartCodePrefix));
-                size_t next = pnext == 0 ? psize : reinterpret_cast <const uint8_t*> (pnext) - pdata;
+                const uint8_t* pnext = LocateZeroZero(pdata + offset + 1, psize - offset - 1, 0x01);
+                size_t next = pnext == 0 ? psize : pnext - pdata;
                 // Invoke handler
                 if (_pes_handler != 0) {
                     _pes_handler->handleVideoStartCode (*this, pp, pdata[offset+3], offset, next - offset);
@@ -348,30 +598,24 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
 
         // Process AVC (ISO 14496-10, ITU H.264) access units (aka "NALunits")
         else if (pp.isAVC()) {
+            // Offset of next 00 00 00 sequence. Searched again only when we move past it.
+            // Searching it for each NALunit would rescan the complete PES packet each time.
+            size_t zero3 = 0;
             for (size_t offset = 0; offset < psize; ) {
                 // Locate next access unit: starts with 00 00 01 (this start code is not part of the NALunit)
-                const uint8_t* p1 = reinterpret_cast<const uint8_t*>(
-                            LocatePattern(pdata + offset, psize - offset, StartCodePrefix, sizeof(StartCodePrefix)));
+                const uint8_t* p1 = LocateZeroZero(pdata + offset, psize - offset, 0x01);
                 if (p1 == 0) {
                     break;
                 }
                 offset = p1 - pdata + sizeof(StartCodePrefix);
 
                 // Locate end of access unit: ends with 00 00 00, 00 00 01 or end of
-                const uint8_t* p2 = reinterpret_cast<const uint8_t*>(
-                            LocatePattern(pdata + offset, psize - offset, StartCodePrefix, sizeof(StartCodePrefix)));
-                const uint8_t* p3 = reinterpret_cast<const uint8_t*>(
-                            LocatePattern(pdata + offset, psize - offset, Zero3, sizeof(Zero3)));
-                size_t nalunit_size;
-                if (p2 == 0 && p3 == 0) {
-                    nalunit_size = psize - offset;
-                }
-                else if (p2 == 0 || p3 < p2) {
-                    nalunit_size = p3 - pdata - offset;
-                }
-                else {
-                    nalunit_size = p2 - pdata - offset;
+                const uint8_t* p2 = LocateZeroZero(pdata + offset, psize - offset, 0x01);
+                if (zero3 < offset) {
+                    const uint8_t* p3 = LocateZeroZero(pdata + offset, psize - offset, 0x00);
+                    zero3 = p3 == 0 ? psize : p3 - pdata;
                 }
+                const size_t nalunit_size = std::min<size_t>(p2 == 0 ? psize : p2 - pdata, zero3) - offset;
 
                 // Compute NALunit type.
                 const uint8_t nalunit_type = nalunit_size == 0 ? 0 : (pdata[offset] & 0x1F);
@@ -447,3 +691,28 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
     }
     afterCallingHandler(true);
 }
+
+
+//----------------------------------------------------------------------------
+// Process the video units of a PES packet which was analyzed in streaming mode.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::processStreamingUnits(const PESPacket& pp, PIDContext& pc)
+{
+    // Terminate the last unit at end of PES packet.
+    pc.closeUnit(pc.es_size);
+
+    // Only the start of MPEG-1/2 video units and the AVC sequence parameter sets
+    // were kept. This is all we need to extract video attributes.
+    for (UnitLocationVector::const_iterator it = pc.unit_list.begin(); it != pc.unit_list.end(); ++it) {
+        const uint8_t* const data = pc.units.data() + it->first;
+        if (pc.state == SS_MPEG2) {
+            if (pc.video.moreBinaryData(data, it->second) && _pes_handler != 0) {
+                _pes_handler->handleNewVideoAttributes(*this, pp, pc.video);
+            }
+        }
+        else if (pc.avc.moreBinaryData(data, it->second) && _pes_handler != 0) {
+            _pes_handler->handleNewAVCAttributes(*this, pp, pc.avc);
+        }
+    }
+}
@@ -40,6 +40,7 @@
 #include "tsVideoAttributes.h"
 #include "tsAVCAttributes.h"
 #include "tsAC3Attributes.h"
+#include "tsPIDContextTable.h"
 
 namespace ts {
     //!
@@ -120,6 +121,39 @@ namespace ts {
         //!
         bool allAC3(PID) const;
 
+        //!
+        //! Set the streaming mode.
+        //!
+        //! By default, the demux reassembles the complete PES packets before analyzing them.
+        //! In streaming mode, the elementary stream data of MPEG-1/2 and AVC video PES packets
+        //! are scanned on the fly, as the TS packets arrive, and are never reassembled. Only
+        //! the start of each video unit and the complete AVC sequence parameter sets are kept
+        //! to extract the video attributes. This is much faster on high-bitrate video streams
+        //! and it is recommended for applications which only need PES headers and attributes.
+        //!
+        //! In streaming mode, the PESPacket objects which are passed to the handlers for video
+        //! PES packets contain the PES header and only the beginning of the payload (usually
+        //! the part of the payload which is in the first TS packet). The handlers for video
+        //! start codes, AVC access units and SEI are never invoked in that case. Other PES
+        //! packets, including audio ones, are always completely reassembled.
+        //!
+        //! @param [in] on True to enable the streaming mode, false to reassemble all PES packets.
+        //!
+        void setStreamingMode(bool on)
+        {
+            _streaming = on;
+        }
+
+        //!
+        //! Check if the streaming mode is enabled.
+        //! @return True if the streaming mode is enabled.
+        //! @see setStreamingMode()
+        //!
+        bool streamingMode() const
+        {
+            return _streaming;
+        }
+
     protected:
         //!
         //! This hook is invoked when a complete PES packet is available.
@@ -133,6 +167,18 @@ namespace ts {
         virtual void immediateResetPID(PID pid) override;
 
     private:
+        // Streaming analysis of the current PES packet on a PID.
+        enum StreamingState {
+            SS_PENDING,  // Not yet known, need more data
+            SS_FULL,     // Reassemble the complete PES packet
+            SS_MPEG2,    // Scan MPEG-1/2 video start codes on the fly
+            SS_AVC       // Scan AVC access units on the fly
+        };
+
+        // Location of a video unit which was kept in streaming mode: offset in units buffer and size.
+        typedef std::pair<size_t, size_t> UnitLocation;
+        typedef std::vector<UnitLocation> UnitLocationVector;
+
         // This internal structure contains the analysis context for one PID.
         struct PIDContext
         {
@@ -147,15 +193,43 @@ namespace ts {
             AVCAttributes   avc;         // Current AVC attributes
             AC3Attributes   ac3;         // Current AC-3 attributes
             PacketCounter   ac3_count;   // Number of PES packets with contents which looks like AC-3
+            StreamingState  state;       // Streaming analysis of current PES packet
+            size_t          es_size;     // Streaming: number of scanned ES bytes in current PES packet
+            uint8_t         es_tail[2];  // Streaming: last two scanned ES bytes
+            bool            in_unit;     // Streaming: inside a video unit or AVC access unit
+            size_t          unit_start;  // Streaming: ES offset of current unit
+            size_t          unit_data;   // Streaming: offset of current unit in units buffer
+            size_t          collect_pos; // Streaming: ES offset of next byte to keep in current unit
+            size_t          collect_end; // Streaming: ES offset after last byte to keep in current unit
+            ByteBlock       units;       // Streaming: kept data from video units
+            UnitLocationVector unit_list; // Streaming: location of kept units in current PES packet
 
             // Default constructor:
             PIDContext();
 
             // Called when packet synchronization is lost on the pid
-            void syncLost() {sync = false; ts->clear();}
+            void syncLost() {sync = false; ts->clear(); resetStreaming();}
+
+            // Reset the streaming state at the beginning of a PES packet.
+            void resetStreaming();
+
+            // Check if the current PES packet can be analyzed on the fly (state is SS_PENDING).
+            void checkStreaming();
+
+            // Scan a chunk of ES data in streaming mode.
+            void scanES(const uint8_t* data, size_t size);
+
+            // Process a start code (00 00 01) or a 00 00 00 sequence at ES offset pos.
+            void startCode(size_t pos, bool zero3, const uint8_t* data, size_t base);
+
+            // Keep data from the current unit, up to ES offset end, in a chunk starting at ES offset base.
+            void collectUnit(const uint8_t* data, size_t base, size_t end);
+
+            // Terminate the current unit at ES offset end.
+            void closeUnit(size_t end);
         };
 
-        typedef std::map <PID, PIDContext> PIDContextMap;
+        typedef PIDContextTable<PIDContext> PIDContextMap;
 
         // Feed the demux with a TS packet (PID already filtered).
         void processPacket(const TSPacket&);
@@ -163,9 +237,13 @@ namespace ts {
         // Process a complete PES packet
         void processPESPacket(PID, PIDContext&);
 
+        // Process the video units of a PES packet which was analyzed in streaming mode.
+        void processStreamingUnits(const PESPacket&, PIDContext&);
+
         // Private members:
         PESHandlerInterface* _pes_handler;
         PIDContextMap        _pids;
+        bool                 _streaming;
 
         // Inacessible operations
         PESDemux(const PESDemux&) = delete;
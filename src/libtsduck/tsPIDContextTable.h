@@ -0,0 +1,223 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Dense table of contexts, indexed by PID.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+
+namespace ts {
+
+    //!
+    //! Dense table of contexts, indexed by PID.
+    //!
+    //! This class is a replacement for @c std::map<PID,T> in demuxes and analyzers
+    //! where the context of a PID is searched for each TS packet. The lookup is a
+    //! direct index in a table of ts::PID_MAX pointers, without tree traversal.
+    //! The contexts are individually allocated the first time they are accessed.
+    //!
+    //! The interface is a subset of @c std::map. Like in a map, the elements are
+    //! pairs where @c first is the PID and @c second is the context. Iterators
+    //! traverse the allocated contexts in increasing order of PID values.
+    //! References to contexts remain valid until they are erased.
+    //!
+    //! @tparam T The type of the contexts. Must be default-constructible.
+    //!
+    template <typename T>
+    class PIDContextTable
+    {
+    public:
+        //!
+        //! Type of the keys.
+        //!
+        typedef PID key_type;
+
+        //!
+        //! Type of the contexts.
+        //!
+        typedef T mapped_type;
+
+        //!
+        //! Type of the elements, similar to @c std::map elements.
+        //!
+        struct value_type
+        {
+            const PID first;   //!< PID value.
+            T         second;  //!< Context for the PID.
+
+            //!
+            //! Constructor.
+            //! @param [in] pid PID value.
+            //!
+            value_type(PID pid) : first(pid), second() {}
+        };
+
+    private:
+        // Common template for iterators.
+        template <typename TABLE, typename VALUE>
+        class IteratorBase
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef VALUE value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef VALUE* pointer;
+            typedef VALUE& reference;
+
+            IteratorBase() : _table(0), _pid(PID_MAX) {}
+            IteratorBase(TABLE* table, PID pid) : _table(table), _pid(pid) {}
+            template <typename TABLE2, typename VALUE2>
+            IteratorBase(const IteratorBase<TABLE2, VALUE2>& other) : _table(other._table), _pid(other._pid) {}
+            VALUE& operator*() const {return *_table->_slots[_pid];}
+            VALUE* operator->() const {return _table->_slots[_pid];}
+            IteratorBase& operator++() {_pid = _table->nextPID(_pid + 1); return *this;}
+            IteratorBase operator++(int) {IteratorBase it(*this); ++*this; return it;}
+            bool operator==(const IteratorBase& other) const {return _pid == other._pid;}
+            bool operator!=(const IteratorBase& other) const {return _pid != other._pid;}
+
+        private:
+            template <typename, typename> friend class IteratorBase;
+            TABLE* _table;
+            PID    _pid;
+        };
+
+    public:
+        //!
+        //! Iterator type.
+        //!
+        typedef IteratorBase<PIDContextTable, value_type> iterator;
+
+        //!
+        //! Constant iterator type.
+        //!
+        typedef IteratorBase<const PIDContextTable, const value_type> const_iterator;
+
+        //!
+        //! Default constructor.
+        //!
+        PIDContextTable();
+
+        //!
+        //! Destructor.
+        //!
+        ~PIDContextTable();
+
+        //!
+        //! Access the context of a PID, create it if it does not exist.
+        //! @param [in] pid PID value.
+        //! @return A reference to the context of @a pid.
+        //!
+        T& operator[](PID pid);
+
+        //!
+        //! Find the context of a PID.
+        //! @param [in] pid PID value.
+        //! @return An iterator to the element for @a pid or end() if there is none.
+        //!
+        iterator find(PID pid) {return iterator(this, pid < PID_MAX && _slots[pid] != 0 ? pid : PID_MAX);}
+
+        //!
+        //! Find the context of a PID.
+        //! @param [in] pid PID value.
+        //! @return A constant iterator to the element for @a pid or end() if there is none.
+        //!
+        const_iterator find(PID pid) const {return const_iterator(this, pid < PID_MAX && _slots[pid] != 0 ? pid : PID_MAX);}
+
+        //!
+        //! Check if the context of a PID exists.
+        //! @param [in] pid PID value.
+        //! @return 1 if the context of @a pid exists, 0 otherwise.
+        //!
+        size_t count(PID pid) const {return pid < PID_MAX && _slots[pid] != 0 ? 1 : 0;}
+
+        //!
+        //! Delete the context of a PID.
+        //! @param [in] pid PID value.
+        //! @return Number of erased elements (0 or 1).
+        //!
+        size_t erase(PID pid);
+
+        //!
+        //! Delete all contexts.
+        //!
+        void clear();
+
+        //!
+        //! Get the number of allocated contexts.
+        //! @return The number of allocated contexts.
+        //!
+        size_t size() const {return _count;}
+
+        //!
+        //! Check if the table is empty.
+        //! @return True if no context is allocated.
+        //!
+        bool empty() const {return _count == 0;}
+
+        //!
+        //! Get an iterator to the first element, in PID order.
+        //! @return An iterator to the first element.
+        //!
+        iterator begin() {return iterator(this, nextPID(0));}
+
+        //!
+        //! Get a constant iterator to the first element, in PID order.
+        //! @return A constant iterator to the first element.
+        //!
+        const_iterator begin() const {return const_iterator(this, nextPID(0));}
+
+        //!
+        //! Get an iterator after the last element.
+        //! @return An iterator after the last element.
+        //!
+        iterator end() {return iterator(this, PID_MAX);}
+
+        //!
+        //! Get a constant iterator after the last element.
+        //! @return A constant iterator after the last element.
+        //!
+        const_iterator end() const {return const_iterator(this, PID_MAX);}
+
+    private:
+        value_type* _slots[PID_MAX];  // Lazily allocated contexts, indexed by PID.
+        size_t      _count;           // Number of allocated contexts.
+
+        // Get the first allocated PID, starting at pid, PID_MAX if there is none.
+        PID nextPID(PID pid) const;
+
+        // Inaccessible operations.
+        PIDContextTable(const PIDContextTable&) = delete;
+        PIDContextTable& operator=(const PIDContextTable&) = delete;
+    };
+}
+
+#include "tsPIDContextTableTemplate.h"
@@ -0,0 +1,117 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Dense table of contexts, indexed by PID.
+//
+//----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+template <typename T>
+ts::PIDContextTable<T>::PIDContextTable() :
+    _slots(),
+    _count(0)
+{
+}
+
+template <typename T>
+ts::PIDContextTable<T>::~PIDContextTable()
+{
+    clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Access the context of a PID, create it if it does not exist.
+//----------------------------------------------------------------------------
+
+template <typename T>
+T& ts::PIDContextTable<T>::operator[](PID pid)
+{
+    assert(pid < PID_MAX);
+    value_type*& slot(_slots[pid & (PID_MAX - 1)]);
+    if (slot == 0) {
+        slot = new value_type(pid);
+        _count++;
+    }
+    return slot->second;
+}
+
+
+//----------------------------------------------------------------------------
+// Delete the context of a PID.
+//----------------------------------------------------------------------------
+
+template <typename T>
+size_t ts::PIDContextTable<T>::erase(PID pid)
+{
+    if (pid < PID_MAX && _slots[pid] != 0) {
+        delete _slots[pid];
+        _slots[pid] = 0;
+        _count--;
+        return 1;
+    }
+    else {
+        return 0;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Delete all contexts.
+//----------------------------------------------------------------------------
+
+template <typename T>
+void ts::PIDContextTable<T>::clear()
+{
+    for (PID pid = 0; _count > 0 && pid < PID_MAX; ++pid) {
+        if (_slots[pid] != 0) {
+            delete _slots[pid];
+            _slots[pid] = 0;
+            _count--;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the first allocated PID, starting at pid, PID_MAX if there is none.
+//----------------------------------------------------------------------------
+
+template <typename T>
+ts::PID ts::PIDContextTable<T>::nextPID(PID pid) const
+{
+    while (pid < PID_MAX && _slots[pid] == 0) {
+        ++pid;
+    }
+    return pid;
+}
@@ -0,0 +1,278 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsParallelScrambling.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
+#include "tsThread.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::ParallelScrambling::MAX_THREADS;
+const size_t ts::ParallelScrambling::MIN_JOB_SIZE;
+#endif
+
+
+//----------------------------------------------------------------------------
+// A job: a set of data blocks to process with the same key.
+//----------------------------------------------------------------------------
+
+class ts::ParallelScrambling::Job
+{
+public:
+    Scrambling            key;
+    bool                  encrypt;
+    std::vector<uint8_t*> data;
+    std::vector<size_t>   size;
+
+    Job() : key(), encrypt(true), data(), size() {}
+
+    void run()
+    {
+        if (!data.empty()) {
+            if (encrypt) {
+                key.encryptBatch(&data[0], &size[0], data.size());
+            }
+            else {
+                key.decryptBatch(&data[0], &size[0], data.size());
+            }
+        }
+    }
+};
+
+
+//----------------------------------------------------------------------------
+// A worker thread: process jobs until termination.
+//----------------------------------------------------------------------------
+
+class ts::ParallelScrambling::WorkerThread: public Thread
+{
+public:
+    WorkerThread(ParallelScrambling* pool) : Thread(), _pool(pool) {}
+    virtual ~WorkerThread() override { waitForTermination(); }
+
+private:
+    ParallelScrambling* _pool;
+
+    virtual void main() override
+    {
+        Job* job = 0;
+        while ((job = _pool->nextJob(true)) != 0) {
+            job->run();
+            _pool->releaseJob(job);
+        }
+    }
+
+    // Inaccessible operations.
+    WorkerThread() = delete;
+    WorkerThread(const WorkerThread&) = delete;
+    WorkerThread& operator=(const WorkerThread&) = delete;
+};
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::ParallelScrambling::ParallelScrambling(size_t threads) :
+    _data(),
+    _size(),
+    _threads(),
+    _free(),
+    _queue(),
+    _running(0),
+    _terminate(false),
+    _mutex(),
+    _work(),
+    _done()
+{
+    setThreads(threads);
+}
+
+ts::ParallelScrambling::~ParallelScrambling()
+{
+    setThreads(0);
+    for (size_t i = 0; i < _free.size(); ++i) {
+        delete _free[i];
+    }
+    _free.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Set the number of worker threads.
+//----------------------------------------------------------------------------
+
+void ts::ParallelScrambling::setThreads(size_t count)
+{
+    count = std::min(count, MAX_THREADS);
+    if (count == _threads.size()) {
+        return;
+    }
+
+    // Complete all submitted jobs and terminate the current threads.
+    wait();
+    if (!_threads.empty()) {
+        {
+            GuardCondition lock(_mutex, _work);
+            _terminate = true;
+            lock.signal();
+        }
+        // The destructor of the threads waits for their termination.
+        for (size_t i = 0; i < _threads.size(); ++i) {
+            delete _threads[i];
+        }
+        _threads.clear();
+    }
+
+    // Start the new threads.
+    _terminate = false;
+    for (size_t i = 0; i < count; ++i) {
+        _threads.push_back(new WorkerThread(this));
+        _threads.back()->start();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Submit all added data blocks.
+//----------------------------------------------------------------------------
+
+void ts::ParallelScrambling::submit(const Scrambling& key, bool encrypt)
+{
+    const size_t count = _data.size();
+    if (count == 0) {
+        return;
+    }
+
+    // Without worker threads, process the data blocks now.
+    if (_threads.empty()) {
+        Scrambling local_key(key);
+        if (encrypt) {
+            local_key.encryptBatch(&_data[0], &_size[0], count);
+        }
+        else {
+            local_key.decryptBatch(&_data[0], &_size[0], count);
+        }
+        _data.clear();
+        _size.clear();
+        return;
+    }
+
+    // Split the data blocks between the worker threads and the application thread
+    // which helps in wait(). Small sets of data blocks are not split.
+    const size_t parts = _threads.size() + 1;
+    const size_t job_size = std::max(MIN_JOB_SIZE, (count + parts - 1) / parts);
+
+    GuardCondition lock(_mutex, _work);
+    for (size_t first = 0; first < count; first += job_size) {
+        const size_t last = std::min(count, first + job_size);
+        Job* job = 0;
+        if (_free.empty()) {
+            job = new Job;
+        }
+        else {
+            job = _free.back();
+            _free.pop_back();
+        }
+        job->key = key;
+        job->encrypt = encrypt;
+        job->data.assign(_data.begin() + first, _data.begin() + last);
+        job->size.assign(_size.begin() + first, _size.begin() + last);
+        _queue.push_back(job);
+        _running++;
+    }
+    _data.clear();
+    _size.clear();
+
+    // Wake up one worker thread, which wakes up another one if more jobs are queued.
+    lock.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Get next job from the queue.
+//----------------------------------------------------------------------------
+
+ts::ParallelScrambling::Job* ts::ParallelScrambling::nextJob(bool wait_for_job)
+{
+    GuardCondition lock(_mutex, _work);
+    while (wait_for_job && _queue.empty() && !_terminate) {
+        lock.waitCondition();
+    }
+    if (_queue.empty()) {
+        // On termination, propagate the wake-up to the next worker thread.
+        if (_terminate) {
+            lock.signal();
+        }
+        return 0;
+    }
+    Job* job = _queue.front();
+    _queue.pop_front();
+    if (!_queue.empty()) {
+        lock.signal();
+    }
+    return job;
+}
+
+
+//----------------------------------------------------------------------------
+// Release a completed job.
+//----------------------------------------------------------------------------
+
+void ts::ParallelScrambling::releaseJob(Job* job)
+{
+    GuardCondition lock(_mutex, _done);
+    _free.push_back(job);
+    assert(_running > 0);
+    if (--_running == 0) {
+        lock.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for the completion of all submitted jobs.
+//----------------------------------------------------------------------------
+
+void ts::ParallelScrambling::wait()
+{
+    // The application thread processes the jobs which are not yet started.
+    Job* job = 0;
+    while ((job = nextJob(false)) != 0) {
+        job->run();
+        releaseJob(job);
+    }
+
+    // Then wait for the jobs in the worker threads.
+    GuardCondition lock(_mutex, _done);
+    while (_running > 0) {
+        lock.waitCondition();
+    }
+}
@@ -0,0 +1,161 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  DVB-CSA scrambling of packet payloads using a pool of threads.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsScrambling.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+
+namespace ts {
+    //!
+    //! DVB-CSA scrambling of packet payloads using a pool of threads.
+    //!
+    //! The application adds the addresses of data blocks (typically TS packet payloads)
+    //! using add(). Then encrypt() or decrypt() submits all added data blocks with a
+    //! given control word. The data blocks are split in jobs which are processed in
+    //! place by the worker threads, using Scrambling::encryptBatch() or decryptBatch().
+    //! The application can add and submit more data blocks, possibly with another control
+    //! word, while the previous jobs are processed. Each job uses its own copy of the
+    //! Scrambling object, as it was when the job was submitted.
+    //!
+    //! The application must call wait() before using the data blocks. While waiting,
+    //! the application thread also processes the remaining jobs.
+    //!
+    //! Without worker threads, encrypt() and decrypt() directly process the data blocks.
+    //!
+    class TSDUCKDLL ParallelScrambling
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] threads Initial number of worker threads.
+        //!
+        ParallelScrambling(size_t threads = 0);
+
+        //!
+        //! Destructor.
+        //! Wait for all submitted jobs and terminate the worker threads.
+        //!
+        ~ParallelScrambling();
+
+        //!
+        //! Set the number of worker threads.
+        //! All submitted jobs are completed first.
+        //! @param [in] count Number of worker threads. Zero means no thread, the data blocks
+        //! are processed in encrypt() or decrypt(). The value is silently limited to MAX_THREADS.
+        //!
+        void setThreads(size_t count);
+
+        //!
+        //! Get the number of worker threads.
+        //! @return The number of worker threads.
+        //!
+        size_t threads() const { return _threads.size(); }
+
+        //!
+        //! Maximum number of worker threads.
+        //!
+        static const size_t MAX_THREADS = 64;
+
+        //!
+        //! Minimum number of data blocks in a job. The bitsliced DVB-CSA implementation
+        //! processes at least 64 data blocks at a time, smaller jobs would waste CPU.
+        //!
+        static const size_t MIN_JOB_SIZE = 64;
+
+        //!
+        //! Add a data block to process in the next call to encrypt() or decrypt().
+        //! @param [in,out] data Address of the data block. It must remain valid until wait() returns.
+        //! @param [in] size Size in bytes of the data block.
+        //!
+        void add(uint8_t* data, size_t size)
+        {
+            _data.push_back(data);
+            _size.push_back(size);
+        }
+
+        //!
+        //! Get the number of data blocks which were added and not yet submitted.
+        //! @return The number of data blocks which were added and not yet submitted.
+        //!
+        size_t pending() const { return _data.size(); }
+
+        //!
+        //! Submit all added data blocks for encryption.
+        //! @param [in] key DVB-CSA key for the data blocks. It is copied, the application
+        //! may reinitialize it with another control word as soon as encrypt() returns.
+        //!
+        void encrypt(const Scrambling& key) { submit(key, true); }
+
+        //!
+        //! Submit all added data blocks for decryption.
+        //! @param [in] key DVB-CSA key for the data blocks. It is copied, the application
+        //! may reinitialize it with another control word as soon as decrypt() returns.
+        //!
+        void decrypt(const Scrambling& key) { submit(key, false); }
+
+        //!
+        //! Wait for the completion of all submitted jobs.
+        //!
+        void wait();
+
+    private:
+        class Job;
+        class WorkerThread;
+
+        std::vector<uint8_t*>      _data;      // Added data blocks, not yet submitted.
+        std::vector<size_t>        _size;      // Sizes of added data blocks.
+        std::vector<WorkerThread*> _threads;   // Worker threads.
+        std::vector<Job*>          _free;      // Free jobs, for reuse, under mutex.
+        std::deque<Job*>           _queue;     // Submitted jobs, not yet started, under mutex.
+        size_t                     _running;   // Number of jobs which are submitted and not completed, under mutex.
+        bool                       _terminate; // Request the worker threads to terminate, under mutex.
+        Mutex                      _mutex;     // Protect the job queues.
+        Condition                  _work;      // Signaled when jobs are submitted or on termination.
+        Condition                  _done;      // Signaled when the last running job completes.
+
+        // Submit all added data blocks.
+        void submit(const Scrambling& key, bool encrypt);
+
+        // Get next job from the queue, wait for it in worker threads. Return zero on termination or empty queue.
+        Job* nextJob(bool wait_for_job);
+
+        // Release a completed job.
+        void releaseJob(Job* job);
+
+        // Inaccessible operations.
+        ParallelScrambling(const ParallelScrambling&) = delete;
+        ParallelScrambling& operator=(const ParallelScrambling&) = delete;
+    };
+}
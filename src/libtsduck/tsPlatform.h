@@ -616,6 +616,7 @@
 #include <deque>
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <set>
 #include <bitset>
 #include <algorithm>
@@ -85,3 +85,26 @@ void ts::Plugin::writeLog(int severity, const UString& message)
     // Force message to go through tsp
     tsp->log(severity, message);
 }
+
+
+//----------------------------------------------------------------------------
+// Default packet batch processing: process packets one by one.
+//----------------------------------------------------------------------------
+
+size_t ts::ProcessorPlugin::processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
+{
+    size_t n = 0;
+    while (n < count) {
+        TSPacket& p(pkt[n]);
+        Status& st(status[n++]);
+        if (p.b[0] == 0) {
+            // Already dropped by a previous plugin.
+            st = TSP_DROP;
+        }
+        else if ((st = processPacket(p, flush, bitrate_changed)) == TSP_END || flush || bitrate_changed) {
+            // Return immediately, tsp must act at this packet.
+            break;
+        }
+    }
+    return n;
+}
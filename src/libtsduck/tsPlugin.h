@@ -84,7 +84,7 @@ namespace ts {
         //! @c int data named @c tspInterfaceVersion which contains the current
         //! interface version at the time the library is built.
         //!
-        static const int API_VERSION = 5;
+        static const int API_VERSION = 6;
 
         //!
         //! Get the current input bitrate in bits/seconds.
@@ -408,6 +408,36 @@ namespace ts {
         //!
         virtual Status processPacket(TSPacket& pkt, bool& flush, bool& bitrate_changed) = 0;
 
+        //!
+        //! Packet batch processing interface.
+        //!
+        //! The main application invokes processPacketBatch() to let the shared library
+        //! process a contiguous range of TS packets in the tsp buffer. The default
+        //! implementation invokes processPacket() for each packet. Plugins with a high
+        //! per-packet processing rate may override this method to process the packets
+        //! in a tight loop. Using processPacketBatchWith() is the simplest way to do
+        //! that without duplicating the processing code.
+        //!
+        //! Packets which were dropped by a previous plugin (the first byte of the packet
+        //! is zero) shall not be processed and their status shall be set to TSP_DROP.
+        //! The processing stops after the first packet which returns TSP_END or which
+        //! sets @a flush or @a bitrate_changed, so that tsp can act at this packet.
+        //!
+        //! @param [in,out] pkt Address of the first TS packet to process.
+        //! @param [out] status Address of an array of @a count processing status,
+        //! one per packet, as returned by processPacket().
+        //! @param [in] count Number of packets to process.
+        //! @param [in,out] flush Initially set to false. If the method sets @a flush to true,
+        //! the processed packets and all previously processed and buffered packets should
+        //! be passed to the next processor as soon as possible.
+        //! @param [in,out] bitrate_changed Initially set to false. If the method sets
+        //! @a bitrate_changed to true, tsp should call the getBitrate() callback as soon as possible.
+        //! @return The number of processed packets. This is @a count, unless a packet
+        //! returned TSP_END or set @a flush or @a bitrate_changed. In that case, this
+        //! packet is the last processed one.
+        //!
+        virtual size_t processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed);
+
         //!
         //! Constructor.
         //!
@@ -426,6 +456,40 @@ namespace ts {
         //!
         virtual ~ProcessorPlugin() {}
 
+    protected:
+        //!
+        //! Implementation helper for processPacketBatch() in subclasses.
+        //!
+        //! A subclass may override processPacketBatch() using this method. It
+        //! loops on the packets with a non-virtual call to PLUGIN::processPacket(),
+        //! which can be inlined by the compiler.
+        //! @tparam PLUGIN The class of the subclass, the one which defines processPacket().
+        //! @param [in,out] pkt Address of the first TS packet to process.
+        //! @param [out] status Address of an array of @a count processing status.
+        //! @param [in] count Number of packets to process.
+        //! @param [in,out] flush Set to true if a packet requests a flush.
+        //! @param [in,out] bitrate_changed Set to true if a packet signals a bitrate change.
+        //! @return The number of processed packets.
+        //! @see processPacketBatch()
+        //!
+        template <class PLUGIN>
+        size_t processPacketBatchWith(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
+        {
+            PLUGIN* const plugin = static_cast<PLUGIN*>(this);
+            size_t n = 0;
+            while (n < count) {
+                TSPacket& p(pkt[n]);
+                Status& st(status[n++]);
+                if (p.b[0] == 0) {
+                    st = TSP_DROP;
+                }
+                else if ((st = plugin->PLUGIN::processPacket(p, flush, bitrate_changed)) == TSP_END || flush || bitrate_changed) {
+                    break;
+                }
+            }
+            return n;
+        }
+
     private:
         // Inaccessible operations
         ProcessorPlugin() = delete;
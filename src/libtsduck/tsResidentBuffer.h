@@ -34,8 +34,23 @@
 
 #pragma once
 #include "tsPlatform.h"
+#include "tsEnumeration.h"
 
 namespace ts {
+    //!
+    //! Types of memory pages which can be used by a ts::ResidentBuffer.
+    //!
+    enum MemoryPageType {
+        NORMAL_PAGES           = 0,  //!< Normal memory pages.
+        TRANSPARENT_HUGE_PAGES = 1,  //!< Normal memory pages with a hint to use transparent huge pages (Linux).
+        HUGE_PAGES             = 2,  //!< Explicit huge pages (Linux hugetlbfs, Windows large pages).
+    };
+
+    //!
+    //! Enumeration description of ts::MemoryPageType.
+    //!
+    TSDUCKDLL extern const Enumeration MemoryPageTypeEnum;
+
     //!
     //! Implementation of memory buffer locked in physical memory.
     //! @tparam T Type of the buffer element.
@@ -48,9 +63,22 @@ namespace ts {
         //! Constructor, based on required amount of elements.
         //! Abort application if memory allocation fails.
         //! Do not abort if memory locking fails.
+        //!
+        //! When @a huge_pages is true, the buffer is allocated using the largest possible
+        //! memory pages to reduce TLB misses with large buffers. The following methods
+        //! are tried in this order, the first one which succeeds is used:
+        //! - Linux: explicit 1 GB huge pages (buffers of 1 GB or more only), explicit
+        //!   2 MB huge pages (both require pre-allocated pages in hugetlbfs, see
+        //!   /proc/sys/vm/nr_hugepages), anonymous memory with a transparent huge
+        //!   pages hint (madvise), normal pages.
+        //! - Windows: large pages (require the "Lock pages in memory" privilege), normal pages.
+        //! - Other systems: normal pages.
+        //!
         //! @param [in] elem_count Number of @a T elements.
+        //! @param [in] huge_pages If true, try to use huge memory pages.
+        //! @see pageType()
         //!
-        ResidentBuffer(size_t elem_count);
+        ResidentBuffer(size_t elem_count, bool huge_pages = false);
 
         //!
         //! Destructor.
@@ -93,21 +121,46 @@ namespace ts {
             return _elem_count;
         }
 
+        //!
+        //! Get the type of memory pages which were actually obtained.
+        //! @return The type of memory pages in the buffer.
+        //!
+        MemoryPageType pageType() const
+        {
+            return _page_type;
+        }
+
+        //!
+        //! Get the size of the memory pages which were actually obtained.
+        //! @return The size in bytes of the memory pages in the buffer. With transparent
+        //! huge pages, this is the expected huge page size; the operating system may
+        //! still use normal pages for some or all of the buffer.
+        //!
+        size_t pageSize() const
+        {
+            return _page_size;
+        }
+
     private:
         // Unreachable constructors and operators.
         ResidentBuffer() = delete;
         ResidentBuffer(const ResidentBuffer&) = delete;
         ResidentBuffer& operator=(const ResidentBuffer&) = delete;
 
+        // Try to allocate huge pages. Return true on success.
+        bool allocateHugePages(size_t requested_size);
+
         // Private members:
         char*     _allocated_base;   // First allocated address
         char*     _locked_base;      // First locked address (mlock, page boundary)
         T*        _base;             // Same as _locked_base with type T*
-        size_t    _allocated_size;   // Allocated size (ts_malloc)
+        size_t    _allocated_size;   // Allocated size (new, mmap, VirtualAlloc)
         size_t    _locked_size;      // Locked size (mlock, multiple of page size)
         size_t    _elem_count;       // Element count in locked region
         bool      _is_locked;        // False if mlock failed.
         ErrorCode _error_code;       // Lock error code
+        MemoryPageType _page_type;   // Type of memory pages
+        size_t    _page_size;        // Size of memory pages
     };
 
 }
@@ -46,7 +46,7 @@
 //----------------------------------------------------------------------------
 
 template <typename T>
-ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count) :
+ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count, bool huge_pages) :
     _allocated_base(0),
     _locked_base(0),
     _base(0),
@@ -54,40 +54,50 @@ ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count) :
     _locked_size(0),
     _elem_count(elem_count),
     _is_locked(false),
-    _error_code(SYS_SUCCESS)
+    _error_code(SYS_SUCCESS),
+    _page_type(NORMAL_PAGES),
+    _page_size(SysInfo::Instance()->memoryPageSize())
 {
     const size_t requested_size = elem_count * sizeof(T);
-    const size_t page_size = SysInfo::Instance()->memoryPageSize();
 
-    // Allocate enough space to include memory pages around the requested size
+    if (!huge_pages || !allocateHugePages(requested_size)) {
 
-    _allocated_size = requested_size + 2 * page_size;
-    _allocated_base = new char[_allocated_size];
+        // Allocate enough space to include memory pages around the requested size
 
-    // Locked space starts at next page boundary after allocated base:
-    // Its size is the next multiple of page size after requested_size:
+        _allocated_size = requested_size + 2 * _page_size;
+        _allocated_base = new char[_allocated_size];
 
-    _locked_base = (char*)(RoundUp(uint64_t(_allocated_base), uint64_t(page_size)));
-    _locked_size = RoundUp(requested_size, page_size);
+        // Locked space starts at next page boundary after allocated base:
+        // Its size is the next multiple of page size after requested_size:
+
+        _locked_base = (char*)(RoundUp(uint64_t(_allocated_base), uint64_t(_page_size)));
+        _locked_size = RoundUp(requested_size, _page_size);
+    }
 
     _base = new (_locked_base) T[elem_count];
 
     // Integrity checks
 
     assert(_allocated_base <= _locked_base);
-    assert(_locked_base < _allocated_base + page_size);
+    assert(_locked_base < _allocated_base + _page_size);
     assert(_locked_base + _locked_size <= _allocated_base + _allocated_size);
     assert(requested_size <= _locked_size);
     assert(_locked_size <= _allocated_size);
-    assert(uint64_t(_locked_base) % page_size == 0);
+    assert(uint64_t(_locked_base) % _page_size == 0);
     assert(uint64_t(_locked_base) == uint64_t(_base));
     assert((char*)(_base + elem_count) <= _locked_base + _locked_size);
-    assert(_locked_size % page_size == 0);
+    assert(_locked_size % _page_size == 0);
 
 #if defined (TS_WINDOWS)
 
     // Windows implementation.
 
+    // Large pages are always locked in physical memory.
+    if (_page_type == HUGE_PAGES) {
+        _is_locked = true;
+        return;
+    }
+
     // Get the current working set of the process.
     // If working set too low, try to extend working set.
     ::SIZE_T wsmin, wsmax;
@@ -119,6 +129,90 @@ ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count) :
 }
 
 
+//----------------------------------------------------------------------------
+// Try to allocate huge pages. Return true on success.
+//----------------------------------------------------------------------------
+
+template <typename T>
+bool ts::ResidentBuffer<T>::allocateHugePages(size_t requested_size)
+{
+#if defined(TS_LINUX)
+
+    // Explicit huge pages from hugetlbfs: the mapping must be a multiple of the
+    // huge page size. 1 GB pages are used only when at least one page is filled.
+    // The huge page size is encoded as its log2 at bit MAP_HUGE_SHIFT (26) in the
+    // mmap() flags (MAP_HUGE_2MB and MAP_HUGE_1GB are not always defined in libc).
+    static const size_t size_2mb = 2 * 1024 * 1024;
+    static const size_t size_1gb = 1024 * 1024 * 1024;
+    struct HugePage {
+        size_t size;
+        int    flags;
+    };
+    static const HugePage huge_pages[] = {
+        {size_1gb, MAP_HUGETLB | (30 << 26)},
+        {size_2mb, MAP_HUGETLB | (21 << 26)},
+    };
+
+    for (size_t i = 0; i < sizeof(huge_pages) / sizeof(huge_pages[0]); ++i) {
+        if (huge_pages[i].size > size_2mb && requested_size < huge_pages[i].size) {
+            continue;
+        }
+        const size_t size = RoundUp(requested_size, huge_pages[i].size);
+        void* addr = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | huge_pages[i].flags, -1, 0);
+        if (addr != MAP_FAILED) {
+            _allocated_base = _locked_base = reinterpret_cast<char*>(addr);
+            _allocated_size = _locked_size = size;
+            _page_type = HUGE_PAGES;
+            _page_size = huge_pages[i].size;
+            return true;
+        }
+    }
+
+    // Transparent huge pages: the kernel transparently uses huge pages when the
+    // region is aligned on a huge page boundary. Allocate one more huge page to align.
+    const size_t size = RoundUp(requested_size, size_2mb);
+    void* addr = ::mmap(0, size + size_2mb, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr != MAP_FAILED) {
+        char* const aligned = reinterpret_cast<char*>(RoundUp(uint64_t(addr), uint64_t(size_2mb)));
+        if (::madvise(aligned, size, MADV_HUGEPAGE) == 0) {
+            _allocated_base = reinterpret_cast<char*>(addr);
+            _allocated_size = size + size_2mb;
+            _locked_base = aligned;
+            _locked_size = size;
+            _page_type = TRANSPARENT_HUGE_PAGES;
+            _page_size = size_2mb;
+            return true;
+        }
+        ::munmap(addr, size + size_2mb);
+    }
+    return false;
+
+#elif defined(TS_WINDOWS)
+
+    // Large pages require the "Lock pages in memory" privilege (SeLockMemoryPrivilege).
+    const size_t large_size = size_t(::GetLargePageMinimum());
+    if (large_size > 0) {
+        const size_t size = RoundUp(requested_size, large_size);
+        void* addr = ::VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (addr != NULL) {
+            _allocated_base = _locked_base = reinterpret_cast<char*>(addr);
+            _allocated_size = _locked_size = size;
+            _page_type = HUGE_PAGES;
+            _page_size = large_size;
+            return true;
+        }
+    }
+    return false;
+
+#else
+
+    // No huge page support on this system.
+    return false;
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Destructor
 //----------------------------------------------------------------------------
@@ -127,7 +221,7 @@ template <typename T>
 ts::ResidentBuffer<T>::~ResidentBuffer()
 {
     // Unlock from physical memory
-    if (_is_locked) {
+    if (_is_locked && _page_type == NORMAL_PAGES) {
 #if defined (TS_WINDOWS)
         ::VirtualUnlock(_locked_base, _locked_size);
 #else
@@ -137,7 +231,16 @@ ts::ResidentBuffer<T>::~ResidentBuffer()
 
     // Free memory
     if (_allocated_base != 0) {
-        delete[] _allocated_base;
+        if (_page_type == NORMAL_PAGES) {
+            delete[] _allocated_base;
+        }
+        else {
+#if defined(TS_WINDOWS)
+            ::VirtualFree(_allocated_base, 0, MEM_RELEASE);
+#elif defined(TS_UNIX)
+            ::munmap(_allocated_base, _allocated_size);
+#endif
+        }
     }
 
     // Reset state (it explicit call of destructor)
@@ -148,4 +251,5 @@ ts::ResidentBuffer<T>::~ResidentBuffer()
     _locked_size = 0;
     _elem_count = 0;
     _is_locked = false;
+    _page_type = NORMAL_PAGES;
 }
@@ -31,6 +31,29 @@ TSDUCK_SOURCE;
 #pragma warning(disable:4244) // '=': conversion from 'int' to 'uint8_t', possible loss of data
 #endif
 
+// The bitsliced stream cipher uses 128-bit words (SSE2 is always present on x86-64)
+// and 256-bit words when AVX2 is supported by the CPU.
+
+#if defined(TS_X86_64) && (defined(TS_GCC) || defined(TS_MSC))
+    #define TS_SCRAMBLING_SIMD 1
+    #if defined(TS_MSC)
+        #include <intrin.h>
+        #define TS_AVX2_TARGET
+    #else
+        #include <immintrin.h>
+        #define TS_AVX2_TARGET __attribute__((target("avx2"), flatten))
+        #if defined(TS_GCC_ONLY)
+            // 256-bit vectors are passed by value between inlined functions only.
+            #pragma GCC diagnostic ignored "-Wpsabi"
+        #endif
+    #endif
+#endif
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::Scrambling::MIN_BATCH_SIZE;
+const size_t ts::Scrambling::BlockCipher::LANES;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Manually perform entropy reduction on a control word.
@@ -568,6 +591,87 @@ void ts::Scrambling::BlockCipher::encipher (const uint8_t *bd, uint8_t *ib)
 }
 
 
+//----------------------------------------------------------------------------
+// Block cipher on interleaved blocks.
+//
+// A block is stored in a 64-bit value, R[1] in the least significant byte.
+// One round of encipher() becomes:
+//   v = (v >> 8) ^ (R[1] broadcast in bytes 1, 2, 3, 7) ^ EncRound[kk ^ R[8]]
+// where EncRound[] contains sbox_out in byte 7 and perm_out in byte 5.
+// One round of decipher() becomes:
+//   v = (v << 8) ^ (R[8] broadcast in bytes 0, 2, 3, 4) ^ DecRound[kk ^ R[7]]
+// where DecRound[] contains sbox_out in bytes 0, 2, 3, 4 and perm_out in byte 6.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    const uint64_t ENC_BROADCAST = TS_UCONST64(0x0100000001010100);
+    const uint64_t DEC_BROADCAST = TS_UCONST64(0x0000000101010001);
+
+    struct BlockRoundTables
+    {
+        uint64_t enc[256];
+        uint64_t dec[256];
+
+        BlockRoundTables() : enc(), dec()
+        {
+            for (size_t i = 0; i < 256; ++i) {
+                const uint64_t sbox_out = block_sbox[i];
+                const uint64_t perm_out = uint64_t(block_perm[sbox_out]);
+                enc[i] = (sbox_out << 56) | (perm_out << 40);
+                dec[i] = (sbox_out * DEC_BROADCAST) | (perm_out << 48);
+            }
+        }
+    };
+
+    const BlockRoundTables RoundTables;
+}
+
+void ts::Scrambling::BlockCipher::encipherLanes(uint64_t* blocks) const
+{
+    uint64_t v0 = blocks[0];
+    uint64_t v1 = blocks[1];
+    uint64_t v2 = blocks[2];
+    uint64_t v3 = blocks[3];
+
+    for (int i = 1; i <= 56; i++) {
+        const uint64_t* const table = RoundTables.enc;
+        const int k = _kk[i];
+        v0 = (v0 >> 8) ^ ((v0 & 0xFF) * ENC_BROADCAST) ^ table[k ^ int(v0 >> 56)];
+        v1 = (v1 >> 8) ^ ((v1 & 0xFF) * ENC_BROADCAST) ^ table[k ^ int(v1 >> 56)];
+        v2 = (v2 >> 8) ^ ((v2 & 0xFF) * ENC_BROADCAST) ^ table[k ^ int(v2 >> 56)];
+        v3 = (v3 >> 8) ^ ((v3 & 0xFF) * ENC_BROADCAST) ^ table[k ^ int(v3 >> 56)];
+    }
+
+    blocks[0] = v0;
+    blocks[1] = v1;
+    blocks[2] = v2;
+    blocks[3] = v3;
+}
+
+void ts::Scrambling::BlockCipher::decipherLanes(uint64_t* blocks) const
+{
+    uint64_t v0 = blocks[0];
+    uint64_t v1 = blocks[1];
+    uint64_t v2 = blocks[2];
+    uint64_t v3 = blocks[3];
+
+    for (int i = 56; i > 0; i--) {
+        const uint64_t* const table = RoundTables.dec;
+        const int k = _kk[i];
+        v0 = (v0 << 8) ^ ((v0 >> 56) * DEC_BROADCAST) ^ table[k ^ int((v0 >> 48) & 0xFF)];
+        v1 = (v1 << 8) ^ ((v1 >> 56) * DEC_BROADCAST) ^ table[k ^ int((v1 >> 48) & 0xFF)];
+        v2 = (v2 << 8) ^ ((v2 >> 56) * DEC_BROADCAST) ^ table[k ^ int((v2 >> 48) & 0xFF)];
+        v3 = (v3 << 8) ^ ((v3 >> 56) * DEC_BROADCAST) ^ table[k ^ int((v3 >> 48) & 0xFF)];
+    }
+
+    blocks[0] = v0;
+    blocks[1] = v1;
+    blocks[2] = v2;
+    blocks[3] = v3;
+}
+
+
 //----------------------------------------------------------------------------
 // Set the control word for subsequent encrypt/decrypt operations
 //----------------------------------------------------------------------------
@@ -707,3 +811,535 @@ void ts::Scrambling::decrypt (uint8_t* data, size_t size)
         }
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Bitsliced stream cipher.
+//
+// Each bit of the stream cipher state is stored in a separate "slice" word.
+// Bit N of a slice word is the state bit for data block N. All operations on
+// the state are boolean operations on slice words and are applied to all data
+// blocks at the same time. The word type W is uint64_t (64 blocks in parallel)
+// or a SIMD vector type (128 or 256 blocks in parallel).
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // SIMD slice word types.
+#if defined(TS_SCRAMBLING_SIMD) && defined(TS_MSC)
+    struct CSAWord128
+    {
+        __m128i v;
+        CSAWord128 operator&(const CSAWord128& w) const { CSAWord128 r; r.v = _mm_and_si128(v, w.v); return r; }
+        CSAWord128 operator|(const CSAWord128& w) const { CSAWord128 r; r.v = _mm_or_si128(v, w.v); return r; }
+        CSAWord128 operator^(const CSAWord128& w) const { CSAWord128 r; r.v = _mm_xor_si128(v, w.v); return r; }
+        CSAWord128 operator~() const { CSAWord128 r; r.v = _mm_xor_si128(v, _mm_set1_epi32(-1)); return r; }
+    };
+    struct CSAWord256
+    {
+        __m256i v;
+        CSAWord256 operator&(const CSAWord256& w) const { CSAWord256 r; r.v = _mm256_and_si256(v, w.v); return r; }
+        CSAWord256 operator|(const CSAWord256& w) const { CSAWord256 r; r.v = _mm256_or_si256(v, w.v); return r; }
+        CSAWord256 operator^(const CSAWord256& w) const { CSAWord256 r; r.v = _mm256_xor_si256(v, w.v); return r; }
+        CSAWord256 operator~() const { CSAWord256 r; r.v = _mm256_xor_si256(v, _mm256_set1_epi32(-1)); return r; }
+    };
+#elif defined(TS_SCRAMBLING_SIMD)
+    // With GCC and LLVM, the vector extensions provide the boolean operators.
+    // The 256-bit code is compiled for AVX2 when inlined in a TS_AVX2_TARGET function.
+    typedef long long CSAWord128 __attribute__((vector_size(16)));
+    typedef long long CSAWord256 __attribute__((vector_size(32)));
+#endif
+
+    // Conversion between slice words and arrays of 64-bit chunks (chunk 0 is blocks 0 to 63).
+    template <class W>
+    struct CSAWordTraits
+    {
+        static const size_t CHUNKS = sizeof(W) / 8;
+        static W Load(const uint64_t* p) { W w; ::memcpy(&w, p, sizeof(W)); return w; }
+        static void Store(uint64_t* p, const W& w) { ::memcpy(p, &w, sizeof(W)); }
+        static W Broadcast(bool bit) { W w; ::memset(&w, bit ? 0xFF : 0x00, sizeof(W)); return w; }
+    };
+
+    // Select a when s is set, b otherwise.
+    template <class W>
+    inline W Select(const W& s, const W& a, const W& b)
+    {
+        return b ^ ((a ^ b) & s);
+    }
+
+    // Evaluation of a boolean function with N inputs, described by its truth table TT.
+    // The input x[N-1] is the most significant bit of the index in the truth table.
+    // The function is recursively split in two halves and the constant parts are
+    // eliminated at compile time.
+    template <class W, uint64_t TT, unsigned N,
+              bool CONSTANT = (TT == 0 || TT == (uint64_t(1) << (1 << N)) - 1)>
+    struct CSABoolFunction
+    {
+        static const unsigned HALF = 1 << (N - 1);
+        static const uint64_t MASK = (uint64_t(1) << HALF) - 1;
+        static const uint64_t LOW = TT & MASK;
+        static const uint64_t HIGH = (TT >> HALF) & MASK;
+
+        static W Eval(const W* x)
+        {
+            if (LOW == HIGH) {
+                // The function does not depend on x[N-1].
+                return CSABoolFunction<W, LOW, (N - 1)>::Eval(x);
+            }
+            else if (LOW == (~HIGH & MASK)) {
+                // The two halves are complementary.
+                return CSABoolFunction<W, LOW, (N - 1)>::Eval(x) ^ x[N - 1];
+            }
+            else {
+                return Select(x[N - 1], CSABoolFunction<W, HIGH, (N - 1)>::Eval(x), CSABoolFunction<W, LOW, (N - 1)>::Eval(x));
+            }
+        }
+    };
+
+    template <class W, uint64_t TT, unsigned N>
+    struct CSABoolFunction<W, TT, N, true>
+    {
+        static W Eval(const W*)
+        {
+            return CSAWordTraits<W>::Broadcast(TT != 0);
+        }
+    };
+
+    // Bitsliced s-box with 5 inputs and 2 outputs, described by the truth tables of the two output bits.
+    template <class W, uint32_t BIT0, uint32_t BIT1>
+    inline void CSASBox(W s[2], const W& x4, const W& x3, const W& x2, const W& x1, const W& x0)
+    {
+        const W x[5] = {x0, x1, x2, x3, x4};
+        s[0] = CSABoolFunction<W, BIT0, 5>::Eval(x);
+        s[1] = CSABoolFunction<W, BIT1, 5>::Eval(x);
+    }
+
+    // Transpose a 64x64 bit matrix: bit j of a[i] is swapped with bit i of a[j].
+    void Transpose64(uint64_t a[64])
+    {
+        uint64_t m = TS_UCONST64(0x00000000FFFFFFFF);
+        for (unsigned j = 32; j != 0; j >>= 1, m ^= m << j) {
+            for (unsigned k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+                const uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+                a[k | j] ^= t;
+                a[k] ^= t << j;
+            }
+        }
+    }
+
+    // Bitsliced stream cipher state.
+    // Nibble registers are arrays of 4 slices, index 0 is the least significant bit.
+    template <class W>
+    class CSAStreamSlices
+    {
+    public:
+        // Number of data blocks which are processed in parallel.
+        static const size_t LANES = sizeof(W) * 8;
+
+        // Load the key, same operation as StreamCipher::init() on all data blocks.
+        void init(const uint8_t* key);
+
+        // Same operation as StreamCipher::cipher() on all data blocks.
+        // Initialization when in is not null, using 64 slices of input. Otherwise, generate 64 slices of output.
+        void cipher(const W* in, W* out);
+
+    private:
+        W A[11][4];
+        W B[11][4];
+        W X[4], Y[4], Z[4], D[4], E[4], F[4];
+        W p, q, r;
+    };
+
+    template <class W>
+    void CSAStreamSlices<W>::init(const uint8_t* key)
+    {
+        const W zero(CSAWordTraits<W>::Broadcast(false));
+        for (size_t n = 0; n < 8; ++n) {
+            // A[1]..A[8] from key[0..3], B[1]..B[8] from key[4..7], high nibble first.
+            const int a = (key[n / 2] >> (n % 2 == 0 ? 4 : 0)) & 0x0F;
+            const int b = (key[4 + n / 2] >> (n % 2 == 0 ? 4 : 0)) & 0x0F;
+            for (size_t i = 0; i < 4; ++i) {
+                A[n + 1][i] = CSAWordTraits<W>::Broadcast(((a >> i) & 1) != 0);
+                B[n + 1][i] = CSAWordTraits<W>::Broadcast(((b >> i) & 1) != 0);
+            }
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            A[0][i] = A[9][i] = A[10][i] = zero;
+            B[0][i] = B[9][i] = B[10][i] = zero;
+            X[i] = Y[i] = Z[i] = D[i] = E[i] = F[i] = zero;
+        }
+        p = q = r = zero;
+    }
+
+    template <class W>
+    void CSAStreamSlices<W>::cipher(const W* in, W* out)
+    {
+        W s1[2], s2[2], s3[2], s4[2], s5[2], s6[2], s7[2];
+        W extra_B[4], next_A1[4], next_B1[4], next_E[4];
+
+        // 8 bytes per operation, 2 bits per iteration.
+        for (size_t i = 0; i < 8; i++) {
+            for (size_t j = 0; j < 4; j++) {
+
+                // From A[1]..A[10], 35 bits are selected as inputs to 7 s-boxes.
+                CSASBox<W, 0x78C6B16C, 0x4B368771>(s1, A[4][0], A[1][2], A[6][1], A[7][3], A[9][0]);
+                CSASBox<W, 0xE41B4B63, 0x58B98679>(s2, A[2][1], A[3][2], A[6][3], A[7][0], A[9][1]);
+                CSASBox<W, 0xE41B1BE4, 0x69D25879>(s3, A[1][3], A[2][0], A[5][1], A[5][3], A[6][2]);
+                CSASBox<W, 0x92AD994B, 0x66B492AD>(s4, A[3][3], A[1][1], A[2][3], A[4][2], A[8][0]);
+                CSASBox<W, 0x35E29E58, 0x9C274CF1>(s5, A[5][2], A[4][3], A[6][0], A[8][1], A[9][2]);
+                CSASBox<W, 0x66D2E61A, 0x691BB46C>(s6, A[3][1], A[4][1], A[5][0], A[7][2], A[9][3]);
+                CSASBox<W, 0x266D9D92, 0xB38C691E>(s7, A[2][2], A[3][0], A[7][1], A[8][2], A[8][3]);
+
+                // 4x4 xor to produce extra nibble for T3.
+                extra_B[3] = B[3][0] ^ B[6][1] ^ B[7][2] ^ B[9][3];
+                extra_B[2] = B[6][0] ^ B[8][1] ^ B[3][3] ^ B[4][2];
+                extra_B[1] = B[5][3] ^ B[8][2] ^ B[4][0] ^ B[5][1];
+                extra_B[0] = B[9][2] ^ B[6][3] ^ B[3][1] ^ B[8][0];
+
+                for (size_t k = 0; k < 4; ++k) {
+                    // T1 and T2, input bits and D are used during initialization only.
+                    next_A1[k] = A[10][k] ^ X[k];
+                    next_B1[k] = B[7][k] ^ B[10][k] ^ Y[k];
+                    if (in != 0) {
+                        // in1 is the most significant nibble of the input byte, in2 the least significant one.
+                        const W& in1(in[8 * i + 4 + k]);
+                        const W& in2(in[8 * i + k]);
+                        next_A1[k] = next_A1[k] ^ D[k] ^ ((j % 2) ? in2 : in1);
+                        next_B1[k] = next_B1[k] ^ ((j % 2) ? in1 : in2);
+                    }
+                }
+
+                // If p=1, rotate next_B1 left.
+                const W b3(next_B1[3]);
+                next_B1[3] = Select(p, next_B1[2], next_B1[3]);
+                next_B1[2] = Select(p, next_B1[1], next_B1[2]);
+                next_B1[1] = Select(p, next_B1[0], next_B1[1]);
+                next_B1[0] = Select(p, b3, next_B1[0]);
+
+                // T3 = xor all inputs, T4 = sum, carry of Z + E + r when q=1.
+                W carry(r);
+                for (size_t k = 0; k < 4; ++k) {
+                    D[k] = E[k] ^ Z[k] ^ extra_B[k];
+                    next_E[k] = F[k];
+                    const W sum(Z[k] ^ E[k] ^ carry);
+                    carry = (Z[k] & E[k]) | (carry & (Z[k] ^ E[k]));
+                    F[k] = Select(q, sum, E[k]);
+                    E[k] = next_E[k];
+                }
+                r = Select(q, carry, r);
+
+                // Shift registers.
+                for (size_t n = 10; n > 1; --n) {
+                    for (size_t k = 0; k < 4; ++k) {
+                        A[n][k] = A[n - 1][k];
+                        B[n][k] = B[n - 1][k];
+                    }
+                }
+                for (size_t k = 0; k < 4; ++k) {
+                    A[1][k] = next_A1[k];
+                    B[1][k] = next_B1[k];
+                }
+
+                X[3] = s4[0]; X[2] = s3[0]; X[1] = s2[1]; X[0] = s1[1];
+                Y[3] = s6[0]; Y[2] = s5[0]; Y[1] = s4[1]; Y[0] = s3[1];
+                Z[3] = s2[0]; Z[2] = s1[0]; Z[1] = s6[1]; Z[0] = s5[1];
+                p = s7[1];
+                q = s7[0];
+
+                // 2 output bits are a function of the 4 bits of D, most significant bits first.
+                if (out != 0) {
+                    out[8 * i + 7 - 2 * j] = D[3] ^ D[2];
+                    out[8 * i + 6 - 2 * j] = D[1] ^ D[0];
+                }
+            }
+        }
+    }
+
+    // Apply the bitsliced stream cipher on up to LANES data blocks.
+    // The first 8 bytes of each data block initialize the stream cipher.
+    // The rest of each data block is xor'ed with the stream cipher output.
+    template <class W>
+    void CSAStreamLanes(const uint8_t* key, uint8_t* const* data, const size_t* size, size_t count)
+    {
+        typedef CSAWordTraits<W> Traits;
+        assert(count <= CSAStreamSlices<W>::LANES);
+
+        CSAStreamSlices<W> state;
+        W slices[64];
+        uint64_t chunks[64][Traits::CHUNKS];
+        uint64_t blocks[64];
+
+        // Transpose the first 8 bytes of each data block into 64 slices.
+        size_t max_size = 0;
+        for (size_t c = 0; c < Traits::CHUNKS; ++c) {
+            for (size_t l = 0; l < 64; ++l) {
+                const size_t lane = 64 * c + l;
+                blocks[l] = lane < count ? ts::GetUInt64LE(data[lane]) : 0;
+                if (lane < count && size[lane] > max_size) {
+                    max_size = size[lane];
+                }
+            }
+            Transpose64(blocks);
+            for (size_t s = 0; s < 64; ++s) {
+                chunks[s][c] = blocks[s];
+            }
+        }
+        for (size_t s = 0; s < 64; ++s) {
+            slices[s] = Traits::Load(chunks[s]);
+        }
+
+        // Initialize the stream cipher.
+        state.init(key);
+        state.cipher(slices, 0);
+
+        // Generate the stream cipher output, 8 bytes per data block at a time.
+        for (size_t offset = 8; offset < max_size; offset += 8) {
+            state.cipher(0, slices);
+            for (size_t s = 0; s < 64; ++s) {
+                Traits::Store(chunks[s], slices[s]);
+            }
+            for (size_t c = 0; c < Traits::CHUNKS && 64 * c < count; ++c) {
+                for (size_t s = 0; s < 64; ++s) {
+                    blocks[s] = chunks[s][c];
+                }
+                Transpose64(blocks);
+                for (size_t l = 0; l < 64 && 64 * c + l < count; ++l) {
+                    const size_t lane = 64 * c + l;
+                    if (size[lane] >= offset + 8) {
+                        ts::PutUInt64LE(data[lane] + offset, ts::GetUInt64LE(data[lane] + offset) ^ blocks[l]);
+                    }
+                    else {
+                        // Residue or end of data block.
+                        for (size_t i = offset; i < size[lane]; ++i) {
+                            data[lane][i] ^= uint8_t(blocks[l] >> (8 * (i - offset)));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+#if defined(TS_SCRAMBLING_SIMD)
+    // Check if the CPU and the operating system support AVX2.
+    bool CPUHasAVX2()
+    {
+    #if defined(TS_MSC)
+        int info[4];
+        __cpuid(info, 1);
+        // OSXSAVE (ECX bit 27) and AVX (ECX bit 28) are required to check the OS support.
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x06) != 0x06) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2") != 0;
+    #endif
+    }
+
+    const bool UseAVX2 = CPUHasAVX2();
+
+    // The whole 256-bit stream cipher is inlined in this function and compiled for AVX2.
+    TS_AVX2_TARGET void CSAStreamLanesAVX2(const uint8_t* key, uint8_t* const* data, const size_t* size, size_t count)
+    {
+        CSAStreamLanes<CSAWord256>(key, data, size, count);
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Apply the bitsliced stream cipher on a batch of data blocks.
+//----------------------------------------------------------------------------
+
+void ts::Scrambling::streamBatch(uint8_t* const* data, const size_t* size, size_t count)
+{
+    while (count > 0) {
+        size_t lanes = 0;
+#if defined(TS_SCRAMBLING_SIMD)
+        if (UseAVX2 && count > CSAStreamSlices<CSAWord128>::LANES) {
+            lanes = std::min(count, CSAStreamSlices<CSAWord256>::LANES);
+            CSAStreamLanesAVX2(_key, data, size, lanes);
+        }
+        else if (count > CSAStreamSlices<uint64_t>::LANES) {
+            lanes = std::min(count, CSAStreamSlices<CSAWord128>::LANES);
+            CSAStreamLanes<CSAWord128>(_key, data, size, lanes);
+        }
+        else
+#endif
+        {
+            lanes = std::min(count, CSAStreamSlices<uint64_t>::LANES);
+            CSAStreamLanes<uint64_t>(_key, data, size, lanes);
+        }
+        data += lanes;
+        size += lanes;
+        count -= lanes;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt a batch of data blocks.
+//----------------------------------------------------------------------------
+
+void ts::Scrambling::encryptBatch(uint8_t* const* data, const size_t* size, size_t count)
+{
+    assert(_init);
+
+    // Small batches are not worth the bitsliced implementation.
+    if (count < MIN_BATCH_SIZE) {
+        for (size_t n = 0; n < count; ++n) {
+            encrypt(data[n], size[n]);
+        }
+        return;
+    }
+
+    std::vector<uint8_t*> sdata;
+    std::vector<size_t> ssize;
+    sdata.reserve(count);
+    ssize.reserve(count);
+
+    // Data blocks smaller than 8 bytes are left unscrambled.
+    for (size_t n = 0; n < count; ++n) {
+        assert(size[n] / 8 <= MAX_NBLOCKS);
+        if (size[n] >= 8) {
+            sdata.push_back(data[n]);
+            ssize.push_back(size[n]);
+        }
+    }
+    if (sdata.empty()) {
+        return;
+    }
+
+    // Perform block cipher in reverse CBC mode, in place. After last block
+    // is initialization vector (zero in DVB-CSA). The first block is scrambled
+    // using the block cipher only. The other blocks are xor'ed with the stream
+    // cipher output in streamBatch().
+    //
+    // The blocks of a data block are chained but distinct data blocks are
+    // independent. Each lane of the block cipher processes the chain of one
+    // data block at a time, from last to first block. When a chain is complete,
+    // the lane starts the next data block.
+    const size_t LANES = BlockCipher::LANES;
+    uint64_t values[LANES];
+    uint8_t* current[LANES];   // data block in each lane, zero when unused
+    size_t next_block[LANES];  // next block to encipher in each lane
+    size_t next_data = 0;      // next data block to assign to a lane
+    size_t active = 0;         // number of used lanes
+
+    for (size_t l = 0; l < LANES; ++l) {
+        values[l] = 0;
+        current[l] = 0;
+        next_block[l] = 0;
+    }
+
+    do {
+        // Assign new data blocks to free lanes.
+        for (size_t l = 0; l < LANES; ++l) {
+            if (current[l] == 0 && next_data < sdata.size()) {
+                current[l] = sdata[next_data];
+                next_block[l] = ssize[next_data] / 8 - 1;
+                values[l] = 0; // IV
+                next_data++;
+                active++;
+            }
+            if (current[l] != 0) {
+                values[l] ^= GetUInt64LE(current[l] + 8 * next_block[l]);
+            }
+        }
+
+        _block.encipherLanes(values);
+
+        // Store enciphered blocks, release completed lanes.
+        for (size_t l = 0; l < LANES; ++l) {
+            if (current[l] != 0) {
+                PutUInt64LE(current[l] + 8 * next_block[l], values[l]);
+                if (next_block[l]-- == 0) {
+                    current[l] = 0;
+                    active--;
+                }
+            }
+        }
+    } while (active > 0 || next_data < sdata.size());
+
+    // The scrambled value of the first block initializes the stream cipher.
+    streamBatch(&sdata[0], &ssize[0], sdata.size());
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt a batch of data blocks.
+//----------------------------------------------------------------------------
+
+void ts::Scrambling::decryptBatch(uint8_t* const* data, const size_t* size, size_t count)
+{
+    assert(_init);
+
+    // Small batches are not worth the bitsliced implementation.
+    if (count < MIN_BATCH_SIZE) {
+        for (size_t n = 0; n < count; ++n) {
+            decrypt(data[n], size[n]);
+        }
+        return;
+    }
+
+    std::vector<uint8_t*> sdata;
+    std::vector<size_t> ssize;
+    sdata.reserve(count);
+    ssize.reserve(count);
+
+    // Data blocks smaller than 8 bytes are left unscrambled.
+    for (size_t n = 0; n < count; ++n) {
+        assert(size[n] / 8 <= MAX_NBLOCKS);
+        if (size[n] >= 8) {
+            sdata.push_back(data[n]);
+            ssize.push_back(size[n]);
+        }
+    }
+    if (sdata.empty()) {
+        return;
+    }
+
+    // The first 8 bytes of scrambled data initialize the stream cipher.
+    // After the stream cipher, the data blocks contain the intermediate
+    // blocks of the block cipher. The residue, if any, is fully deciphered.
+    streamBatch(&sdata[0], &ssize[0], sdata.size());
+
+    // Decipher all blocks in place: plain[i] = decipher(ib[i]) ^ ib[i+1].
+    // Last block: ib[nblocks] = IV = 0. All blocks are independent, LANES
+    // blocks are deciphered at a time, in increasing order so that ib[i+1]
+    // is not yet overwritten when plain[i] is computed.
+    const size_t LANES = BlockCipher::LANES;
+    uint64_t values[LANES];
+    uint8_t* addr[LANES];  // address of the block in each lane
+    uint8_t* next[LANES];  // address of the next block in each lane, zero after last block
+    size_t n = 0;          // current data block
+    size_t i = 0;          // current block in data block
+
+    while (n < sdata.size()) {
+        size_t used = 0;
+        while (used < LANES && n < sdata.size()) {
+            const size_t nblocks = ssize[n] / 8;
+            addr[used] = sdata[n] + 8 * i;
+            values[used] = GetUInt64LE(addr[used]);
+            if (++i < nblocks) {
+                next[used] = sdata[n] + 8 * i;
+            }
+            else {
+                next[used] = 0;
+                i = 0;
+                n++;
+            }
+            used++;
+        }
+        for (size_t l = used; l < LANES; ++l) {
+            values[l] = 0;
+        }
+
+        _block.decipherLanes(values);
+
+        for (size_t l = 0; l < used; ++l) {
+            PutUInt64LE(addr[l], next[l] == 0 ? values[l] : values[l] ^ GetUInt64LE(next[l]));
+        }
+    }
+}
@@ -94,6 +94,33 @@ namespace ts {
         //!
         void decrypt(uint8_t* data, size_t size);
 
+        //!
+        //! Encrypt a batch of data blocks (typically the payloads of TS packets).
+        //! The result is identical to encrypt() on each data block. The stream cipher
+        //! is computed on many data blocks in parallel using a bitsliced implementation
+        //! (64 data blocks at a time, 128 with SSE2, 256 with AVX2).
+        //! @param [in] data Array of @a count addresses of buffers to encrypt in place.
+        //! @param [in] size Array of @a count buffer sizes.
+        //! @param [in] count Number of data blocks.
+        //!
+        void encryptBatch(uint8_t* const* data, const size_t* size, size_t count);
+
+        //!
+        //! Decrypt a batch of data blocks (typically the payloads of TS packets).
+        //! The result is identical to decrypt() on each data block.
+        //! @param [in] data Array of @a count addresses of buffers to decrypt in place.
+        //! @param [in] size Array of @a count buffer sizes.
+        //! @param [in] count Number of data blocks.
+        //! @see encryptBatch()
+        //!
+        void decryptBatch(uint8_t* const* data, const size_t* size, size_t count);
+
+        //!
+        //! Minimum number of data blocks in encryptBatch() or decryptBatch() to use the
+        //! bitsliced implementation. Smaller batches are processed one data block at a time.
+        //!
+        static const size_t MIN_BATCH_SIZE = 8;
+
         //!
         //! Manually perform the entropy reduction on a control word.
         //! Not needed with ts::Scrambling class, preferably use @link REDUCE_ENTROPY @endlink mode.
@@ -118,6 +145,13 @@ namespace ts {
             void init(const uint8_t *cw);
             void encipher(const uint8_t *bd, uint8_t *ib);
             void decipher(const uint8_t *ib, uint8_t *bd);
+
+            // Same as encipher() and decipher() on LANES independent blocks at a time.
+            // Interleaving the rounds of independent blocks hides the latency of each round.
+            // The blocks are stored as little-endian 64-bit values.
+            static const size_t LANES = 4;
+            void encipherLanes(uint64_t* blocks) const;
+            void decipherLanes(uint64_t* blocks) const;
         };
 
         // Stream cipher data
@@ -140,6 +174,11 @@ namespace ts {
             void cipher(const uint8_t* sb, uint8_t *cb);
         };
 
+        // Apply the stream cipher on a batch of data blocks, using the bitsliced implementation.
+        // The first 8 bytes of each data block initialize the stream cipher and are unmodified.
+        // The rest of each data block is xor'ed with the stream cipher output.
+        void streamBatch(uint8_t* const* data, const size_t* size, size_t count);
+
         // DVB-CSA scrambling data
         bool         _init;
         uint8_t      _key[KEY_SIZE];
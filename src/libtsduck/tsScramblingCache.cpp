@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsScramblingCache.h"
+#include "tsGuard.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::ScramblingCache::DEFAULT_CAPACITY;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::ScramblingCache::ScramblingCache(size_t capacity) :
+    _mutex(),
+    _capacity(std::max<size_t>(capacity, 1)),
+    _entries(),
+    _hits(0),
+    _misses(0)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Get a preprocessed control word.
+//----------------------------------------------------------------------------
+
+ts::ScramblingPtr ts::ScramblingCache::get(const uint8_t* cw, Scrambling::EntropyMode mode)
+{
+    Guard lock(_mutex);
+
+    // Look for the control word, move it at the front of the list when found.
+    for (EntryList::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+        if (it->mode == mode && ::memcmp(it->cw, cw, Scrambling::KEY_SIZE) == 0) {
+            _entries.splice(_entries.begin(), _entries, it);
+            _hits++;
+            return _entries.front().key;
+        }
+    }
+
+    // Not found, reuse the least recently used entry if the cache is full.
+    if (_entries.size() < _capacity) {
+        _entries.push_front(Entry());
+    }
+    else {
+        _entries.splice(_entries.begin(), _entries, --_entries.end());
+    }
+
+    // Always allocate a new Scrambling object, the previous one may be still in use.
+    Entry& entry(_entries.front());
+    ::memcpy(entry.cw, cw, Scrambling::KEY_SIZE);  // Flawfinder: ignore: memcpy()
+    entry.mode = mode;
+    entry.key = new Scrambling;
+    entry.key->init(cw, mode);
+    _misses++;
+    return entry.key;
+}
+
+
+//----------------------------------------------------------------------------
+// Clear the content of the cache.
+//----------------------------------------------------------------------------
+
+void ts::ScramblingCache::clear()
+{
+    Guard lock(_mutex);
+    _entries.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the number of control words in the cache.
+//----------------------------------------------------------------------------
+
+size_t ts::ScramblingCache::size() const
+{
+    Guard lock(_mutex);
+    return _entries.size();
+}
@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Cache of preprocessed DVB-CSA control words.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsScrambling.h"
+#include "tsSafePtr.h"
+#include "tsMutex.h"
+
+namespace ts {
+
+    //!
+    //! Safe pointer to a preprocessed DVB-CSA control word (thread-safe).
+    //!
+    typedef SafePtr<Scrambling, Mutex> ScramblingPtr;
+
+    //!
+    //! Cache of preprocessed DVB-CSA control words.
+    //!
+    //! Initializing a ts::Scrambling object computes the block cipher key schedule and the
+    //! stream cipher initial state. The cache keeps the most recently used Scrambling
+    //! objects, indexed by control word and entropy mode. An application can prepare the
+    //! next control word as soon as it is known, for instance in an ECM thread, and switch
+    //! to it at the crypto-period boundary by simply assigning a ts::ScramblingPtr.
+    //!
+    //! The cache is thread-safe. The returned Scrambling objects are shared: an object
+    //! which is evicted from the cache remains valid as long as the application uses it.
+    //! But the encrypt and decrypt operations on a given Scrambling object must be
+    //! performed by one thread at a time.
+    //!
+    class TSDUCKDLL ScramblingCache
+    {
+    public:
+        //!
+        //! Default number of control words in the cache.
+        //!
+        static const size_t DEFAULT_CAPACITY = 8;
+
+        //!
+        //! Constructor.
+        //! @param [in] capacity Maximum number of control words in the cache.
+        //!
+        ScramblingCache(size_t capacity = DEFAULT_CAPACITY);
+
+        //!
+        //! Get a preprocessed control word.
+        //! If the control word is not in the cache, it is preprocessed and added in the cache.
+        //! @param [in] cw Address of control word. Its size must be ts::Scrambling::KEY_SIZE.
+        //! @param [in] mode Entropy reduction mode.
+        //! @return A safe pointer to the preprocessed control word. Never null.
+        //!
+        ScramblingPtr get(const uint8_t* cw, Scrambling::EntropyMode mode);
+
+        //!
+        //! Preprocess a control word in advance, typically the one of the next crypto-period.
+        //! @param [in] cw Address of control word. Its size must be ts::Scrambling::KEY_SIZE.
+        //! @param [in] mode Entropy reduction mode.
+        //!
+        void prefetch(const uint8_t* cw, Scrambling::EntropyMode mode) {get(cw, mode);}
+
+        //!
+        //! Clear the content of the cache.
+        //!
+        void clear();
+
+        //!
+        //! Get the number of control words in the cache.
+        //! @return The number of control words in the cache.
+        //!
+        size_t size() const;
+
+        //!
+        //! Get the number of control words which were found in the cache.
+        //! @return The number of successful calls to get() or prefetch().
+        //!
+        uint64_t hits() const {return _hits;}
+
+        //!
+        //! Get the number of control words which were preprocessed.
+        //! @return The number of calls to get() or prefetch() which preprocessed a control word.
+        //!
+        uint64_t misses() const {return _misses;}
+
+    private:
+        // One entry in the cache.
+        struct Entry
+        {
+            uint8_t                 cw[Scrambling::KEY_SIZE];
+            Scrambling::EntropyMode mode;
+            ScramblingPtr           key;
+        };
+        typedef std::list<Entry> EntryList;
+
+        mutable Mutex _mutex;     // Exclusive access to the cache
+        size_t        _capacity;  // Maximum number of entries
+        EntryList     _entries;   // Most recently used first
+        uint64_t      _hits;      // Number of found entries
+        uint64_t      _misses;    // Number of computed entries
+
+        // Inaccessible operations
+        ScramblingCache(const ScramblingCache&) = delete;
+        ScramblingCache& operator=(const ScramblingCache&) = delete;
+    };
+}
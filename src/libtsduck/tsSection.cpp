@@ -175,6 +175,25 @@ ts::Section::Section(TID tid,
 }
 
 
+//----------------------------------------------------------------------------
+// Reload from full binary content.
+//----------------------------------------------------------------------------
+
+void ts::Section::reload(const void* content, size_t content_size, PID source_pid, CRC32::Validation crc_op)
+{
+    // Reuse the previous data block when nobody else references it.
+    ByteBlockPtr bbp;
+    if (!_data.isNull() && _data.count() == 1) {
+        bbp = _data;
+        bbp->copy(content, content_size);
+    }
+    else {
+        bbp = new ByteBlock(content, content_size);
+    }
+    initialize(bbp, source_pid, crc_op);
+}
+
+
 //----------------------------------------------------------------------------
 // Reload short section
 //----------------------------------------------------------------------------
@@ -34,6 +34,11 @@
 #include "tsSectionDemux.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::SectionDemux::DEFAULT_SECTION_POOL_SIZE;
+const size_t ts::SectionDemux::TS_BUFFER_SIZE;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Demux status information - Default constructor
@@ -45,7 +50,8 @@ ts::SectionDemux::Status::Status() :
     scrambled(0),
     inv_sect_length(0),
     inv_sect_index(0),
-    wrong_crc(0)
+    wrong_crc(0),
+    repeated(0)
 {
 }
 
@@ -61,7 +67,8 @@ ts::SectionDemux::Status::Status(const SectionDemux& demux) :
     scrambled(0),
     inv_sect_length(0),
     inv_sect_index(0),
-    wrong_crc(0)
+    wrong_crc(0),
+    repeated(0)
 {
     demux.getStatus(*this);
 }
@@ -79,6 +86,7 @@ void ts::SectionDemux::Status::reset()
     inv_sect_length = 0;
     inv_sect_index = 0;
     wrong_crc = 0;
+    repeated = 0;
 }
 
 
@@ -126,6 +134,9 @@ std::ostream& ts::SectionDemux::Status::display(std::ostream& strm, int indent,
     if (!errors_only || wrong_crc != 0) {
         strm << margin << "Corrupted sections (bad CRC): " << UString::Decimal(wrong_crc) << std::endl;
     }
+    if (!errors_only && repeated != 0) {
+        strm << margin << "Repeated sections (filtered): " << UString::Decimal(repeated) << std::endl;
+    }
 
     return strm;
 }
@@ -142,7 +153,10 @@ ts::SectionDemux::SectionDemux(TableHandlerInterface* table_handler,
     _table_handler(table_handler),
     _section_handler(section_handler),
     _pids(),
-    _status()
+    _status(),
+    _section_pool(),
+    _section_pool_max(DEFAULT_SECTION_POOL_SIZE),
+    _filter_repeated(false)
 {
 }
 
@@ -173,6 +187,57 @@ void ts::SectionDemux::immediateResetPID(PID pid)
 }
 
 
+//----------------------------------------------------------------------------
+// Pool of released sections.
+//----------------------------------------------------------------------------
+
+void ts::SectionDemux::setSectionPoolSize(size_t count)
+{
+    _section_pool_max = count;
+    if (_section_pool.size() > count) {
+        _section_pool.resize(count);
+    }
+}
+
+ts::SectionPtr ts::SectionDemux::newSection(const uint8_t* data, size_t size, PID pid)
+{
+    if (_section_pool.empty()) {
+        return new Section(data, size, pid, CRC32::CHECK);
+    }
+    else {
+        SectionPtr sect(_section_pool.back());
+        _section_pool.pop_back();
+        sect->reload(data, size, pid, CRC32::CHECK);
+        return sect;
+    }
+}
+
+void ts::SectionDemux::recycleSection(SectionPtr& sect)
+{
+    // Recycle only if the section object is referenced by nobody else.
+    if (!sect.isNull() && sect.count() == 1 && _section_pool.size() < _section_pool_max) {
+        _section_pool.push_back(sect);
+    }
+    sect.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a binary section is a repetition of a previous one, based on
+// the section size and CRC32.
+//----------------------------------------------------------------------------
+
+namespace {
+    inline bool IsRepeatedSection(const ts::SectionPtr& previous, const uint8_t* data, size_t size)
+    {
+        return !previous.isNull() &&
+            previous->size() == size &&
+            size >= ts::SECTION_CRC32_SIZE &&
+            ts::GetUInt32(previous->content() + size - ts::SECTION_CRC32_SIZE) == ts::GetUInt32(data + size - ts::SECTION_CRC32_SIZE);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Feed the depacketizer with a TS packet.
 //----------------------------------------------------------------------------
@@ -296,12 +361,26 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
 
     // Copy TS packet payload in PID context
 
-    pc.ts.append (payload, payload_size);
+    if (pc.ts_end + payload_size > pc.ts.size()) {
+        if (pc.ts.empty()) {
+            // First use of the buffer in this PID.
+            pc.ts.resize(TS_BUFFER_SIZE);
+        }
+        else {
+            // End of buffer reached, move the incomplete section back to the start.
+            ::memmove(pc.ts.data(), pc.ts.data() + pc.ts_begin, pc.ts_end - pc.ts_begin);  // Flawfinder: ignore: memmove()
+            pc.ts_end -= pc.ts_begin;
+            pc.ts_begin = 0;
+        }
+    }
+    assert(pc.ts_end + payload_size <= pc.ts.size());
+    ::memcpy(pc.ts.data() + pc.ts_end, payload, payload_size);  // Flawfinder: ignore: memcpy()
+    pc.ts_end += payload_size;
 
     // Locate TS buffer by address and size.
 
-    const uint8_t* ts_start = pc.ts.data();
-    size_t ts_size = pc.ts.size();
+    const uint8_t* ts_start = pc.ts.data() + pc.ts_begin;
+    size_t ts_size = pc.ts_end - pc.ts_begin;
 
     // If current packet has a PUSI, locate start of this new section
     // inside the TS buffer. This is not useful to locate the section but
@@ -400,11 +479,11 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
                 tc.version = version;
                 tc.sect_expected = size_t (last_section_number) + 1;
                 tc.sect_received = 0;
-                tc.sects.resize (tc.sect_expected);
                 // Mark all section entries as unused
-                for (size_t si = 0; si < tc.sect_expected; si++) {
-                    tc.sects[si].reset();
+                for (size_t si = 0; si < tc.sects.size(); si++) {
+                    recycleSection(tc.sects[si]);
                 }
+                tc.sects.resize (tc.sect_expected);
             }
 
             // Check that the total number of sections in the table
@@ -415,13 +494,21 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
                 section_ok = false;
             }
 
+            // When filtering repeated sections, ignore an exact repetition of the
+            // stored section (same version since the table was not reset).
+
+            if (section_ok && _filter_repeated && long_header && IsRepeatedSection(tc.sects[section_number], ts_start, section_length)) {
+                _status.repeated++;
+                section_ok = false;
+            }
+
             // Create a new Section object if necessary (ie. if a section
             // hendler is registered or if this is a new section).
 
             SectionPtr sect_ptr;
 
             if (section_ok && (_section_handler != 0 || tc.sects[section_number].isNull())) {
-                sect_ptr = new Section (ts_start, section_length, pid, CRC32::CHECK);
+                sect_ptr = newSection(ts_start, section_length, pid);
                 sect_ptr->setFirstTSPacketIndex (pusi_pkt_index);
                 sect_ptr->setLastTSPacketIndex (_packet_count);
                 if (!sect_ptr->isValid()) {
@@ -468,6 +555,9 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
             if (afterCallingHandler(true)) {
                 return;  // the PID of this packet or the complete demux was reset.
             }
+
+            // Recycle the section if it was only passed to the section handler.
+            recycleSection(sect_ptr);
         }
 
         // Move to next section in the buffer
@@ -486,15 +576,14 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         }
     }
 
-    // If an incomplete section remains in the buffer, move it back to
-    // the start of the buffer.
+    // Keep track of the incomplete section which remains in the buffer, if any.
 
     if (ts_size <= 0) {
         // TS buffer becomes empty
-        pc.ts.clear();
+        pc.ts_begin = pc.ts_end = 0;
     }
-    else if (ts_start > pc.ts.data()) {
-        // Remove start of TS buffer
-        pc.ts.erase(0, ts_start - pc.ts.data());
+    else {
+        // Keep the incomplete section in place, it will be moved only when the end of buffer is reached.
+        pc.ts_begin = ts_start - pc.ts.data();
     }
 }
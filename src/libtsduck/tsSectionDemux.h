@@ -35,6 +35,7 @@
 #pragma once
 #include "tsAbstractDemux.h"
 #include "tsETID.h"
+#include "tsPIDContextTable.h"
 #include "tsTableHandlerInterface.h"
 #include "tsSectionHandlerInterface.h"
 
@@ -90,6 +91,44 @@ namespace ts {
             _section_handler = h;
         }
 
+        //!
+        //! Default maximum number of released sections which are kept for reuse.
+        //!
+        static const size_t DEFAULT_SECTION_POOL_SIZE = 32;
+
+        //!
+        //! Set the maximum number of released sections which are kept for reuse.
+        //!
+        //! When the section handler does not keep the section it receives, the Section
+        //! object (including its data block and its safe pointer) is recycled for the
+        //! next section instead of being deallocated. This avoids dynamic memory allocation
+        //! for most sections on streams with a high rate of sections (EIT for instance).
+        //! A section is recycled only when it is no longer referenced outside the demux,
+        //! including as a shared copy of its binary content.
+        //!
+        //! @param [in] count Maximum number of sections in the pool. Zero disables
+        //! the recycling of sections.
+        //!
+        void setSectionPoolSize(size_t count);
+
+        //!
+        //! Filter out exact repetitions of long sections.
+        //!
+        //! On a stable multiplex, most PSI/SI sections are repetitions of the previous occurrence
+        //! of the same section. When this mode is enabled, a long section is ignored when a section
+        //! with the same PID, table id, table id extension, section number, version, size and CRC32
+        //! was previously received and is still part of the current version of the table.
+        //! Such a section is neither allocated, nor CRC-checked, nor passed to the section handler.
+        //! It is only counted in the demux status. The section header is still validated.
+        //! This mode is disabled by default.
+        //!
+        //! @param [in] on If true, filter out repeated sections.
+        //!
+        void setFilterRepeatedSections(bool on)
+        {
+            _filter_repeated = on;
+        }
+
         //!
         //! Demux status information.
         //! It contains error counters.
@@ -103,6 +142,7 @@ namespace ts {
             uint64_t inv_sect_length;  //!< Number of invalid section length.
             uint64_t inv_sect_index;   //!< Number of invalid section index.
             uint64_t wrong_crc;        //!< Number of sections with wrong CRC32.
+            uint64_t repeated;         //!< Number of repeated sections which were filtered out (not an error).
 
             //!
             //! Default constructor.
@@ -121,7 +161,8 @@ namespace ts {
             void reset();
 
             //!
-            //! Check if any counter is non zero.
+            //! Check if any error counter is non zero.
+            //! The number of repeated sections is not an error.
             //! @return True if any error counter is not zero.
             //!
             bool hasErrors() const;
@@ -181,13 +222,29 @@ namespace ts {
             }
         };
 
+        // Hash function for ETID, used as index of the TID analysis contexts.
+        struct ETIDHash
+        {
+            size_t operator()(const ETID& etid) const
+            {
+                return (size_t(etid.isLongSection()) << 24) | (size_t(etid.tid()) << 16) | size_t(etid.tidExt());
+            }
+        };
+
+        // Size of the reassembly buffer of a PID. The buffer must contain at least
+        // one incomplete section and the payload of one TS packet. When the end of
+        // the buffer is reached, the remaining data are moved back to the start.
+        static const size_t TS_BUFFER_SIZE = 4 * MAX_PRIVATE_SECTION_SIZE;
+
         // This internal structure contains the analysis context for one PID.
         struct PIDContext
         {
             uint8_t continuity;                // Last continuity counter
             bool sync;                         // We are synchronous in this PID
-            ByteBlock ts;                      // TS payload buffer
-            std::map <ETID, ETIDContext> tids; // TID analysis contexts
+            ByteBlock ts;                      // TS payload buffer, TS_BUFFER_SIZE bytes once allocated
+            size_t ts_begin;                   // Index in ts of first unprocessed byte
+            size_t ts_end;                     // Index in ts after last received byte
+            std::unordered_map<ETID, ETIDContext, ETIDHash> tids; // TID analysis contexts
             PacketCounter pusi_pkt_index;      // Index of last PUSI packet in this PID
 
             // Default constructor:
@@ -195,6 +252,8 @@ namespace ts {
                 continuity(0),
                 sync(false),
                 ts(),
+                ts_begin(0),
+                ts_end(0),
                 tids(),
                 pusi_pkt_index(0)
             {
@@ -204,15 +263,24 @@ namespace ts {
             void syncLost()
             {
                 sync = false;
-                ts.clear();
+                ts_begin = ts_end = 0;
             }
         };
 
+        // Get a section object, either from the pool or newly allocated.
+        SectionPtr newSection(const uint8_t* data, size_t size, PID pid);
+
+        // Release a section. It is returned to the pool when not referenced elsewhere.
+        void recycleSection(SectionPtr& sect);
+
         // Private members:
-        TableHandlerInterface*   _table_handler;
-        SectionHandlerInterface* _section_handler;
-        std::map<PID,PIDContext> _pids;
-        Status                   _status;
+        TableHandlerInterface*      _table_handler;
+        SectionHandlerInterface*    _section_handler;
+        PIDContextTable<PIDContext> _pids;
+        Status                      _status;
+        SectionPtrVector            _section_pool;      // Released sections, ready for reuse
+        size_t                      _section_pool_max;  // Maximum size of the pool
+        bool                        _filter_repeated;   // Filter out exact repetitions of long sections
 
         // Inacessible operations
         SectionDemux(const SectionDemux&) = delete;
@@ -78,7 +78,8 @@ ts::SysInfo::SysInfo() :
     _systemVersion(),
     _systemName(),
     _hostName(),
-    _memoryPageSize(0)
+    _memoryPageSize(0),
+    _cpuCount(1)
 {
     //
     // Get operating system name and version.
@@ -218,6 +219,7 @@ ts::SysInfo::SysInfo() :
     ::SYSTEM_INFO sysinfo;
     ::GetSystemInfo(&sysinfo);
     _memoryPageSize = size_t(sysinfo.dwPageSize);
+    _cpuCount = std::max<size_t>(1, size_t(sysinfo.dwNumberOfProcessors));
 
 #else
 
@@ -226,6 +228,10 @@ ts::SysInfo::SysInfo() :
     if (pageSize > 0) {
         _memoryPageSize = size_t(pageSize);
     }
+    const long cpuCount = ::sysconf(_SC_NPROCESSORS_CONF);
+    if (cpuCount > 0) {
+        _cpuCount = size_t(cpuCount);
+    }
 
 #endif
 }
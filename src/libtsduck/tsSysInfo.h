@@ -111,6 +111,12 @@ namespace ts {
         //! @return The system memory page size in bytes.
         //!
         size_t memoryPageSize() const { return _memoryPageSize; }
+        //!
+        //! Get the number of configured CPU's in the system.
+        //! CPU's are identified by an index from 0 to cpuCount() - 1.
+        //! @return The number of CPU's in the system.
+        //!
+        size_t cpuCount() const { return _cpuCount; }
 
     private:
         bool    _isLinux;
@@ -126,5 +132,6 @@ namespace ts {
         UString _systemName;
         UString _hostName;
         size_t  _memoryPageSize;
+        size_t  _cpuCount;
     };
 }
@@ -37,6 +37,7 @@
 #include "tsSectionDemux.h"
 #include "tsPMT.h"
 #include "tsT2MIHandlerInterface.h"
+#include "tsPIDContextTable.h"
 
 namespace ts {
     //!
@@ -122,7 +123,7 @@ namespace ts {
 
         // Map of safe pointers to PIDContext, indexed by PID.
         typedef SafePtr<PIDContext, NullMutex> PIDContextPtr;
-        typedef std::map<PID, PIDContextPtr> PIDContextMap;
+        typedef PIDContextTable<PIDContextPtr> PIDContextMap;
 
         // Inherited methods from TableHandlerInterface.
         virtual void handleTable(SectionDemux&, const BinaryTable&) override;
@@ -35,12 +35,63 @@
 #include "tsT2MIPacket.h"
 #include "tsNames.h"
 #include "tsAlgorithm.h"
+#include "tsThread.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::TSAnalyzer::MAX_WORKER_THREADS;
+const size_t ts::TSAnalyzer::BATCH_SIZE;
+const size_t ts::TSAnalyzer::BATCH_COUNT;
+#endif
+
 // Constant string "Unreferenced"
 const ts::UString ts::TSAnalyzer::UNREFERENCED(u"Unreferenced");
 
 
+//----------------------------------------------------------------------------
+// Parallel analysis: a thread which processes all batches of packets.
+// The thread #0 feeds the demuxes. Other threads accumulate the statistics
+// of a subset of the PID's in their own PID contexts.
+//----------------------------------------------------------------------------
+
+class ts::TSAnalyzer::AnalysisThread: public Thread
+{
+public:
+    // Constructor and destructor.
+    AnalysisThread(TSAnalyzer* analyzer, size_t index, size_t stat_threads);
+    virtual ~AnalysisThread() override;
+
+    // Reset the statistics context. Must be called when the thread is idle.
+    void reset();
+
+    Condition     _work;               // Signaled when a batch is published or on termination.
+    uint64_t      _next_batch;         // Next batch to process, under mutex.
+    PIDContextMap _pids;               // Statistics contexts of the PID's in this thread.
+    size_t        _scrambled_pid_cnt;  // Additional number of scrambled PID's since last merge.
+    size_t        _pcr_pid_cnt;        // Additional number of PID's with PCR's since last merge.
+    uint64_t      _ts_bitrate_sum;     // Additional sum of computed TS bitrates since last merge.
+    uint64_t      _ts_bitrate_cnt;     // Additional number of computed TS bitrates since last merge.
+
+private:
+    TSAnalyzer* _analyzer;
+    size_t      _index;
+    size_t      _stat_threads;
+
+    // Process one batch of packets.
+    void processBatch(const PacketBatch& batch);
+
+    // Inherited from Thread
+    virtual void main() override;
+
+    // Inaccessible operations.
+    AnalysisThread() = delete;
+    AnalysisThread(const AnalysisThread&) = delete;
+    AnalysisThread& operator=(const AnalysisThread&) = delete;
+};
+
+
 //----------------------------------------------------------------------------
 // Constructor for the TS analyzer
 //----------------------------------------------------------------------------
@@ -90,7 +141,15 @@ ts::TSAnalyzer::TSAnalyzer(BitRate bitrate_hint) :
     _max_consecutive_suspects(1),
     _demux(this, this),
     _pes_demux(this),
-    _t2mi_demux(this)
+    _t2mi_demux(this),
+    _demux_pkt_index(0),
+    _analyzed_pids(),
+    _threads(),
+    _batches(),
+    _batch_mutex(),
+    _batch_done(),
+    _batch_published(0),
+    _batch_terminate(false)
 {
     // Specify the PID filters to collect PSI tables.
     _demux.addPID(PID_PAT);
@@ -100,6 +159,9 @@ ts::TSAnalyzer::TSAnalyzer(BitRate bitrate_hint) :
     _demux.addPID(PID_RST);
     _demux.addPID(PID_SDT);  // also BAT
     _demux.addPID(PID_TDT);  // also TOT
+
+    // Only the PES headers and the audio/video attributes are needed.
+    _pes_demux.setStreamingMode(true);
 }
 
 
@@ -109,6 +171,7 @@ ts::TSAnalyzer::TSAnalyzer(BitRate bitrate_hint) :
 
 ts::TSAnalyzer::~TSAnalyzer()
 {
+    stopThreads();
     this->reset();
 }
 
@@ -119,6 +182,12 @@ ts::TSAnalyzer::~TSAnalyzer()
 
 void ts::TSAnalyzer::reset()
 {
+    // In a parallel analysis, wait for all pending packets and reset the threads contexts.
+    syncThreads();
+    for (size_t i = 1; i < _threads.size(); ++i) {
+        _threads[i]->reset();
+    }
+
     _modified = false;
     _ts_id = 0;
     _ts_id_valid = false;
@@ -159,6 +228,8 @@ void ts::TSAnalyzer::reset()
     _ts_bitrate_cnt = 0;
     _preceding_errors = 0;
     _preceding_suspects = 0;
+    _demux_pkt_index = 0;
+    _analyzed_pids.reset();
     _demux.reset();
     _pes_demux.reset();
 
@@ -504,13 +575,13 @@ void ts::TSAnalyzer::handleSection(SectionDemux&, const Section& section)
     if (section.sectionNumber() == 0) {
         if (etc->table_count++ == 0) {
             // First occurence of table
-            etc->first_pkt = _ts_pkt_cnt;
+            etc->first_pkt = _demux_pkt_index;
             if (section.isLongSection()) {
                 etc->first_version = version;
             }
         }
         else {
-            const uint64_t rep = _ts_pkt_cnt - etc->last_pkt;
+            const uint64_t rep = _demux_pkt_index - etc->last_pkt;
             if (etc->table_count == 2) {
                 // First time we are able to compute an interval
                 etc->repetition_ts = etc->min_repetition_ts = etc->max_repetition_ts = rep;
@@ -523,10 +594,10 @@ void ts::TSAnalyzer::handleSection(SectionDemux&, const Section& section)
                     etc->max_repetition_ts = rep;
                 }
                 assert(etc->table_count > 2);
-                etc->repetition_ts = (_ts_pkt_cnt - etc->first_pkt + (etc->table_count - 1) / 2) / (etc->table_count - 1);
+                etc->repetition_ts = (_demux_pkt_index - etc->first_pkt + (etc->table_count - 1) / 2) / (etc->table_count - 1);
             }
         }
-        etc->last_pkt = _ts_pkt_cnt;
+        etc->last_pkt = _demux_pkt_index;
         if (section.isLongSection()) {
             etc->versions.set(version);
             etc->last_version = version;
@@ -792,12 +863,13 @@ void ts::TSAnalyzer::analyzeDescriptors(const DescriptorList& descs, ServiceCont
 {
     for (size_t di = 0; di < descs.count(); ++di) {
 
-        const uint8_t* data(descs[di]->payload());
-        size_t size(descs[di]->payloadSize());
+        // Use the binary descriptors from the list, without building Descriptor objects.
+        const uint8_t* data(descs.payload(di));
+        size_t size(descs.payloadSize(di));
 
-        switch (descs[di]->tag()) {
+        switch (descs.tag(di)) {
             case DID_CA: {
-                analyzeCADescriptor(*descs[di], svp, ps);
+                analyzeCADescriptor(data, size, svp, ps);
                 break;
             }
             case DID_LANGUAGE: {
@@ -938,17 +1010,14 @@ void ts::TSAnalyzer::analyzeDescriptors(const DescriptorList& descs, ServiceCont
 
 
 //----------------------------------------------------------------------------
-//  Analyse one CA descriptor, either from the CAT or a PMT.
+//  Analyse the payload of one CA descriptor, either from the CAT or a PMT.
 //  If svp is not 0, we are in the PMT of the specified service.
 //  If ps is not 0, we are in the description of this PID in a PMT.
 //  If svp is 0, we are in the CAT.
 //----------------------------------------------------------------------------
 
-void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext* svp, PIDContext* ps)
+void ts::TSAnalyzer::analyzeCADescriptor(const uint8_t* data, size_t size, ServiceContext* svp, PIDContext* ps)
 {
-    const uint8_t* data(desc.payload());
-    size_t size(desc.payloadSize());
-
     // Analyze the common part
     if (size < 4) {
         return;
@@ -1225,8 +1294,6 @@ void ts::TSAnalyzer::handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, co
 
 void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
 {
-    bool broken_rate(false);
-
     // Store system times of first packet
     if (_first_utc == Time::Epoch) {
         _first_utc = Time::CurrentUTC();
@@ -1256,127 +1323,174 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
         return;
     }
 
-    // Detect and ignore suspect packets
-    if (_min_error_before_suspect > 0 && _max_consecutive_suspects > 0 && !pidExists(pkt.getPID())) {
-        // Suspect packet detection enabled and potential suspect packet
-        if (_preceding_errors >= _min_error_before_suspect || (_preceding_suspects > 0 && _preceding_suspects < _max_consecutive_suspects)) {
-            _suspect_ignored++;
-            _preceding_suspects++;
-            _preceding_errors = 0;
-            return;
-        }
+    // Detect and ignore suspect packets.
+    // The existence of the PID is checked last since it requires a synchronization in a parallel analysis.
+    if (_min_error_before_suspect > 0 && _max_consecutive_suspects > 0 &&
+        (_preceding_errors >= _min_error_before_suspect || (_preceding_suspects > 0 && _preceding_suspects < _max_consecutive_suspects)) &&
+        !pidExists(pkt.getPID()))
+    {
+        // Suspect packet detection enabled and suspect packet
+        _suspect_ignored++;
+        _preceding_suspects++;
+        _preceding_errors = 0;
+        return;
     }
 
     // Packet is not suspect, reset suspect detection
     _preceding_errors = 0;
     _preceding_suspects = 0;
+    _analyzed_pids.set(pkt.getPID());
+
+    if (_threads.empty()) {
+        // Sequential analysis: demux and accumulate statistics in this thread.
+        const PIDContextPtr ps(demuxPacket(pkt, packet_index));
+        AnalyzePacket(*ps, pkt, packet_index, _scrambled_pid_cnt, _pcr_pid_cnt, _ts_bitrate_sum, _ts_bitrate_cnt);
+    }
+    else {
+        // Parallel analysis: add the packet in the current batch.
+        PacketBatch& batch(_batches[_batch_published % BATCH_COUNT]);
+        batch.packets[batch.count] = pkt;
+        batch.indexes[batch.count] = packet_index;
+        if (++batch.count >= BATCH_SIZE) {
+            publishBatch();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Feed the demuxes with a TS packet and return the PID context.
+//----------------------------------------------------------------------------
+
+ts::TSAnalyzer::PIDContextPtr ts::TSAnalyzer::demuxPacket(const TSPacket& pkt, uint64_t packet_index)
+{
+    // Packet index, as seen by the table handlers.
+    _demux_pkt_index = packet_index;
 
     // Feed packets into the various demux
     _demux.feedPacket(pkt);
     _pes_demux.feedPacket(pkt);
     _t2mi_demux.feedPacket(pkt);
 
-    // Get PID context
-    PIDContextPtr ps(getPID(pkt.getPID()));
-    ps->ts_pkt_cnt++;
+    // Get PID context, after the handlers which may have created it with a specific description.
+    return getPID(pkt.getPID());
+}
+
+
+//----------------------------------------------------------------------------
+// Accumulate the per-PID statistics of a TS packet.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::AnalyzePacket(PIDContext& ps,
+                                   const TSPacket& pkt,
+                                   uint64_t packet_index,
+                                   size_t& scrambled_pid_cnt,
+                                   size_t& pcr_pid_cnt,
+                                   uint64_t& ts_bitrate_sum,
+                                   uint64_t& ts_bitrate_cnt)
+{
+    bool broken_rate(false);
+
+    // Count packets in the PID
+    ps.ts_pkt_cnt++;
 
     // Accumulate stat from packet
     if (pkt.hasAF()) {
-        ps->ts_af_cnt++;
+        ps.ts_af_cnt++;
     }
     if (pkt.getPUSI()) {
-        ps->unit_start_cnt++;
+        ps.unit_start_cnt++;
     }
     if (pkt.getPUSI() && pkt.hasPayload()) {
-        ps->pl_start_cnt++;
+        ps.pl_start_cnt++;
     }
 
     // Process scrambling information
-    if (pkt.getScrambling() != SC_CLEAR && !ps->scrambled) {
-        ps->scrambled = true;
-        _scrambled_pid_cnt++;
+    if (pkt.getScrambling() != SC_CLEAR && !ps.scrambled) {
+        ps.scrambled = true;
+        scrambled_pid_cnt++;
     }
     if (pkt.getScrambling() == SC_DVB_RESERVED) {
-        ps->inv_ts_sc_cnt++;
+        ps.inv_ts_sc_cnt++;
     }
     else if (pkt.getScrambling() != SC_CLEAR) {
-        ps->ts_sc_cnt++;
+        ps.ts_sc_cnt++;
     }
-    if (pkt.getScrambling() != ps->cur_ts_sc) {
+    if (pkt.getScrambling() != ps.cur_ts_sc) {
         // Change of crypto-period
-        if (ps->cur_ts_sc != SC_CLEAR) {
+        if (ps.cur_ts_sc != SC_CLEAR) {
             // End of a crypto-period, not a clear/scramble transition.
             // Count number of crypto-periods:
-            ps->cryptop_cnt++;
+            ps.cryptop_cnt++;
             // Count number of TS packets in all crypto-periods.
             // Ignore first crypto-period since it is truncated and
             // not significant for evaluation of duration.
-            if (ps->cryptop_cnt > 1) {
-                ps->cryptop_ts_cnt += packet_index - ps->cur_ts_sc_pkt;
+            if (ps.cryptop_cnt > 1) {
+                ps.cryptop_ts_cnt += packet_index - ps.cur_ts_sc_pkt;
             }
         }
-        ps->cur_ts_sc = pkt.getScrambling();
-        ps->cur_ts_sc_pkt = packet_index;
+        ps.cur_ts_sc = pkt.getScrambling();
+        ps.cur_ts_sc_pkt = packet_index;
     }
 
     // Process discontinuities.
     // The continuity counter of null packets is undefined.
-    if (ps->pid != PID_NULL) {
-        if (ps->ts_pkt_cnt == 1) {
+    if (ps.pid != PID_NULL) {
+        if (ps.ts_pkt_cnt == 1) {
             // First packet, initialize continuity
-            ps->cur_continuity = pkt.getCC();
+            ps.cur_continuity = pkt.getCC();
         }
         else if (pkt.getDiscontinuityIndicator()) {
             // Expected discontinuity
-            ps->exp_discont++;
+            ps.exp_discont++;
             broken_rate = true;
         }
         else if (pkt.hasPayload()) {
             // Packet has payload.
-            if (pkt.getCC() == ps->cur_continuity) {
+            if (pkt.getCC() == ps.cur_continuity) {
                 // Same counter means duplicated packet.
-                ps->duplicated++;
+                ps.duplicated++;
             }
-            else if (pkt.getCC() != (ps->cur_continuity + 1) % CC_MAX) {
+            else if (pkt.getCC() != (ps.cur_continuity + 1) % CC_MAX) {
                 // Counter not following previous -> discountinuity
-                ps->unexp_discont++;
+                ps.unexp_discont++;
                 broken_rate = true;
             }
         }
-        else if (pkt.getCC() != ps->cur_continuity) {
+        else if (pkt.getCC() != ps.cur_continuity) {
             // Packet has no payload -> should have same counter
-            ps->unexp_discont++;
+            ps.unexp_discont++;
             broken_rate = true;
         }
-        ps->cur_continuity = pkt.getCC();
+        ps.cur_continuity = pkt.getCC();
     }
 
     // Process PCR
     if (broken_rate) {
         // Suspected packet loss, forget last PCR.
-        ps->last_pcr = 0;
+        ps.last_pcr = 0;
     }
     if (pkt.hasPCR()) {
         uint64_t pcr(pkt.getPCR());
         // Count PID's with PCR
-        if (ps->pcr_cnt++ == 0)
-            _pcr_pid_cnt++;
+        if (ps.pcr_cnt++ == 0)
+            pcr_pid_cnt++;
         // If last PCR valid, compute transport rate between the two
-        if (ps->last_pcr != 0 && ps->last_pcr < pcr) {
+        if (ps.last_pcr != 0 && ps.last_pcr < pcr) {
             // Compute transport rate in b/s since last PCR
             uint64_t ts_bitrate =
-                (uint64_t(packet_index - ps->last_pcr_pkt) * SYSTEM_CLOCK_FREQ * PKT_SIZE * 8) /
-                (pcr - ps->last_pcr);
+                (uint64_t(packet_index - ps.last_pcr_pkt) * SYSTEM_CLOCK_FREQ * PKT_SIZE * 8) /
+                (pcr - ps.last_pcr);
             // Per-PID statistics:
-            ps->ts_bitrate_sum += ts_bitrate;
-            ps->ts_bitrate_cnt++;
+            ps.ts_bitrate_sum += ts_bitrate;
+            ps.ts_bitrate_cnt++;
             // Transport stream statistics:
-            _ts_bitrate_sum += ts_bitrate;
-            _ts_bitrate_cnt++;
+            ts_bitrate_sum += ts_bitrate;
+            ts_bitrate_cnt++;
         }
         // Save PCR for next calculation
-        ps->last_pcr = pcr;
-        ps->last_pcr_pkt = packet_index;
+        ps.last_pcr = pcr;
+        ps.last_pcr_pkt = packet_index;
     }
 
     // Check PES start code: PES packet headers start with the constant
@@ -1400,9 +1514,9 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
             // PID carries sections (we may not yet know this, so count
             // all these errors now and ignore them later if we know
             // that the PID does not carry PES packets).
-            ps->inv_pes_start++;
+            ps.inv_pes_start++;
         }
-        else if (header_size <= PKT_SIZE - 4 && ps->pid != 0) {
+        else if (header_size <= PKT_SIZE - 4 && ps.pid != 0) {
             // Here, the start of the packet payload is 00 00 01.
             // The only case where this can happen on a section is a PAT
             // (first 00 = "pointer field", second 00 = table_id = PAT).
@@ -1411,19 +1525,319 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
             // As a consequence, we are pretty sure to have a PES packet.
             // Remember the stream_id of the PES packets on this PID
             // (the PES stream_id is next byte after PES start code).
-            if (ps->pes_stream_id == 0) {
+            if (ps.pes_stream_id == 0) {
                 // First PES stream_id found on this PID
-                ps->pes_stream_id = pkt.b [header_size + 3];
-                ps->same_stream_id = true;
+                ps.pes_stream_id = pkt.b [header_size + 3];
+                ps.same_stream_id = true;
             }
-            else if (ps->pes_stream_id != pkt.b [header_size + 3]) {
+            else if (ps.pes_stream_id != pkt.b [header_size + 3]) {
                 // Got different values of stream_id in PES packets
-                ps->same_stream_id = false;
+                ps.same_stream_id = false;
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Copy the statistics fields of a PID context, as updated by AnalyzePacket().
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::CopyPacketStatistics(PIDContext& dest, const PIDContext& src)
+{
+    dest.scrambled = src.scrambled;
+    dest.same_stream_id = src.same_stream_id;
+    dest.pes_stream_id = src.pes_stream_id;
+    dest.ts_pkt_cnt = src.ts_pkt_cnt;
+    dest.ts_af_cnt = src.ts_af_cnt;
+    dest.unit_start_cnt = src.unit_start_cnt;
+    dest.pl_start_cnt = src.pl_start_cnt;
+    dest.unexp_discont = src.unexp_discont;
+    dest.exp_discont = src.exp_discont;
+    dest.duplicated = src.duplicated;
+    dest.ts_sc_cnt = src.ts_sc_cnt;
+    dest.inv_ts_sc_cnt = src.inv_ts_sc_cnt;
+    dest.inv_pes_start = src.inv_pes_start;
+    dest.pcr_cnt = src.pcr_cnt;
+    dest.cur_continuity = src.cur_continuity;
+    dest.cur_ts_sc = src.cur_ts_sc;
+    dest.cur_ts_sc_pkt = src.cur_ts_sc_pkt;
+    dest.cryptop_cnt = src.cryptop_cnt;
+    dest.cryptop_ts_cnt = src.cryptop_ts_cnt;
+    dest.last_pcr = src.last_pcr;
+    dest.last_pcr_pkt = src.last_pcr_pkt;
+    dest.ts_bitrate_sum = src.ts_bitrate_sum;
+    dest.ts_bitrate_cnt = src.ts_bitrate_cnt;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a PID context exists.
+//----------------------------------------------------------------------------
+
+bool ts::TSAnalyzer::pidExists(PID pid)
+{
+    if (_analyzed_pids.test(pid)) {
+        // At least one packet was analyzed in this PID.
+        return true;
+    }
+    else {
+        // The PID context may have been created by a table. In a parallel analysis,
+        // the PID contexts are created by the demux thread, wait for it.
+        syncThreads();
+        return _pids.find(pid) != _pids.end();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel analysis: analysis thread implementation.
+//----------------------------------------------------------------------------
+
+ts::TSAnalyzer::AnalysisThread::AnalysisThread(TSAnalyzer* analyzer, size_t index, size_t stat_threads) :
+    Thread(),
+    _work(),
+    _next_batch(0),
+    _pids(),
+    _scrambled_pid_cnt(0),
+    _pcr_pid_cnt(0),
+    _ts_bitrate_sum(0),
+    _ts_bitrate_cnt(0),
+    _analyzer(analyzer),
+    _index(index),
+    _stat_threads(stat_threads)
+{
+}
+
+ts::TSAnalyzer::AnalysisThread::~AnalysisThread()
+{
+    waitForTermination();
+}
+
+void ts::TSAnalyzer::AnalysisThread::reset()
+{
+    _pids.clear();
+    _scrambled_pid_cnt = 0;
+    _pcr_pid_cnt = 0;
+    _ts_bitrate_sum = 0;
+    _ts_bitrate_cnt = 0;
+}
+
+void ts::TSAnalyzer::AnalysisThread::main()
+{
+    for (;;) {
+        PacketBatch* batch = 0;
+
+        // Wait for the next batch of packets.
+        {
+            GuardCondition lock(_analyzer->_batch_mutex, _work);
+            while (_next_batch == _analyzer->_batch_published && !_analyzer->_batch_terminate) {
+                lock.waitCondition();
+            }
+            if (_next_batch == _analyzer->_batch_published) {
+                // Termination requested and all batches processed.
+                break;
+            }
+            batch = &_analyzer->_batches[_next_batch % BATCH_COUNT];
+        }
+
+        processBatch(*batch);
+
+        // Release the batch, the last thread notifies the application thread.
+        {
+            GuardCondition lock(_analyzer->_batch_mutex, _analyzer->_batch_done);
+            _next_batch++;
+            assert(batch->pending > 0);
+            if (--batch->pending == 0) {
+                lock.signal();
             }
         }
     }
 }
 
+void ts::TSAnalyzer::AnalysisThread::processBatch(const PacketBatch& batch)
+{
+    if (_index == 0) {
+        // The demux thread processes all packets.
+        for (size_t i = 0; i < batch.count; ++i) {
+            _analyzer->demuxPacket(batch.packets[i], batch.indexes[i]);
+        }
+    }
+    else {
+        // A statistics thread processes the PID's of its own shard.
+        const size_t shard = _index - 1;
+        for (size_t i = 0; i < batch.count; ++i) {
+            const PID pid = batch.packets[i].getPID();
+            if (pid % _stat_threads == shard) {
+                PIDContextPtr& ps(_pids[pid]);
+                if (ps.isNull()) {
+                    ps = new PIDContext(pid);
+                }
+                AnalyzePacket(*ps, batch.packets[i], batch.indexes[i], _scrambled_pid_cnt, _pcr_pid_cnt, _ts_bitrate_sum, _ts_bitrate_cnt);
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel analysis: batch constructor.
+//----------------------------------------------------------------------------
+
+ts::TSAnalyzer::PacketBatch::PacketBatch() :
+    packets(BATCH_SIZE),
+    indexes(BATCH_SIZE, 0),
+    count(0),
+    pending(0)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel analysis: set the number of statistics threads.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::setWorkerThreads(size_t count)
+{
+    count = std::min(count, MAX_WORKER_THREADS);
+    if (count != workerThreads()) {
+        stopThreads();
+        if (count > 0) {
+            startThreads(count);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel analysis: start the analysis threads.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::startThreads(size_t count)
+{
+    assert(_threads.empty());
+
+    _batches.resize(BATCH_COUNT);
+    for (size_t i = 0; i < _batches.size(); ++i) {
+        _batches[i].count = 0;
+        _batches[i].pending = 0;
+    }
+    _batch_published = 0;
+    _batch_terminate = false;
+
+    // Thread #0 is the demux thread, followed by the statistics threads.
+    for (size_t i = 0; i <= count; ++i) {
+        _threads.push_back(new AnalysisThread(this, i, count));
+    }
+
+    // Initialize the statistics contexts of the threads with the current state of the analysis.
+    for (PIDContextMap::const_iterator it = _pids.begin(); it != _pids.end(); ++it) {
+        const PIDContextPtr ps(new PIDContext(it->first));
+        CopyPacketStatistics(*ps, *it->second);
+        _threads[1 + it->first % count]->_pids[it->first] = ps;
+    }
+
+    for (size_t i = 0; i < _threads.size(); ++i) {
+        _threads[i]->start();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel analysis: terminate the analysis threads, keeping all results.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::stopThreads()
+{
+    if (!_threads.empty()) {
+        syncThreads();
+        mergeThreads();
+        {
+            Guard lock(_batch_mutex);
+            _batch_terminate = true;
+            for (size_t i = 0; i < _threads.size(); ++i) {
+                _threads[i]->_work.signal();
+            }
+        }
+        // The destructor of the threads waits for their termination.
+        for (size_t i = 0; i < _threads.size(); ++i) {
+            delete _threads[i];
+        }
+        _threads.clear();
+        _batches.clear();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel analysis: publish the current batch of packets to the threads.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::publishBatch()
+{
+    GuardCondition lock(_batch_mutex, _batch_done);
+
+    // Publish the current batch to all threads.
+    _batches[_batch_published % BATCH_COUNT].pending = _threads.size();
+    _batch_published++;
+    for (size_t i = 0; i < _threads.size(); ++i) {
+        _threads[i]->_work.signal();
+    }
+
+    // Wait for the next batch to be released by all threads.
+    PacketBatch& next(_batches[_batch_published % BATCH_COUNT]);
+    while (next.pending > 0) {
+        lock.waitCondition();
+    }
+    next.count = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel analysis: wait until all packets are processed by the threads.
+// On return, all threads are idle and their data can be accessed.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::syncThreads()
+{
+    if (!_threads.empty()) {
+        // Publish the partially filled batch.
+        if (_batches[_batch_published % BATCH_COUNT].count > 0) {
+            publishBatch();
+        }
+        // The batches are processed in order, wait for the last one.
+        GuardCondition lock(_batch_mutex, _batch_done);
+        const PacketBatch& last(_batches[(_batch_published + BATCH_COUNT - 1) % BATCH_COUNT]);
+        while (_batch_published > 0 && last.pending > 0) {
+            lock.waitCondition();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel analysis: merge the statistics of the threads into the analysis.
+// The threads must be idle (see syncThreads()).
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::mergeThreads()
+{
+    for (size_t i = 1; i < _threads.size(); ++i) {
+        AnalysisThread* thread = _threads[i];
+        for (PIDContextMap::const_iterator it = thread->_pids.begin(); it != thread->_pids.end(); ++it) {
+            CopyPacketStatistics(*getPID(it->first), *it->second);
+        }
+        _scrambled_pid_cnt += thread->_scrambled_pid_cnt;
+        _pcr_pid_cnt += thread->_pcr_pid_cnt;
+        _ts_bitrate_sum += thread->_ts_bitrate_sum;
+        _ts_bitrate_cnt += thread->_ts_bitrate_cnt;
+        thread->_scrambled_pid_cnt = 0;
+        thread->_pcr_pid_cnt = 0;
+        thread->_ts_bitrate_sum = 0;
+        thread->_ts_bitrate_cnt = 0;
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Specify a "bitrate hint" for the analysis. It is the user-specified
@@ -1444,6 +1858,10 @@ void ts::TSAnalyzer::setBitrateHint(BitRate bitrate)
 
 void ts::TSAnalyzer::recomputeStatistics()
 {
+    // In a parallel analysis, wait for all pending packets and collect the statistics of the threads.
+    syncThreads();
+    mergeThreads();
+
     // Don't do anything if not necessary
     if (!_modified) {
         return;
@@ -47,6 +47,9 @@
 #include "tsTime.h"
 #include "tsUString.h"
 #include "tsSafePtr.h"
+#include "tsPIDContextTable.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
 
 namespace ts {
     //!
@@ -117,6 +120,41 @@ namespace ts {
             _max_consecutive_suspects = count;
         }
 
+        //!
+        //! Set the number of statistics threads for a parallel analysis.
+        //!
+        //! By default, the complete analysis is performed in the thread which calls
+        //! feedPacket(). When a non-zero number of threads is specified, the analysis
+        //! is split over internal threads. The calling thread only checks the validity
+        //! of the packets and dispatches them by batches. One internal thread demuxes
+        //! the PSI/SI, PES and T2-MI data and @a count internal threads compute the
+        //! per-PID statistics (packet counters, continuity, scrambling, PCR-based
+        //! bitrates), each of them handling a subset of the PID's.
+        //!
+        //! The partial results are merged each time the global statistics are
+        //! recomputed, typically before a report. The results are identical
+        //! to a sequential analysis.
+        //!
+        //! This method can be called at any time, the current analysis context is preserved.
+        //! @param [in] count Number of statistics threads. Zero means sequential analysis.
+        //! The value is silently limited to MAX_WORKER_THREADS.
+        //!
+        void setWorkerThreads(size_t count);
+
+        //!
+        //! Get the number of statistics threads for a parallel analysis.
+        //! @return The number of statistics threads, zero in the case of a sequential analysis.
+        //!
+        size_t workerThreads() const
+        {
+            return _threads.empty() ? 0 : _threads.size() - 1;
+        }
+
+        //!
+        //! Maximum number of statistics threads for a parallel analysis.
+        //!
+        static const size_t MAX_WORKER_THREADS = 32;
+
         //!
         //! Get the list of service ids.
         //! @param [out] list The returned list of service ids.
@@ -375,8 +413,9 @@ namespace ts {
 
         //!
         //! Map of PIDContext, indexed by PID.
+        //! This is a dense table since the context of the PID is searched for each packet.
         //!
-        typedef std::map <PID, PIDContextPtr> PIDContextMap;
+        typedef PIDContextTable<PIDContextPtr> PIDContextMap;
 
     protected:
 
@@ -433,7 +472,7 @@ namespace ts {
         static const UString UNREFERENCED;
 
         // Check if a PID context exists.
-        bool pidExists(PID pid) const {return _pids.find(pid) != _pids.end();}
+        bool pidExists(PID pid);
 
         // Return a PID context. Allocate a new entry if PID not found.
         PIDContextPtr getPID(PID pid, const UString& description = UNREFERENCED);
@@ -457,11 +496,27 @@ namespace ts {
         // If ps is not 0, we are in the description of this PID in a PMT.
         void analyzeDescriptors(const DescriptorList& descs, ServiceContext* svp = 0, PIDContext* ps = 0);
 
-        // Analyse one CA descriptor, either from the CAT or a PMT.
+        // Analyse the payload of one CA descriptor, either from the CAT or a PMT.
         // If svp is not 0, we are in the PMT of the specified service.
         // If ps is not 0, we are in the description of this PID in a PMT.
         // If svp is 0, we are in the CAT.
-        void analyzeCADescriptor(const Descriptor& desc, ServiceContext* svp = 0, PIDContext* ps = 0);
+        void analyzeCADescriptor(const uint8_t* data, size_t size, ServiceContext* svp = 0, PIDContext* ps = 0);
+
+        // Feed the demuxes with a TS packet and return the PID context.
+        PIDContextPtr demuxPacket(const TSPacket& pkt, uint64_t packet_index);
+
+        // Accumulate the per-PID statistics of a TS packet. Only the statistics fields
+        // of the PID context are used. The other parameters are global counters.
+        static void AnalyzePacket(PIDContext& ps,
+                                  const TSPacket& pkt,
+                                  uint64_t packet_index,
+                                  size_t& scrambled_pid_cnt,
+                                  size_t& pcr_pid_cnt,
+                                  uint64_t& ts_bitrate_sum,
+                                  uint64_t& ts_bitrate_cnt);
+
+        // Copy the statistics fields of a PID context, as updated by AnalyzePacket().
+        static void CopyPacketStatistics(PIDContext& dest, const PIDContext& src);
 
         // Implementation of TableHandlerInterface
         virtual void handleTable(SectionDemux&, const BinaryTable&) override;
@@ -491,5 +546,44 @@ namespace ts {
         SectionDemux _demux;                     // PSI tables analysis
         PESDemux     _pes_demux;                 // Audio/video analysis
         T2MIDemux    _t2mi_demux;                // T2-MI analysis
+        uint64_t     _demux_pkt_index;           // Index of the packet which is currently demuxed
+        PIDSet       _analyzed_pids;             // PID's of all packets which were passed to the analysis
+
+        // Parallel analysis, see setWorkerThreads().
+        // The packets are copied in a circular set of batches. Each batch is processed
+        // in sequence by all analysis threads and released when all threads are done.
+        class AnalysisThread;
+
+        // A batch of packets, shared by all analysis threads.
+        class PacketBatch
+        {
+        public:
+            TSPacketVector        packets;  // TS packets, up to count.
+            std::vector<uint64_t> indexes;  // Index of each packet in the transport stream.
+            size_t                count;    // Number of packets in the batch.
+            size_t                pending;  // Number of threads which have not yet processed the batch, under mutex.
+            PacketBatch();
+        };
+
+        static const size_t BATCH_SIZE = 1024;  // Number of packets per batch.
+        static const size_t BATCH_COUNT = 8;    // Number of batches in the circular set.
+
+        std::vector<AnalysisThread*> _threads;          // Thread 0 is the demux thread, others compute statistics.
+        std::vector<PacketBatch>     _batches;          // Circular set of batches.
+        Mutex                        _batch_mutex;      // Protect the batch synchronization.
+        Condition                    _batch_done;       // Signaled when a batch is processed by all threads.
+        uint64_t                     _batch_published;  // Number of batches published to the threads, under mutex.
+        bool                         _batch_terminate;  // Request the threads to terminate, under mutex.
+
+        // Parallel analysis methods.
+        void startThreads(size_t count);
+        void stopThreads();
+        void publishBatch();
+        void syncThreads();
+        void mergeThreads();
+
+        // Inaccessible operations.
+        TSAnalyzer(const TSAnalyzer&) = delete;
+        TSAnalyzer& operator=(const TSAnalyzer&) = delete;
     };
 }
@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsTSAnalyzerOptions.h"
+#include "tsTSAnalyzer.h"
 #include "tsException.h"
 TSDUCK_SOURCE;
 
@@ -70,6 +71,13 @@ void ts::TSAnalyzerOptions::setHelp(const UString& help)
         u"      --suspect-max-consecutive. The default value is 1. If set to zero,\n"
         u"      the suspect packet detection is disabled.\n"
         u"\n"
+        u"  --threads value\n"
+        u"      Specifies the number of threads which compute the per-PID statistics\n"
+        u"      in parallel. An additional thread demuxes the PSI/SI and PES data.\n"
+        u"      The results are identical to a sequential analysis but the analysis\n"
+        u"      of large files is faster on multi-core systems. The default is zero,\n"
+        u"      meaning that the analysis is performed in one single thread.\n"
+        u"\n"
         u"Controlling output:\n"
         u"\n"
         u"  The output can include full synthetic analysis (options *-analysis),\n"
@@ -159,7 +167,8 @@ ts::TSAnalyzerOptions::TSAnalyzerOptions(const UString& description, const UStri
     prefix(),
     title(),
     suspect_min_error_count(1),
-    suspect_max_consecutive(1)
+    suspect_max_consecutive(1),
+    threads(0)
 {
     setHelp(help);
 
@@ -179,6 +188,7 @@ ts::TSAnalyzerOptions::TSAnalyzerOptions(const UString& description, const UStri
     option(u"title", 0, STRING);
     option(u"suspect-min-error-count", 0, UNSIGNED);
     option(u"suspect-max-consecutive", 0, UNSIGNED);
+    option(u"threads", 0, INTEGER, 0, 1, 0, TSAnalyzer::MAX_WORKER_THREADS);
 }
 
 
@@ -206,6 +216,7 @@ void ts::TSAnalyzerOptions::getOptions (const Args& args)
     title = args.value(u"title");
     suspect_min_error_count = args.intValue<uint64_t>(u"suspect-min-error-count", 1);
     suspect_max_consecutive = args.intValue<uint64_t>(u"suspect-max-consecutive", 1);
+    threads = args.intValue<size_t>(u"threads", 0);
 
     // Default: --ts-analysis --service-analysis --pid-analysis
     if (!ts_analysis &&
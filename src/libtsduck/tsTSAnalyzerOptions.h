@@ -84,6 +84,9 @@ namespace ts {
         uint64_t suspect_min_error_count;  //!< Option -\-suspect-min-error-count
         uint64_t suspect_max_consecutive;  //!< Option -\-suspect-max-consecutive
 
+        // Parallel analysis
+        size_t threads;  //!< Option -\-threads
+
         // Overriden methods.
         virtual void setHelp(const UString& help) override;
         virtual bool analyze(int argc, char* argv[]) override;
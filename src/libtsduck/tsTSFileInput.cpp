@@ -36,6 +36,10 @@
 #include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::TSFileInput::DEFAULT_READ_AHEAD;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -51,6 +55,10 @@ ts::TSFileInput::TSFileInput() :
     _severity(Severity::Error),
     _at_eof(false),
     _rewindable(false),
+    _regular(false),
+    _read_ahead(DEFAULT_READ_AHEAD),
+    _position(0),
+    _advised(0),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE)
 #else
@@ -132,7 +140,7 @@ bool ts::TSFileInput::openInternal (Report& report)
         _handle = ::GetStdHandle (STD_INPUT_HANDLE);
     }
     else {
-        _handle = ::CreateFile(_filename.toUTF8().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        _handle = ::CreateFile(_filename.toUTF8().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
         if (_handle == INVALID_HANDLE_VALUE) {
             ErrorCode error_code = LastErrorCode ();
             report.log(_severity, u"cannot open file %s: %s", {_filename, ErrorCodeMessage(error_code)});
@@ -142,7 +150,8 @@ bool ts::TSFileInput::openInternal (Report& report)
 
     // If a repeat count or initial offset is specified, the input file must be a regular file
 
-    if ((_repeat != 1 || _start_offset != 0) && ::GetFileType (_handle) != FILE_TYPE_DISK) {
+    _regular = ::GetFileType(_handle) == FILE_TYPE_DISK;
+    if ((_repeat != 1 || _start_offset != 0) && !_regular) {
         report.log(_severity, u"input file %s is not a regular file, cannot %s", {_filename, _repeat != 1 ? u"repeat" : u"specify start offset"});
         if (!_filename.empty()) {
             ::CloseHandle(_handle);
@@ -181,23 +190,22 @@ bool ts::TSFileInput::openInternal (Report& report)
     // If a repeat count or initial offset is specified, the input file
     // must be a regular file
 
-    if (_repeat != 1 || _start_offset != 0) {
-        struct stat st;
-        if (::fstat(_fd, &st) < 0) {
-            ErrorCode error_code = LastErrorCode ();
-            report.log(_severity, u"cannot stat input file %s: %s", {_filename, ErrorCodeMessage(error_code)});
-            if (!_filename.empty()) {
-                ::close (_fd);
-            }
-            return false;
+    struct stat st;
+    if (::fstat(_fd, &st) < 0) {
+        ErrorCode error_code = LastErrorCode ();
+        report.log(_severity, u"cannot stat input file %s: %s", {_filename, ErrorCodeMessage(error_code)});
+        if (!_filename.empty()) {
+            ::close (_fd);
         }
-        if (!S_ISREG(st.st_mode)) {
-            report.log(_severity, u"input file %s is not a regular file, cannot %s", {_filename, _repeat != 1 ? u"repeat" : u"specify start offset"});
-            if (!_filename.empty()) {
-                ::close(_fd);
-            }
-            return false;
+        return false;
+    }
+    _regular = S_ISREG(st.st_mode);
+    if ((_repeat != 1 || _start_offset != 0) && !_regular) {
+        report.log(_severity, u"input file %s is not a regular file, cannot %s", {_filename, _repeat != 1 ? u"repeat" : u"specify start offset"});
+        if (!_filename.empty()) {
+            ::close(_fd);
         }
+        return false;
     }
 
     // If an initial offset is specified, move here
@@ -211,8 +219,14 @@ bool ts::TSFileInput::openInternal (Report& report)
         return false;
     }
 
+#if defined(TS_LINUX)
+    // Let the kernel use a larger read-ahead window. Ignore errors on pipes.
+    ::posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
 #endif
 
+    _position = _advised = _start_offset;
     _is_open = true;
     _total_packets = 0;
     return true;
@@ -239,11 +253,31 @@ bool ts::TSFileInput::seekInternal(uint64_t index, Report& report)
     }
     else {
         _at_eof = false;
+        _position = _advised = _start_offset + index;
         return true;
     }
 }
 
 
+//----------------------------------------------------------------------------
+// Request the operating system to load the next part of the file.
+//----------------------------------------------------------------------------
+
+void ts::TSFileInput::readAhead()
+{
+#if defined(TS_LINUX)
+    // Keep between one and two read-ahead sizes in progress after the current position.
+    // The kernel starts the I/O asynchronously and the next read() finds the data
+    // in the page cache. Errors are ignored (pipes, unsupported file systems).
+    if (_read_ahead > 0 && _advised < _position + _read_ahead) {
+        const uint64_t start = std::max(_advised, _position);
+        ::posix_fadvise(_fd, off_t(start), off_t(_read_ahead), POSIX_FADV_WILLNEED);
+        _advised = start + _read_ahead;
+    }
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Seek the file to the specified packet_index (plus the previously specified start_offset).
 // The file must have been open in rewindable mode.
@@ -314,15 +348,23 @@ size_t ts::TSFileInput::read(TSPacket* buffer, size_t max_packets, Report& repor
     bool got_error = false;
     ErrorCode error_code = 0;
 
-    // Loop on read until we get enough
-    while (got_size < req_size && !_at_eof && !got_error) {
+    // Loop on read until we get enough. On a pipe or a device, do not wait for more
+    // data than available, only complete the last partial packet, if any.
+    while (got_size < req_size && !_at_eof && !got_error && (_regular || got_size == 0 || got_size % PKT_SIZE != 0)) {
+
+        // Load the next part of the file in the background.
+        readAhead();
+
+        // Size of next read operation.
+        const size_t size = _regular || got_size == 0 ? req_size - got_size : PKT_SIZE - got_size % PKT_SIZE;
 
 #if defined (TS_WINDOWS)
         // Windows implementation
         ::DWORD insize;
-        if (::ReadFile (_handle, data + got_size, ::DWORD (req_size - got_size), &insize, NULL)) {
+        if (::ReadFile (_handle, data + got_size, ::DWORD (size), &insize, NULL)) {
             // Normal case: some data were read
             got_size += insize;
+            _position += insize;
             assert (got_size <= req_size);
             _at_eof = insize == 0;
         }
@@ -333,10 +375,11 @@ size_t ts::TSFileInput::read(TSPacket* buffer, size_t max_packets, Report& repor
         }
 #else
         // UNIX implementation
-        ssize_t insize = ::read (_fd, data + got_size, req_size - got_size);
+        ssize_t insize = ::read (_fd, data + got_size, size);
         if (insize > 0) {
             // Normal case: some data were read
             got_size += insize;
+            _position += insize;
             assert (got_size <= req_size);
         }
         else if (insize == 0) {
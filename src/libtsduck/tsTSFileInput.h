@@ -43,6 +43,11 @@ namespace ts {
     class TSDUCKDLL TSFileInput
     {
     public:
+        //!
+        //! Default read-ahead size in bytes.
+        //!
+        static const size_t DEFAULT_READ_AHEAD = 8 * 1024 * 1024;
+
         //!
         //! Default constructor.
         //!
@@ -108,6 +113,24 @@ namespace ts {
             _severity = level;
         }
 
+        //!
+        //! Set the read-ahead size.
+        //!
+        //! When reading a regular file, the operating system is requested to
+        //! asynchronously load the next @a size bytes of the file while the
+        //! application processes the previously read packets. This is
+        //! currently implemented on Linux only (posix_fadvise). On Windows,
+        //! the file is only open for sequential access.
+        //!
+        //! @param [in] size Read-ahead size in bytes. Zero means no explicit
+        //! read-ahead, only the default one from the operating system.
+        //! Must be called before open() to be taken into account.
+        //!
+        void setReadAhead(size_t size)
+        {
+            _read_ahead = size;
+        }
+
         //!
         //! Get the file name.
         //! @return The file name.
@@ -128,6 +151,9 @@ namespace ts {
         //! Read TS packets.
         //! If the file file was opened with a @a repeat_count different from 1,
         //! reading packets transparently loops back at end if file.
+        //! On a regular file, the buffer is filled unless the end of file is reached.
+        //! On a pipe or a device, the packets are returned as soon as they are
+        //! available, without waiting for the buffer to be filled.
         //! @param [out] buffer Address of reception packet buffer.
         //! @param [in] max_packets Size of @a buffer in packets.
         //! @param [in,out] report Where to report errors.
@@ -180,6 +206,10 @@ namespace ts {
         int      _severity;      //!< Severity level for error reporting
         bool     _at_eof;        //!< End of file has been reached
         bool     _rewindable;    //!< Opened in rewindable mode
+        bool     _regular;       //!< Input is a regular file, not a pipe or a device
+        size_t   _read_ahead;    //!< Read-ahead size in bytes
+        uint64_t _position;      //!< Current byte position in file
+        uint64_t _advised;       //!< End of read-ahead area in file
 #if defined(TS_WINDOWS)
         ::HANDLE _handle;        //!< File handle
 #else
@@ -193,5 +223,6 @@ namespace ts {
         // Internal methods
         bool openInternal(Report& report);
         bool seekInternal(uint64_t, Report& report);
+        void readAhead();
     };
 }
@@ -0,0 +1,255 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Decoding of the headers of a batch of TS packets in one pass.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSPacketHeaders.h"
+TSDUCK_SOURCE;
+
+// SSE2 is always present on x86-64. AVX2 is used when supported by the CPU.
+#if defined(TS_X86_64) && (defined(TS_GCC) || defined(TS_MSC))
+    #define TS_HEADERS_SIMD 1
+    #if defined(TS_MSC)
+        #include <intrin.h>
+        #define TS_AVX2_TARGET
+    #else
+        #include <immintrin.h>
+        #define TS_AVX2_TARGET __attribute__((target("avx2")))
+    #endif
+#endif
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const uint8_t ts::TSPacketHeaders::TEI;
+const uint8_t ts::TSPacketHeaders::PUSI;
+const uint8_t ts::TSPacketHeaders::PRIORITY;
+const uint8_t ts::TSPacketHeaders::VALID_SYNC;
+const uint8_t ts::TSPacketHeaders::HAS_AF;
+const uint8_t ts::TSPacketHeaders::HAS_PAYLOAD;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Decoding primitives. The first 4 bytes of a packet are read as one
+// big-endian 32-bit word: sync byte (8), TEI, PUSI, priority (3 bits),
+// PID (13), scrambling control (2), adaptation field control (2), CC (4).
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Decode one packet header.
+    inline void DecodeOne(const ts::TSPacket& pkt, ts::PID* pid, uint8_t* flags, uint8_t* cc, uint8_t* scrambling)
+    {
+        const uint32_t w = ts::GetUInt32(pkt.b);
+        *pid = ts::PID((w >> 8) & 0x1FFF);
+        *cc = uint8_t(w & 0x0F);
+        *scrambling = uint8_t((w >> 6) & 0x03);
+        *flags = uint8_t(((w >> 16) & 0xE0) | ((w >> 4) & 0x03) | ((w >> 24) == ts::SYNC_BYTE ? ts::TSPacketHeaders::VALID_SYNC : 0));
+    }
+
+#if defined(TS_HEADERS_SIMD)
+
+    // Store the low byte of four 32-bit values.
+    inline void Store4Bytes(uint8_t* dest, __m128i v)
+    {
+        v = _mm_packs_epi32(v, v);
+        v = _mm_packus_epi16(v, v);
+        const int32_t x = _mm_cvtsi128_si32(v);
+        ::memcpy(dest, &x, 4);  // Flawfinder: ignore: memcpy()
+    }
+
+    // Decode four packet headers (SSE2).
+    inline void DecodeFour(const ts::TSPacket* pkt, ts::PID* pid, uint8_t* flags, uint8_t* cc, uint8_t* scrambling)
+    {
+        const __m128i w = _mm_set_epi32(int(ts::GetUInt32(pkt[3].b)), int(ts::GetUInt32(pkt[2].b)), int(ts::GetUInt32(pkt[1].b)), int(ts::GetUInt32(pkt[0].b)));
+        const __m128i pids = _mm_and_si128(_mm_srli_epi32(w, 8), _mm_set1_epi32(0x1FFF));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pid), _mm_packs_epi32(pids, pids));
+        Store4Bytes(cc, _mm_and_si128(w, _mm_set1_epi32(0x0F)));
+        Store4Bytes(scrambling, _mm_and_si128(_mm_srli_epi32(w, 6), _mm_set1_epi32(0x03)));
+        Store4Bytes(flags, _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(w, 16), _mm_set1_epi32(0xE0)),
+                                                     _mm_and_si128(_mm_srli_epi32(w, 4), _mm_set1_epi32(0x03))),
+                                        _mm_and_si128(_mm_cmpeq_epi32(_mm_srli_epi32(w, 24), _mm_set1_epi32(ts::SYNC_BYTE)),
+                                                      _mm_set1_epi32(ts::TSPacketHeaders::VALID_SYNC))));
+    }
+
+    // Check if the CPU and the operating system support AVX2.
+    bool CPUHasAVX2()
+    {
+    #if defined(TS_MSC)
+        int info[4];
+        __cpuid(info, 1);
+        // OSXSAVE (ECX bit 27) and AVX (ECX bit 28) are required to check the OS support.
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x06) != 0x06) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2") != 0;
+    #endif
+    }
+
+    const bool UseAVX2 = CPUHasAVX2();
+
+    // Narrow eight 32-bit values into eight 16-bit values.
+    TS_AVX2_TARGET inline __m128i Narrow16(__m256i v)
+    {
+        // Packing works inside each 128-bit lane: gather the two useful 64-bit parts.
+        return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packs_epi32(v, v), 0x08));
+    }
+
+    // Store the low byte of eight 32-bit values.
+    TS_AVX2_TARGET inline void Store8Bytes(uint8_t* dest, __m256i v)
+    {
+        const __m128i v16 = Narrow16(v);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), _mm_packus_epi16(v16, v16));
+    }
+
+    // Decode all groups of eight packet headers (AVX2). Return the number of decoded packets.
+    TS_AVX2_TARGET size_t DecodeAVX2(const ts::TSPacket* pkt, size_t count, ts::PID* pid, uint8_t* flags, uint8_t* cc, uint8_t* scrambling)
+    {
+        const __m256i pid_mask = _mm256_set1_epi32(0x1FFF);
+        const __m256i cc_mask = _mm256_set1_epi32(0x0F);
+        const __m256i sc_mask = _mm256_set1_epi32(0x03);
+        const __m256i ind_mask = _mm256_set1_epi32(0xE0);
+        const __m256i afc_mask = _mm256_set1_epi32(0x03);
+        const __m256i sync = _mm256_set1_epi32(ts::SYNC_BYTE);
+        const __m256i valid = _mm256_set1_epi32(ts::TSPacketHeaders::VALID_SYNC);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            // Individual loads are faster than a gather instruction on most CPU's.
+            const ts::TSPacket* const p = pkt + i;
+            const __m256i w = _mm256_setr_epi32(int(ts::GetUInt32(p[0].b)), int(ts::GetUInt32(p[1].b)), int(ts::GetUInt32(p[2].b)), int(ts::GetUInt32(p[3].b)),
+                                                int(ts::GetUInt32(p[4].b)), int(ts::GetUInt32(p[5].b)), int(ts::GetUInt32(p[6].b)), int(ts::GetUInt32(p[7].b)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pid + i), Narrow16(_mm256_and_si256(_mm256_srli_epi32(w, 8), pid_mask)));
+            Store8Bytes(cc + i, _mm256_and_si256(w, cc_mask));
+            Store8Bytes(scrambling + i, _mm256_and_si256(_mm256_srli_epi32(w, 6), sc_mask));
+            Store8Bytes(flags + i, _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(w, 16), ind_mask),
+                                                                   _mm256_and_si256(_mm256_srli_epi32(w, 4), afc_mask)),
+                                                   _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_srli_epi32(w, 24), sync), valid)));
+        }
+        return i;
+    }
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::TSPacketHeaders::TSPacketHeaders() :
+    _pid(),
+    _flags(),
+    _cc(),
+    _scrambling()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Decode the headers of a batch of TS packets.
+//----------------------------------------------------------------------------
+
+void ts::TSPacketHeaders::decode(const TSPacket* pkt, size_t count)
+{
+    _pid.resize(count);
+    _flags.resize(count);
+    _cc.resize(count);
+    _scrambling.resize(count);
+
+    PID* const pid = _pid.data();
+    uint8_t* const flags = _flags.data();
+    uint8_t* const cc = _cc.data();
+    uint8_t* const scrambling = _scrambling.data();
+    size_t i = 0;
+
+#if defined(TS_HEADERS_SIMD)
+    assert(sizeof(TSPacket) == PKT_SIZE);
+    if (UseAVX2) {
+        i = DecodeAVX2(pkt, count, pid, flags, cc, scrambling);
+    }
+    for (; i + 4 <= count; i += 4) {
+        DecodeFour(pkt + i, pid + i, flags + i, cc + i, scrambling + i);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        DecodeOne(pkt[i], pid + i, flags + i, cc + i, scrambling + i);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Batched lookups in a set of PID's.
+//----------------------------------------------------------------------------
+
+size_t ts::TSPacketHeaders::matchPIDs(const PIDSet& filter, uint8_t* match) const
+{
+    // Use local copies: the output bytes may alias anything, including the vector internals.
+    const PID* const pid = _pid.data();
+    const size_t count = _pid.size();
+    size_t found = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t m = uint8_t(filter[pid[i]]);
+        match[i] = m;
+        found += m;
+    }
+    return found;
+}
+
+size_t ts::TSPacketHeaders::selectPIDs(const PIDSet& filter, std::vector<size_t>& indexes) const
+{
+    const PID* const pid = _pid.data();
+    const size_t count = _pid.size();
+    indexes.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (filter[pid[i]]) {
+            indexes.push_back(i);
+        }
+    }
+    return indexes.size();
+}
+
+
+//----------------------------------------------------------------------------
+// Instruction set which is used to decode the headers.
+//----------------------------------------------------------------------------
+
+ts::UString ts::TSPacketHeaders::Acceleration()
+{
+#if defined(TS_HEADERS_SIMD)
+    return UseAVX2 ? u"AVX2" : u"SSE2";
+#else
+    return u"none";
+#endif
+}
@@ -0,0 +1,195 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Decoding of the headers of a batch of TS packets in one pass.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+
+namespace ts {
+
+    //!
+    //! Decoding of the headers of a batch of TS packets in one pass.
+    //!
+    //! Plugins and demuxes which process packets by batches can decode all headers
+    //! at once and then use the decoded arrays instead of repeatedly extracting the
+    //! fields through the TSPacket accessors. The decoding uses SIMD instructions
+    //! when available (SSE2 and AVX2 on x86-64). The result is identical in all cases.
+    //!
+    //! The flags of a packet are a combination of the bit masks defined in this class.
+    //!
+    class TSDUCKDLL TSPacketHeaders
+    {
+    public:
+        static const uint8_t TEI         = 0x80;  //!< Flag: transport_error_indicator is set.
+        static const uint8_t PUSI        = 0x40;  //!< Flag: payload_unit_start_indicator is set.
+        static const uint8_t PRIORITY    = 0x20;  //!< Flag: transport_priority is set.
+        static const uint8_t VALID_SYNC  = 0x10;  //!< Flag: the packet starts with a sync byte.
+        static const uint8_t HAS_AF      = 0x02;  //!< Flag: the packet has an adaptation field.
+        static const uint8_t HAS_PAYLOAD = 0x01;  //!< Flag: the packet has a payload.
+
+        //!
+        //! Constructor.
+        //!
+        TSPacketHeaders();
+
+        //!
+        //! Decode the headers of a batch of TS packets.
+        //! The results of the previous batch are discarded.
+        //! @param [in] pkt Address of the first TS packet.
+        //! @param [in] count Number of TS packets.
+        //!
+        void decode(const TSPacket* pkt, size_t count);
+
+        //!
+        //! Get the number of decoded packets.
+        //! @return The number of packets in the last decoded batch.
+        //!
+        size_t size() const { return _pid.size(); }
+
+        //!
+        //! Get the array of PID values.
+        //! @return The address of an array of size() PID values, one per packet.
+        //!
+        const PID* pids() const { return _pid.data(); }
+
+        //!
+        //! Get the array of flags.
+        //! @return The address of an array of size() flags, one per packet.
+        //!
+        const uint8_t* flags() const { return _flags.data(); }
+
+        //!
+        //! Get the array of continuity counters.
+        //! @return The address of an array of size() continuity counters, one per packet.
+        //!
+        const uint8_t* continuityCounters() const { return _cc.data(); }
+
+        //!
+        //! Get the array of scrambling control values.
+        //! @return The address of an array of size() scrambling control values (0 to 3), one per packet.
+        //!
+        const uint8_t* scramblingControls() const { return _scrambling.data(); }
+
+        //!
+        //! Get the PID of a packet.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return The PID value.
+        //!
+        PID getPID(size_t index) const { return _pid[index]; }
+
+        //!
+        //! Get the continuity counter of a packet.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return The continuity counter.
+        //!
+        uint8_t getCC(size_t index) const { return _cc[index]; }
+
+        //!
+        //! Get the scrambling control value of a packet.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return The scrambling control value.
+        //!
+        uint8_t getScrambling(size_t index) const { return _scrambling[index]; }
+
+        //!
+        //! Check if a packet starts with a sync byte.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return True if the packet starts with a sync byte.
+        //!
+        bool hasValidSync(size_t index) const { return (_flags[index] & VALID_SYNC) != 0; }
+
+        //!
+        //! Check the transport_error_indicator of a packet.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return True if the transport_error_indicator is set.
+        //!
+        bool getTEI(size_t index) const { return (_flags[index] & TEI) != 0; }
+
+        //!
+        //! Check the payload_unit_start_indicator of a packet.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return True if the payload_unit_start_indicator is set.
+        //!
+        bool getPUSI(size_t index) const { return (_flags[index] & PUSI) != 0; }
+
+        //!
+        //! Check the transport_priority of a packet.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return True if the transport_priority is set.
+        //!
+        bool getPriority(size_t index) const { return (_flags[index] & PRIORITY) != 0; }
+
+        //!
+        //! Check if a packet has an adaptation field.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return True if the packet has an adaptation field.
+        //!
+        bool hasAF(size_t index) const { return (_flags[index] & HAS_AF) != 0; }
+
+        //!
+        //! Check if a packet has a payload.
+        //! @param [in] index Index of the packet in the last batch.
+        //! @return True if the packet has a payload.
+        //!
+        bool hasPayload(size_t index) const { return (_flags[index] & HAS_PAYLOAD) != 0; }
+
+        //!
+        //! Check the PID's of all packets of the last batch in a set of PID's.
+        //! @param [in] filter The set of PID's to check.
+        //! @param [out] match Address of an array of size() bytes. Each byte is set
+        //! to 1 when the PID of the corresponding packet is in @a filter, 0 otherwise.
+        //! @return The number of packets with a PID in @a filter.
+        //!
+        size_t matchPIDs(const PIDSet& filter, uint8_t* match) const;
+
+        //!
+        //! Get the indexes of all packets of the last batch with a PID in a set of PID's.
+        //! @param [in] filter The set of PID's to check.
+        //! @param [out] indexes Returned indexes of the packets in the last batch.
+        //! @return The number of packets with a PID in @a filter.
+        //!
+        size_t selectPIDs(const PIDSet& filter, std::vector<size_t>& indexes) const;
+
+        //!
+        //! Check if SIMD instructions are used to decode the headers.
+        //! @return A string describing the instruction set which is used ("AVX2", "SSE2", "none").
+        //!
+        static UString Acceleration();
+
+    private:
+        std::vector<PID>     _pid;
+        std::vector<uint8_t> _flags;
+        std::vector<uint8_t> _cc;
+        std::vector<uint8_t> _scrambling;
+    };
+}
@@ -36,6 +36,7 @@
 #include "tsPESDemux.h"
 #include "tsTeletextCharset.h"
 #include "tsTeletextHandlerInterface.h"
+#include "tsPIDContextTable.h"
 
 namespace ts {
     //!
@@ -166,7 +167,7 @@ namespace ts {
         //!
         //! Map of PID analysis contexts, indexed by PID value.
         //!
-        typedef std::map<PID, PIDContext> PIDContextMap;
+        typedef PIDContextTable<PIDContext> PIDContextMap;
 
         //!
         //! Process one Teletext packet.
@@ -187,6 +187,20 @@ bool ts::Thread::start()
         return false;
     }
 
+    // Set the CPU affinity. Only the CPU's in the current processor group can be used.
+    if (!_attributes._cpus.empty()) {
+        ::DWORD_PTR mask = 0;
+        for (std::set<size_t>::const_iterator it = _attributes._cpus.begin(); it != _attributes._cpus.end(); ++it) {
+            if (*it < 8 * sizeof(mask)) {
+                mask |= ::DWORD_PTR(1) << *it;
+            }
+        }
+        if (mask == 0 || ::SetThreadAffinityMask(_handle, mask) == 0) {
+            ::CloseHandle(_handle);
+            return false;
+        }
+    }
+
     // Release the thread
     if (::ResumeThread(_handle) == ::DWORD(-1)) {
         ::CloseHandle(_handle);
@@ -233,6 +247,22 @@ bool ts::Thread::start()
         ::pthread_attr_destroy(&attr);
         return false;
     }
+#if defined(TS_LINUX)
+    // Set CPU affinity. Not supported on macOS, silently ignored.
+    if (!_attributes._cpus.empty()) {
+        ::cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (std::set<size_t>::const_iterator it = _attributes._cpus.begin(); it != _attributes._cpus.end(); ++it) {
+            if (*it < CPU_SETSIZE) {
+                CPU_SET(*it, &cpus);
+            }
+        }
+        if (CPU_COUNT(&cpus) == 0 || ::pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) != 0) {
+            ::pthread_attr_destroy(&attr);
+            return false;
+        }
+    }
+#endif
     // Create the thread
     if (::pthread_create(&_pthread, &attr, Thread::ThreadProc, this) != 0) {
         ::pthread_attr_destroy(&attr);
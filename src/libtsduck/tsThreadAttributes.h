@@ -184,6 +184,46 @@ namespace ts {
             return _priority;
         }
 
+        //!
+        //! Set the CPU affinity for the thread.
+        //!
+        //! The CPU affinity is the set of CPU's on which the thread is allowed to run.
+        //! CPU's are identified by an index from 0 to SysInfo::cpuCount() - 1.
+        //! An empty set means no affinity: the thread can run on any CPU, as decided
+        //! by the operating system. This is the default.
+        //!
+        //! Binding the various threads of an application to distinct CPU's avoids
+        //! competition between them and improves cache locality. On systems with
+        //! several NUMA nodes, it also keeps the memory which is first accessed by
+        //! the thread on the node of these CPU's.
+        //!
+        //! <h3>Support</h3>
+        //!
+        //! CPU affinity is supported on Linux and Windows. On Windows, only the first
+        //! 64 CPU's (the first processor group) can be used. CPU affinity is ignored
+        //! on macOS which does not provide an API to bind threads to specific CPU's.
+        //!
+        //! @param [in] cpus The set of CPU indexes for the thread.
+        //! @return A reference to this object.
+        //!
+        ThreadAttributes& setCPUAffinity(const std::set<size_t>& cpus)
+        {
+            _cpus = cpus;
+            return *this;
+        }
+
+        //!
+        //! Get the CPU affinity for the thread.
+        //!
+        //! @return A constant reference to the set of CPU indexes for the thread.
+        //! When the set is empty, the thread can run on any CPU.
+        //! @see setCPUAffinity()
+        //!
+        const std::set<size_t>& getCPUAffinity() const
+        {
+            return _cpus;
+        }
+
         //!
         //! Get the minimum priority for a thread in this context of the operating system.
         //! @return The minimum priority for a thread.
@@ -241,6 +281,7 @@ namespace ts {
         size_t _stackSize;
         bool _deleteWhenTerminated;
         int _priority;
+        std::set<size_t> _cpus;
 
         //
         // These fields describe the operating system priority range.
@@ -50,6 +50,14 @@ ts::UDPSocket::UDPSocket(bool auto_open, Report& report) :
     _local_address(),
     _default_destination(),
     _mcast()
+#if defined(TS_LINUX)
+    , _mmsg(),
+    _mmsg_iov(),
+    _mmsg_names(),
+    _mmsg_ancil(),
+    _smsg(),
+    _smsg_iov()
+#endif
 {
     if (auto_open) {
         // Returned value ignored on purpose, the socket is marked as closed in the object on error.
@@ -288,6 +296,27 @@ bool ts::UDPSocket::dropMembership (Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Enable or disable the reception time stamps of incoming messages.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::setReceiveTimestamps(bool on, Report& report)
+{
+#if defined(TS_WINDOWS)
+    report.error(u"UDP reception time stamps are not supported on Windows");
+    return false;
+#else
+    int opt = int(on); // Actual socket option is an int.
+    report.debug(u"setting socket SO_TIMESTAMP to %d", {opt});
+    if (::setsockopt(getSocket(), SOL_SOCKET, SO_TIMESTAMP, TS_SOCKOPT_T(&opt), sizeof(opt)) != 0) {
+        report.error(u"error setting socket SO_TIMESTAMP option: %s", {SocketErrorCodeMessage()});
+        return false;
+    }
+    return true;
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Send a message to a destination address and port.
 // Address and port are mandatory in SocketAddress.
@@ -307,6 +336,100 @@ bool ts::UDPSocket::send(const void* data, size_t size, const SocketAddress& des
 }
 
 
+//----------------------------------------------------------------------------
+// Outgoing message description constructor.
+//----------------------------------------------------------------------------
+
+ts::UDPSocket::OutgoingMessage::OutgoingMessage(const void* data_, size_t size_, const void* header_, size_t header_size_) :
+    header(header_),
+    header_size(header_size_),
+    data(data_),
+    size(size_)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Send a batch of messages to a destination address and port.
+// Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::send(const OutgoingMessage* messages, size_t count, const SocketAddress& dest, Report& report)
+{
+#if defined(TS_LINUX)
+
+    ::sockaddr addr;
+    dest.copy(addr);
+
+    // Reuse the same system structures between calls.
+    // Two iovec per message, for the optional header and the data.
+    if (_smsg.size() < count) {
+        _smsg.resize(count);
+        _smsg_iov.resize(2 * count);
+    }
+
+    // Build the message headers.
+    for (size_t i = 0; i < count; ++i) {
+        TS_ZERO(_smsg[i]);
+        ::iovec* iov = &_smsg_iov[2 * i];
+        size_t iovlen = 0;
+        if (messages[i].header_size > 0) {
+            iov[iovlen].iov_base = const_cast<void*>(messages[i].header);
+            iov[iovlen++].iov_len = messages[i].header_size;
+        }
+        iov[iovlen].iov_base = const_cast<void*>(messages[i].data);
+        iov[iovlen++].iov_len = messages[i].size;
+        ::msghdr& hdr(_smsg[i].msg_hdr);
+        hdr.msg_name = &addr;
+        hdr.msg_namelen = sizeof(addr);
+        hdr.msg_iov = iov;
+        hdr.msg_iovlen = iovlen; // number of iovec structures
+    }
+
+    // The kernel may send less messages than requested, loop until all are sent.
+    size_t sent = 0;
+    while (sent < count) {
+        const int res = ::sendmmsg(getSocket(), &_smsg[sent], (unsigned int)(count - sent), 0);
+        if (res > 0) {
+            sent += size_t(res);
+        }
+        else if (res == 0) {
+            // Should not happen with a blocking socket, do not loop forever.
+            report.error(u"error sending UDP message: no message sent");
+            return false;
+        }
+        else if (LastSocketErrorCode() != EINTR) {
+            report.error(u"error sending UDP message: " + SocketErrorCodeMessage());
+            return false;
+        }
+    }
+    return true;
+
+#else
+
+    // Other systems, send messages one by one.
+    // Messages with a header are rebuilt in a contiguous buffer.
+    ByteBlock buffer;
+    for (size_t i = 0; i < count; ++i) {
+        bool ok;
+        if (messages[i].header_size == 0) {
+            ok = send(messages[i].data, messages[i].size, dest, report);
+        }
+        else {
+            buffer.copy(messages[i].header, messages[i].header_size);
+            buffer.append(messages[i].data, messages[i].size);
+            ok = send(buffer.data(), buffer.size(), dest, report);
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Receive a message.
 // If abort interface is non-zero, invoke it when I/O is interrupted
@@ -354,12 +477,15 @@ bool ts::UDPSocket::receive(void* data,
 // Perform one receive operation. Hide the system mud.
 //----------------------------------------------------------------------------
 
-ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, Report& report)
+ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, Report& report, MicroSecond* timestamp)
 {
     // Clear returned values
     ret_size = 0;
     sender.clear();
     destination.clear();
+    if (timestamp != 0) {
+        *timestamp = -1;
+    }
 
     // Reserve a socket address to receive the sender address.
     ::sockaddr sender_sock;
@@ -460,19 +586,153 @@ ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data, size_t max_size, size_
     }
 
     // Browse returned ancillary data.
+    getAncillaryData(hdr, destination, timestamp, report);
+
+#endif // Windows vs. UNIX
+
+    // Successfully received a message
+    ret_size = size_t(insize);
+    sender = SocketAddress(sender_sock);
+
+    return SYS_SUCCESS;
+}
+
+
+//----------------------------------------------------------------------------
+// Analyze the ancillary data of a received message (UNIX only).
+//----------------------------------------------------------------------------
+
+#if defined(TS_UNIX)
+void ts::UDPSocket::getAncillaryData(::msghdr& hdr, SocketAddress& destination, MicroSecond* timestamp, Report& report)
+{
     for (::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != 0; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
         report.debug(u"UDP recvmsg, ancillary message %d, level %d, %d bytes", {cmsg->cmsg_type, cmsg->cmsg_level, cmsg->cmsg_len});
         if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO && cmsg->cmsg_len >= sizeof(::in_pktinfo)) {
             const ::in_pktinfo* info = reinterpret_cast<const ::in_pktinfo*>(CMSG_DATA(cmsg));
             destination = SocketAddress(info->ipi_addr, _local_address.port());
         }
+        else if (timestamp != 0 && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP && cmsg->cmsg_len >= CMSG_LEN(sizeof(::timeval))) {
+            ::timeval tv;
+            ::memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+            *timestamp = MicroSecond(tv.tv_sec) * MicroSecPerSec + MicroSecond(tv.tv_usec);
+        }
     }
+}
+#endif
 
-#endif // Windows vs. UNIX
 
-    // Successfully received a message
-    ret_size = size_t(insize);
-    sender = SocketAddress(sender_sock);
+//----------------------------------------------------------------------------
+// Received message description constructor.
+//----------------------------------------------------------------------------
+
+ts::UDPSocket::ReceivedMessage::ReceivedMessage(void* data_, size_t max_size_) :
+    data(data_),
+    max_size(max_size_),
+    size(0),
+    sender(),
+    destination(),
+    timestamp(-1)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Receive a batch of messages.
+// If abort interface is non-zero, invoke it when I/O is interrupted
+// (in case of user-interrupt, return, otherwise retry).
+// Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::receive(ReceivedMessage* messages, size_t max_count, size_t& count, const AbortInterface* abort, Report& report)
+{
+    count = 0;
+    if (messages == 0 || max_count == 0) {
+        return true;
+    }
+
+    // Loop on unsollicited interrupts
+    for (;;) {
+
+        // Wait for messages.
+#if defined(TS_LINUX)
+        const SocketErrorCode err = receiveMany(messages, max_count, count, report);
+#else
+        const SocketErrorCode err = receiveOne(messages[0].data, messages[0].max_size, messages[0].size, messages[0].sender, messages[0].destination, report, &messages[0].timestamp);
+        count = err == SYS_SUCCESS ? 1 : 0;
+#endif
+
+        if (err == SYS_SUCCESS) {
+            return true;
+        }
+        else if (abort != 0 && abort->aborting()) {
+            // User-interrupt, end of processing but no error message
+            return false;
+        }
+#if !defined(TS_WINDOWS)
+        else if (err == EINTR) {
+            // Got a signal, not a user interrupt, will ignore it
+            report.debug(u"signal, not user interrupt");
+        }
+#endif
+        else {
+            // Abort on non-interrupt errors.
+            report.error(u"error receiving from UDP socket: %s", {SocketErrorCodeMessage(err)});
+            return false;
+        }
+    }
+}
 
+
+//----------------------------------------------------------------------------
+// Perform one batch receive operation using recvmmsg (Linux only).
+//----------------------------------------------------------------------------
+
+#if defined(TS_LINUX)
+ts::SocketErrorCode ts::UDPSocket::receiveMany(ReceivedMessage* messages, size_t max_count, size_t& count, Report& report)
+{
+    // Size of ancillary data per message: IP_PKTINFO and SO_TIMESTAMP, with some margin.
+    static const size_t ANCIL_SIZE = 256;
+
+    // Reuse the same system structures between calls.
+    count = 0;
+    if (_mmsg.size() < max_count) {
+        _mmsg.resize(max_count);
+        _mmsg_iov.resize(max_count);
+        _mmsg_names.resize(max_count);
+        _mmsg_ancil.resize(max_count * ANCIL_SIZE);
+    }
+
+    // Build the message headers.
+    for (size_t i = 0; i < max_count; ++i) {
+        TS_ZERO(_mmsg[i]);
+        TS_ZERO(_mmsg_names[i]);
+        _mmsg_iov[i].iov_base = messages[i].data;
+        _mmsg_iov[i].iov_len = messages[i].max_size;
+        ::msghdr& hdr(_mmsg[i].msg_hdr);
+        hdr.msg_name = &_mmsg_names[i];
+        hdr.msg_namelen = sizeof(::sockaddr);
+        hdr.msg_iov = &_mmsg_iov[i];
+        hdr.msg_iovlen = 1; // number of iovec structures
+        hdr.msg_control = &_mmsg_ancil[i * ANCIL_SIZE];
+        hdr.msg_controllen = ANCIL_SIZE;
+    }
+
+    // Wait for at least one message, then get all messages which are immediately available.
+    const int res = ::recvmmsg(getSocket(), &_mmsg[0], (unsigned int)(max_count), MSG_WAITFORONE, 0);
+    if (res < 0) {
+        return LastSocketErrorCode();
+    }
+
+    // Analyze all received messages.
+    count = size_t(res);
+    for (size_t i = 0; i < count; ++i) {
+        ReceivedMessage& msg(messages[i]);
+        msg.size = std::min<size_t>(_mmsg[i].msg_len, msg.max_size);
+        msg.sender = SocketAddress(_mmsg_names[i]);
+        msg.destination.clear();
+        msg.timestamp = -1;
+        getAncillaryData(_mmsg[i].msg_hdr, msg.destination, &msg.timestamp, report);
+    }
     return SYS_SUCCESS;
 }
+#endif
@@ -38,6 +38,7 @@
 #include "tsAbortInterface.h"
 #include "tsReport.h"
 #include "tsMemoryUtils.h"
+#include "tsByteBlock.h"
 
 namespace ts {
     //!
@@ -206,6 +207,21 @@ namespace ts {
         //!
         bool dropMembership(Report& report = CERR);
 
+        //!
+        //! Enable or disable the reception time stamps of incoming messages.
+        //!
+        //! When enabled, the kernel time stamps the incoming messages when they are
+        //! received by the network stack. The time stamps are returned in
+        //! ReceivedMessage::timestamp by the batch version of receive(). This is
+        //! more accurate than reading the system time when the application gets
+        //! the message. Not supported on Windows.
+        //!
+        //! @param [in] on If true, enable time stamps, disable them otherwise.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool setReceiveTimestamps(bool on, Report& report = CERR);
+
         //!
         //! Send a message to a destination address and port.
         //!
@@ -233,6 +249,60 @@ namespace ts {
             return send(data, size, _default_destination, report);
         }
 
+        //!
+        //! Description of one message in a batch send operation.
+        //! An optional header can be specified. The header and the data are sent
+        //! in the same UDP message. When possible, the header and the data are not
+        //! copied into an intermediate buffer (scatter-gather I/O).
+        //! @see send(const OutgoingMessage*, size_t, const SocketAddress&, Report&)
+        //!
+        struct TSDUCKDLL OutgoingMessage
+        {
+            const void* header;       //!< Address of the optional header, sent before the data.
+            size_t      header_size;  //!< Size in bytes of the optional header, zero if none.
+            const void* data;         //!< Address of the message to send.
+            size_t      size;         //!< Size in bytes of the message to send.
+
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the message to send.
+            //! @param [in] size Size in bytes of the message to send.
+            //! @param [in] header Address of the optional header.
+            //! @param [in] header_size Size in bytes of the optional header.
+            //!
+            OutgoingMessage(const void* data = 0, size_t size = 0, const void* header = 0, size_t header_size = 0);
+        };
+
+        //!
+        //! Send a batch of messages to a destination address and port.
+        //!
+        //! On Linux, all messages are sent using as few system calls as possible
+        //! (sendmmsg). On other systems, the messages are sent one by one.
+        //!
+        //! @param [in] messages Address of an array of @a count messages to send.
+        //! @param [in] count Number of messages to send.
+        //! @param [in] destination Socket address of the destination.
+        //! Both address and port are mandatory in the socket address, they cannot
+        //! be set to @link IPAddress::AnyAddress @endlink or
+        //! @link SocketAddress::AnyPort @endlink.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool send(const OutgoingMessage* messages, size_t count, const SocketAddress& destination, Report& report = CERR);
+
+        //!
+        //! Send a batch of messages to the default destination address and port.
+        //!
+        //! @param [in] messages Address of an array of @a count messages to send.
+        //! @param [in] count Number of messages to send.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool send(const OutgoingMessage* messages, size_t count, Report& report = CERR)
+        {
+            return send(messages, count, _default_destination, report);
+        }
+
         //!
         //! Receive a message.
         //!
@@ -256,6 +326,52 @@ namespace ts {
                      const AbortInterface* abort = 0,
                      Report& report = CERR);
 
+        //!
+        //! Description of one message in a batch receive operation.
+        //! @see receive(ReceivedMessage*, size_t, size_t&, const AbortInterface*, Report&)
+        //!
+        struct TSDUCKDLL ReceivedMessage
+        {
+            void*         data;         //!< [in] Address of the buffer for the received message.
+            size_t        max_size;     //!< [in] Size in bytes of the reception buffer.
+            size_t        size;         //!< [out] Size in bytes of the received message, never larger than @a max_size.
+            SocketAddress sender;       //!< [out] Socket address of the sender.
+            SocketAddress destination;  //!< [out] Socket address of the packet destination.
+            MicroSecond   timestamp;    //!< [out] Kernel reception time in microseconds since the Unix epoch, -1 if unavailable.
+
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the buffer for the received message.
+            //! @param [in] max_size Size in bytes of the reception buffer.
+            //!
+            ReceivedMessage(void* data = 0, size_t max_size = 0);
+        };
+
+        //!
+        //! Receive a batch of messages.
+        //!
+        //! The method waits for at least one message and then returns as many
+        //! messages as are immediately available, up to @a max_count. On Linux,
+        //! all messages are received using one single system call (recvmmsg).
+        //! On other systems, one message is returned at a time.
+        //!
+        //! @param [in,out] messages Address of an array of @a max_count message
+        //! descriptions. The fields @a data and @a max_size must be set by the caller.
+        //! The other fields are returned for each received message.
+        //! @param [in] max_count Maximum number of messages to receive.
+        //! @param [out] count Number of actually received messages in @a messages.
+        //! @param [in] abort If non-zero, invoked when I/O is interrupted
+        //! (in case of user-interrupt, return, otherwise retry).
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see setReceiveTimestamps()
+        //!
+        bool receive(ReceivedMessage* messages,
+                     size_t max_count,
+                     size_t& count,
+                     const AbortInterface* abort = 0,
+                     Report& report = CERR);
+
         // Implementation of Socket interface.
         virtual bool open(Report& report = CERR) override;
         virtual bool close(Report& report = CERR) override;
@@ -294,7 +410,25 @@ namespace ts {
         MReqSet       _mcast; // Current list of multicast memberships
 
         // Perform one receive operation. Hide the system mud.
-        SocketErrorCode receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, Report& report);
+        SocketErrorCode receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, Report& report, MicroSecond* timestamp = 0);
+
+#if defined(TS_LINUX)
+        // Perform one batch receive operation using recvmmsg.
+        SocketErrorCode receiveMany(ReceivedMessage* messages, size_t max_count, size_t& count, Report& report);
+
+        // Buffers for recvmmsg and sendmmsg, kept between calls to avoid reallocations.
+        std::vector<::mmsghdr>  _mmsg;
+        std::vector<::iovec>    _mmsg_iov;
+        std::vector<::sockaddr> _mmsg_names;
+        ByteBlock               _mmsg_ancil;
+        std::vector<::mmsghdr>  _smsg;
+        std::vector<::iovec>    _smsg_iov;
+#endif
+
+#if defined(TS_UNIX)
+        // Analyze the ancillary data of a received message.
+        void getAncillaryData(::msghdr& hdr, SocketAddress& destination, MicroSecond* timestamp, Report& report);
+#endif
 
         // Furiously idiotic Windows feature, see comment in receiveOne()
 #if defined(TS_WINDOWS)
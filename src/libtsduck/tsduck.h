@@ -173,6 +173,7 @@
 #include "tsOutputPager.h"
 #include "tsOutputRedirector.h"
 #include "tsPacketizer.h"
+#include "tsParallelScrambling.h"
 #include "tsParentalRatingDescriptor.h"
 #include "tsPAT.h"
 #include "tsPCR.h"
@@ -181,6 +182,7 @@
 #include "tsPESDemux.h"
 #include "tsPESHandlerInterface.h"
 #include "tsPESPacket.h"
+#include "tsPIDContextTable.h"
 #include "tsPIDOperator.h"
 #include "tsPlatform.h"
 #include "tsPlugin.h"
@@ -209,6 +211,7 @@
 #include "tsSafePtr.h"
 #include "tsSatelliteDeliverySystemDescriptor.h"
 #include "tsScrambling.h"
+#include "tsScramblingCache.h"
 #include "tsSDT.h"
 #include "tsSection.h"
 #include "tsSectionDemux.h"
@@ -301,6 +304,7 @@
 #include "tsTSFileOutput.h"
 #include "tsTSFileOutputResync.h"
 #include "tsTSPacket.h"
+#include "tsTSPacketHeaders.h"
 #include "tsTSScanner.h"
 #include "tsTuner.h"
 #include "tsTunerArgs.h"
@@ -36,6 +36,9 @@
 #include "tsPluginRepository.h"
 #include "tsTSAnalyzerReport.h"
 #include "tsSysUtils.h"
+#include "tsThread.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
 
@@ -44,7 +47,7 @@ TSDUCK_SOURCE;
 //----------------------------------------------------------------------------
 
 namespace ts {
-    class AnalyzePlugin: public ProcessorPlugin
+    class AnalyzePlugin: public ProcessorPlugin, private Thread
     {
     public:
         // Implementation of plugin API
@@ -62,14 +65,30 @@ namespace ts {
         PacketCounter     _current_packet;
         Time              _next_report_time;
         PacketCounter     _next_report_packet;
-        TSAnalyzerReport  _analyzer;
         TSAnalyzerOptions _analyzer_options;
-
-        bool openOutput();
+        TSAnalyzerReport  _analyzers[2];      // Current analysis and previous one (being reported with --interval).
+        TSAnalyzerReport* _analyzer;          // Current analysis, fed with packets.
+
+        // With --interval, the reports are produced by an internal thread.
+        // The complete analysis context is passed to the thread and the packet
+        // processing continues with the other (already reset) analysis context.
+        Mutex             _report_mutex;      // Protect the fields below.
+        Condition         _report_request;    // Signaled when a report is requested or on termination.
+        Condition         _report_done;       // Signaled when a report is completed.
+        TSAnalyzerReport* _report_analyzer;   // Analysis to report, zero when the thread is idle.
+        Time              _report_time;       // Local time of the report request.
+        bool              _report_error;      // An error occurred in the reporting thread.
+        bool              _report_terminate;  // Request the termination of the reporting thread.
+
+        bool openOutput(const Time& local_time);
         void closeOutput();
-        bool produceReport();
+        bool produceReport(TSAnalyzerReport& analyzer, const Time& local_time);
+        bool requestReport();
         void computeNextReportTime (const Time& current_utc, MilliSecond interval);
 
+        // Inherited from Thread
+        virtual void main() override;
+
         // Inaccessible operations
         AnalyzePlugin() = delete;
         AnalyzePlugin(const AnalyzePlugin&) = delete;
@@ -95,8 +114,16 @@ ts::AnalyzePlugin::AnalyzePlugin(TSP* tsp_) :
     _current_packet(0),
     _next_report_time(Time::Epoch),
     _next_report_packet(0),
-    _analyzer(),
-    _analyzer_options()
+    _analyzer_options(),
+    _analyzers(),
+    _analyzer(&_analyzers[0]),
+    _report_mutex(),
+    _report_request(),
+    _report_done(),
+    _report_analyzer(0),
+    _report_time(),
+    _report_error(false),
+    _report_terminate(false)
 {
     option(u"interval",       'i', POSITIVE);
     option(u"multiple-files", 'm');
@@ -145,16 +172,29 @@ bool ts::AnalyzePlugin::start()
     _multiple_output = present(u"multiple-files");
     _output = _output_name.empty() ? &std::cout : &_output_stream;
     _analyzer_options.getOptions (*this);
-    _analyzer.setAnalysisOptions (_analyzer_options);
+    _analyzers[0].setAnalysisOptions (_analyzer_options);
+    _analyzers[1].setAnalysisOptions (_analyzer_options);
+    _analyzer = &_analyzers[0];
     _current_packet = 0;
 
     // Create the output file. Note that this file is used only in the stop
     // method and could be created there. However, if the file cannot be
     // created, we do not want to wait all along the analysis and finally fail.
-    if (_output_interval == 0 && !openOutput()) {
+    if (_output_interval == 0 && !openOutput(Time::CurrentLocalTime())) {
         return false;
     }
 
+    // With --interval, the reports are produced in the background.
+    if (_output_interval > 0) {
+        _report_analyzer = 0;
+        _report_error = false;
+        _report_terminate = false;
+        if (!Thread::start()) {
+            tsp->error(u"cannot start reporting thread");
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -163,7 +203,7 @@ bool ts::AnalyzePlugin::start()
 // Create an output file. Return true on success, false on error.
 //----------------------------------------------------------------------------
 
-bool ts::AnalyzePlugin::openOutput()
+bool ts::AnalyzePlugin::openOutput(const Time& local_time)
 {
     // Standard output is always open. Also do not reopen an open file.
     if (_output_name.empty() || _output_stream.is_open()) {
@@ -173,7 +213,7 @@ bool ts::AnalyzePlugin::openOutput()
     // Build file name in case of --multiple-files
     UString name;
     if (_multiple_output) {
-        const Time::Fields now(Time::CurrentLocalTime());
+        const Time::Fields now(local_time);
         name = UString::Format(u"%s_%04d%02d%02d_%02d%02d%02d%s", {PathPrefix(_output_name), now.year, now.month, now.day, now.hour, now.minute, now.second, PathSuffix(_output_name)});
     }
     else {
@@ -208,30 +248,108 @@ void ts::AnalyzePlugin::closeOutput()
 // Produce a report. Return true on success, false on error.
 //----------------------------------------------------------------------------
 
-bool ts::AnalyzePlugin::produceReport()
+bool ts::AnalyzePlugin::produceReport(TSAnalyzerReport& analyzer, const Time& local_time)
 {
-    if (!openOutput()) {
+    if (!openOutput(local_time)) {
         return false;
     }
     else {
-        // Set last known input bitrate as hint
-        _analyzer.setBitrateHint(tsp->bitrate());
-
-        // Produce the report
-        _analyzer.report(*_output, _analyzer_options);
+        analyzer.report(*_output, _analyzer_options);
         closeOutput();
         return true;
     }
 }
 
 
+//----------------------------------------------------------------------------
+// Pass the current analysis context to the reporting thread and continue
+// with the other one. Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::AnalyzePlugin::requestReport()
+{
+    // Set last known input bitrate as hint
+    _analyzer->setBitrateHint(tsp->bitrate());
+
+    GuardCondition lock(_report_mutex, _report_done);
+
+    // Wait for the completion of the previous report. This happens only
+    // when producing a report takes longer than the reporting interval.
+    while (_report_analyzer != 0) {
+        lock.waitCondition();
+    }
+    if (_report_error) {
+        return false;
+    }
+
+    // The other analysis context was reset by the reporting thread.
+    _report_analyzer = _analyzer;
+    _report_time = Time::CurrentLocalTime();
+    _analyzer = _analyzer == &_analyzers[0] ? &_analyzers[1] : &_analyzers[0];
+    _report_request.signal();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Reporting thread, with --interval.
+//----------------------------------------------------------------------------
+
+void ts::AnalyzePlugin::main()
+{
+    for (;;) {
+        TSAnalyzerReport* analyzer = 0;
+        Time local_time;
+
+        // Wait for a report request.
+        {
+            GuardCondition lock(_report_mutex, _report_request);
+            while (_report_analyzer == 0 && !_report_terminate) {
+                lock.waitCondition();
+            }
+            if (_report_analyzer == 0) {
+                break;
+            }
+            analyzer = _report_analyzer;
+            local_time = _report_time;
+        }
+
+        // Produce the report and reset the analysis context for the next interval.
+        const bool ok = produceReport(*analyzer, local_time);
+        analyzer->reset();
+
+        // Give back the analysis context to the packet processing thread.
+        {
+            GuardCondition lock(_report_mutex, _report_done);
+            _report_analyzer = 0;
+            _report_error = _report_error || !ok;
+            lock.signal();
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Stop method
 //----------------------------------------------------------------------------
 
 bool ts::AnalyzePlugin::stop()
 {
-    produceReport();
+    // Complete the pending report and terminate the reporting thread.
+    if (_output_interval > 0) {
+        {
+            Guard lock(_report_mutex);
+            _report_terminate = true;
+            _report_request.signal();
+        }
+        Thread::waitForTermination();
+    }
+
+    // Set last known input bitrate as hint
+    _analyzer->setBitrateHint(tsp->bitrate());
+
+    // Final report.
+    produceReport(*_analyzer, Time::CurrentLocalTime());
     return true;
 }
 
@@ -267,7 +385,7 @@ ts::ProcessorPlugin::Status ts::AnalyzePlugin::processPacket (TSPacket& pkt, boo
     _current_packet++;
 
     // Feed the analyzer with one packet
-    _analyzer.feedPacket (pkt);
+    _analyzer->feedPacket (pkt);
 
     // With --interval, check if it is time to produce a report
     if (_output_interval > 0) {
@@ -283,12 +401,11 @@ ts::ProcessorPlugin::Status ts::AnalyzePlugin::processPacket (TSPacket& pkt, boo
                 computeNextReportTime(current_utc, _next_report_time - current_utc);
             }
             else {
-                // Time to produce a report
-                if (!produceReport()) {
+                // Time to produce a report. The report is produced in the background
+                // and the analysis continues with a new analysis context.
+                if (!requestReport()) {
                     return TSP_END;
                 }
-                // Reset analysis context
-                _analyzer.reset();
                 computeNextReportTime (current_utc, _output_interval);
             }
         }
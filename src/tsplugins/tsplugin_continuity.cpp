@@ -49,6 +49,7 @@ namespace ts {
         ContinuityPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, Status*, size_t, bool&, bool&) override;
 
     private:
         UString       _tag;            // Message tag
@@ -138,3 +139,13 @@ ts::ProcessorPlugin::Status ts::ContinuityPlugin::processPacket (TSPacket& pkt,
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method: inlined calls to processPacket().
+//----------------------------------------------------------------------------
+
+size_t ts::ContinuityPlugin::processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
+{
+    return processPacketBatchWith<ContinuityPlugin>(pkt, status, count, flush, bitrate_changed);
+}
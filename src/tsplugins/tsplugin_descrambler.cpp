@@ -51,6 +51,7 @@ namespace ts {
         DescramblerPlugin (TSP*);
         virtual bool start() override;
         virtual Status processPacket (TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, Status*, size_t, bool&, bool&) override;
 
     private:
         Scrambling::EntropyMode        _cw_mode;  // CW entropy mode
@@ -59,6 +60,12 @@ namespace ts {
         Scrambling                     _key;      // Preprocessed current control word
         uint8_t                        _last_scv; // Scrambling_control_value in last packet
         PIDSet                         _pids;     // List of PID's to descramble
+        bool                           _batch_mode; // Payloads are queued, see processPacketBatch()
+        std::vector<uint8_t*>          _batch_data; // Queued payloads to descramble with _key
+        std::vector<size_t>            _batch_size; // Sizes of queued payloads
+
+        // Descramble all queued payloads with the current key.
+        void flushBatch();
 
         // Inaccessible operations
         DescramblerPlugin() = delete;
@@ -82,7 +89,10 @@ ts::DescramblerPlugin::DescramblerPlugin(TSP* tsp_) :
     _next_cw(),
     _key(),
     _last_scv(0),
-    _pids()
+    _pids(),
+    _batch_mode(false),
+    _batch_data(),
+    _batch_size()
 {
     option(u"cw",                   'c', STRING);
     option(u"cw-file",              'f', STRING);
@@ -202,7 +212,8 @@ ts::ProcessorPlugin::Status ts::DescramblerPlugin::processPacket(TSPacket& pkt,
         if (_next_cw == _cw_list.end()) {
             _next_cw = _cw_list.begin();
         }
-        // Set key for DVB-CSA
+        // Set key for DVB-CSA, queued payloads use the previous one
+        flushBatch();
         _key.init(_next_cw->data(), _cw_mode);
         tsp->verbose(u"using control word: " + UString::Dump(*_next_cw, UString::SINGLE_LINE));
         // Point to next CW
@@ -211,11 +222,42 @@ ts::ProcessorPlugin::Status ts::DescramblerPlugin::processPacket(TSPacket& pkt,
         _last_scv = scv;
     }
 
-    // Descramble the packet payload
-    _key.decrypt (pkt.getPayload(), pkt.getPayloadSize());
+    // Descramble the packet payload, later in batch mode
+    if (_batch_mode) {
+        _batch_data.push_back(pkt.getPayload());
+        _batch_size.push_back(pkt.getPayloadSize());
+    }
+    else {
+        _key.decrypt(pkt.getPayload(), pkt.getPayloadSize());
+    }
 
     // Reset scrambling_control_value to zero in TS header
     pkt.setScrambling(SC_CLEAR);
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method: inlined calls to processPacket().
+// The payloads are queued and descrambled together using the batch
+// DVB-CSA implementation, at the end of the batch or before a CW change.
+//----------------------------------------------------------------------------
+
+size_t ts::DescramblerPlugin::processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
+{
+    _batch_mode = true;
+    const size_t processed = processPacketBatchWith<DescramblerPlugin>(pkt, status, count, flush, bitrate_changed);
+    flushBatch();
+    _batch_mode = false;
+    return processed;
+}
+
+void ts::DescramblerPlugin::flushBatch()
+{
+    if (!_batch_data.empty()) {
+        _key.decryptBatch(&_batch_data[0], &_batch_size[0], _batch_data.size());
+        _batch_data.clear();
+        _batch_size.clear();
+    }
+}
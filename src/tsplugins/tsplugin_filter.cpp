@@ -34,6 +34,7 @@
 
 #include "tsPlugin.h"
 #include "tsPluginRepository.h"
+#include "tsTSPacketHeaders.h"
 TSDUCK_SOURCE;
 
 
@@ -49,22 +50,31 @@ namespace ts {
         FilterPlugin (TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, Status*, size_t, bool&, bool&) override;
 
     private:
-        int    scrambling_ctrl;  // Scrambling control value (<0: no filter)
-        bool   with_payload;     // Packets with payload
-        bool   with_af;          // Packets with adaptation field
-        bool   with_pes;         // Packets with clear PES headers
-        bool   has_pcr;          // Packets with PCR or OPCR
-        bool   unit_start;       // Packets with payload unit start
-        bool   valid;            // Packets with valid sync byte and error ind
-        bool   negate;           // Negate filter (exclude selected packets)
-        bool   stuffing;         // Replace excluded packet with stuffing
-        int    min_payload;      // Minimum payload size (<0: no filter)
-        int    max_payload;      // Maximum payload size (<0: no filter)
-        int    min_af;           // Minimum adaptation field size (<0: no filter)
-        int    max_af;           // Maximum adaptation field size (<0: no filter)
-        PIDSet pid;              // PID values to filter
+        int                  scrambling_ctrl;  // Scrambling control value (<0: no filter)
+        bool                 with_payload;     // Packets with payload
+        bool                 with_af;          // Packets with adaptation field
+        bool                 with_pes;         // Packets with clear PES headers
+        bool                 has_pcr;          // Packets with PCR or OPCR
+        bool                 unit_start;       // Packets with payload unit start
+        bool                 valid;            // Packets with valid sync byte and error ind
+        bool                 negate;           // Negate filter (exclude selected packets)
+        bool                 stuffing;         // Replace excluded packet with stuffing
+        int                  min_payload;      // Minimum payload size (<0: no filter)
+        int                  max_payload;      // Maximum payload size (<0: no filter)
+        int                  min_af;           // Minimum adaptation field size (<0: no filter)
+        int                  max_af;           // Maximum adaptation field size (<0: no filter)
+        PIDSet               pid;              // PID values to filter
+        TSPacketHeaders      headers;          // Decoded headers of a batch of packets
+        std::vector<uint8_t> pid_ok;           // Packets of a batch with a selected PID
+
+        // Decode the headers of a batch of packets.
+        void decodeHeaders(const TSPacket* pkt, size_t count);
+
+        // Filter one packet, its header is at the given index in the last decoded batch.
+        Status filterPacket(const TSPacket& pkt, size_t index) const;
 
         // Inaccessible operations
         FilterPlugin() = delete;
@@ -96,7 +106,9 @@ ts::FilterPlugin::FilterPlugin(TSP* tsp_) :
     max_payload(0),
     min_af(0),
     max_af(0),
-    pid()
+    pid(),
+    headers(),
+    pid_ok()
 {
     option(u"adaptation-field",          0);
     option(u"clear",                    'c');
@@ -212,17 +224,54 @@ bool ts::FilterPlugin::start()
 // Packet processing method
 //----------------------------------------------------------------------------
 
-ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket (TSPacket& pkt, bool& flush, bool& bitrate_changed)
+ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, bool& flush, bool& bitrate_changed)
+{
+    decodeHeaders(&pkt, 1);
+    return filterPacket(pkt, 0);
+}
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method: all headers are decoded at once.
+//----------------------------------------------------------------------------
+
+size_t ts::FilterPlugin::processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
 {
+    decodeHeaders(pkt, count);
+    for (size_t n = 0; n < count; ++n) {
+        status[n] = pkt[n].b[0] == 0 ? TSP_DROP : filterPacket(pkt[n], n);
+    }
+    return count;
+}
+
 
+//----------------------------------------------------------------------------
+// Decode the headers of a batch of packets.
+//----------------------------------------------------------------------------
+
+void ts::FilterPlugin::decodeHeaders(const TSPacket* pkt, size_t count)
+{
+    headers.decode(pkt, count);
+    pid_ok.resize(count);
+    headers.matchPIDs(pid, pid_ok.data());
+}
+
+
+//----------------------------------------------------------------------------
+// Filter one packet.
+//----------------------------------------------------------------------------
+
+ts::ProcessorPlugin::Status ts::FilterPlugin::filterPacket(const TSPacket& pkt, size_t index) const
+{
     // Check if the packet matches one of the selected criteria.
 
-    bool ok = pid[pkt.getPID()] ||
-        (with_payload && pkt.hasPayload()) ||
-        (with_af && pkt.hasAF()) ||
-        (unit_start && pkt.getPUSI()) ||
-        (valid && pkt.hasValidSync() && !pkt.getTEI()) ||
-        (scrambling_ctrl == pkt.getScrambling()) ||
+    const uint8_t flags = headers.flags()[index];
+    bool ok = pid_ok[index] != 0 ||
+        (with_payload && (flags & TSPacketHeaders::HAS_PAYLOAD) != 0) ||
+        (with_af && (flags & TSPacketHeaders::HAS_AF) != 0) ||
+        (unit_start && (flags & TSPacketHeaders::PUSI) != 0) ||
+        (valid && (flags & (TSPacketHeaders::VALID_SYNC | TSPacketHeaders::TEI)) == TSPacketHeaders::VALID_SYNC) ||
+        (scrambling_ctrl == headers.getScrambling(index)) ||
         (has_pcr && (pkt.hasPCR() || pkt.hasOPCR())) ||
         (min_payload >= 0 && int (pkt.getPayloadSize()) >= min_payload) ||
         (int (pkt.getPayloadSize()) <= max_payload) ||
@@ -38,6 +38,9 @@
 #include "tsUDPSocket.h"
 #include "tsSysUtils.h"
 #include "tsTime.h"
+#include "tsMonotonic.h"
+#include "tsEnumeration.h"
+#include "tsSystemRandomGenerator.h"
 TSDUCK_SOURCE;
 
 // Grouping TS packets in UDP packets
@@ -45,6 +48,19 @@ TSDUCK_SOURCE;
 #define DEF_PACKET_BURST     7  // 1316 B, fits (with headers) in Ethernet MTU
 #define MAX_PACKET_BURST   128  // ~ 48 kB
 #define MAX_IP_SIZE      65536
+#define RECV_BATCH          32  // Max number of UDP messages per receive system call
+#define SEND_BATCH          64  // Max number of UDP messages per send system call
+#define MAX_PACING_LATE    100  // Max delay in milliseconds before re-synchronizing the pacing
+#define NO_PCR_INDEX (~size_t(0)) // No PCR in a UDP message
+
+// RTP encapsulation (RFC 3550 and RFC 2250)
+
+#define RTP_HEADER_SIZE     12  // Size of a fixed RTP header, without CSRC or extension
+#define RTP_PT_MP2T         33  // RTP payload type for MPEG-2 transport streams
+#define DEF_RTP_REORDER      8  // Default depth of the RTP reorder buffer, in messages
+#define MAX_RTP_REORDER    256  // Maximum depth of the RTP reorder buffer, in messages
+#define RTP_MAX_MISORDER   100  // Older messages are considered as a new RTP sequence (RFC 3550, A.1)
+#define RTP_MAX_DROPOUT   3000  // Larger gaps are considered as a new RTP sequence (RFC 3550, A.1)
 
 
 //----------------------------------------------------------------------------
@@ -81,9 +97,36 @@ namespace ts {
         SocketAddress _use_source;         // Filter on this socket address of sender.
         SocketAddress _first_source;       // Socket address of first received packet.
         std::set<SocketAddress> _sources;  // Set of all detected packet sources.
-        size_t        _inbuf_count;        // Remaining TS packets in inbuf
-        size_t        _inbuf_next;         // Index in inbuf of next TS packet to return
-        uint8_t       _inbuf[MAX_IP_SIZE]; // Input buffer
+        ByteBlock     _inbuf;              // Input buffer, for RECV_BATCH messages of MAX_IP_SIZE bytes
+        std::vector<UDPSocket::ReceivedMessage> _msgs; // Message descriptions in input buffer
+        size_t        _msg_count;          // Number of received messages in _msgs
+        size_t        _msg_next;           // Index in _msgs of next message to analyze
+        size_t        _inbuf_count;        // Remaining TS packets in current message
+        const uint8_t* _inbuf_next;        // Address of next TS packet to return
+        bool          _rtp;                // Decapsulate RTP messages
+        bool          _rtp_started;        // An RTP sequence has started
+        bool          _rtp_resync;         // Flushing the reorder buffer because of a new RTP sequence
+        uint16_t      _rtp_next;           // Next expected RTP sequence number
+        size_t        _rtp_base;           // Index in _rtp_slots of the message with sequence number _rtp_next
+        size_t        _rtp_buffered;       // Number of messages in the reorder buffer
+        size_t        _rtp_flush;          // Number of sequence numbers to flush from the reorder buffer
+        std::vector<ByteBlock> _rtp_slots; // RTP reorder buffer, empty slots are missing messages
+        ByteBlock     _rtp_current;        // Payload of the current RTP message, when extracted from the reorder buffer
+        ByteBlock     _rtp_deferred;       // Payload of an RTP message which was received while flushing
+        uint16_t      _rtp_deferred_seq;   // Sequence number of _rtp_deferred
+        bool          _rtp_has_deferred;   // _rtp_deferred is used
+        PacketCounter _rtp_reordered;      // Number of RTP messages which were reordered
+        PacketCounter _rtp_lost;           // Number of lost RTP messages
+        PacketCounter _rtp_dropped;        // Number of late or duplicated RTP messages
+
+        // Locate the TS packets in a received message. Return true if some were found.
+        bool locatePackets(const UDPSocket::ReceivedMessage& msg);
+        bool locateTSPackets(const uint8_t* data, size_t size);
+        bool locateRTPPayload(const uint8_t* data, size_t size);
+
+        // Get the next RTP message from the reorder buffer. Return true if some TS packets are available.
+        bool nextRTPMessage();
+        void advanceRTP(size_t count);
 
         // Inaccessible operations
         IPInput() = delete;
@@ -103,8 +146,46 @@ namespace ts {
         virtual bool send(const TSPacket*, size_t) override;
 
     private:
-        UDPSocket _sock;        // Outgoing socket
-        size_t    _pkt_burst;   // Number of TS packets per UDP message
+        // Pacing modes.
+        enum {PACING_NONE, PACING_BITRATE, PACING_PCR};
+
+        const Enumeration _pacing_names;  // Names of pacing modes
+        UDPSocket     _sock;          // Outgoing socket
+        size_t        _pkt_burst;     // Number of TS packets per UDP message
+        bool          _rtp;           // Use RTP encapsulation
+        uint8_t       _rtp_pt;        // RTP payload type
+        uint32_t      _rtp_ssrc;      // RTP synchronization source identifier
+        uint16_t      _rtp_seq;       // RTP sequence number of next message
+        Monotonic     _rtp_start;     // Origin of RTP timestamps before the first PCR
+        ByteBlock     _rtp_headers;   // RTP headers of the messages in _msgs
+        int           _pacing;        // Pacing mode
+        NanoSecond    _precision;     // Guaranteed precision of the system timers
+        std::vector<UDPSocket::OutgoingMessage> _msgs;  // Messages to send in one system call
+        bool          _due_valid;     // The due time of next message is valid
+        Monotonic     _due;           // Due time of next UDP message
+        bool          _pace_valid;    // A PCR pacing sequence is in progress
+        Monotonic     _pace_origin;   // Time of first PCR in current PCR pacing sequence
+        uint64_t      _pace_elapsed;  // PCR units since _pace_origin
+        PID           _pcr_pid;       // Reference PID for PCR's
+        bool          _pcr_valid;     // At least one PCR was found in the reference PID
+        uint64_t      _pcr_last;      // Last PCR value in reference PID
+        PacketCounter _pcr_last_pkt;  // Packet index of last PCR
+        PacketCounter _pkt_count;     // Number of sent packets
+        BitRate       _pcr_bitrate;   // Bitrate between the two last PCR's
+
+        // Look for a PCR from the reference PID in a UDP message. Return the index
+        // of the packet or NO_PCR_INDEX if there is none. Also return the difference with
+        // the previous PCR, zero if this PCR starts a new sequence.
+        size_t findPCR(const TSPacket* pkt, size_t count, uint64_t& diff);
+
+        // Compute the due time of the next UDP message.
+        void computeDueTime(size_t pcr_index, uint64_t pcr_diff);
+
+        // Build the RTP header of the next UDP message.
+        void buildRTPHeader(uint8_t* header);
+
+        // Send all accumulated messages.
+        bool flushMessages();
 
         // Inaccessible operations
         IPOutput() = delete;
@@ -139,9 +220,27 @@ ts::IPInput::IPInput(TSP* tsp_) :
     _use_source(),
     _first_source(),
     _sources(),
+    _inbuf(),
+    _msgs(),
+    _msg_count(0),
+    _msg_next(0),
     _inbuf_count(0),
     _inbuf_next(0),
-    _inbuf()
+    _rtp(false),
+    _rtp_started(false),
+    _rtp_resync(false),
+    _rtp_next(0),
+    _rtp_base(0),
+    _rtp_buffered(0),
+    _rtp_flush(0),
+    _rtp_slots(),
+    _rtp_current(),
+    _rtp_deferred(),
+    _rtp_deferred_seq(0),
+    _rtp_has_deferred(false),
+    _rtp_reordered(0),
+    _rtp_lost(0),
+    _rtp_dropped(0)
 {
     option(u"",                     0,  STRING, 1, 1);
     option(u"buffer-size",         'b', UNSIGNED);
@@ -149,7 +248,9 @@ ts::IPInput::IPInput(TSP* tsp_) :
     option(u"evaluation-interval", 'e', POSITIVE);
     option(u"first-source",        'f');
     option(u"local-address",       'l', STRING);
+    option(u"reorder-buffer",       0,  INTEGER, 0, 1, 1, MAX_RTP_REORDER);
     option(u"reuse-port",          'r');
+    option(u"rtp",                  0);
     option(u"source",              's', STRING);
 
     setHelp(u"Parameter:\n"
@@ -197,10 +298,23 @@ ts::IPInput::IPInput(TSP* tsp_) :
             u"      It can be also a host name that translates to a local address.\n"
             u"      By default, listen on all local interfaces.\n"
             u"\n"
+            u"  --reorder-buffer count\n"
+            u"      With --rtp, specify the maximum number of out-of-order RTP messages\n"
+            u"      which are kept to restore the order of the sequence numbers. When a\n"
+            u"      message is still missing after this number of subsequent messages, it\n"
+            u"      is considered as lost. The default is " TS_STRINGIFY(DEF_RTP_REORDER) u" messages, the maximum\n"
+            u"      is " TS_STRINGIFY(MAX_RTP_REORDER) u".\n"
+            u"\n"
             u"  -r\n"
             u"  --reuse-port\n"
             u"      Set the reuse port socket option.\n"
             u"\n"
+            u"  --rtp\n"
+            u"      The UDP messages are RTP messages (RFC 3550, RFC 2250). The RTP headers\n"
+            u"      are removed and the messages are reordered according to their RTP\n"
+            u"      sequence numbers. Without this option, a header before the TS packets,\n"
+            u"      such as an RTP header, is ignored but no reordering is performed.\n"
+            u"\n"
             u"  -s address[:port]\n"
             u"  --source address[:port]\n"
             u"      Filter UDP packets based on the specified source address. This option is\n"
@@ -220,12 +334,38 @@ ts::IPInput::IPInput(TSP* tsp_) :
 
 ts::IPOutput::IPOutput(TSP* tsp_) :
     OutputPlugin(tsp_, u"Send TS packets using UDP/IP, multicast or unicast.", u"[options] address:port"),
+    _pacing_names({{u"bitrate", PACING_BITRATE}, {u"pcr", PACING_PCR}}),
     _sock(false, *tsp_),
-    _pkt_burst(DEF_PACKET_BURST)
+    _pkt_burst(DEF_PACKET_BURST),
+    _rtp(false),
+    _rtp_pt(RTP_PT_MP2T),
+    _rtp_ssrc(0),
+    _rtp_seq(0),
+    _rtp_start(),
+    _rtp_headers(),
+    _pacing(PACING_NONE),
+    _precision(0),
+    _msgs(),
+    _due_valid(false),
+    _due(),
+    _pace_valid(false),
+    _pace_origin(),
+    _pace_elapsed(0),
+    _pcr_pid(PID_NULL),
+    _pcr_valid(false),
+    _pcr_last(0),
+    _pcr_last_pkt(0),
+    _pkt_count(0),
+    _pcr_bitrate(0)
 {
     option(u"",               0,  STRING, 1, 1);
     option(u"local-address", 'l', STRING);
+    option(u"pacing",         0,  _pacing_names);
     option(u"packet-burst",  'p', INTEGER, 0, 1, 1, MAX_PACKET_BURST);
+    option(u"payload-type",   0,  INTEGER, 0, 1, 0, 127);
+    option(u"pcr-pid",        0,  PIDVAL);
+    option(u"rtp",            0);
+    option(u"ssrc-identifier", 0, UINT32);
     option(u"ttl",           't', POSITIVE);
 
     setHelp(u"Parameter:\n"
@@ -245,12 +385,39 @@ ts::IPOutput::IPOutput(TSP* tsp_) :
             u"      of the outgoing local interface. It can be also a host name that\n"
             u"      translates to a local address.\n"
             u"\n"
+            u"  --pacing mode\n"
+            u"      Regulate the emission of UDP packets. The mode is either \"bitrate\" or\n"
+            u"      \"pcr\". With \"bitrate\", the UDP packets are evenly spaced according\n"
+            u"      to the bitrate of the transport stream, as computed by tsp. With \"pcr\",\n"
+            u"      each UDP packet is sent at the time which is indicated by the PCR's in\n"
+            u"      the reference PID. By default, the packets are sent as soon as they are\n"
+            u"      available, several UDP packets being sent in one single system call\n"
+            u"      when possible.\n"
+            u"\n"
             u"  -p value\n"
             u"  --packet-burst value\n"
             u"      Specifies how many TS packets should be grouped into a UDP packet.\n"
             u"      The default is " TS_STRINGIFY(DEF_PACKET_BURST) u", the maximum is "
             TS_STRINGIFY(MAX_PACKET_BURST) u".\n"
             u"\n"
+            u"  --payload-type value\n"
+            u"      With --rtp, specify the payload type of the RTP messages. The default is\n"
+            u"      " TS_STRINGIFY(RTP_PT_MP2T) u", the standard value for MPEG-2 transport streams.\n"
+            u"\n"
+            u"  --pcr-pid value\n"
+            u"      Specifies the reference PID for the PCR's which are used by --pacing pcr\n"
+            u"      and to compute the RTP timestamps. By default, use the first PID\n"
+            u"      containing PCR's.\n"
+            u"\n"
+            u"  --rtp\n"
+            u"      Encapsulate the TS packets in RTP messages (RFC 3550, RFC 2250). The\n"
+            u"      RTP timestamps, at 90 kHz, are computed from the PCR's of the reference\n"
+            u"      PID. By default, the TS packets are directly sent in UDP messages.\n"
+            u"\n"
+            u"  --ssrc-identifier value\n"
+            u"      With --rtp, specify the synchronization source (SSRC) identifier of the\n"
+            u"      RTP messages. By default, a random value is used.\n"
+            u"\n"
             u"  -t value\n"
             u"  --ttl value\n"
             u"      Specifies the TTL (Time-To-Live) socket option. The actual option\n"
@@ -276,6 +443,8 @@ bool ts::IPInput::start()
     UString local(value(u"local-address"));
     size_t recv_bufsize = intValue<size_t>(u"buffer-size", 0);
     bool reuse_port = present(u"reuse-port");
+    _rtp = present(u"rtp");
+    const size_t rtp_reorder = intValue<size_t>(u"reorder-buffer", DEF_RTP_REORDER);
     _use_first_source = present(u"first-source");
     UString source(value(u"source"));
 
@@ -342,7 +511,20 @@ bool ts::IPInput::start()
 
     // Socket now ready.
     // Initialize working data.
-    _inbuf_count = _inbuf_next = 0;
+    _inbuf.resize(RECV_BATCH * MAX_IP_SIZE);
+    _msgs.clear();
+    for (size_t i = 0; i < RECV_BATCH; ++i) {
+        _msgs.push_back(UDPSocket::ReceivedMessage(&_inbuf[i * MAX_IP_SIZE], MAX_IP_SIZE));
+    }
+    _msg_count = _msg_next = 0;
+    _inbuf_count = 0;
+    _inbuf_next = 0;
+    _rtp_started = _rtp_resync = _rtp_has_deferred = false;
+    _rtp_next = 0;
+    _rtp_base = _rtp_buffered = _rtp_flush = 0;
+    _rtp_slots.clear();
+    _rtp_slots.resize(rtp_reorder);
+    _rtp_reordered = _rtp_lost = _rtp_dropped = 0;
     _start = _start_0 = _start_1 = _next_display = Time::Epoch;
     _packets = _packets_0 = _packets_1 = 0;
     _first_source.clear();
@@ -358,6 +540,9 @@ bool ts::IPInput::start()
 
 bool ts::IPInput::stop()
 {
+    if (_rtp) {
+        tsp->verbose(u"RTP messages: %'d reordered, %'d lost, %'d late or duplicated", {_rtp_reordered, _rtp_lost, _rtp_dropped});
+    }
     _sock.close();
     return true;
 }
@@ -398,133 +583,45 @@ ts::BitRate ts::IPInput::getBitrate()
 
 size_t ts::IPInput::receive(TSPacket* buffer, size_t max_packets)
 {
-    // Check if we receive new packets or process remain of previous buffer.
-    bool new_packets = false;
-
-    // If there is no remaining packet in the input buffer, wait for a UDP
-    // message. Loop until we get some TS packets.
-    while (_inbuf_count <= 0) {
-
-        // Wait for a UDP message
-        SocketAddress sender;
-        SocketAddress destination;
-        size_t insize;
-        if (!_sock.receive(_inbuf, sizeof(_inbuf), insize, sender, destination, tsp, *tsp)) {
-            return 0;
+    size_t pkt_cnt = 0;
+
+    // Fill the input window with TS packets from as many UDP messages as possible.
+    // Several UDP messages are received using one single system call. We wait for
+    // new messages only when no packet at all is available.
+    while (pkt_cnt < max_packets) {
+
+        if (_inbuf_count > 0) {
+            // Return remaining packets from current UDP message.
+            const size_t count = std::min(_inbuf_count, max_packets - pkt_cnt);
+            ::memcpy(buffer[pkt_cnt].b, _inbuf_next, count * PKT_SIZE);
+            pkt_cnt += count;
+            _inbuf_count -= count;
+            _inbuf_next += count * PKT_SIZE;
         }
-        tsp->log(2, u"received UDP packet, source: %s, destination: %s", {sender.toString(), destination.toString()});
-
-        // Check the destination address to exclude packets from other streams.
-        // When several multicast streams use the same destination port and several
-        // applications on the same system listen to these distinct streams,
-        // the multicast MAC address management is such that any socket which
-        // is bound to the common port will receive the traffic for all streams.
-        // This is why we need to check the destination address and exclude
-        // packets which are not from the intended stream.
-        //
-        // We accept a packet in any of:
-        // 1) Actual packet destination is unknown. Probably, the system cannot
-        //    report the destination address.
-        // 2) We listen to a multicast address and the actual destination is the same.
-        // 3) If we listen to unicast traffic and the actual destination is unicast.
-        //    In that case, unicast is by definition sent to us.
-
-        if (destination.hasAddress() && ((_dest_addr.hasAddress() && destination != _dest_addr) || (!_dest_addr.hasAddress() && destination.isMulticast()))) {
-            // This is a spurious packet.
-            continue;
+        else if (_rtp && nextRTPMessage()) {
+            // Got TS packets from a message in the RTP reorder buffer.
         }
-
-        // Keep track of the first sender address.
-        if (!_first_source.hasAddress()) {
-            // First packet, keep address of the sender.
-            _first_source = sender;
-            _sources.insert(sender);
-
-            // With option --first-source, use this one to filter packets.
-            if (_use_first_source) {
-                assert(!_use_source.hasAddress());
-                _use_source = sender;
-                tsp->verbose(u"now filtering on source address %s", {sender.toString()});
-            }
+        else if (_msg_next < _msg_count) {
+            // Locate TS packets in next UDP message.
+            locatePackets(_msgs[_msg_next++]);
         }
-
-        // Keep track of senders (sources) to detect or filter multiple sources.
-        if (_sources.count(sender) == 0) {
-            // Detected an additional source, warn the user that distinct streams are potentially mixed.
-            // If no source filtering is applied, this is a warning since this may affect the resulting stream.
-            // With source filtering, this is just an informational verbose-level message.
-            const int level = _use_source.hasAddress() ? Severity::Verbose : Severity::Warning;
-            tsp->log(level, u"detected multiple sources for the same destination %s with potentially distinct streams", {destination.toString()});
-            if (_sources.size() == 1) {
-                tsp->log(level, u"detected source: %s", {_first_source.toString()});
-            }
-            tsp->log(level, u"detected source: %s", {sender.toString()});
-            _sources.insert(sender);
-        }
-
-        // Filter packets based on source address if requested.
-        if ((_use_source.hasAddress() && _use_source.address() != sender.address()) || (_use_source.hasPort() && _use_source.port() != sender.port())) {
-            // Not the expected source, this is a spurious packet.
-            continue;
-        }
-
-        // Locate the TS packets inside the UDP message. Basically, we
-        // expect the message to contain only TS packets. However, we
-        // will face the following situations:
-        // - Presence of a header preceeding the first TS packet (typically
-        //   when the TS packets are encapsulated in RTP).
-        // - Presence of a truncated packet at the end of message.
-
-        // To face the first situation, we look backward from the end of
-        // the message, looking for a 0x47 sync byte every 188 bytes, going
-        // backward.
-
-        const uint8_t* p;
-        for (p = _inbuf + insize; p >= _inbuf + PKT_SIZE && p[-int(PKT_SIZE)] == SYNC_BYTE; p -= PKT_SIZE) {}
-
-        if (p < _inbuf + insize) {
-            // Some packets were found
-            _inbuf_next = p - _inbuf;
-            _inbuf_count = (_inbuf + insize - p) / PKT_SIZE;
-            new_packets = true;
-            break; // exit receive loop
+        else if (pkt_cnt > 0) {
+            // No more received message, do not wait, return what we have.
+            break;
         }
-
-        // If no TS packet is found using the first method, we restart from
-        // the beginning of the message, looking for a 0x47 sync byte every
-        // 188 bytes, going forward. If we find this pattern, followed by
-        // less than 188 bytes, then we have found a sequence of TS packets.
-
-        const uint8_t* max = _inbuf + insize - PKT_SIZE; // max address for a TS packet
-        _inbuf_count = 0;
-
-        for (p = _inbuf; p <= max; p++) {
-            if (*p == SYNC_BYTE) {
-                // Verify that we get a 0x47 sync byte every 188 bytes up
-                // to the end of message (not leaving more than one truncated
-                // TS packet at the end of the message).
-                const uint8_t* end;
-                for (end = p; end <= max && *end == SYNC_BYTE; end += PKT_SIZE) {}
-                if (end > max) {
-                    // Less than 188 bytes after last packet. Consider we are OK
-                    _inbuf_next = p - _inbuf;
-                    _inbuf_count = (end - p) / PKT_SIZE;
-                    new_packets = true;
-                    break; // exit packet search loop
-                }
+        else {
+            // Wait for a batch of UDP messages.
+            _msg_next = 0;
+            if (!_sock.receive(&_msgs[0], _msgs.size(), _msg_count, tsp, *tsp)) {
+                _msg_count = 0;
+                return 0;
             }
+            tsp->log(2, u"received %d UDP packets", {_msg_count});
         }
-
-        if (new_packets) {
-            break; // exit receive loop
-        }
-
-        // No TS packet found in UDP message, wait for another one.
-        tsp->debug(u"no TS packet in message from %s, %s bytes", {sender.toString(), insize});
     }
 
     // If new packets were received, we may need to re-evaluate the real-time input bitrate.
-    if (new_packets && _eval_time > 0) {
+    if (pkt_cnt > 0 && _eval_time > 0) {
 
         const Time now(Time::CurrentUTC());
 
@@ -537,9 +634,9 @@ size_t ts::IPInput::receive(TSPacket* buffer, size_t max_packets)
         }
 
         // Count packets
-        _packets += _inbuf_count;
-        _packets_0 += _inbuf_count;
-        _packets_1 += _inbuf_count;
+        _packets += pkt_cnt;
+        _packets_0 += pkt_cnt;
+        _packets_1 += pkt_cnt;
 
         // Detect new evaluation period
         if (now >= _start_1 + _eval_time) {
@@ -563,16 +660,311 @@ size_t ts::IPInput::receive(TSPacket* buffer, size_t max_packets)
         }
     }
 
-    // Return packets from the input buffer
-    size_t pkt_cnt = std::min(_inbuf_count, max_packets);
-    ::memcpy(buffer, _inbuf + _inbuf_next, pkt_cnt * PKT_SIZE);
-    _inbuf_count -= pkt_cnt;
-    _inbuf_next += pkt_cnt * PKT_SIZE;
-
     return pkt_cnt;
 }
 
 
+//----------------------------------------------------------------------------
+// Locate the TS packets in a received message.
+// On success, set _inbuf_next and _inbuf_count.
+//----------------------------------------------------------------------------
+
+bool ts::IPInput::locatePackets(const UDPSocket::ReceivedMessage& msg)
+{
+    const SocketAddress& sender(msg.sender);
+    const SocketAddress& destination(msg.destination);
+    const uint8_t* const data = static_cast<const uint8_t*>(msg.data);
+    const size_t insize = msg.size;
+
+    _inbuf_next = 0;
+    _inbuf_count = 0;
+    tsp->log(2, u"received UDP packet, source: %s, destination: %s", {sender.toString(), destination.toString()});
+
+    // Check the destination address to exclude packets from other streams.
+    // When several multicast streams use the same destination port and several
+    // applications on the same system listen to these distinct streams,
+    // the multicast MAC address management is such that any socket which
+    // is bound to the common port will receive the traffic for all streams.
+    // This is why we need to check the destination address and exclude
+    // packets which are not from the intended stream.
+    //
+    // We accept a packet in any of:
+    // 1) Actual packet destination is unknown. Probably, the system cannot
+    //    report the destination address.
+    // 2) We listen to a multicast address and the actual destination is the same.
+    // 3) If we listen to unicast traffic and the actual destination is unicast.
+    //    In that case, unicast is by definition sent to us.
+
+    if (destination.hasAddress() && ((_dest_addr.hasAddress() && destination != _dest_addr) || (!_dest_addr.hasAddress() && destination.isMulticast()))) {
+        // This is a spurious packet.
+        return false;
+    }
+
+    // Keep track of the first sender address.
+    if (!_first_source.hasAddress()) {
+        // First packet, keep address of the sender.
+        _first_source = sender;
+        _sources.insert(sender);
+
+        // With option --first-source, use this one to filter packets.
+        if (_use_first_source) {
+            assert(!_use_source.hasAddress());
+            _use_source = sender;
+            tsp->verbose(u"now filtering on source address %s", {sender.toString()});
+        }
+    }
+
+    // Keep track of senders (sources) to detect or filter multiple sources.
+    if (_sources.count(sender) == 0) {
+        // Detected an additional source, warn the user that distinct streams are potentially mixed.
+        // If no source filtering is applied, this is a warning since this may affect the resulting stream.
+        // With source filtering, this is just an informational verbose-level message.
+        const int level = _use_source.hasAddress() ? Severity::Verbose : Severity::Warning;
+        tsp->log(level, u"detected multiple sources for the same destination %s with potentially distinct streams", {destination.toString()});
+        if (_sources.size() == 1) {
+            tsp->log(level, u"detected source: %s", {_first_source.toString()});
+        }
+        tsp->log(level, u"detected source: %s", {sender.toString()});
+        _sources.insert(sender);
+    }
+
+    // Filter packets based on source address if requested.
+    if ((_use_source.hasAddress() && _use_source.address() != sender.address()) || (_use_source.hasPort() && _use_source.port() != sender.port())) {
+        // Not the expected source, this is a spurious packet.
+        return false;
+    }
+
+    // Locate the TS packets in the RTP payload. Out-of-order RTP messages
+    // are kept in the reorder buffer and their packets are returned later.
+    if (_rtp) {
+        return locateRTPPayload(data, insize);
+    }
+    else if (locateTSPackets(data, insize)) {
+        return true;
+    }
+    else {
+        tsp->debug(u"no TS packet in message from %s, %s bytes", {sender.toString(), insize});
+        return false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Locate the TS packets in a memory area.
+// On success, set _inbuf_next and _inbuf_count.
+//----------------------------------------------------------------------------
+
+bool ts::IPInput::locateTSPackets(const uint8_t* data, size_t insize)
+{
+    _inbuf_next = 0;
+    _inbuf_count = 0;
+
+    // Locate the TS packets inside the UDP message. Basically, we
+    // expect the message to contain only TS packets. However, we
+    // will face the following situations:
+    // - Presence of a header preceeding the first TS packet (typically
+    //   when the TS packets are encapsulated in RTP).
+    // - Presence of a truncated packet at the end of message.
+
+    // To face the first situation, we look backward from the end of
+    // the message, looking for a 0x47 sync byte every 188 bytes, going
+    // backward.
+
+    const uint8_t* p;
+    for (p = data + insize; p >= data + PKT_SIZE && p[-int(PKT_SIZE)] == SYNC_BYTE; p -= PKT_SIZE) {}
+
+    if (p < data + insize) {
+        // Some packets were found
+        _inbuf_next = p;
+        _inbuf_count = (data + insize - p) / PKT_SIZE;
+        return true;
+    }
+
+    // If no TS packet is found using the first method, we restart from
+    // the beginning of the message, looking for a 0x47 sync byte every
+    // 188 bytes, going forward. If we find this pattern, followed by
+    // less than 188 bytes, then we have found a sequence of TS packets.
+
+    if (insize >= PKT_SIZE) {
+        const uint8_t* max = data + insize - PKT_SIZE; // max address for a TS packet
+        for (p = data; p <= max; p++) {
+            if (*p == SYNC_BYTE) {
+                // Verify that we get a 0x47 sync byte every 188 bytes up
+                // to the end of message (not leaving more than one truncated
+                // TS packet at the end of the message).
+                const uint8_t* end;
+                for (end = p; end <= max && *end == SYNC_BYTE; end += PKT_SIZE) {}
+                if (end > max) {
+                    // Less than 188 bytes after last packet. Consider we are OK
+                    _inbuf_next = p;
+                    _inbuf_count = (end - p) / PKT_SIZE;
+                    return true;
+                }
+            }
+        }
+    }
+
+    // No TS packet found in UDP message.
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Locate the TS packets in an RTP message.
+// Messages which are out of sequence are kept in the reorder buffer.
+// On success, set _inbuf_next and _inbuf_count.
+//----------------------------------------------------------------------------
+
+bool ts::IPInput::locateRTPPayload(const uint8_t* data, size_t size)
+{
+    _inbuf_next = 0;
+    _inbuf_count = 0;
+
+    // Analyze the RTP header: version 2, optional CSRC list, extension and padding.
+    if (size < RTP_HEADER_SIZE || (data[0] & 0xC0) != 0x80) {
+        tsp->debug(u"invalid RTP header, ignoring message");
+        return false;
+    }
+    const uint16_t seq = GetUInt16(data + 2);
+    size_t header_size = RTP_HEADER_SIZE + 4 * (data[0] & 0x0F);
+    if ((data[0] & 0x10) != 0 && header_size + 4 <= size) {
+        header_size += 4 + 4 * GetUInt16(data + header_size + 2);
+    }
+    const size_t padding = (data[0] & 0x20) != 0 ? data[size - 1] : 0;
+    if (header_size + padding > size) {
+        tsp->debug(u"invalid RTP header, ignoring message");
+        return false;
+    }
+    const uint8_t* const payload = data + header_size;
+    const size_t payload_size = size - header_size - padding;
+
+    // The first message starts the RTP sequence.
+    if (!_rtp_started) {
+        _rtp_started = true;
+        _rtp_next = seq;
+    }
+
+    // Position of this message relative to the next expected one.
+    const int diff = int16_t(uint16_t(seq - _rtp_next));
+    const size_t depth = _rtp_slots.size();
+
+    if (diff == 0) {
+        // Expected message, the TS packets are directly returned from the input buffer.
+        advanceRTP(1);
+        return locateTSPackets(payload, payload_size);
+    }
+    else if (diff < 0 && diff >= -RTP_MAX_MISORDER) {
+        // Late or duplicated message, its sequence number was already processed.
+        tsp->debug(u"dropping late RTP message, sequence: %d, expected: %d", {seq, _rtp_next});
+        _rtp_dropped++;
+        return false;
+    }
+    else if (diff > 0 && size_t(diff) < depth) {
+        // Out-of-order message, keep it in the reorder buffer until the previous ones are received.
+        ByteBlock& slot(_rtp_slots[(_rtp_base + diff) % depth]);
+        if (slot.empty()) {
+            slot.copy(payload, payload_size);
+            _rtp_buffered++;
+            _rtp_reordered++;
+        }
+        else {
+            _rtp_dropped++;
+        }
+        return false;
+    }
+    else {
+        // Either some messages were lost or a new RTP sequence starts. In both cases,
+        // the reorder buffer must be flushed first. The message is processed later.
+        _rtp_resync = diff < 0 || diff > RTP_MAX_DROPOUT;
+        _rtp_flush = _rtp_resync ? depth : diff - depth + 1;
+        _rtp_deferred.copy(payload, payload_size);
+        _rtp_deferred_seq = seq;
+        _rtp_has_deferred = true;
+        if (_rtp_resync) {
+            tsp->verbose(u"new RTP sequence, sequence number %d, expected %d", {seq, _rtp_next});
+        }
+        return false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Advance the RTP sequence by a number of messages.
+//----------------------------------------------------------------------------
+
+void ts::IPInput::advanceRTP(size_t count)
+{
+    _rtp_next = uint16_t(_rtp_next + count);
+    _rtp_base = (_rtp_base + count) % _rtp_slots.size();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the next RTP message from the reorder buffer.
+// On success, set _inbuf_next and _inbuf_count.
+//----------------------------------------------------------------------------
+
+bool ts::IPInput::nextRTPMessage()
+{
+    while (_rtp_buffered > 0 || _rtp_flush > 0 || _rtp_has_deferred) {
+
+        ByteBlock& slot(_rtp_slots[_rtp_base]);
+
+        if (!slot.empty()) {
+            // The next message in sequence is in the reorder buffer.
+            _rtp_current.swap(slot);
+            slot.clear();
+            _rtp_buffered--;
+            advanceRTP(1);
+            if (_rtp_flush > 0) {
+                _rtp_flush--;
+            }
+            if (locateTSPackets(_rtp_current.data(), _rtp_current.size())) {
+                return true;
+            }
+        }
+        else if (_rtp_flush > 0) {
+            // The next message in sequence is missing, skip it. When the reorder buffer
+            // is empty, directly skip all remaining sequence numbers to flush.
+            const size_t count = _rtp_buffered == 0 ? _rtp_flush : 1;
+            if (!_rtp_resync) {
+                _rtp_lost += count;
+            }
+            _rtp_flush -= count;
+            advanceRTP(count);
+        }
+        else if (_rtp_has_deferred) {
+            // Now process the message which triggered the flush.
+            _rtp_has_deferred = false;
+            if (_rtp_resync) {
+                // The reorder buffer is now empty, restart at this message.
+                _rtp_resync = false;
+                _rtp_next = _rtp_deferred_seq;
+            }
+            const size_t diff = uint16_t(_rtp_deferred_seq - _rtp_next);
+            if (diff == 0) {
+                _rtp_current.swap(_rtp_deferred);
+                advanceRTP(1);
+                if (locateTSPackets(_rtp_current.data(), _rtp_current.size())) {
+                    return true;
+                }
+            }
+            else {
+                // Cannot be larger than the reorder buffer after flushing.
+                assert(diff < _rtp_slots.size());
+                _rtp_slots[(_rtp_base + diff) % _rtp_slots.size()].swap(_rtp_deferred);
+                _rtp_buffered++;
+            }
+        }
+        else {
+            // The next message in sequence is not yet received.
+            break;
+        }
+    }
+    return false;
+}
+
+
 //----------------------------------------------------------------------------
 // Output start method
 //----------------------------------------------------------------------------
@@ -584,6 +976,31 @@ bool ts::IPOutput::start()
     UString loc_name(value(u"local-address"));
     int ttl = intValue(u"ttl", 0);
     _pkt_burst = intValue(u"packet-burst", DEF_PACKET_BURST);
+    _pacing = intValue<int>(u"pacing", PACING_NONE);
+    _pcr_pid = intValue<PID>(u"pcr-pid", PID_NULL);
+    _rtp = present(u"rtp");
+    _rtp_pt = intValue<uint8_t>(u"payload-type", RTP_PT_MP2T);
+
+    // The default SSRC identifier and initial sequence number are random (RFC 3550).
+    uint32_t rand = 0;
+    SystemRandomGenerator prng;
+    prng.read(&rand, sizeof(rand));
+    _rtp_ssrc = intValue<uint32_t>(u"ssrc-identifier", rand);
+    _rtp_seq = uint16_t(rand >> 16);
+    _rtp_start.getSystemTime();
+    _rtp_headers.resize(SEND_BATCH * RTP_HEADER_SIZE);
+
+    // Initialize pacing.
+    _precision = _pacing == PACING_NONE ? 0 : Monotonic::SetPrecision(2000000); // 2 ms
+    _msgs.clear();
+    _msgs.reserve(SEND_BATCH);
+    _due_valid = false;
+    _pace_valid = false;
+    _pace_elapsed = 0;
+    _pcr_valid = false;
+    _pcr_last = 0;
+    _pcr_last_pkt = _pkt_count = 0;
+    _pcr_bitrate = 0;
 
     // Create UDP socket
     bool ok = _sock.open(*tsp);
@@ -629,15 +1046,180 @@ ts::IPOutput::~IPOutput()
 bool ts::IPOutput::send(const TSPacket* pkt, size_t packet_count)
 {
     // Send TS packets in UDP messages, grouped according to burst size.
+    // Several UDP messages are sent using one single system call.
 
     while (packet_count > 0) {
-        size_t count = std::min(packet_count, _pkt_burst);
-        if (!_sock.send(pkt, count * PKT_SIZE, *tsp)) {
+        const size_t count = std::min(packet_count, _pkt_burst);
+
+        // Locate PCR's when they are needed.
+        uint64_t pcr_diff = 0;
+        const size_t pcr_index = _rtp || _pacing == PACING_PCR ? findPCR(pkt, count, pcr_diff) : NO_PCR_INDEX;
+
+        if (_pacing != PACING_NONE) {
+            // Compute the due time of this UDP message. If it is not due
+            // yet, send the previous messages and wait for the due time.
+            computeDueTime(pcr_index, pcr_diff);
+            Monotonic now;
+            now.getSystemTime();
+            if (_due > now && _due - now > _precision) {
+                if (!flushMessages()) {
+                    return false;
+                }
+                _due.wait();
+            }
+            else if (now - _due > MAX_PACING_LATE * NanoSecPerMilliSec) {
+                // Too late, we cannot catch up, resynchronize on current time.
+                tsp->debug(u"pacing is %'d ms late, resynchronizing", {(now - _due) / NanoSecPerMilliSec});
+                _due = now;
+                _pace_valid = false;
+            }
+        }
+
+        // Enqueue the message, with its RTP header if necessary.
+        if (_rtp) {
+            uint8_t* header = &_rtp_headers[_msgs.size() * RTP_HEADER_SIZE];
+            buildRTPHeader(header);
+            _msgs.push_back(UDPSocket::OutgoingMessage(pkt, count * PKT_SIZE, header, RTP_HEADER_SIZE));
+        }
+        else {
+            _msgs.push_back(UDPSocket::OutgoingMessage(pkt, count * PKT_SIZE));
+        }
+        if (_msgs.size() >= SEND_BATCH && !flushMessages()) {
             return false;
         }
+
+        // Space the next message from this one according to the bitrate.
+        if (_pacing != PACING_NONE) {
+            const BitRate bitrate = _pacing == PACING_PCR && _pcr_bitrate > 0 ? _pcr_bitrate : tsp->bitrate();
+            if (bitrate > 0) {
+                _due += NanoSecond((count * PKT_SIZE * 8 * NanoSecPerSec) / bitrate);
+            }
+        }
+
         pkt += count;
         packet_count -= count;
+        _pkt_count += count;
     }
 
-    return true;
+    // Do not keep messages across calls, the packet buffer is released on return.
+    return flushMessages();
+}
+
+
+//----------------------------------------------------------------------------
+// Send all accumulated messages.
+//----------------------------------------------------------------------------
+
+bool ts::IPOutput::flushMessages()
+{
+    const bool ok = _msgs.empty() || _sock.send(&_msgs[0], _msgs.size(), *tsp);
+    _msgs.clear();
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Look for a PCR from the reference PID in a UDP message.
+//----------------------------------------------------------------------------
+
+size_t ts::IPOutput::findPCR(const TSPacket* pkt, size_t count, uint64_t& diff)
+{
+    diff = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (pkt[i].hasPCR() && (_pcr_pid == PID_NULL || pkt[i].getPID() == _pcr_pid)) {
+            if (_pcr_pid == PID_NULL) {
+                _pcr_pid = pkt[i].getPID();
+                tsp->verbose(u"using PCR from PID 0x%X (%d) as reference", {_pcr_pid, _pcr_pid});
+            }
+            const uint64_t pcr = pkt[i].getPCR();
+            const PacketCounter pkt_index = _pkt_count + i;
+            if (_pcr_valid && !pkt[i].getDiscontinuityIndicator()) {
+                diff = pcr >= _pcr_last ? pcr - _pcr_last : (WrapUpPCR(_pcr_last, pcr) ? pcr + PCR_SCALE - _pcr_last : 0);
+            }
+            if (diff > SYSTEM_CLOCK_FREQ) {
+                // More than one second between two PCR's, this is a discontinuity.
+                diff = 0;
+            }
+            if (diff > 0) {
+                _pcr_bitrate = BitRate(((pkt_index - _pcr_last_pkt) * PKT_SIZE * 8 * SYSTEM_CLOCK_FREQ) / diff);
+            }
+            _pcr_valid = true;
+            _pcr_last = pcr;
+            _pcr_last_pkt = pkt_index;
+            return i;
+        }
+    }
+    return NO_PCR_INDEX;
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the due time of the next UDP message.
+// On input, _due is the due time, based on the bitrate, of the message.
+// When the message contains a PCR from the reference PID, the due time is
+// adjusted to the PCR value.
+//----------------------------------------------------------------------------
+
+void ts::IPOutput::computeDueTime(size_t pcr_index, uint64_t pcr_diff)
+{
+    // First message is immediately due.
+    if (!_due_valid) {
+        _due.getSystemTime();
+        _due_valid = true;
+    }
+
+    // With PCR pacing, the packet containing the PCR is due at the time of the PCR.
+    if (_pacing == PACING_PCR && pcr_index != NO_PCR_INDEX) {
+        // Time offset of the PCR packet inside the UDP message.
+        const NanoSecond offset = _pcr_bitrate == 0 ? 0 : NanoSecond((pcr_index * PKT_SIZE * 8 * NanoSecPerSec) / _pcr_bitrate);
+        if (!_pace_valid || pcr_diff == 0) {
+            // Start a new PCR sequence at the current due time.
+            _pace_valid = true;
+            _pace_origin = _due;
+            _pace_origin += offset;
+            _pace_elapsed = 0;
+        }
+        else {
+            // Same PCR sequence, rewind to the first packet of the UDP message.
+            // Note: elapsed * 10^9 would overflow after a few minutes, use elapsed * 10^3.
+            _pace_elapsed += pcr_diff;
+            _due = _pace_origin;
+            _due += NanoSecond((_pace_elapsed * 1000) / (SYSTEM_CLOCK_FREQ / 1000000));
+            _due -= offset;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the RTP header of the next UDP message.
+//----------------------------------------------------------------------------
+
+void ts::IPOutput::buildRTPHeader(uint8_t* header)
+{
+    // The RTP timestamp is the PCR of the first packet in the message, at 90 kHz.
+    // It is extrapolated from the last PCR in the reference PID. Before the first
+    // PCR, use the system time. The 33-bit PCR base is truncated to 32 bits, which
+    // is consistent with the wrap-up of the PCR.
+    int64_t pcr = 0;
+    if (_pcr_valid) {
+        const int64_t distance = int64_t(_pkt_count) - int64_t(_pcr_last_pkt);
+        const BitRate bitrate = _pcr_bitrate > 0 ? _pcr_bitrate : tsp->bitrate();
+        pcr = int64_t(_pcr_last);
+        if (bitrate > 0) {
+            pcr += (distance * int64_t(PKT_SIZE * 8) * int64_t(SYSTEM_CLOCK_FREQ)) / int64_t(bitrate);
+        }
+    }
+    else {
+        Monotonic now;
+        now.getSystemTime();
+        pcr = ((now - _rtp_start) * (SYSTEM_CLOCK_FREQ / 1000000)) / 1000;
+    }
+    const uint32_t timestamp = uint32_t(pcr / SYSTEM_CLOCK_SUBFACTOR);
+
+    header[0] = 0x80;  // version 2, no padding, no extension, no CSRC
+    header[1] = _rtp_pt & 0x7F;
+    PutUInt16(header + 2, _rtp_seq++);
+    PutUInt32(header + 4, timestamp);
+    PutUInt32(header + 8, _rtp_ssrc);
 }
@@ -55,6 +55,7 @@ namespace ts {
         uint8_t   _offset_pusi;      // Start offset in packets with PUSI
         uint8_t   _offset_non_pusi;  // Start offset in packets without PUSI
         ByteBlock _pattern;          // Binary pattern to apply
+        ByteBlock _payload;          // Pattern repeated over the maximum payload size
         PIDSet    _pid_list;         // Array of pid values to filter
 
         // Inaccessible operations
@@ -77,6 +78,7 @@ ts::PatternPlugin::PatternPlugin(TSP* tsp_) :
     _offset_pusi(0),
     _offset_non_pusi(0),
     _pattern(),
+    _payload(),
     _pid_list()
 {
     option(u"",                 0, STRING, 1, 1);
@@ -142,6 +144,12 @@ bool ts::PatternPlugin::start()
         return false;
     }
 
+    // Build the replacement payload once, the pattern is repeated from the start offset.
+    _payload.clear();
+    while (_payload.size() < PKT_SIZE) {
+        _payload.append(_pattern);
+    }
+
     return true;
 }
 
@@ -161,14 +169,11 @@ ts::ProcessorPlugin::Status ts::PatternPlugin::processPacket(TSPacket& pkt, bool
     uint8_t* pl = pkt.b + pkt.getHeaderSize() + (pkt.getPUSI() ? _offset_pusi : _offset_non_pusi);
 
     // Compute remaining size to replace (maybe negative if starting offset is beyond the end of the packet).
-    int remain = int(pkt.b + PKT_SIZE - pl);
+    const int remain = int(pkt.b + PKT_SIZE - pl);
 
     // Replace the payload with the pattern
-    while (remain > 0) {
-        int cursize = std::min(remain, int(_pattern.size()));
-        ::memcpy(pl, _pattern.data(), cursize);  // Flawfinder: ignore: memcpy()
-        pl += cursize;
-        remain -= cursize;
+    if (remain > 0) {
+        ::memcpy(pl, _payload.data(), remain);  // Flawfinder: ignore: memcpy()
     }
 
     return TSP_OK;
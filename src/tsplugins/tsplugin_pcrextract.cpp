@@ -34,6 +34,7 @@
 
 #include "tsPlugin.h"
 #include "tsPluginRepository.h"
+#include "tsTSPacketHeaders.h"
 TSDUCK_SOURCE;
 
 #define DEFAULT_SEPARATOR u";"
@@ -52,6 +53,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, Status*, size_t, bool&, bool&) override;
 
     private:
         // Description of one PID
@@ -59,21 +61,23 @@ namespace ts {
         typedef std::map<PID,PIDContext> PIDContextMap;
 
         // PCRExtractPlugin private members
-        PIDSet        _pids;           // List of PID's to analyze
-        UString       _separator;      // Field separator
-        bool          _noheader;       // Suppress header
-        bool          _good_pts_only;  // Keep "good" PTS only
-        bool          _get_pcr;        // Get PCR
-        bool          _get_opcr;       // Get OPCR
-        bool          _get_pts;        // Get PTS
-        bool          _get_dts;        // Get DTS
-        bool          _csv_format;     // Output in CSV format
-        bool          _log_format;     // Output in log format
-        UString       _output_name;    // Output file name (NULL means stderr)
-        std::ofstream _output_stream;  // Output stream file
-        std::ostream* _output;         // Reference to actual output stream file
-        PacketCounter _packet_count;   // Global packets count
-        PIDContextMap _stats;          // Per-PID statistics
+        PIDSet               _pids;          // List of PID's to analyze
+        UString              _separator;     // Field separator
+        bool                 _noheader;      // Suppress header
+        bool                 _good_pts_only; // Keep "good" PTS only
+        bool                 _get_pcr;       // Get PCR
+        bool                 _get_opcr;      // Get OPCR
+        bool                 _get_pts;       // Get PTS
+        bool                 _get_dts;       // Get DTS
+        bool                 _csv_format;    // Output in CSV format
+        bool                 _log_format;    // Output in log format
+        UString              _output_name;   // Output file name (NULL means stderr)
+        std::ofstream        _output_stream; // Output stream file
+        std::ostream*        _output;        // Reference to actual output stream file
+        PacketCounter        _packet_count;  // Global packets count
+        PIDContextMap        _stats;         // Per-PID statistics
+        TSPacketHeaders      _headers;       // Decoded headers of a batch of packets
+        std::vector<uint8_t> _match;         // Packets of a batch in selected PID's
 
         // Description of one PID
         struct PIDContext
@@ -136,7 +140,9 @@ ts::PCRExtractPlugin::PCRExtractPlugin(TSP* tsp_) :
     _output_stream(),
     _output(0),
     _packet_count(0),
-    _stats()
+    _stats(),
+    _headers(),
+    _match()
 {
     option(u"csv",           'c');
     option(u"dts",           'd');
@@ -407,3 +413,30 @@ ts::ProcessorPlugin::Status ts::PCRExtractPlugin::processPacket(TSPacket& pkt, b
     _packet_count++;
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method: the PID's of all packets are checked at
+// once, only the packets from the selected PID's are individually analyzed.
+//----------------------------------------------------------------------------
+
+size_t ts::PCRExtractPlugin::processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
+{
+    _headers.decode(pkt, count);
+    _match.resize(count);
+    _headers.matchPIDs(_pids, _match.data());
+
+    for (size_t n = 0; n < count; ++n) {
+        if (pkt[n].b[0] == 0) {
+            status[n] = TSP_DROP;
+        }
+        else if (_match[n] != 0) {
+            status[n] = PCRExtractPlugin::processPacket(pkt[n], flush, bitrate_changed);
+        }
+        else {
+            _packet_count++;
+            status[n] = TSP_OK;
+        }
+    }
+    return count;
+}
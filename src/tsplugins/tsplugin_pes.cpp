@@ -270,6 +270,9 @@ bool ts::PESPlugin::start()
     _min_payload = intValue<int>(u"min-payload-size", -1);
     _max_payload = intValue<int>(u"max-payload-size", -1);
 
+    // When only attributes are displayed, there is no need to reassemble complete video PES packets.
+    _demux.setStreamingMode(!_trace_packets && !_dump_start_code && !_dump_nal_units && !_dump_avc_sei && _min_payload < 0 && _max_payload < 0);
+
     // Hexa dump flags and bytes-per-line
     _hexa_flags = UString::HEXA | UString::OFFSET | UString::BPL;
     _hexa_bpl = 16;
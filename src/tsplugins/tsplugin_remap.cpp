@@ -57,6 +57,7 @@ namespace ts {
         RemapPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, Status*, size_t, bool&, bool&) override;
 
     private:
         typedef SafePtr<CyclingPacketizer, NullMutex> CyclingPacketizerPtr;
@@ -393,3 +394,13 @@ ts::ProcessorPlugin::Status ts::RemapPlugin::processPacket (TSPacket& pkt, bool&
     pkt.setPID(new_pid);
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method: inlined calls to processPacket().
+//----------------------------------------------------------------------------
+
+size_t ts::RemapPlugin::processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
+{
+    return processPacketBatchWith<RemapPlugin>(pkt, status, count, flush, bitrate_changed);
+}
@@ -35,6 +35,8 @@
 #include "tsPlugin.h"
 #include "tsPluginRepository.h"
 #include "tsScrambling.h"
+#include "tsParallelScrambling.h"
+#include "tsScramblingCache.h"
 #include "tsByteBlock.h"
 #include "tsService.h"
 #include "tsSectionDemux.h"
@@ -103,6 +105,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, Status*, size_t, bool&, bool&) override;
 
     private:
         // Description of a crypto-period.
@@ -131,6 +134,7 @@ namespace ts {
             void getNextECMPacket(TSPacket&);
 
             // Initialize the scrambler with the current control word.
+            // The control word was preprocessed when the crypto-period was initialized.
             void initScramblerKey() const;
 
             // Get scrambling control value for scrambled TS packets
@@ -144,6 +148,7 @@ namespace ts {
             size_t           _ecm_pkt_index;  // Next ECM packet to insert in TS
             uint8_t          _cw_current[CW_BYTES];
             uint8_t          _cw_next[CW_BYTES];
+            ScramblingPtr    _key;            // Preprocessed _cw_current, prepared in advance
 
             // Generate the ECM for a crypto-period.
             // With --synchronous, the ECM is directly generated. Otherwise,
@@ -199,7 +204,10 @@ namespace ts {
         CryptoPeriod      _cp[2];              // Previous/current or current/next crypto-periods
         size_t            _current_cw;         // Index to current CW (current crypto period)
         size_t            _current_ecm;        // Index to current ECM (ECM being broadcast)
-        Scrambling        _current_key;        // Preprocessed current control word
+        ScramblingCache   _keys;               // Cache of preprocessed control words
+        ScramblingPtr     _current_key;        // Preprocessed current control word
+        bool              _batch_mode;         // Packet payloads are queued, see processPacketBatch()
+        ParallelScrambling _batch;             // Queued payloads and scrambling threads
         SectionDemux      _demux;              // Section demux
         CyclingPacketizer _pzer_pmt;           // Packetizer for modified PMT
         SystemRandomGenerator _cw_gen;         // Control word generator
@@ -214,6 +222,9 @@ namespace ts {
         void changeCW();
         void changeECM();
 
+        // Submit all queued packet payloads for scrambling with the current key.
+        void flushBatch();
+
         // Check if we are in degraded mode or if we enter degraded mode
         bool inDegradedMode();
 
@@ -283,7 +294,10 @@ ts::ScramblerPlugin::ScramblerPlugin(TSP* tsp_) :
     _cp(),
     _current_cw(0),
     _current_ecm(0),
+    _keys(),
     _current_key(),
+    _batch_mode(false),
+    _batch(),
     _demux(this),
     _pzer_pmt(),
     _cw_gen()
@@ -309,6 +323,7 @@ ts::ScramblerPlugin::ScramblerPlugin(TSP* tsp_) :
     option(u"subtitles",             0);
     option(u"super-cas-id",         's', UINT32);
     option(u"synchronous",           0);
+    option(u"threads",               0,  INTEGER, 0, 1, 0, ParallelScrambling::MAX_THREADS);
 
     setHelp(u"Service:\n"
             u"  Specifies the service to scramble.\n"
@@ -415,6 +430,13 @@ ts::ScramblerPlugin::ScramblerPlugin(TSP* tsp_) :
             u"      offline packet processing. Use the default (asynchronous) with live\n"
             u"      packet processing.\n"
             u"\n"
+            u"  --threads value\n"
+            u"      Specifies the number of threads which scramble the packets in addition\n"
+            u"      to the plugin thread. The packets are scrambled by batches, the order of\n"
+            u"      the packets and the crypto-period transitions are preserved. Useful to\n"
+            u"      scramble many services on a multi-core system. The default is zero: all\n"
+            u"      packets are scrambled in the plugin thread.\n"
+            u"\n"
             u"  --version\n"
             u"      Display the version number.\n");
 }
@@ -445,6 +467,7 @@ bool ts::ScramblerPlugin::start()
     _service.set (value(u""));
     _use_fixed_key = present(u"control-word");
     _synchronous_ecmg = present(u"synchronous");
+    _batch.setThreads(intValue<size_t>(u"threads", 0));
     _cw_mode = present(u"no-entropy-reduction") ? Scrambling::FULL_CW : Scrambling::REDUCE_ENTROPY;
     _component_level = present(u"component-level");
     _scramble_audio = !present(u"no-audio");
@@ -485,7 +508,7 @@ bool ts::ScramblerPlugin::start()
         }
 
         // Initialize current scrambling key
-        _current_key.init(cw.data(), _cw_mode);
+        _current_key = _keys.get(cw.data(), _cw_mode);
         tsp->verbose(u"using fixed control word: " + UString::Dump(cw, UString::SINGLE_LINE));
     }
     else if (!present(u"ecmg")) {
@@ -558,6 +581,9 @@ bool ts::ScramblerPlugin::stop()
         _ecmg.disconnect();
     }
 
+    // Terminate the scrambling threads.
+    _batch.setThreads(0);
+
     tsp->debug(u"scrambled %'d packets in %'d PID's", {_scrambled_count, _scrambled_pids.count()});
     return true;
 }
@@ -822,6 +848,8 @@ void ts::ScramblerPlugin::changeCW()
 {
     // Allowed to change CW only if not in degraded mode
     if (!inDegradedMode()) {
+        // Queued packets belong to the previous crypto-period
+        flushBatch();
         // Point to next crypto-period
         _current_cw = (_current_cw + 1) & 0x01;
         // Use new control word
@@ -957,8 +985,14 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket (TSPacket& pkt, b
         _partial_clear = _partial_scrambling - 1;
     }
 
-    // Scramble the packet payload.
-    _current_key.encrypt(pkt.getPayload(), pkt.getPayloadSize());
+    // Scramble the packet payload. In batch mode, the payload is scrambled later
+    // with all other payloads of the batch, using the same control word.
+    if (_batch_mode) {
+        _batch.add(pkt.getPayload(), pkt.getPayloadSize());
+    }
+    else {
+        _current_key->encrypt(pkt.getPayload(), pkt.getPayloadSize());
+    }
     _scrambled_count++;
 
     // Set scrambling_control_value in TS header.
@@ -974,6 +1008,33 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket (TSPacket& pkt, b
 }
 
 
+//----------------------------------------------------------------------------
+// Packet batch processing method: inlined calls to processPacket().
+// The payloads to scramble are queued and scrambled together using the
+// batch DVB-CSA implementation, at the end of the batch or before a CW change.
+// All payloads are scrambled when the batch is returned to tsp.
+//----------------------------------------------------------------------------
+
+size_t ts::ScramblerPlugin::processPacketBatch(TSPacket* pkt, Status* status, size_t count, bool& flush, bool& bitrate_changed)
+{
+    _batch_mode = true;
+    const size_t processed = processPacketBatchWith<ScramblerPlugin>(pkt, status, count, flush, bitrate_changed);
+    flushBatch();
+    _batch.wait();
+    _batch_mode = false;
+    return processed;
+}
+
+void ts::ScramblerPlugin::flushBatch()
+{
+    // With scrambling threads, the payloads are scrambled in the background,
+    // using a copy of the current key. The key can be changed immediately.
+    if (_batch.pending() > 0) {
+        _batch.encrypt(*_current_key);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // CryptoPeriod default constructor.
 //----------------------------------------------------------------------------
@@ -985,7 +1046,8 @@ ts::ScramblerPlugin::CryptoPeriod::CryptoPeriod() :
     _ecm(),
     _ecm_pkt_index(0),
     _cw_current(),
-    _cw_next()
+    _cw_next(),
+    _key()
 {
 }
 
@@ -1000,6 +1062,7 @@ void ts::ScramblerPlugin::CryptoPeriod::initCycle (ScramblerPlugin* scrambler, u
     _cp_number = cp_number;
     _scrambler->_cw_gen.read(_cw_current, sizeof(_cw_current));
     _scrambler->_cw_gen.read(_cw_next, sizeof(_cw_next));
+    _key = _scrambler->_keys.get(_cw_current, _scrambler->_cw_mode);
     generateECM();
 }
 
@@ -1014,6 +1077,7 @@ void ts::ScramblerPlugin::CryptoPeriod::initNext (const CryptoPeriod& previous)
     _cp_number = previous._cp_number + 1;
     ::memcpy(_cw_current, previous._cw_next, sizeof(_cw_current));  // Flawfinder: ignore: memcpy()
     _scrambler->_cw_gen.read(_cw_next, sizeof(_cw_next));
+    _key = _scrambler->_keys.get(_cw_current, _scrambler->_cw_mode);
     generateECM();
 }
 
@@ -1133,5 +1197,5 @@ void ts::ScramblerPlugin::CryptoPeriod::getNextECMPacket (TSPacket& pkt)
 void ts::ScramblerPlugin::CryptoPeriod::initScramblerKey() const
 {
     _scrambler->tsp->debug(u"using new control word: " + UString::Dump(_cw_current, sizeof(_cw_current), UString::SINGLE_LINE));
-    _scrambler->_current_key.init(_cw_current, _scrambler->_cw_mode);
+    _scrambler->_current_key = _key;
 }
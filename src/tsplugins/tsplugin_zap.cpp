@@ -591,8 +591,8 @@ void ts::ZapPlugin::analyzeCADescriptors (const DescriptorList& dlist, uint8_t p
     for (size_t index = dlist.search (DID_CA); index < dlist.count(); index = dlist.search (DID_CA, index + 1)) {
 
         // Descriptor payload
-        const uint8_t* desc = dlist[index]->payload();
-        size_t size = dlist[index]->payloadSize();
+        const uint8_t* desc = dlist.payload(index);
+        size_t size = dlist.payloadSize(index);
 
         // The fixed part of a CA descriptor is 4 bytes long.
         if (size < 4) {
@@ -33,10 +33,12 @@
 
 #include "tsTSAnalyzerReport.h"
 #include "tsTSAnalyzerOptions.h"
-#include "tsInputRedirector.h"
+#include "tsTSFileInput.h"
 #include "tsVersionInfo.h"
 TSDUCK_SOURCE;
 
+#define READ_CHUNK 8192  // Number of TS packets per read operation
+
 
 //----------------------------------------------------------------------------
 //  Command line options
@@ -98,14 +100,29 @@ int main(int argc, char *argv[])
     TSDuckLibCheckVersion();
     Options opt(argc, argv);
     ts::TSAnalyzerReport analyzer(opt.bitrate);
-    ts::InputRedirector input(opt.infile, opt);
-    ts::TSPacket pkt;
+    ts::TSFileInput file;
+    ts::TSPacketVector buffer(READ_CHUNK);
 
     analyzer.setAnalysisOptions(opt);
 
-    while (pkt.read(std::cin, true, opt)) {
-        analyzer.feedPacket(pkt);
+    // Read the file by large chunks, the file is asynchronously read ahead.
+    if (!file.open(opt.infile, 1, 0, opt)) {
+        return EXIT_FAILURE;
+    }
+    size_t count = 0;
+    bool ok = true;
+    while (ok && (count = file.read(&buffer[0], buffer.size(), opt)) > 0) {
+        for (size_t i = 0; ok && i < count; ++i) {
+            ok = buffer[i].hasValidSync();
+            if (ok) {
+                analyzer.feedPacket(buffer[i]);
+            }
+            else {
+                opt.error(u"synchronization lost after %'d TS packets, got 0x%X instead of 0x%X at start of TS packet", {file.getPacketCount() - count + i, buffer[i].b[0], ts::SYNC_BYTE});
+            }
+        }
     }
+    file.close(opt);
 
     analyzer.report(std::cout, opt);
 
@@ -35,11 +35,14 @@
 #include "tspInputExecutor.h"
 #include "tspOutputExecutor.h"
 #include "tspProcessorExecutor.h"
+#include "tspPipelineMonitor.h"
 #include "tsPluginRepository.h"
 #include "tsAsyncReport.h"
 #include "tsSystemMonitor.h"
 #include "tsMonotonic.h"
 #include "tsResidentBuffer.h"
+#include "tsSafePtr.h"
+#include "tsMemoryUtils.h"
 #include "tsOutputPager.h"
 #include "tsIPUtils.h"
 #include "tsVersionInfo.h"
@@ -94,6 +97,52 @@ void ts::tsp::TSPInterruptHandler::handleInterrupt()
 }
 
 
+//----------------------------------------------------------------------------
+//  Packet buffer allocator thread (option --numa-buffer)
+//----------------------------------------------------------------------------
+
+namespace ts {
+    namespace tsp {
+        // With the default "first touch" memory policy of the operating system,
+        // memory pages are physically allocated on the NUMA node of the CPU which
+        // first accesses them. This thread allocates and initializes the packet
+        // buffer while running on the same CPU's as the input plugin.
+        class BufferAllocator: public Thread
+        {
+        public:
+            BufferAllocator(const std::set<size_t>& cpus, size_t count, bool huge_pages);
+            PluginExecutor::PacketBuffer* buffer() const { return _buffer; }
+        private:
+            size_t                        _count;
+            bool                          _huge_pages;
+            PluginExecutor::PacketBuffer* _buffer;
+            virtual void main() override;
+
+            // Inaccessible operations
+            BufferAllocator() = delete;
+            BufferAllocator(const BufferAllocator&) = delete;
+            BufferAllocator& operator=(const BufferAllocator&) = delete;
+        };
+    }
+}
+
+ts::tsp::BufferAllocator::BufferAllocator(const std::set<size_t>& cpus, size_t count, bool huge_pages) :
+    Thread(ThreadAttributes().setCPUAffinity(cpus)),
+    _count(count),
+    _huge_pages(huge_pages),
+    _buffer(0)
+{
+}
+
+void ts::tsp::BufferAllocator::main()
+{
+    // Locking the buffer in physical memory touches all pages. But locking may
+    // fail when the user has not enough privileges. Always touch all pages.
+    _buffer = new PluginExecutor::PacketBuffer(_count, _huge_pages);
+    Zero(_buffer->base(), _buffer->count() * PKT_SIZE);
+}
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -153,12 +202,12 @@ int main(int argc, char *argv[])
     // plugin has a hight priority to make room in the buffer, but not as
     // high as the input which must remain the top-most priority?
 
-    ts::tsp::InputExecutor* input = new ts::tsp::InputExecutor(&opt, &opt.input, ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetMaximumPriority()), global_mutex);
-    ts::tsp::OutputExecutor* output = new ts::tsp::OutputExecutor(&opt, &opt.output, ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), global_mutex);
+    ts::tsp::InputExecutor* input = new ts::tsp::InputExecutor(&opt, &opt.input, ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetMaximumPriority()).setCPUAffinity(opt.input.cpus), global_mutex);
+    ts::tsp::OutputExecutor* output = new ts::tsp::OutputExecutor(&opt, &opt.output, ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()).setCPUAffinity(opt.output.cpus), global_mutex);
     output->ringInsertAfter(input);
 
     for (ts::tsp::Options::PluginOptionsVector::const_iterator it = opt.plugins.begin(); it != opt.plugins.end(); ++it) {
-        ts::tsp::PluginExecutor* p = new ts::tsp::ProcessorExecutor(&opt, &*it, ts::ThreadAttributes(), global_mutex);
+        ts::tsp::PluginExecutor* p = new ts::tsp::ProcessorExecutor(&opt, &*it, ts::ThreadAttributes().setCPUAffinity(it->cpus), global_mutex);
         p->ringInsertBefore(output);
     }
 
@@ -175,13 +224,30 @@ int main(int argc, char *argv[])
         proc->setMaxSeverity(report.maxSeverity());
     } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
 
-    // Allocate a memory-resident buffer of TS packets
-    ts::ResidentBuffer<ts::TSPacket> packet_buffer(opt.bufsize / ts::PKT_SIZE);
-    if (!packet_buffer.isLocked()) {
+    // Allocate a memory-resident buffer of TS packets.
+    // With --numa-buffer, allocate it from a thread running on the CPU's of the input plugin.
+    ts::SafePtr<ts::tsp::PluginExecutor::PacketBuffer> packet_buffer;
+    if (opt.numa_buffer && !opt.input.cpus.empty()) {
+        ts::tsp::BufferAllocator allocator(opt.input.cpus, opt.bufsize / ts::PKT_SIZE, opt.huge_pages);
+        if (allocator.start()) {
+            allocator.waitForTermination();
+            packet_buffer.reset(allocator.buffer());
+        }
+        else {
+            report.error(u"tsp: cannot start a thread on the CPU's of the input plugin");
+        }
+    }
+    if (packet_buffer.isNull()) {
+        packet_buffer.reset(new ts::tsp::PluginExecutor::PacketBuffer(opt.bufsize / ts::PKT_SIZE, opt.huge_pages));
+    }
+    if (!packet_buffer->isLocked()) {
         report.verbose(u"tsp: buffer failed to lock into physical memory (%d: %s), risk of real-time issue",
-                       {packet_buffer.lockErrorCode(), ts::ErrorCodeMessage(packet_buffer.lockErrorCode())});
+                       {packet_buffer->lockErrorCode(), ts::ErrorCodeMessage(packet_buffer->lockErrorCode())});
+    }
+    report.debug(u"tsp: buffer size: %'d TS packets, %'d bytes", {packet_buffer->count(), packet_buffer->count() * ts::PKT_SIZE});
+    if (opt.huge_pages) {
+        report.verbose(u"tsp: buffer allocated using %s, page size: %'d bytes", {ts::MemoryPageTypeEnum.name(packet_buffer->pageType()), packet_buffer->pageSize()});
     }
-    report.debug(u"tsp: buffer size: %'d TS packets, %'d bytes", {packet_buffer.count(), packet_buffer.count() * ts::PKT_SIZE});
 
     // Start all processors, except output, in reverse order (input last).
     // Exit application in case of error.
@@ -193,7 +259,7 @@ int main(int argc, char *argv[])
 
     // Initialize packet buffer in the ring of executors.
     // Exit application in case of error.
-    if (!input->initAllBuffers(&packet_buffer)) {
+    if (!input->initAllBuffers(packet_buffer.pointer())) {
         return EXIT_FAILURE;
     }
 
@@ -219,12 +285,21 @@ int main(int argc, char *argv[])
         proc->start();
     } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
 
+    // Create a pipeline monitoring thread if required.
+    ts::tsp::PipelineMonitor pipeline_monitor(&opt, &report, input);
+    if (opt.monitor_pipeline > 0) {
+        pipeline_monitor.start();
+    }
+
     // Wait for threads to terminate
     proc = input;
     do {
         proc->waitForTermination();
     } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
 
+    // Stop the pipeline monitor before deallocating the plugin executors.
+    pipeline_monitor.terminate();
+
     // Deallocate all plugins and plugin executor
     bool last;
     proc = input;
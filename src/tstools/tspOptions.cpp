@@ -34,11 +34,17 @@
 #include "tspOptions.h"
 #include "tsSysUtils.h"
 #include "tsAsyncReport.h"
+#include "tsSysInfo.h"
 TSDUCK_SOURCE;
 
 #define DEF_BUFSIZE_MB           16  // mega-bytes
 #define DEF_BITRATE_INTERVAL      5  // seconds
 #define DEF_MAX_FLUSH_PKT     10000  // packets
+#define DEF_MONITOR_PIPELINE     10  // seconds
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const ts::MilliSecond ts::tsp::Options::ADAPTIVE_FLUSH_LATENCY;
+#endif
 
 // Displayable names of plugin types.
 const ts::Enumeration ts::tsp::Options::PluginTypeNames({
@@ -58,29 +64,43 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     monitor(false),
     ignore_jt(false),
     sync_log(false),
+    lock_free(false),
+    adaptive_flush(false),
+    numa_buffer(false),
+    huge_pages(false),
     bufsize(0),
     log_msg_count(AsyncReport::MAX_LOG_MESSAGES),
     max_flush_pkt(0),
     max_input_pkt(0),
+    spin_wait(0),
     instuff_nullpkt(0),
     instuff_inpkt(0),
     bitrate(0),
     bitrate_adj(0),
+    monitor_pipeline(0),
+    monitor_pipeline_json(),
     input(),
     output(),
     plugins()
 {
+    option(u"adaptive-flush",            0);
     option(u"add-input-stuffing",       'a', Args::STRING);
     option(u"bitrate",                  'b', Args::POSITIVE);
     option(u"bitrate-adjust-interval",   0,  Args::POSITIVE);
     option(u"buffer-size-mb",            0,  Args::POSITIVE);
+    option(u"huge-pages",                0);
     option(u"ignore-joint-termination", 'i');
     option(u"list-processors",          'l');
+    option(u"lock-free-buffer",          0);
     option(u"log-message-count",         0,  Args::POSITIVE);
     option(u"max-flushed-packets",       0,  Args::POSITIVE);
     option(u"max-input-packets",         0,  Args::POSITIVE);
     option(u"no-realtime-clock",         0); // was a temporary workaround, now ignored
+    option(u"numa-buffer",               0);
     option(u"monitor",                  'm');
+    option(u"monitor-pipeline",          0,  Args::POSITIVE, 0, 1, 0, 0, true);
+    option(u"monitor-pipeline-json",     0,  Args::STRING);
+    option(u"spin-wait",                 0,  Args::UNSIGNED);
     option(u"synchronous-log",          's');
     option(u"timed-log",                't');
 
@@ -104,13 +124,22 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
                    u"plug-in. All input, processors and output plug-in's are " HELP_SHLIBS u".");
 
     setSyntax(u" [tsp-options] \\\n"
-              u"    [-I input-name [input-options]] \\\n"
-              u"    [-P processor-name [processor-options]] ... \\\n"
-              u"    [-O output-name [output-options]]");
+              u"    [-I [--cpu list] input-name [input-options]] \\\n"
+              u"    [-P [--cpu list] processor-name [processor-options]] ... \\\n"
+              u"    [-O [--cpu list] output-name [output-options]]");
 
     setHelp(u"All tsp-options must be placed on the command line before the input,\n"
             u"processors and output specifications. The tsp-options are:\n"
             u"\n"
+            u"  --adaptive-flush\n"
+            u"      Dynamically adjust the number of packets to be processed by a packet\n"
+            u"      processor before flushing them to the next processor. The number of\n"
+            u"      packets is reduced when the next processor has nothing to do (low\n"
+            u"      latency) and increased when the next processor has a backlog (fewer\n"
+            u"      thread switches). It is also limited to the number of packets which\n"
+            u"      are received in " + UString::Decimal(ADAPTIVE_FLUSH_LATENCY) + u" milliseconds at the current bitrate.\n"
+            u"      The value of --max-flushed-packets remains the upper limit.\n"
+            u"\n"
             u"  -a nullpkt/inpkt\n"
             u"  --add-input-stuffing nullpkt/inpkt\n"
             u"      Specify that <nullpkt> null TS packets must be automatically inserted\n"
@@ -146,6 +175,16 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"  --help\n"
             u"      Display this help text.\n"
             u"\n"
+            u"  --huge-pages\n"
+            u"      Allocate the packet buffer using huge memory pages, when available. With\n"
+            u"      large buffers, this reduces the number of TLB misses when accessing the\n"
+            u"      packets. On Linux, explicit huge pages are used when they have been\n"
+            u"      reserved by the system administrator (see /proc/sys/vm/nr_hugepages),\n"
+            u"      otherwise transparent huge pages are requested. On Windows, large pages\n"
+            u"      require the \"Lock pages in memory\" privilege. When huge pages are not\n"
+            u"      available, normal pages are used. Use --verbose to display the type of\n"
+            u"      memory pages which were actually obtained.\n"
+            u"\n"
             u"  -i\n"
             u"  --ignore-joint-termination\n"
             u"      Ignore all --joint-termination options in plugins.\n"
@@ -161,6 +200,14 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"  --list-processors\n"
             u"      List all available processors.\n"
             u"\n"
+            u"  --lock-free-buffer\n"
+            u"      Use lock-free synchronization between the plugin threads to access the\n"
+            u"      packet buffer. By default, all plugin threads use one global mutex to\n"
+            u"      pass packets from one plugin to the next one. With this option, packets\n"
+            u"      are passed using atomic counters and a thread uses the global mutex only\n"
+            u"      when it has nothing to do and needs to sleep. This option may improve\n"
+            u"      the performance with long chains of plugins on high bitrate streams.\n"
+            u"\n"
             u"  --log-message-count value\n"
             u"      Specify the maximum number of buffered log messages. Log messages are\n"
             u"      displayed asynchronously in a low priority thread. This value specifies\n"
@@ -187,6 +234,33 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"      This includes CPU load, virtual memory usage. Useful to verify the\n"
             u"      stability of the application.\n"
             u"\n"
+            u"  --monitor-pipeline[=seconds]\n"
+            u"      Periodically report the activity of each plugin in the chain: packets\n"
+            u"      per second, ratio of processing and waiting time, average and maximum\n"
+            u"      number of packets in the plugin window, number of processed batches and\n"
+            u"      average processing time per batch. This helps locating the bottleneck\n"
+            u"      in a long chain of plugins. A final cumulative report is displayed at\n"
+            u"      the end of the processing. The optional value is the reporting interval\n"
+            u"      in seconds. The default is " TS_USTRINGIFY(DEF_MONITOR_PIPELINE) u" seconds.\n"
+            u"\n"
+            u"  --monitor-pipeline-json filename\n"
+            u"      With --monitor-pipeline, also save each report in the specified file in\n"
+            u"      JSON format. The file is overwritten at each report.\n"
+            u"\n"
+            u"  --numa-buffer\n"
+            u"      Allocate the packet buffer on the NUMA node of the CPU's of the input\n"
+            u"      plugin thread, as specified by the --cpu option of the input plugin.\n"
+            u"      On systems with several NUMA nodes (multi-socket hosts), this avoids\n"
+            u"      cross-node memory traffic when the plugin threads are bound to the CPU's\n"
+            u"      of the same node. Ignored if the input plugin has no --cpu option.\n"
+            u"\n"
+            u"  --spin-wait microseconds\n"
+            u"      When a plugin thread has nothing to do, spin during the specified number\n"
+            u"      of microseconds, checking for new packets, before going to sleep. This\n"
+            u"      avoids thread context switches at the expense of CPU usage. Useful with\n"
+            u"      high bitrate streams on systems with enough CPU cores. The default is\n"
+            u"      zero (do not spin).\n"
+            u"\n"
             u"  -s\n"
             u"  --synchronous-log\n"
             u"      Each logged message is guaranteed to be displayed, synchronously, without\n"
@@ -228,6 +302,14 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"      is no processor and the packets are directly passed from the input to\n"
             u"      the output.\n"
             u"\n"
+            u"Each -I, -P or -O option can be followed by \"--cpu list\" before the plug-in\n"
+            u"name. The corresponding plug-in thread is then bound to the specified CPU's.\n"
+            u"The list is a comma-separated list of CPU indexes or ranges of indexes, for\n"
+            u"instance \"--cpu 2\" or \"--cpu 0-3,8\". CPU's are numbered from zero. By\n"
+            u"default, the operating system decides on which CPU each thread runs. Binding\n"
+            u"the input, processors and output threads to distinct CPU's avoids competition\n"
+            u"between them. CPU affinity is not supported on macOS.\n"
+            u"\n"
             u"The specified <name> is used to locate a " HELP_SHLIB u". It can be designated\n"
             u"in a number of ways, in the following order:\n"
             u"\n"
@@ -254,7 +336,14 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     timed_log = present(u"timed-log");
     list_proc = present(u"list-processors");
     monitor = present(u"monitor");
+    monitor_pipeline = present(u"monitor-pipeline") ? MilliSecPerSec * intValue<MilliSecond>(u"monitor-pipeline", DEF_MONITOR_PIPELINE) : 0;
+    getValue(monitor_pipeline_json, u"monitor-pipeline-json");
     sync_log = present(u"synchronous-log");
+    lock_free = present(u"lock-free-buffer");
+    adaptive_flush = present(u"adaptive-flush");
+    numa_buffer = present(u"numa-buffer");
+    huge_pages = present(u"huge-pages");
+    spin_wait = intValue<MicroSecond>(u"spin-wait", 0);
     bufsize = 1024 * 1024 * intValue<size_t>(u"buffer-size-mb", DEF_BUFSIZE_MB);
     bitrate = intValue<BitRate>(u"bitrate", 0);
     bitrate_adj = MilliSecPerSec * intValue(u"bitrate-adjust-interval", DEF_BITRATE_INTERVAL);
@@ -298,12 +387,13 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
         // Locate plugin description, seach for next plugin
 
         int start = plugin_index;
+        const char* const plugin_switch = argv[start];  // -I, -P or -O, start moves past --cpu options later
         PluginType type = plugin_type;
         plugin_index = nextProcOpt(argc, argv, plugin_index, plugin_type);
         PluginOptions* opt = 0;
 
         if (start >= argc - 1) {
-            error(u"missing plugin name for option %s", {argv[start]});
+            error(u"missing plugin name for option %s", {plugin_switch});
             break;
         }
 
@@ -331,11 +421,31 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
                 assert(false);
         }
 
+        // Optional tsp-level options for this plugin, before the plugin name.
+        opt->cpus.clear();
+        while (start + 1 < plugin_index && std::string(argv[start+1]) == "--cpu") {
+            if (start + 2 >= plugin_index) {
+                error(u"missing CPU list after --cpu in %s", {plugin_switch});
+            }
+            else {
+                decodeCPUList(opt->cpus, UString::FromUTF8(argv[start+2]));
+            }
+            start += 2;
+        }
+        if (start + 1 >= plugin_index) {
+            error(u"missing plugin name for option %s", {plugin_switch});
+            continue;
+        }
+
         opt->type = type;
         opt->name = UString::FromUTF8(argv[start+1]);
         UString::Assign(opt->args, plugin_index - start - 2, argv + start + 2);
     }
 
+    if (numa_buffer && input.cpus.empty()) {
+        verbose(u"--numa-buffer ignored, no --cpu option on the input plugin");
+    }
+
     // Debug display
     if (maxSeverity() >= 2) {
         display(std::cerr);
@@ -379,16 +489,23 @@ std::ostream& ts::tsp::Options::display(std::ostream& strm, int indent) const
 {
     const std::string margin(indent, ' ');
     strm << margin << "* tsp options:" << std::endl
+         << margin << "  --adaptive-flush: " << adaptive_flush << std::endl
          << margin << "  --add-input-stuffing: " << UString::Decimal(instuff_nullpkt)
          << "/" << UString::Decimal(instuff_inpkt) << std::endl
          << margin << "  --bitrate: " << UString::Decimal(bitrate) << " b/s" << std::endl
          << margin << "  --bitrate-adjust-interval: " << UString::Decimal(bitrate_adj) << " milliseconds" << std::endl
          << margin << "  --buffer-size-mb: " << UString::Decimal(bufsize) << " bytes" << std::endl
          << margin << "  --debug: " << maxSeverity() << std::endl
+         << margin << "  --huge-pages: " << huge_pages << std::endl
          << margin << "  --list-processors: " << list_proc << std::endl
+         << margin << "  --lock-free-buffer: " << lock_free << std::endl
          << margin << "  --max-flushed-packets: " << UString::Decimal(max_flush_pkt) << std::endl
          << margin << "  --max-input-packets: " << UString::Decimal(max_input_pkt) << std::endl
          << margin << "  --monitor: " << monitor << std::endl
+         << margin << "  --monitor-pipeline: " << UString::Decimal(monitor_pipeline) << " milliseconds" << std::endl
+         << margin << "  --monitor-pipeline-json: " << monitor_pipeline_json << std::endl
+         << margin << "  --numa-buffer: " << numa_buffer << std::endl
+         << margin << "  --spin-wait: " << UString::Decimal(spin_wait) << " microseconds" << std::endl
          << margin << "  --verbose: " << verbose() << std::endl
          << margin << "  Number of packet processors: " << plugins.size() << std::endl
          << margin << "  Input plugin:" << std::endl;
@@ -410,7 +527,8 @@ std::ostream& ts::tsp::Options::display(std::ostream& strm, int indent) const
 ts::tsp::Options::PluginOptions::PluginOptions() :
     type(PROCESSOR),
     name(),
-    args()
+    args(),
+    cpus()
 {
 }
 
@@ -424,8 +542,53 @@ std::ostream& ts::tsp::Options::PluginOptions::display(std::ostream& strm, int i
     const std::string margin(indent, ' ');
     strm << margin << "Name: " << name << std::endl
          << margin << "Type: " << PluginTypeNames.name(type) << std::endl;
+    if (!cpus.empty()) {
+        strm << margin << "CPU's:";
+        for (std::set<size_t>::const_iterator it = cpus.begin(); it != cpus.end(); ++it) {
+            strm << " " << *it;
+        }
+        strm << std::endl;
+    }
     for (size_t i = 0; i < args.size(); ++i) {
         strm << margin << "Arg[" << i << "]: \"" << args[i] << "\"" << std::endl;
     }
     return strm;
 }
+
+
+//----------------------------------------------------------------------------
+// Decode a list of CPU's, as specified in option --cpu.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::Options::decodeCPUList(std::set<size_t>& cpus, const UString& list)
+{
+    const size_t cpu_count = SysInfo::Instance()->cpuCount();
+    UStringVector ranges;
+    list.split(ranges, u',');
+
+    for (UStringVector::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
+        const UString::size_type dash = it->find(u'-');
+        size_t first = 0;
+        size_t last = 0;
+        bool valid = false;
+        if (dash == UString::NPOS) {
+            valid = it->toInteger(first);
+            last = first;
+        }
+        else {
+            valid = it->substr(0, dash).toInteger(first) && it->substr(dash + 1).toInteger(last) && first <= last;
+        }
+        if (!valid) {
+            error(u"invalid CPU list \"%s\" in option --cpu", {list});
+            return false;
+        }
+        if (last >= cpu_count) {
+            error(u"invalid CPU %d in option --cpu, this system has %d CPU's (0 to %d)", {last, cpu_count, cpu_count - 1});
+            return false;
+        }
+        for (size_t cpu = first; cpu <= last; ++cpu) {
+            cpus.insert(cpu);
+        }
+    }
+    return true;
+}
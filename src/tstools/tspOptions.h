@@ -75,6 +75,7 @@ namespace ts {
                 PluginType    type;  //!< Plugin type.
                 UString       name;  //!< Plugin name.
                 UStringVector args;  //!< Plugin options.
+                std::set<size_t> cpus; //!< CPU affinity of the plugin thread, empty if none.
 
                 //!
                 //! Default constructor.
@@ -101,18 +102,30 @@ namespace ts {
             bool          monitor;         //!< Run a resource monitoring thread.
             bool          ignore_jt;       //!< Ignore "joint termination" options in plugins.
             bool          sync_log;        //!< Synchronous log.
+            bool          lock_free;       //!< Use lock-free synchronization on the packet buffer.
+            bool          adaptive_flush;  //!< Dynamically adjust the number of packets before flush.
+            bool          numa_buffer;     //!< Allocate the packet buffer on the NUMA node of the input thread.
+            bool          huge_pages;      //!< Allocate the packet buffer using huge memory pages.
             size_t        bufsize;         //!< Buffer size.
             size_t        log_msg_count;   //!< Maximum buffered log messages.
             size_t        max_flush_pkt;   //!< Max processed packets before flush.
             size_t        max_input_pkt;   //!< Max packets per input operation.
+            MicroSecond   spin_wait;       //!< Spin duration before sleeping when a plugin has nothing to do.
             size_t        instuff_nullpkt; //!< Add input stuffing: add @a nullpkt null packets every @a inpkt input packets.
             size_t        instuff_inpkt;   //!< Add input stuffing: add @a nullpkt null packets every @a inpkt input packets.
             BitRate       bitrate;         //!< Fixed input bitrate.
             MilliSecond   bitrate_adj;     //!< Bitrate adjust interval.
+            MilliSecond   monitor_pipeline;      //!< Pipeline monitoring interval, zero if disabled.
+            UString       monitor_pipeline_json; //!< JSON file for pipeline monitoring reports.
             PluginOptions input;           //!< Input plugin.
             PluginOptions output;          //!< Output plugin.
             PluginOptionsVector plugins;   //!< List of packet processor plugins.
 
+            //!
+            //! With --adaptive-flush, maximum duration of packets in a flushed batch, at the current bitrate.
+            //!
+            static const MilliSecond ADAPTIVE_FLUSH_LATENCY = 10;
+
             //!
             //! Display the content of this object to a stream.
             //! @param [in,out] strm Where to output the content.
@@ -135,6 +148,15 @@ namespace ts {
             //! @return Index of plugin option or @a argc if not found.
             //!
             static int nextProcOpt(int argc, char *argv[], int index, PluginType& type);
+
+            //!
+            //! Decode a list of CPU's, as specified in option -\-cpu.
+            //! Report an error if the list is invalid.
+            //! @param [out] cpus Set of CPU indexes.
+            //! @param [in] list List of CPU's, as specified in option -\-cpu.
+            //! @return True on success, false on error.
+            //!
+            bool decodeCPUList(std::set<size_t>& cpus, const UString& list);
         };
     }
 }
@@ -0,0 +1,213 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor: Monitoring thread for the plugin pipeline
+//
+//----------------------------------------------------------------------------
+
+#include "tspPipelineMonitor.h"
+#include "tsGuardCondition.h"
+#include "tsTime.h"
+#include "tsjson.h"
+TSDUCK_SOURCE;
+
+// Stack size for the monitor thread
+#define MONITOR_STACK_SIZE (64 * 1024)
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::tsp::PipelineMonitor::PipelineMonitor(const Options* options, Report* report, PluginExecutor* input) :
+    Thread(ThreadAttributes().setPriority(ThreadAttributes::GetMinimumPriority()).setStackSize(MONITOR_STACK_SIZE)),
+    _report(report),
+    _input(input),
+    _interval(options->monitor_pipeline),
+    _json_file(options->monitor_pipeline_json),
+    _mutex(),
+    _wake_up(),
+    _terminate(false)
+{
+}
+
+ts::tsp::PipelineMonitor::~PipelineMonitor()
+{
+    terminate();
+}
+
+
+//----------------------------------------------------------------------------
+// Terminate the monitoring thread.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PipelineMonitor::terminate()
+{
+    {
+        GuardCondition lock(_mutex, _wake_up);
+        _terminate = true;
+        lock.signal();
+    }
+    waitForTermination();
+}
+
+
+//----------------------------------------------------------------------------
+// Collect the current statistics of all plugins.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PipelineMonitor::collect(StatsVector& stats)
+{
+    stats.clear();
+    PluginExecutor* proc = _input;
+    do {
+        stats.resize(stats.size() + 1);
+        proc->getPipelineStats(stats.back());
+    } while ((proc = proc->ringNext<PluginExecutor>()) != _input);
+}
+
+
+//----------------------------------------------------------------------------
+// Report the statistics between two collections.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PipelineMonitor::display(const StatsVector& previous, const StatsVector& current, MilliSecond duration, bool final)
+{
+    const UString prefix(u"[PIPE] " + Time::CurrentLocalTime().format(Time::DATE | Time::TIME) + (final ? u", final, " : u", "));
+    json::Object* const root = new json::Object;
+    json::ValuePtr root_ptr(root);
+    json::Array* const plugins = new json::Array;
+    json::ValuePtr plugins_ptr(plugins);
+
+    root->add(u"time", json::ValuePtr(new json::String(Time::CurrentLocalTime().format(Time::DATE | Time::TIME))));
+    root->add(u"final", json::ValuePtr(final ? static_cast<json::Value*>(new json::True) : static_cast<json::Value*>(new json::False)));
+    root->add(u"duration-ms", json::ValuePtr(new json::Number(duration)));
+    root->add(u"plugins", plugins_ptr);
+
+    const PluginExecutor* proc = _input;
+    size_t index = 0;
+    do {
+        assert(index < current.size() && index < previous.size());
+        const PluginExecutor::PipelineStats& cur(current[index]);
+        const PluginExecutor::PipelineStats& prev(previous[index]);
+
+        // Differences since previous report.
+        const PacketCounter packets = cur.packets - prev.packets;
+        const uint64_t batches = cur.batches - prev.batches;
+        const NanoSecond process_ns = cur.process_ns - prev.process_ns;
+        const NanoSecond wait_ns = cur.wait_ns - prev.wait_ns;
+        const uint64_t window_avg = batches == 0 ? 0 : (cur.window_sum - prev.window_sum) / batches;
+        const uint64_t pkt_per_sec = duration <= 0 ? 0 : (packets * MilliSecPerSec) / duration;
+        const NanoSecond ns_per_batch = batches == 0 ? 0 : process_ns / NanoSecond(batches);
+        const UString type(index == 0 ? u"input" : (proc->ringNext<PluginExecutor>() == _input ? u"output" : u"processor"));
+
+        _report->info(u"%s#%d %s %s: %'d pkt/s, process: %s, wait: %s, window: avg %'d, max %'d / %'d pkt, %'d batches, %'d ns/batch",
+                      {prefix, index, type, proc->pluginName(), pkt_per_sec,
+                       UString::Percentage(process_ns, process_ns + wait_ns), UString::Percentage(wait_ns, process_ns + wait_ns),
+                       window_avg, cur.window_max, proc->bufferSize(), batches, ns_per_batch});
+
+        if (!_json_file.empty()) {
+            json::Object* const plugin = new json::Object;
+            plugins->set(json::ValuePtr(plugin));
+            plugin->add(u"index", json::ValuePtr(new json::Number(index)));
+            plugin->add(u"type", json::ValuePtr(new json::String(type)));
+            plugin->add(u"name", json::ValuePtr(new json::String(proc->pluginName())));
+            plugin->add(u"packets", json::ValuePtr(new json::Number(packets)));
+            plugin->add(u"packets-per-second", json::ValuePtr(new json::Number(pkt_per_sec)));
+            plugin->add(u"batches", json::ValuePtr(new json::Number(batches)));
+            plugin->add(u"process-ns", json::ValuePtr(new json::Number(process_ns)));
+            plugin->add(u"wait-ns", json::ValuePtr(new json::Number(wait_ns)));
+            plugin->add(u"window-average", json::ValuePtr(new json::Number(window_avg)));
+            plugin->add(u"window-max", json::ValuePtr(new json::Number(cur.window_max)));
+            plugin->add(u"buffer-size", json::ValuePtr(new json::Number(proc->bufferSize())));
+        }
+        index++;
+    } while ((proc = proc->ringNext<PluginExecutor>()) != _input);
+
+    // Save the JSON report, overwriting the previous one.
+    if (!_json_file.empty()) {
+        const UStringList lines({root->printed(2, *_report)});
+        if (!UString::Save(lines, _json_file)) {
+            _report->error(u"error writing %s", {_json_file});
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Thread main code. Inherited from Thread
+//----------------------------------------------------------------------------
+
+void ts::tsp::PipelineMonitor::main()
+{
+    StatsVector initial;
+    StatsVector previous;
+    StatsVector current;
+    std::vector<size_t> window_max;  // Maximum window sizes since start, for the final report.
+    const Time start_time(Time::CurrentUTC());
+    Time last_time(start_time);
+
+    collect(initial);
+    previous = initial;
+    for (size_t i = 0; i < initial.size(); ++i) {
+        window_max.push_back(initial[i].window_max);
+    }
+
+    for (;;) {
+        // Wait until due time or termination request.
+        bool terminate = false;
+        {
+            GuardCondition lock(_mutex, _wake_up);
+            if (!_terminate) {
+                lock.waitCondition(_interval);
+            }
+            terminate = _terminate;
+        }
+
+        const Time now(Time::CurrentUTC());
+        collect(current);
+        assert(current.size() == window_max.size());
+        for (size_t i = 0; i < current.size(); ++i) {
+            window_max[i] = std::max(window_max[i], current[i].window_max);
+        }
+
+        if (terminate) {
+            // Final report: global statistics since start.
+            for (size_t i = 0; i < current.size(); ++i) {
+                current[i].window_max = window_max[i];
+            }
+            display(initial, current, now - start_time, true);
+            break;
+        }
+
+        display(previous, current, now - last_time, false);
+        previous.swap(current);
+        last_time = now;
+    }
+}
@@ -0,0 +1,98 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Transport stream processor: Monitoring thread for the plugin pipeline
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tspPluginExecutor.h"
+#include "tsReport.h"
+
+namespace ts {
+    namespace tsp {
+        //!
+        //! Monitoring thread for the tsp plugin pipeline (tsp option -\-monitor-pipeline).
+        //!
+        //! This class starts an internal thread which periodically wakes up and
+        //! reports the statistics of all plugin executors: throughput, processing
+        //! time, time waiting for packets and occupancy of the packet windows.
+        //! The report is logged as text and optionally saved in a JSON file.
+        //!
+        class PipelineMonitor: public Thread
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] options Command line options for tsp.
+            //! @param [in] report Where to report log data.
+            //! @param [in] input The input plugin executor, first one in the ring of executors.
+            //!
+            PipelineMonitor(const Options* options, Report* report, PluginExecutor* input);
+
+            //!
+            //! Destructor.
+            //!
+            virtual ~PipelineMonitor();
+
+            //!
+            //! Terminate the monitoring thread and display a final report.
+            //! Must be called before deleting the plugin executors.
+            //!
+            void terminate();
+
+        private:
+            // Statistics of a plugin, as collected at the last report.
+            typedef std::vector<PluginExecutor::PipelineStats> StatsVector;
+
+            Report*         _report;
+            PluginExecutor* _input;
+            MilliSecond     _interval;
+            UString         _json_file;
+            Mutex           _mutex;
+            Condition       _wake_up;    // accessed under mutex
+            bool            _terminate;  // accessed under mutex
+
+            // Collect the current statistics of all plugins.
+            void collect(StatsVector& stats);
+
+            // Report the statistics between two collections.
+            void display(const StatsVector& previous, const StatsVector& current, MilliSecond duration, bool final);
+
+            // Inherited from Thread
+            virtual void main() override;
+
+            // Inaccessible operations.
+            PipelineMonitor() = delete;
+            PipelineMonitor(const PipelineMonitor&) = delete;
+            PipelineMonitor& operator=(const PipelineMonitor&) = delete;
+        };
+    }
+}
@@ -35,6 +35,7 @@
 #include "tsPluginRepository.h"
 #include "tsGuardCondition.h"
 #include "tsGuard.h"
+#include "tsMonotonic.h"
 TSDUCK_SOURCE;
 
 
@@ -54,10 +55,23 @@ ts::tsp::PluginExecutor::PluginExecutor(Options* options,
     _buffer(0),
     _report(options),
     _to_do(),
+    _lock_free(options->lock_free),
+    _spin_wait(options->spin_wait * NanoSecPerMicroSec),
+    _monitor(options->monitor_pipeline > 0),
     _pkt_first(0),
     _pkt_cnt(0),
     _input_end(false),
-    _bitrate(0)
+    _bitrate(0),
+    _waiting(false),
+    _stat_started(false),
+    _stat_time(),
+    _stat_now(),
+    _stat_packets(0),
+    _stat_batches(0),
+    _stat_process_ns(0),
+    _stat_wait_ns(0),
+    _stat_window_sum(0),
+    _stat_window_max(0)
 {
     const UChar* shell = 0;
 
@@ -145,6 +159,7 @@ void ts::tsp::PluginExecutor::initBuffer(PacketBuffer* buffer,
     _tsp_aborting = aborted;
     _bitrate = bitrate;
     _tsp_bitrate = bitrate;
+    _waiting = false;
 }
 
 
@@ -184,6 +199,11 @@ void ts::tsp::PluginExecutor::passPackets(size_t count,     // of packets to pas
 
     log(10, u"passPackets (count = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {count, bitrate, input_end, aborted});
 
+    if (_lock_free) {
+        passPacketsLockFree(count, bitrate, input_end, aborted);
+        return;
+    }
+
     // We access data under the protection of the global mutex.
 
     Guard lock(_global_mutex);
@@ -243,25 +263,221 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first,
 {
     log(10, u"waitWork(...)");
 
-    // We access data under the protection of the global mutex.
+    // Collect pipeline statistics: end of processing of previous batch.
+    if (_monitor) {
+        statBeforeWait();
+    }
+
+    // Optionally spin a little while before sleeping.
+    if (_spin_wait > 0) {
+        spinWork();
+    }
+
+    if (_lock_free) {
+        waitWorkLockFree(pkt_first, pkt_cnt, bitrate, input_end, aborted);
+    }
+    else {
+        // We access data under the protection of the global mutex.
+
+        GuardCondition lock(_global_mutex, _to_do);
+
+        while (_pkt_cnt == 0 && !_input_end && !ringNext<PluginExecutor>()->_tsp_aborting) {
+
+            // If packet area for this processor is empty, wait for some packet.
+            // The mutex is implicitely released, we wait for the condition
+            // '_to_do' and, once we get it, implicitely relock the mutex.
+            // We loop on this until packets are actually available.
+
+            lock.waitCondition();
+        }
+
+        pkt_first = _pkt_first;
+        pkt_cnt = std::min<size_t>(_pkt_cnt, _buffer->count() - _pkt_first);
+        bitrate = _bitrate;
+        input_end = _input_end && pkt_cnt == _pkt_cnt;
+        aborted = ringNext<PluginExecutor>()->_tsp_aborting;
+
+        log(10, u"waitWork (pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {pkt_first, pkt_cnt, bitrate, input_end, aborted});
+    }
+
+    // Collect pipeline statistics: start of processing of new batch.
+    if (_monitor) {
+        statAfterWait();
+    }
+}
 
-    GuardCondition lock(_global_mutex, _to_do);
 
-    while (_pkt_cnt == 0 && !_input_end && !ringNext<PluginExecutor>()->_tsp_aborting) {
+//----------------------------------------------------------------------------
+// Pipeline statistics (tsp --monitor-pipeline).
+// The statistics are updated by the plugin thread only and read by the
+// monitor thread. Relaxed atomic load and store are sufficient.
+//----------------------------------------------------------------------------
 
-        // If packet area for this processor is empty, wait for some packet.
-        // The mutex is implicitely released, we wait for the condition
-        // '_to_do' and, once we get it, implicitely relock the mutex.
-        // We loop on this until packets are actually available.
+ts::tsp::PluginExecutor::PipelineStats::PipelineStats() :
+    packets(0),
+    batches(0),
+    process_ns(0),
+    wait_ns(0),
+    window_sum(0),
+    window_max(0)
+{
+}
 
-        lock.waitCondition();
+namespace {
+    template <typename T>
+    inline void StatAdd(std::atomic<T>& stat, T value)
+    {
+        stat.store(stat.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
     }
+}
+
+void ts::tsp::PluginExecutor::statBeforeWait()
+{
+    _stat_now.getSystemTime();
+    if (_stat_started) {
+        StatAdd(_stat_process_ns, _stat_now - _stat_time);
+    }
+    _stat_time = _stat_now;
+    _stat_packets.store(totalPackets(), std::memory_order_relaxed);
+}
+
+void ts::tsp::PluginExecutor::statAfterWait()
+{
+    _stat_now.getSystemTime();
+    StatAdd(_stat_wait_ns, _stat_now - _stat_time);
+    _stat_time = _stat_now;
+    _stat_started = true;
+
+    const size_t window = _pkt_cnt;
+    StatAdd<uint64_t>(_stat_batches, 1);
+    StatAdd<uint64_t>(_stat_window_sum, window);
+    if (window > _stat_window_max.load(std::memory_order_relaxed)) {
+        _stat_window_max.store(window, std::memory_order_relaxed);
+    }
+}
+
+void ts::tsp::PluginExecutor::getPipelineStats(PipelineStats& stats)
+{
+    stats.packets = _stat_packets.load(std::memory_order_relaxed);
+    stats.batches = _stat_batches.load(std::memory_order_relaxed);
+    stats.process_ns = _stat_process_ns.load(std::memory_order_relaxed);
+    stats.wait_ns = _stat_wait_ns.load(std::memory_order_relaxed);
+    stats.window_sum = _stat_window_sum.load(std::memory_order_relaxed);
+    // The maximum is computed per collection interval. A window which is computed by the plugin
+    // thread while the maximum is reset may be missed, this is acceptable for monitoring purpose.
+    stats.window_max = _stat_window_max.exchange(0, std::memory_order_relaxed);
+}
+
+
+//----------------------------------------------------------------------------
+// Spin during _spin_wait, waiting for something to do, without lock.
+// The window description is read using atomic fields only.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::spinWork()
+{
+    // Number of checks between two reads of the system clock.
+    static const size_t CHECKS_PER_CLOCK = 64;
+
+    const PluginExecutor* next = ringNext<PluginExecutor>();
+    Monotonic start;
+    Monotonic now;
+    start.getSystemTime();
+
+    for (;;) {
+        for (size_t i = 0; i < CHECKS_PER_CLOCK; ++i) {
+            if (_pkt_cnt > 0 || _input_end || next->_tsp_aborting) {
+                return true;
+            }
+        }
+        now.getSystemTime();
+        if (now - start >= _spin_wait) {
+            return false;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free version of passPackets().
+//
+// Our _pkt_first is only used by this thread. The windows sizes are atomic
+// counters. The order of the operations is important: the next processor
+// must see the new packets before the end of input and we must see if the
+// next processor is sleeping only after publishing the packets. All atomic
+// operations are sequentially consistent so that either the next processor
+// sees the new packets before sleeping or we see it waiting and notify it.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::passPacketsLockFree(size_t count, BitRate bitrate, bool input_end, bool aborted)
+{
+    // Update our buffer.
+    _pkt_first = (_pkt_first + count) % _buffer->count();
+    _pkt_cnt -= count;
+
+    // Update next processor's buffer.
+    PluginExecutor* next = ringNext<PluginExecutor>();
+    next->_bitrate = bitrate;
+    next->_pkt_cnt += count;
+    if (input_end) {
+        next->_input_end = true;
+    }
+
+    // Wake the next processor when there is some data, only if it sleeps.
+    if ((count > 0 || input_end) && next->_waiting) {
+        Guard lock(_global_mutex);
+        next->_to_do.signal();
+    }
+
+    // Wake the previous processor when we abort. This is an exceptional
+    // situation, no need to optimize it.
+    if (aborted) {
+        Guard lock(_global_mutex);
+        _tsp_aborting = true; // volatile bool in TSP superclass
+        ringPrevious<PluginExecutor>()->_to_do.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free version of waitWork().
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::waitWorkLockFree(size_t& pkt_first,
+                                               size_t& pkt_cnt,
+                                               BitRate& bitrate,
+                                               bool& input_end,
+                                               bool& aborted)
+{
+    PluginExecutor* next = ringNext<PluginExecutor>();
+
+    // Fast path: there is already something to do, no need to lock anything.
+    if (_pkt_cnt == 0 && !_input_end && !next->_tsp_aborting) {
+
+        // Slow path: the window is empty, we need to sleep. We declare that
+        // we are waiting before checking the window again. Since the previous
+        // processor checks _waiting after publishing its packets, either we see
+        // the new packets here or the previous processor sees us waiting and
+        // locks the mutex to signal the condition.
+        GuardCondition lock(_global_mutex, _to_do);
+        _waiting = true;
+        while (_pkt_cnt == 0 && !_input_end && !next->_tsp_aborting) {
+            lock.waitCondition();
+        }
+        _waiting = false;
+    }
+
+    // Get the end of input indicator first. Since the previous processor
+    // increments our window before setting _input_end, all packets are
+    // already in the window when we see the end of input.
+    const bool end = _input_end;
+    const size_t cnt = _pkt_cnt;
 
     pkt_first = _pkt_first;
-    pkt_cnt = std::min(_pkt_cnt, _buffer->count() - _pkt_first);
+    pkt_cnt = std::min(cnt, _buffer->count() - _pkt_first);
     bitrate = _bitrate;
-    input_end = _input_end && pkt_cnt == _pkt_cnt;
-    aborted = ringNext<PluginExecutor>()->_tsp_aborting;
+    input_end = end && pkt_cnt == cnt;
+    aborted = next->_tsp_aborting;
 
     log(10, u"waitWork (pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {pkt_first, pkt_cnt, bitrate, input_end, aborted});
 }
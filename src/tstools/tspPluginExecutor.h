@@ -42,6 +42,8 @@
 #include "tsCondition.h"
 #include "tsMutex.h"
 #include "tsThread.h"
+#include "tsMonotonic.h"
+#include <atomic>
 
 namespace ts {
     namespace tsp {
@@ -95,6 +97,13 @@ namespace ts {
         //!  window of the next processor), it must notify the _to_do condition variable
         //!  of the next thread.
         //!
+        //!  With the tsp option -\-lock-free-buffer, the global mutex is no longer used
+        //!  to pass packets. Each window is a single-producer / single-consumer queue:
+        //!  "_pkt_first" is only used by the owner of the window and "_pkt_cnt" is an
+        //!  atomic counter which is incremented by the previous processor and decremented
+        //!  by the owner. The global mutex and the "_to_do" condition are used only
+        //!  when a processor actually needs to sleep because its window is empty.
+        //!
         //!  When a packet processor decides to drop a packet, the synchronization
         //!  byte (first byte of the packet, normally 0x47) is reset to zero. When
         //!  a packet processor or the output processor encounters a packet starting
@@ -192,6 +201,54 @@ namespace ts {
                 return _shlib;
             }
 
+            //!
+            //! Get the plugin name.
+            //! @return A constant reference to the plugin name.
+            //!
+            const UString& pluginName() const
+            {
+                return _name;
+            }
+
+            //!
+            //! Get the size of the global packet buffer.
+            //! @return The size of the global packet buffer in packets or zero if not yet initialized.
+            //!
+            size_t bufferSize() const
+            {
+                return _buffer == 0 ? 0 : _buffer->count();
+            }
+
+            //!
+            //! Pipeline monitoring statistics of a plugin executor (tsp option -\-monitor-pipeline).
+            //! All values are cumulated since the start of the plugin thread,
+            //! except the maximum window size which is computed since the previous collection.
+            //! For the input plugin, the window is the free space in the packet buffer.
+            //!
+            struct PipelineStats
+            {
+                PacketCounter packets;     //!< Number of processed packets.
+                uint64_t      batches;     //!< Number of batches, ie. number of returns from waitWork().
+                NanoSecond    process_ns;  //!< Processing time (outside waitWork()) in nanoseconds.
+                NanoSecond    wait_ns;     //!< Time in waitWork() in nanoseconds.
+                uint64_t      window_sum;  //!< Sum of the window sizes at the start of each batch.
+                size_t        window_max;  //!< Maximum window size at the start of a batch since previous call to getPipelineStats().
+
+                //!
+                //! Default constructor.
+                //!
+                PipelineStats();
+            };
+
+            //!
+            //! Get the current pipeline monitoring statistics of this plugin executor.
+            //! Can be called from any thread. The statistics are updated only when
+            //! the tsp option -\-monitor-pipeline is specified. The maximum window
+            //! size is reset after each call, it should be called from one single thread.
+            //! @param [out] stats Receive the statistics.
+            //!
+            void getPipelineStats(PipelineStats& stats);
+
         protected:
             UString       _name;   //!< Plugin name.
             Plugin*       _shlib;  //!< Shared library API.
@@ -233,19 +290,58 @@ namespace ts {
                           bool& input_end,
                           bool& aborted);
 
+            //!
+            //! Get the number of packets which are waiting in the window of the next processor.
+            //! This is an instantaneous value which can be read without lock.
+            //! @return Number of packets in the window of the next processor.
+            //!
+            size_t nextBacklog() const
+            {
+                return ringNext<PluginExecutor>()->_pkt_cnt;
+            }
+
             // Inherited from Report (via TSP)
             virtual void writeLog(int severity, const UString& msg) override;
 
         private:
-            Report*   _report;   // Common report interface for all plugins
-            Condition _to_do;    // Notify processor to do something
+            Report*          _report;     // Common report interface for all plugins
+            Condition        _to_do;      // Notify processor to do something
+            const bool       _lock_free;  // Do not use the global mutex to pass packets
+            const NanoSecond _spin_wait;  // Spin duration before sleeping on _to_do
+            const bool       _monitor;    // Collect pipeline statistics
+
+            // Without --lock-free-buffer, the following private data must be accessed
+            // exclusively under the protection of the global mutex. With --lock-free-buffer,
+            // _pkt_first is accessed only by the thread of this processor and the atomic
+            // fields are updated without lock. Only _waiting is set under the global mutex.
+            size_t               _pkt_first;  // Starting index of packets area
+            std::atomic<size_t>  _pkt_cnt;    // Size of packets area
+            std::atomic<bool>    _input_end;  // No more packet after current ones
+            std::atomic<BitRate> _bitrate;    // Input bitrate (set by previous plugin)
+            std::atomic<bool>    _waiting;    // Processor is sleeping (or about to sleep) on _to_do
+
+            // Pipeline statistics. The atomic ones are read by the monitor thread.
+            bool                       _stat_started;     // At least one batch was started
+            Monotonic                  _stat_time;        // Time of last waitWork() entry or exit
+            Monotonic                  _stat_now;         // Current time (avoid constructing Monotonic objects)
+            std::atomic<PacketCounter> _stat_packets;
+            std::atomic<uint64_t>      _stat_batches;
+            std::atomic<NanoSecond>    _stat_process_ns;
+            std::atomic<NanoSecond>    _stat_wait_ns;
+            std::atomic<uint64_t>      _stat_window_sum;
+            std::atomic<size_t>        _stat_window_max;
+
+            // Update pipeline statistics when entering and leaving waitWork().
+            void statBeforeWait();
+            void statAfterWait();
+
+            // Spin during _spin_wait, waiting for something to do, without lock.
+            // Return true if there is something to do, false on timeout.
+            bool spinWork();
 
-            // The following private data must be accessed exclusively under the
-            // protection of the global mutex.
-            size_t  _pkt_first;  // Starting index of packets area
-            size_t  _pkt_cnt;    // Size of packets area
-            bool    _input_end;  // No more packet after current ones
-            BitRate _bitrate;    // Input bitrate (set by previous plugin)
+            // Lock-free implementations of passPackets() and waitWork().
+            void passPacketsLockFree(size_t count, BitRate bitrate, bool input_end, bool aborted);
+            void waitWorkLockFree(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted);
 
             // Inaccessible operations.
             PluginExecutor() = delete;
@@ -35,6 +35,11 @@
 TSDUCK_SOURCE;
 
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::tsp::ProcessorExecutor::MAX_BATCH_PKT;
+#endif
+
+
 //----------------------------------------------------------------------------
 // Constructor
 //----------------------------------------------------------------------------
@@ -46,11 +51,43 @@ ts::tsp::ProcessorExecutor::ProcessorExecutor(Options* options,
 
     PluginExecutor(options, pl_options, attributes, global_mutex),
     _processor(dynamic_cast<ProcessorPlugin*>(_shlib)),
-    _max_flush_pkt(options->max_flush_pkt)
+    _max_flush_pkt(options->max_flush_pkt),
+    _adaptive_flush(options->adaptive_flush),
+    _status(std::min<size_t>(_max_flush_pkt, MAX_BATCH_PKT))
 {
 }
 
 
+//----------------------------------------------------------------------------
+// With --adaptive-flush, compute the next number of packets to process
+// before flush. The backlog is the number of packets which were waiting
+// in the window of the next processor at the time of the last flush.
+//----------------------------------------------------------------------------
+
+size_t ts::tsp::ProcessorExecutor::adaptFlushLimit(size_t current, size_t backlog) const
+{
+    // Minimum number of packets before flush.
+    static const size_t MIN_FLUSH_PKT = 8;
+
+    // The upper limit is the number of packets received during the max latency.
+    size_t max_pkt = _max_flush_pkt;
+    if (_tsp_bitrate > 0) {
+        max_pkt = std::min(max_pkt, std::max(MIN_FLUSH_PKT, size_t(PacketDistance(_tsp_bitrate, Options::ADAPTIVE_FLUSH_LATENCY))));
+    }
+    const size_t min_pkt = std::min(MIN_FLUSH_PKT, max_pkt);
+
+    if (backlog == 0) {
+        // The next processor has nothing to do, flush sooner to reduce its latency.
+        current /= 2;
+    }
+    else if (backlog >= current) {
+        // The next processor is late, flush larger batches to reduce the number of wakeups.
+        current *= 2;
+    }
+    return std::max(min_pkt, std::min(current, max_pkt));
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processor plugin thread
 //----------------------------------------------------------------------------
@@ -66,6 +103,7 @@ void ts::tsp::ProcessorExecutor::main()
     bool bitrate_never_modified = true;
     bool input_end = false;
     bool aborted = false;
+    size_t flush_limit = _max_flush_pkt;
 
     do {
         // Wait for packets to process
@@ -97,7 +135,7 @@ void ts::tsp::ProcessorExecutor::main()
             break;
         }
 
-        // Now process the packets.
+        // Now process the packets by batches. A batch never goes beyond the next flush point.
 
         size_t pkt_done = 0;
         size_t pkt_flush = 0;
@@ -105,38 +143,46 @@ void ts::tsp::ProcessorExecutor::main()
         while (pkt_done < pkt_cnt) {
 
             bool flush_request = false;
-            TSPacket* pkt = _buffer->base() + pkt_first + pkt_done;
+            bool bitrate_changed = false;
+            TSPacket* const pkt = _buffer->base() + pkt_first + pkt_done;
+            const size_t batch = std::min(std::min(pkt_cnt - pkt_done, flush_limit - pkt_flush), _status.size());
 
-            pkt_done++;
-            pkt_flush++;
+            // Let the plugin process the batch. Packets which were already dropped
+            // by a previous packet processor are not processed and marked as dropped.
 
-            // If the packet has not already been dropped by a previous
-            // packet processor, apply the processing routine to the packet
+            const size_t processed = _processor->processPacketBatch(pkt, &_status[0], batch, flush_request, bitrate_changed);
+            assert(processed <= batch);
 
-            if (pkt->b[0] != 0) {
+            pkt_done += processed;
+            pkt_flush += processed;
+            addTotalPackets (processed);
 
-                bool bitrate_changed = false;
-                ProcessorPlugin::Status status = _processor->processPacket (*pkt, flush_request, bitrate_changed);
+            // Use the returned status. Already dropped packets are not counted.
 
-                // Use the returned status
-                switch (status) {
+            for (size_t i = 0; i < processed; ++i) {
+                switch (_status[i]) {
                     case ProcessorPlugin::TSP_OK:
                         // Normal case, pass packet
-                        passed_packets++;
+                        if (pkt[i].b[0] != 0) {
+                            passed_packets++;
+                        }
                         break;
                     case ProcessorPlugin::TSP_NULL:
                         // Replace the packet with a complete null packet
-                        *pkt = NullPacket;
+                        pkt[i] = NullPacket;
                         nullified_packets++;
                         break;
                     case ProcessorPlugin::TSP_DROP:
                         // Drop this packet.
-                        pkt->b[0] = 0;
-                        dropped_packets++;
+                        if (pkt[i].b[0] != 0) {
+                            pkt[i].b[0] = 0;
+                            dropped_packets++;
+                        }
                         break;
                     case ProcessorPlugin::TSP_END:
                         // Signal end of input to successors and abort
-                        // to predecessors
+                        // to predecessors. This is the last processed
+                        // packet and it is not passed.
                         input_end = aborted = true;
                         pkt_done--;
                         pkt_flush--;
@@ -144,27 +190,29 @@ void ts::tsp::ProcessorExecutor::main()
                         break;
                     default:
                         // Invalid status, report error and accept packet.
-                        error(u"invalid packet processing status %d", {status});
+                        error(u"invalid packet processing status %d", {_status[i]});
                         break;
                 }
+            }
 
-                // If the packet processor has signaled a new bitrate, get it.
-                if (bitrate_changed) {
-                    BitRate new_bitrate = _processor->getBitrate();
-                    if (new_bitrate != 0) {
-                        bitrate_never_modified = false;
-                        output_bitrate = new_bitrate;
-                    }
+            // If the packet processor has signaled a new bitrate, get it.
+
+            if (bitrate_changed) {
+                BitRate new_bitrate = _processor->getBitrate();
+                if (new_bitrate != 0) {
+                    bitrate_never_modified = false;
+                    output_bitrate = new_bitrate;
                 }
             }
 
-            addTotalPackets (1);
-
             // Do not wait to process pkt_cnt packets before notifying
             // the next processor. Perform periodic flush to avoid waiting
             // too long before two output operations.
 
-            if (flush_request || pkt_done == pkt_cnt || pkt_flush % _max_flush_pkt == 0) {
+            if (flush_request || pkt_done == pkt_cnt || pkt_flush >= flush_limit) {
+                if (_adaptive_flush) {
+                    flush_limit = adaptFlushLimit(flush_limit, nextBacklog());
+                }
                 passPackets (pkt_flush, output_bitrate, pkt_done == pkt_cnt && input_end, aborted);
                 pkt_flush = 0;
             }
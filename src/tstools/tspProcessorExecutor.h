@@ -65,6 +65,14 @@ namespace ts {
         private:
             ProcessorPlugin* _processor;
             size_t const     _max_flush_pkt;   // Max processed packets before flush
+            bool const       _adaptive_flush;  // Dynamically adjust the number of packets before flush
+            std::vector<ProcessorPlugin::Status> _status;  // Packet status of a batch
+
+            // Maximum number of packets in a batch (size of the status array).
+            static const size_t MAX_BATCH_PKT = 4096;
+
+            // With --adaptive-flush, compute the next number of packets to process before flush.
+            size_t adaptFlushLimit(size_t current, size_t backlog) const;
 
             // Inherited from Thread
             virtual void main() override;
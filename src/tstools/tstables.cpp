@@ -32,11 +32,13 @@
 //----------------------------------------------------------------------------
 
 #include "tsArgs.h"
-#include "tsInputRedirector.h"
+#include "tsTSFileInput.h"
 #include "tsTablesLogger.h"
 #include "tsVersionInfo.h"
 TSDUCK_SOURCE;
 
+#define READ_CHUNK 8192  // Number of TS packets per read operation
+
 // With static link, enforce a reference to MPEG/DVB structures.
 #if defined(TSDUCK_STATIC_LIBRARY)
 #include "tsStaticReferencesDVB.h"
@@ -95,15 +97,30 @@ int main(int argc, char *argv[])
     if (opt.logger.use_udp && !ts::IPInitialize()) {
         return EXIT_FAILURE;
     }
-    ts::InputRedirector input(opt.infile, opt);
     ts::TablesDisplay display(opt.display, opt);
     ts::TablesLogger logger(opt.logger, display, opt);
-    ts::TSPacket pkt;
+    ts::TSFileInput file;
+    ts::TSPacketVector buffer(READ_CHUNK);
 
-    // Read all packets in the file and pass them to the logger
-    while (!logger.completed() && pkt.read(std::cin, true, opt)) {
-        logger.feedPacket(pkt);
+    // Read all packets in the file and pass them to the logger.
+    // The file is read by large chunks and asynchronously read ahead.
+    if (!file.open(opt.infile, 1, 0, opt)) {
+        return EXIT_FAILURE;
+    }
+    size_t count = 0;
+    bool ok = true;
+    while (ok && !logger.completed() && (count = file.read(&buffer[0], buffer.size(), opt)) > 0) {
+        for (size_t i = 0; ok && i < count && !logger.completed(); ++i) {
+            ok = buffer[i].hasValidSync();
+            if (ok) {
+                logger.feedPacket(buffer[i]);
+            }
+            else {
+                opt.error(u"synchronization lost after %'d TS packets, got 0x%X instead of 0x%X at start of TS packet", {file.getPacketCount() - count + i, buffer[i].b[0], ts::SYNC_BYTE});
+            }
+        }
     }
+    file.close(opt);
 
     // Report errors
     if (opt.verbose() && !logger.hasErrors()) {
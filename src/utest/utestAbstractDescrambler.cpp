@@ -0,0 +1,524 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//
+//  CppUnit test suite for class ts::AbstractDescrambler
+//
+//----------------------------------------------------------------------------
+
+#include "tsAbstractDescrambler.h"
+#include "tsOneShotPacketizer.h"
+#include "tsCADescriptor.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
+#include "tsSysUtils.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class AbstractDescramblerTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testSynchronous();
+    void testOrderPerPID();
+    void testDuplicateAfterQueue();
+    void testDuplicateInProgress();
+    void testRestart();
+
+    CPPUNIT_TEST_SUITE(AbstractDescramblerTest);
+    CPPUNIT_TEST(testSynchronous);
+    CPPUNIT_TEST(testOrderPerPID);
+    CPPUNIT_TEST(testDuplicateAfterQueue);
+    CPPUNIT_TEST(testDuplicateInProgress);
+    CPPUNIT_TEST(testRestart);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AbstractDescramblerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void AbstractDescramblerTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void AbstractDescramblerTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test environment.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Service 1: component PID 300 with ECM PID 200, component PID 301 with ECM PID 201.
+    const ts::PID PMT_PID = 100;
+    const ts::PID ECM_PID0 = 200;
+    const ts::PID ECM_PID1 = 201;
+    const ts::PID ES_PID0 = 300;
+    const ts::PID ES_PID1 = 301;
+
+    // Maximum time to wait for a deciphering event.
+    const ts::MilliSecond TIMEOUT = 5000;
+
+    // A minimal tsp environment for plugins.
+    class TestTSP: public ts::TSP
+    {
+    public:
+        TestTSP() : ts::TSP(ts::Severity::Info) {}
+        virtual void useJointTermination(bool) override {}
+        virtual void jointTerminate() override {}
+        virtual bool useJointTermination() const override { return false; }
+        virtual bool thisJointTerminated() const override { return false; }
+    protected:
+        virtual void writeLog(int severity, const ts::UString& msg) override { utest::Out() << "TestTSP: " << msg << std::endl; }
+    };
+
+    // A descrambler with a fake CAS. The ECM payload contains the CW byte (same
+    // byte in all positions of both CW), the deciphering time in units of 10 ms
+    // and an ECM identifier. Deciphered ECM's are recorded in order of completion.
+    // When the CAS is held, the deciphering of ECM's starts but does not complete
+    // until the CAS is released.
+    class TestDescrambler: public ts::AbstractDescrambler
+    {
+    public:
+        TestDescrambler(ts::TSP* tsp_) :
+            ts::AbstractDescrambler(tsp_, u"test", u"[options]"),
+            _lock(),
+            _progress(),
+            _resume(),
+            _hold(false),
+            _started(0),
+            _running(),
+            _deciphered(),
+            _overlaps()
+        {
+        }
+
+        // Start in synchronous mode (no thread) or with ECM threads.
+        bool start(size_t ecm_threads)
+        {
+            return startDescrambler(ecm_threads == 0, false, ts::Service(u"1"), 0, ecm_threads);
+        }
+
+        // Identifiers of deciphered ECM's, in order of completion.
+        std::vector<uint8_t> deciphered()
+        {
+            ts::Guard lock(_lock);
+            return _deciphered;
+        }
+
+        // Pairs of ECM's which were deciphered at the same time.
+        std::vector<std::pair<uint8_t, uint8_t>> overlaps()
+        {
+            ts::Guard lock(_lock);
+            return _overlaps;
+        }
+
+        // Hold or release the deciphering of ECM's.
+        void hold()
+        {
+            ts::Guard lock(_lock);
+            _hold = true;
+        }
+
+        void release()
+        {
+            ts::GuardCondition lock(_lock, _resume);
+            _hold = false;
+            lock.signal();
+        }
+
+        // Wait until the deciphering of a number of ECM's has started.
+        bool waitStarted(size_t count)
+        {
+            ts::GuardCondition lock(_lock, _progress);
+            while (_started < count) {
+                if (!lock.waitCondition(TIMEOUT)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Wait until a number of ECM's are deciphered.
+        bool waitDeciphered(size_t count)
+        {
+            ts::GuardCondition lock(_lock, _progress);
+            while (_deciphered.size() < count) {
+                if (!lock.waitCondition(TIMEOUT)) {
+                    return false;
+                }
+            }
+            return _deciphered.size() == count;
+        }
+
+    protected:
+        virtual bool checkCADescriptor(uint16_t cas_id, const uint8_t* priv, size_t priv_size) override
+        {
+            return true;
+        }
+
+        virtual bool checkECM(const uint8_t* ecm, size_t ecm_size) override
+        {
+            return ecm_size >= 3;
+        }
+
+        virtual bool decipherECM(const uint8_t* ecm, size_t ecm_size, uint8_t* cw_even, uint8_t* cw_odd) override
+        {
+            {
+                ts::GuardCondition lock(_lock, _progress);
+                for (std::set<uint8_t>::const_iterator it = _running.begin(); it != _running.end(); ++it) {
+                    _overlaps.push_back(std::make_pair(*it, ecm[2]));
+                }
+                _running.insert(ecm[2]);
+                _started++;
+                lock.signal();
+            }
+            {
+                ts::GuardCondition lock(_lock, _resume);
+                while (_hold) {
+                    lock.waitCondition();
+                }
+                // Wake up the next held thread, if any.
+                lock.signal();
+            }
+            ts::SleepThread(10 * ecm[1]);
+            ::memset(cw_even, ecm[0], ts::CW_BYTES);
+            ::memset(cw_odd, ecm[0], ts::CW_BYTES);
+            {
+                ts::GuardCondition lock(_lock, _progress);
+                _running.erase(ecm[2]);
+                _deciphered.push_back(ecm[2]);
+                lock.signal();
+            }
+            return true;
+        }
+
+    private:
+        ts::Mutex                                _lock;
+        ts::Condition                            _progress;  // Signaled when a deciphering starts or completes.
+        ts::Condition                            _resume;    // Signaled when the CAS is released.
+        bool                                     _hold;
+        size_t                                   _started;
+        std::set<uint8_t>                        _running;
+        std::vector<uint8_t>                     _deciphered;
+        std::vector<std::pair<uint8_t, uint8_t>> _overlaps;
+    };
+
+    // Build the test stream and feed it into a descrambler.
+    class TestStream
+    {
+    public:
+        TestStream(ts::AbstractDescrambler& desc) :
+            _desc(desc),
+            _cc(),
+            _tid()
+        {
+        }
+
+        // Send the PAT and PMT of the service.
+        void psi()
+        {
+            ts::PAT pat(0, true, 1);
+            pat.pmts[1] = PMT_PID;
+            send(ts::PID_PAT, pat);
+
+            ts::PMT pmt(0, true, 1, ES_PID0);
+            pmt.streams[ES_PID0].stream_type = 0x02;
+            pmt.streams[ES_PID0].descs.add(ts::CADescriptor(0x1234, ECM_PID0));
+            pmt.streams[ES_PID1].stream_type = 0x03;
+            pmt.streams[ES_PID1].descs.add(ts::CADescriptor(0x1234, ECM_PID1));
+            send(PMT_PID, pmt);
+        }
+
+        // Send an ECM. The table id alternates on each PID, as in real ECM streams.
+        void ecm(ts::PID pid, uint8_t cw, uint8_t delay, uint8_t id)
+        {
+            const uint8_t payload[] = {cw, delay, id, 0x55, 0x55, 0x55};
+            const ts::TID tid = _tid[pid] = _tid[pid] == ts::TID_ECM_80 ? ts::TID_ECM_81 : ts::TID_ECM_80;
+            ts::OneShotPacketizer pzer(pid);
+            pzer.addSection(new ts::Section(tid, true, payload, sizeof(payload)));
+            send(pzer);
+        }
+
+        // Scramble a packet with a CW byte on a PID, check that the descrambler restores it.
+        bool check(ts::PID pid, uint8_t cw)
+        {
+            ts::TSPacket plain;
+            plain = ts::NullPacket;
+            plain.setPID(pid);
+            for (size_t i = 4; i < ts::PKT_SIZE; ++i) {
+                plain.b[i] = uint8_t(i + cw);
+            }
+            uint8_t key[ts::CW_BYTES];
+            ::memset(key, cw, sizeof(key));
+            ts::Scrambling scrambling;
+            scrambling.init(key, ts::Scrambling::FULL_CW);
+
+            ts::TSPacket pkt;
+            pkt = plain;
+            scrambling.encrypt(pkt.getPayload(), pkt.getPayloadSize());
+            pkt.setScrambling(ts::SC_EVEN_KEY);
+
+            bool flush = false;
+            bool bitrate_changed = false;
+            _desc.processPacket(pkt, flush, bitrate_changed);
+            return pkt.getScrambling() == ts::SC_CLEAR && ::memcmp(pkt.getPayload(), plain.getPayload(), pkt.getPayloadSize()) == 0;
+        }
+
+        // Same as check() but wait for the CW to be set by an ECM thread after deciphering.
+        bool waitCheck(ts::PID pid, uint8_t cw)
+        {
+            for (ts::MilliSecond wait = 0; wait < TIMEOUT; wait += 10) {
+                if (check(pid, cw)) {
+                    return true;
+                }
+                ts::SleepThread(10);
+            }
+            return false;
+        }
+
+    private:
+        ts::AbstractDescrambler& _desc;
+        std::map<ts::PID, uint8_t> _cc;
+        std::map<ts::PID, ts::TID> _tid;
+
+        void send(ts::PID pid, const ts::AbstractTable& table)
+        {
+            ts::BinaryTable bin;
+            table.serialize(bin);
+            ts::OneShotPacketizer pzer(pid);
+            pzer.addTable(bin);
+            send(pzer);
+        }
+
+        void send(ts::OneShotPacketizer& pzer)
+        {
+            ts::TSPacketVector packets;
+            pzer.getPackets(packets);
+            bool flush = false;
+            bool bitrate_changed = false;
+            for (size_t i = 0; i < packets.size(); ++i) {
+                uint8_t& cc(_cc[packets[i].getPID()]);
+                packets[i].setCC(cc);
+                cc = (cc + 1) & ts::CC_MASK;
+                _desc.processPacket(packets[i], flush, bitrate_changed);
+            }
+        }
+
+        // Inaccessible operations.
+        TestStream(const TestStream&) = delete;
+        TestStream& operator=(const TestStream&) = delete;
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void AbstractDescramblerTest::testSynchronous()
+{
+    TestTSP tsp;
+    TestDescrambler desc(&tsp);
+    TestStream stream(desc);
+
+    CPPUNIT_ASSERT(desc.start(0));
+    stream.psi();
+
+    // In synchronous mode, the CW are available after the ECM packet.
+    stream.ecm(ECM_PID0, 0x11, 0, 1);
+    CPPUNIT_ASSERT(stream.check(ES_PID0, 0x11));
+
+    // An identical ECM on another PID is not deciphered again.
+    stream.ecm(ECM_PID1, 0x11, 0, 1);
+    CPPUNIT_ASSERT(stream.check(ES_PID1, 0x11));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), desc.deciphered().size());
+
+    stream.ecm(ECM_PID0, 0x22, 0, 2);
+    CPPUNIT_ASSERT(stream.check(ES_PID0, 0x22));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), desc.deciphered().size());
+
+    CPPUNIT_ASSERT(desc.stop());
+}
+
+void AbstractDescramblerTest::testOrderPerPID()
+{
+    TestTSP tsp;
+    TestDescrambler desc(&tsp);
+    TestStream stream(desc);
+
+    CPPUNIT_ASSERT(desc.start(4));
+    stream.psi();
+
+    // Three ECM's on each PID, queued while the CAS is held. Only the first
+    // ECM of each PID can be submitted to the CAS, in parallel.
+    desc.hold();
+    stream.ecm(ECM_PID0, 0x11, 5, 1);
+    stream.ecm(ECM_PID1, 0x21, 5, 4);
+    stream.ecm(ECM_PID0, 0x12, 2, 2);
+    stream.ecm(ECM_PID1, 0x22, 2, 5);
+    stream.ecm(ECM_PID0, 0x13, 1, 3);
+    stream.ecm(ECM_PID1, 0x23, 1, 6);
+    CPPUNIT_ASSERT(desc.waitStarted(2));
+    desc.release();
+    CPPUNIT_ASSERT(desc.waitDeciphered(6));
+
+    // On each PID, the ECM's are deciphered in order and one at a time.
+    std::vector<uint8_t> order[2];
+    const std::vector<uint8_t> deciphered(desc.deciphered());
+    for (size_t i = 0; i < deciphered.size(); ++i) {
+        order[deciphered[i] > 3].push_back(deciphered[i]);
+    }
+    const uint8_t order0[] = {1, 2, 3};
+    const uint8_t order1[] = {4, 5, 6};
+    CPPUNIT_ASSERT(order[0] == std::vector<uint8_t>(order0, order0 + 3));
+    CPPUNIT_ASSERT(order[1] == std::vector<uint8_t>(order1, order1 + 3));
+
+    // The two PID's are deciphered in parallel.
+    const std::vector<std::pair<uint8_t, uint8_t>> overlaps(desc.overlaps());
+    CPPUNIT_ASSERT(!overlaps.empty());
+    for (size_t i = 0; i < overlaps.size(); ++i) {
+        CPPUNIT_ASSERT((overlaps[i].first > 3) != (overlaps[i].second > 3));
+    }
+
+    // The last CW are used on each PID.
+    CPPUNIT_ASSERT(stream.waitCheck(ES_PID0, 0x13));
+    CPPUNIT_ASSERT(stream.waitCheck(ES_PID1, 0x23));
+
+    CPPUNIT_ASSERT(desc.stop());
+}
+
+void AbstractDescramblerTest::testDuplicateAfterQueue()
+{
+    TestTSP tsp;
+    TestDescrambler desc(&tsp);
+    TestStream stream(desc);
+
+    CPPUNIT_ASSERT(desc.start(4));
+    stream.psi();
+
+    // An ECM is deciphered on one PID.
+    stream.ecm(ECM_PID1, 0x31, 0, 1);
+    CPPUNIT_ASSERT(desc.waitDeciphered(1));
+    CPPUNIT_ASSERT(stream.waitCheck(ES_PID1, 0x31));
+
+    // On the other PID, two new ECM's are queued, followed by the already
+    // deciphered ECM. Its CW must not be used before the two others.
+    desc.hold();
+    stream.ecm(ECM_PID0, 0x32, 5, 2);
+    stream.ecm(ECM_PID0, 0x33, 1, 3);
+    CPPUNIT_ASSERT(desc.waitStarted(2));
+    stream.ecm(ECM_PID0, 0x31, 0, 1);
+    CPPUNIT_ASSERT(!stream.check(ES_PID0, 0x31));
+    desc.release();
+    CPPUNIT_ASSERT(desc.waitDeciphered(3));
+
+    const uint8_t order[] = {1, 2, 3};
+    CPPUNIT_ASSERT(desc.deciphered() == std::vector<uint8_t>(order, order + 3));
+    CPPUNIT_ASSERT(stream.waitCheck(ES_PID0, 0x31));
+    CPPUNIT_ASSERT(stream.check(ES_PID1, 0x31));
+
+    CPPUNIT_ASSERT(desc.stop());
+}
+
+void AbstractDescramblerTest::testDuplicateInProgress()
+{
+    TestTSP tsp;
+    TestDescrambler desc(&tsp);
+    TestStream stream(desc);
+
+    CPPUNIT_ASSERT(desc.start(2));
+    stream.psi();
+
+    // The same ECM on two PID's, the second one arrives while the first one
+    // is being deciphered. The second thread waits for the first one to
+    // decipher it instead of submitting it again to the CAS.
+    desc.hold();
+    stream.ecm(ECM_PID0, 0x41, 10, 1);
+    CPPUNIT_ASSERT(desc.waitStarted(1));
+    stream.ecm(ECM_PID1, 0x41, 10, 1);
+    desc.release();
+    CPPUNIT_ASSERT(desc.waitDeciphered(1));
+    CPPUNIT_ASSERT(stream.waitCheck(ES_PID0, 0x41));
+    CPPUNIT_ASSERT(stream.waitCheck(ES_PID1, 0x41));
+
+    // No more ECM to process, all threads are idle.
+    CPPUNIT_ASSERT(desc.stop());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), desc.deciphered().size());
+    CPPUNIT_ASSERT(desc.overlaps().empty());
+}
+
+void AbstractDescramblerTest::testRestart()
+{
+    TestTSP tsp;
+    TestDescrambler desc(&tsp);
+    TestStream stream(desc);
+
+    // Restart while an ECM is being deciphered, without stop().
+    CPPUNIT_ASSERT(desc.start(2));
+    stream.psi();
+    desc.hold();
+    stream.ecm(ECM_PID0, 0x51, 10, 1);
+    CPPUNIT_ASSERT(desc.waitStarted(1));
+    desc.release();
+    CPPUNIT_ASSERT(desc.start(1));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), desc.deciphered().size());
+
+    // The previous state is reset, the stream must be described again.
+    stream.psi();
+    stream.ecm(ECM_PID0, 0x52, 0, 2);
+    CPPUNIT_ASSERT(desc.waitDeciphered(2));
+    CPPUNIT_ASSERT(stream.waitCheck(ES_PID0, 0x52));
+    CPPUNIT_ASSERT(desc.stop());
+
+    // Stop and start again, in synchronous mode.
+    CPPUNIT_ASSERT(desc.start(0));
+    stream.psi();
+    stream.ecm(ECM_PID0, 0x53, 0, 3);
+    CPPUNIT_ASSERT(stream.check(ES_PID0, 0x53));
+    CPPUNIT_ASSERT(desc.stop());
+}
@@ -0,0 +1,250 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+//  CppUnit test suite for class ts::CRC32
+//
+//----------------------------------------------------------------------------
+
+#include "tsCRC32.h"
+#include "tsByteBlock.h"
+#include "tsMonotonic.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+#include "tables/psi_pat_r4_sections.h"
+#include "tables/psi_nit_tntv23_sections.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class CRC32Test: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testReference();
+    void testSections();
+    void testBenchmark();
+
+    CPPUNIT_TEST_SUITE(CRC32Test);
+    CPPUNIT_TEST(testReference);
+    CPPUNIT_TEST(testSections);
+    CPPUNIT_TEST(testBenchmark);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    bool _accelerated;
+    ts::ByteBlock _data;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CRC32Test);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void CRC32Test::setUp()
+{
+    _accelerated = ts::CRC32::IsAccelerated();
+
+    // Pseudo-random data.
+    _data.resize(64 * 1024);
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < _data.size(); ++i) {
+        seed = seed * 1103515245 + 12345;
+        _data[i] = uint8_t(seed >> 16);
+    }
+}
+
+// Test suite cleanup method.
+void CRC32Test::tearDown()
+{
+    ts::CRC32::SetAccelerated(_accelerated);
+}
+
+
+//----------------------------------------------------------------------------
+// Reference implementations.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Bit per bit computation, directly from the polynomial.
+    uint32_t BitCRC32(const uint8_t* data, size_t size)
+    {
+        uint32_t fcs = 0xFFFFFFFF;
+        while (size-- > 0) {
+            fcs ^= uint32_t(*data++) << 24;
+            for (int bit = 0; bit < 8; ++bit) {
+                fcs = (fcs & 0x80000000) != 0 ? (fcs << 1) ^ 0x04C11DB7 : fcs << 1;
+            }
+        }
+        return fcs;
+    }
+
+    // One byte at a time with one table (previous implementation of ts::CRC32).
+    class ByteCRC32
+    {
+    public:
+        ByteCRC32()
+        {
+            for (uint32_t b = 0; b < 256; ++b) {
+                uint32_t fcs = b << 24;
+                for (int bit = 0; bit < 8; ++bit) {
+                    fcs = (fcs & 0x80000000) != 0 ? (fcs << 1) ^ 0x04C11DB7 : fcs << 1;
+                }
+                _table[b] = fcs;
+            }
+        }
+        uint32_t compute(const uint8_t* data, size_t size) const
+        {
+            uint32_t fcs = 0xFFFFFFFF;
+            while (size-- > 0) {
+                fcs = (fcs << 8) ^ _table[((fcs >> 24) ^ (*data++)) & 0xFF];
+            }
+            return fcs;
+        }
+    private:
+        uint32_t _table[256];
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void CRC32Test::testReference()
+{
+    const ByteCRC32 byte_crc;
+    CPPUNIT_ASSERT_EQUAL(BitCRC32(_data.data(), 1000), byte_crc.compute(_data.data(), 1000));
+
+    for (int accel = 0; accel < 2; ++accel) {
+        const bool accelerated = ts::CRC32::SetAccelerated(accel != 0);
+        utest::Out() << "CRC32Test: accelerated: " << ts::UString::YesNo(accelerated) << std::endl;
+
+        // All sizes up to a few blocks, all alignments.
+        for (size_t offset = 0; offset < 16; ++offset) {
+            for (size_t size = 0; size <= 300; ++size) {
+                const uint32_t ref = byte_crc.compute(_data.data() + offset, size);
+                CPPUNIT_ASSERT_EQUAL(ref, ts::CRC32(_data.data() + offset, size).value());
+            }
+        }
+
+        // Large areas.
+        CPPUNIT_ASSERT_EQUAL(BitCRC32(_data.data(), _data.size()), ts::CRC32(_data.data(), _data.size()).value());
+        CPPUNIT_ASSERT_EQUAL(BitCRC32(_data.data() + 3, 4093), ts::CRC32(_data.data() + 3, 4093).value());
+
+        // Incremental computation.
+        for (size_t split = 0; split <= 1000; split += 7) {
+            ts::CRC32 crc;
+            crc.add(_data.data(), split);
+            crc.add(_data.data() + split, 1000 - split);
+            CPPUNIT_ASSERT_EQUAL(byte_crc.compute(_data.data(), 1000), crc.value());
+        }
+    }
+}
+
+void CRC32Test::testSections()
+{
+    for (int accel = 0; accel < 2; ++accel) {
+        ts::CRC32::SetAccelerated(accel != 0);
+
+        // The CRC32 is in the last 4 bytes of a section.
+        CPPUNIT_ASSERT_EQUAL(ts::GetUInt32(psi_pat_r4_sections + sizeof(psi_pat_r4_sections) - 4),
+                             ts::CRC32(psi_pat_r4_sections, sizeof(psi_pat_r4_sections) - 4).value());
+        CPPUNIT_ASSERT_EQUAL(ts::GetUInt32(psi_nit_tntv23_sections + sizeof(psi_nit_tntv23_sections) - 4),
+                             ts::CRC32(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections) - 4).value());
+
+        // The CRC32 of a complete section, including its CRC32, is zero.
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0), ts::CRC32(psi_pat_r4_sections, sizeof(psi_pat_r4_sections)).value());
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0), ts::CRC32(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections)).value());
+    }
+}
+
+void CRC32Test::testBenchmark()
+{
+    if (!utest::DebugMode()) {
+        return;
+    }
+
+    // Typical sections sizes: small PSI and maximum size.
+    static const size_t sizes[] = {188, 1024, 4096};
+    const size_t MB = 1024 * 1024;
+    const size_t total = 64 * MB;
+    const ByteCRC32 byte_crc;
+
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+        const size_t size = sizes[si];
+        const size_t loops = total / size;
+        uint32_t ref = 0;
+        uint32_t res = 0;
+
+        // One byte at a time, as in the previous implementation.
+        ts::Monotonic start;
+        start.getSystemTime();
+        for (size_t n = 0; n < loops; ++n) {
+            ref ^= byte_crc.compute(_data.data() + (n % 16), size);
+        }
+        ts::Monotonic end;
+        end.getSystemTime();
+        const ts::NanoSecond byte_duration = end - start;
+
+        // Slicing by 8.
+        ts::CRC32::SetAccelerated(false);
+        start.getSystemTime();
+        for (size_t n = 0; n < loops; ++n) {
+            res ^= ts::CRC32(_data.data() + (n % 16), size).value();
+        }
+        end.getSystemTime();
+        const ts::NanoSecond slice_duration = end - start;
+        CPPUNIT_ASSERT_EQUAL(ref, res);
+
+        // Carry-less multiplication, if supported.
+        ts::UString clmul_rate(u"unsupported");
+        if (ts::CRC32::SetAccelerated(true)) {
+            res = 0;
+            start.getSystemTime();
+            for (size_t n = 0; n < loops; ++n) {
+                res ^= ts::CRC32(_data.data() + (n % 16), size).value();
+            }
+            end.getSystemTime();
+            clmul_rate = utest::Rate(loops * size, end - start, MB) + u" MB/s";
+            CPPUNIT_ASSERT_EQUAL(ref, res);
+        }
+
+        utest::Out() << "CRC32Test: " << size << "-byte areas, one byte at a time: " << utest::Rate(loops * size, byte_duration, MB)
+                     << " MB/s, slicing by 8: " << utest::Rate(loops * size, slice_duration, MB)
+                     << " MB/s, carry-less multiplication: " << clmul_rate << std::endl;
+    }
+}
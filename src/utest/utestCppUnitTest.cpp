@@ -70,3 +70,13 @@ std::ostream& utest::Out()
 {
     return _debugStream.is_open() ? _debugStream : std::cerr;
 }
+
+
+//----------------------------------------------------------------------------
+// Format a processing rate.
+//----------------------------------------------------------------------------
+
+ts::UString utest::Rate(uint64_t count, ts::NanoSecond duration, uint64_t unit)
+{
+    return ts::UString::Decimal(duration <= 0 ? 0 : (int64_t(count) * ts::NanoSecPerSec) / (duration * ts::NanoSecond(unit)));
+}
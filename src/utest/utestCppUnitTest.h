@@ -36,6 +36,7 @@
 //----------------------------------------------------------------------------
 
 #pragma once
+#include "tsUString.h"
 #include <string>
 #include <ostream>
 #include <cppunit/extensions/HelperMacros.h>
@@ -88,6 +89,16 @@ namespace utest {
     //!
     std::ostream& Out();
 
+    //!
+    //! Format a processing rate, typically in benchmarks which run in debug mode only.
+    //!
+    //! @param [in] count Number of processed items (packets, bytes, etc.)
+    //! @param [in] duration Processing duration in nanoseconds.
+    //! @param [in] unit Number of items per displayed unit, e.g. 1024*1024 for MB/s from bytes.
+    //! @return The decimal number of units per second.
+    //!
+    ts::UString Rate(uint64_t count, ts::NanoSecond duration, uint64_t unit = 1);
+
 #if defined(UTEST_CPPUNITMAIN_CPP) || defined(UTEST_CPPUNITTEST_CPP)
     //!
     //! This static method returns a reference to the actual output file
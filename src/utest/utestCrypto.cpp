@@ -79,6 +79,7 @@ public:
     void testAES_CTS3();
     void testAES_CTS4();
     void testAES_DVS042();
+    void testAESBlocks();
     void testDES();
     void testTDES();
     void testTDES_CBC();
@@ -97,6 +98,7 @@ public:
     CPPUNIT_TEST(testAES_CTS3);
     CPPUNIT_TEST(testAES_CTS4);
     CPPUNIT_TEST(testAES_DVS042);
+    CPPUNIT_TEST(testAESBlocks);
     CPPUNIT_TEST(testDES);
     CPPUNIT_TEST(testTDES);
     CPPUNIT_TEST(testTDES_CBC);
@@ -363,6 +365,60 @@ void CryptoTest::testAES_DVS042()
     testChainingSizes(dvs042_aes, 16, 17, 23, 31, 32, 33, 45, 64, 67, 184, 12345, 0);
 }
 
+void CryptoTest::testAESBlocks()
+{
+    // Multi-block and in-place operations must give the same result as one block at a time.
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock key(ts::AES::MAX_KEY_SIZE);
+    ts::ByteBlock iv(ts::AES::BLOCK_SIZE);
+    CPPUNIT_ASSERT(prng.read(key.data(), key.size()));
+    CPPUNIT_ASSERT(prng.read(iv.data(), iv.size()));
+
+    for (size_t key_size = 16; key_size <= 32; key_size += 8) {
+        ts::AES aes;
+        ts::CBC<ts::AES> cbc;
+        ts::DVS042<ts::AES> dvs042;
+        CPPUNIT_ASSERT(aes.setKey(key.data(), key_size));
+        CPPUNIT_ASSERT(cbc.setKey(key.data(), key_size));
+        CPPUNIT_ASSERT(cbc.setIV(iv.data(), iv.size()));
+        CPPUNIT_ASSERT(dvs042.setKey(key.data(), key_size));
+        CPPUNIT_ASSERT(dvs042.setIV(iv.data(), iv.size()));
+
+        for (size_t count = 1; count <= 27; ++count) {
+            const size_t size = count * ts::AES::BLOCK_SIZE;
+            ts::ByteBlock plain(size + 5);
+            ts::ByteBlock ref(size);
+            ts::ByteBlock buf(size + 5);
+            CPPUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+
+            // ECB, one block at a time as reference.
+            for (size_t i = 0; i < size; i += ts::AES::BLOCK_SIZE) {
+                CPPUNIT_ASSERT(aes.encrypt(&plain[i], ts::AES::BLOCK_SIZE, &ref[i], ts::AES::BLOCK_SIZE));
+            }
+            CPPUNIT_ASSERT(aes.encryptBlocks(plain.data(), buf.data(), count));
+            CPPUNIT_ASSERT(::memcmp(ref.data(), buf.data(), size) == 0);
+            ::memcpy(buf.data(), plain.data(), size);
+            CPPUNIT_ASSERT(aes.encryptBlocks(buf.data(), buf.data(), count));
+            CPPUNIT_ASSERT(::memcmp(ref.data(), buf.data(), size) == 0);
+            CPPUNIT_ASSERT(aes.decryptBlocks(buf.data(), buf.data(), count));
+            CPPUNIT_ASSERT(::memcmp(plain.data(), buf.data(), size) == 0);
+
+            // CBC, out of place and in place decryption.
+            CPPUNIT_ASSERT(cbc.encrypt(plain.data(), size, ref.data(), size));
+            CPPUNIT_ASSERT(cbc.decrypt(ref.data(), size, buf.data(), size));
+            CPPUNIT_ASSERT(::memcmp(plain.data(), buf.data(), size) == 0);
+            ::memcpy(buf.data(), ref.data(), size);
+            CPPUNIT_ASSERT(cbc.decrypt(buf.data(), size, buf.data(), size));
+            CPPUNIT_ASSERT(::memcmp(plain.data(), buf.data(), size) == 0);
+
+            // DVS042 with residue, in place decryption.
+            CPPUNIT_ASSERT(dvs042.encrypt(plain.data(), plain.size(), buf.data(), buf.size()));
+            CPPUNIT_ASSERT(dvs042.decrypt(buf.data(), buf.size(), buf.data(), buf.size()));
+            CPPUNIT_ASSERT(plain == buf);
+        }
+    }
+}
+
 void CryptoTest::testDES()
 {
     ts::DES des;
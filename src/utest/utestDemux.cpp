@@ -91,6 +91,8 @@ public:
     void testTDT();
     void testTOT();
     void testHEVC();
+    void testSectionPool();
+    void testRepeatedSections();
 
     CPPUNIT_TEST_SUITE(DemuxTest);
     CPPUNIT_TEST(testPAT);
@@ -104,6 +106,8 @@ public:
     CPPUNIT_TEST(testTDT);
     CPPUNIT_TEST(testTOT);
     CPPUNIT_TEST(testHEVC);
+    CPPUNIT_TEST(testSectionPool);
+    CPPUNIT_TEST(testRepeatedSections);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -115,6 +119,21 @@ private:
 
     // Unitary test for one table.
     void testTable(const char* name, const uint8_t* ref_packets, size_t ref_packets_size, const uint8_t* ref_sections, size_t ref_sections_size);
+
+    // Demux a set of packets with a given section pool size.
+    void testSectionPoolSize(const ts::TSPacketVector& packets, const ts::BinaryTable& ref_table, size_t repeat, size_t pool_size);
+
+    // A section handler which compares the received sections with a reference table.
+    class SectionChecker: public ts::SectionHandlerInterface
+    {
+    public:
+        SectionChecker(const ts::BinaryTable& ref) : count(0), errors(0), _ref(ref) {}
+        size_t count;
+        size_t errors;
+        virtual void handleSection(ts::SectionDemux&, const ts::Section&) override;
+    private:
+        const ts::BinaryTable& _ref;
+    };
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DemuxTest);
@@ -486,3 +505,111 @@ void DemuxTest::testHEVC()
 {
     TEST_TABLE("PMT with HEVC descriptor", pmt_hevc);
 }
+
+void DemuxTest::SectionChecker::handleSection(ts::SectionDemux&, const ts::Section& sect)
+{
+    const ts::Section& ref(*_ref.sectionAt(count++ % _ref.sectionCount()));
+    if (sect.size() != ref.size() || ::memcmp(sect.content(), ref.content(), sect.size()) != 0) {
+        errors++;
+    }
+}
+
+void DemuxTest::testSectionPoolSize(const ts::TSPacketVector& packets, const ts::BinaryTable& ref_table, size_t repeat, size_t pool_size)
+{
+    SectionChecker checker(ref_table);
+    ts::SectionDemux demux(0, &checker, ts::AllPIDs);
+    demux.setSectionPoolSize(pool_size);
+
+    for (size_t i = 0; i < packets.size(); ++i) {
+        demux.feedPacket(packets[i]);
+    }
+
+    utest::Out() << "DemuxTest: pool size: " << pool_size << ", sections: " << checker.count << ", errors: " << checker.errors << std::endl;
+    CPPUNIT_ASSERT_EQUAL(repeat * ref_table.sectionCount(), checker.count);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), checker.errors);
+    CPPUNIT_ASSERT(!demux.hasErrors());
+}
+
+void DemuxTest::testSectionPool()
+{
+    // Get the reference table.
+    const ts::TSPacket* ref_pkt = reinterpret_cast<const ts::TSPacket*>(psi_nit_tntv23_packets);
+    ts::StandaloneTableDemux tdemux(ts::AllPIDs);
+    for (size_t pi = 0; pi < sizeof(psi_nit_tntv23_packets) / ts::PKT_SIZE; ++pi) {
+        tdemux.feedPacket(ref_pkt[pi]);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(1), tdemux.tableCount());
+    const ts::BinaryTable& table(*tdemux.tableAt(0));
+
+    // Packetize the same table many times without stuffing so that sections
+    // span packet boundaries and fill the reassembly buffer of the demux.
+    const size_t repeat = 50;
+    ts::OneShotPacketizer pzer(table.sourcePID(), false);
+    for (size_t i = 0; i < repeat; ++i) {
+        pzer.addTable(table);
+    }
+    ts::TSPacketVector packets;
+    pzer.getPackets(packets);
+
+    testSectionPoolSize(packets, table, repeat, ts::SectionDemux::DEFAULT_SECTION_POOL_SIZE);
+    testSectionPoolSize(packets, table, repeat, 1);
+    testSectionPoolSize(packets, table, repeat, 0);
+}
+
+void DemuxTest::testRepeatedSections()
+{
+    ts::BinaryTable table;
+    table.addSection(new ts::Section(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections), ts::PID_NIT, ts::CRC32::CHECK));
+    CPPUNIT_ASSERT(table.isValid());
+
+    // Same section, repeated many times.
+    const size_t repeat = 50;
+    ts::OneShotPacketizer pzer(ts::PID_NIT, false);
+    for (size_t i = 0; i < repeat; ++i) {
+        pzer.addTable(table);
+    }
+    ts::TSPacketVector packets;
+    pzer.getPackets(packets);
+
+    // Without filtering, all sections are reported.
+    SectionChecker all(table);
+    ts::SectionDemux demux1(0, &all, ts::AllPIDs);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        demux1.feedPacket(packets[i]);
+    }
+    ts::SectionDemux::Status status1(demux1);
+    CPPUNIT_ASSERT_EQUAL(repeat, all.count);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), status1.repeated);
+
+    // With filtering, only the first one is reported.
+    SectionChecker first(table);
+    ts::SectionDemux demux2(0, &first, ts::AllPIDs);
+    demux2.setFilterRepeatedSections(true);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        demux2.feedPacket(packets[i]);
+    }
+    ts::SectionDemux::Status status2(demux2);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), first.count);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), first.errors);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(repeat - 1), status2.repeated);
+    CPPUNIT_ASSERT(!status2.hasErrors());
+
+    // A new version of the table is reported.
+    ts::ByteBlock data(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections));
+    data[5] = (data[5] & 0xC1) | ((((data[5] >> 1) + 1) & 0x1F) << 1);
+    ts::SectionPtr next(new ts::Section(data, ts::PID_NIT, ts::CRC32::COMPUTE));
+    CPPUNIT_ASSERT(next->isValid());
+    ts::OneShotPacketizer pzer2(ts::PID_NIT, false);
+    pzer2.setNextContinuityCounter(uint8_t((packets.back().getCC() + 1) & 0x0F));
+    pzer2.addSection(next);
+    pzer2.addSection(next);
+    pzer2.getPackets(packets);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        demux2.feedPacket(packets[i]);
+    }
+    status2 = ts::SectionDemux::Status(demux2);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), first.count);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), first.errors);  // new version differs from reference table
+    CPPUNIT_ASSERT_EQUAL(uint64_t(repeat), status2.repeated);
+    CPPUNIT_ASSERT(!status2.hasErrors());
+}
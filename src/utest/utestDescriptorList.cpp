@@ -0,0 +1,267 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  CppUnit test suite for class ts::DescriptorList
+//
+//----------------------------------------------------------------------------
+
+#include "tsDescriptorList.h"
+#include "tsTables.h"
+#include "tsBinaryTable.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class DescriptorListTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testCompact();
+    void testCopy();
+    void testAddList();
+    void testRemove();
+    void testSDT();
+
+    CPPUNIT_TEST_SUITE(DescriptorListTest);
+    CPPUNIT_TEST(testCompact);
+    CPPUNIT_TEST(testCopy);
+    CPPUNIT_TEST(testAddList);
+    CPPUNIT_TEST(testRemove);
+    CPPUNIT_TEST(testSDT);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DescriptorListTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void DescriptorListTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void DescriptorListTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test data: a binary descriptor loop.
+//----------------------------------------------------------------------------
+
+namespace {
+    const uint8_t Loop[] = {
+        0x48, 0x06, 0x01, 0x02, 'T', 'V', 0x01, 'A',              // service_descriptor
+        0x5F, 0x04, 0x00, 0x00, 0x00, 0x28,                       // private_data_specifier_descriptor (EACEM)
+        0x87, 0x02, 0xAB, 0xCD,                                   // private descriptor
+        0x0A, 0x04, 'f', 'r', 'e', 0x00,                          // ISO_639_language_descriptor
+        0x5F, 0x04, 0x00, 0x00, 0x00, 0x02,                       // private_data_specifier_descriptor (Canal+)
+        0x88, 0x00,                                               // private descriptor, empty payload
+        0x40, 0x05,                                               // truncated descriptor, ignored
+    };
+    const size_t LoopCount = 6;
+    const size_t LoopSize = sizeof(Loop) - 2;
+
+    // Build the same list with one Descriptor object per descriptor.
+    void BuildObjects(ts::DescriptorList& dlist)
+    {
+        for (size_t offset = 0; offset < LoopSize; offset += size_t(Loop[offset + 1]) + 2) {
+            dlist.add(ts::DescriptorPtr(new ts::Descriptor(Loop + offset, size_t(Loop[offset + 1]) + 2)));
+        }
+    }
+
+    // Serialize a descriptor list into a byte block.
+    ts::ByteBlock Serialize(const ts::DescriptorList& dlist)
+    {
+        ts::ByteBlock bb(dlist.binarySize());
+        uint8_t* addr = bb.data();
+        size_t size = bb.size();
+        CPPUNIT_ASSERT_EQUAL(dlist.count(), dlist.serialize(addr, size));
+        CPPUNIT_ASSERT_EQUAL(size_t(0), size);
+        return bb;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void DescriptorListTest::testCompact()
+{
+    ts::DescriptorList compact(0);
+    compact.add(Loop, sizeof(Loop));
+
+    ts::DescriptorList objects(0);
+    BuildObjects(objects);
+
+    CPPUNIT_ASSERT_EQUAL(LoopCount, compact.count());
+    CPPUNIT_ASSERT(compact == objects);
+    CPPUNIT_ASSERT(Serialize(compact) == ts::ByteBlock(Loop, LoopSize));
+
+    // Direct access to binary descriptors, without Descriptor objects.
+    const ts::DID tags[LoopCount] = {0x48, 0x5F, 0x87, 0x0A, 0x5F, 0x88};
+    const ts::PDS pds[LoopCount] = {0, 0x28, 0x28, 0x28, 0x02, 0x02};
+    for (size_t i = 0; i < LoopCount; ++i) {
+        CPPUNIT_ASSERT_EQUAL(tags[i], compact.tag(i));
+        CPPUNIT_ASSERT_EQUAL(pds[i], compact.privateDataSpecifier(i));
+        CPPUNIT_ASSERT_EQUAL(objects.privateDataSpecifier(i), compact.privateDataSpecifier(i));
+        CPPUNIT_ASSERT_EQUAL(objects[i]->size(), compact.contentSize(i));
+        CPPUNIT_ASSERT_EQUAL(objects[i]->payloadSize(), compact.payloadSize(i));
+        CPPUNIT_ASSERT_EQUAL(0, ::memcmp(objects[i]->content(), compact.content(i), compact.contentSize(i)));
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), compact.payloadSize(5));
+
+    // Searches on binary descriptors.
+    CPPUNIT_ASSERT_EQUAL(size_t(3), compact.search(ts::DID_LANGUAGE));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), compact.searchLanguage(u"FRE"));
+    CPPUNIT_ASSERT_EQUAL(size_t(5), compact.search(0x88, 0, 0x02));
+    CPPUNIT_ASSERT_EQUAL(LoopCount, compact.search(0x87, 0, 0x02));
+
+    // Materialized descriptors, on demand.
+    ts::ServiceDescriptor sd;
+    CPPUNIT_ASSERT_EQUAL(size_t(0), compact.search(ts::DID_SERVICE, sd));
+    CPPUNIT_ASSERT(sd.isValid());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"TV", sd.provider_name);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"A", sd.service_name);
+
+    // A materialized descriptor becomes the reference.
+    const ts::DescriptorPtr& desc(compact[2]);
+    CPPUNIT_ASSERT(!desc.isNull());
+    CPPUNIT_ASSERT(desc.pointer() == compact[2].pointer());
+    desc->payload()[0] = 0x12;
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x12), compact.payload(2)[0]);
+    CPPUNIT_ASSERT(compact != objects);
+    objects[2]->payload()[0] = 0x12;
+    CPPUNIT_ASSERT(compact == objects);
+}
+
+void DescriptorListTest::testCopy()
+{
+    ts::DescriptorList dl1(0);
+    dl1.add(Loop, sizeof(Loop));
+
+    ts::DescriptorList dl2(0, dl1);
+    CPPUNIT_ASSERT(dl1 == dl2);
+
+    // Appending to a copy does not modify the original list.
+    dl2.add(Loop, LoopSize);
+    CPPUNIT_ASSERT_EQUAL(LoopCount, dl1.count());
+    CPPUNIT_ASSERT_EQUAL(2 * LoopCount, dl2.count());
+    CPPUNIT_ASSERT(Serialize(dl1) == ts::ByteBlock(Loop, LoopSize));
+    CPPUNIT_ASSERT_EQUAL(ts::PDS(0x02), dl2.privateDataSpecifier(LoopCount));
+
+    ts::DescriptorList dl3(0);
+    dl3 = dl2;
+    dl2.clear();
+    CPPUNIT_ASSERT(dl2.empty());
+    CPPUNIT_ASSERT_EQUAL(2 * LoopCount, dl3.count());
+    CPPUNIT_ASSERT_EQUAL(ts::DID(0x88), dl3.tag(2 * LoopCount - 1));
+
+    // Adding descriptors from the list into itself.
+    dl1.add(dl1.content(3), dl1.contentSize(3));
+    CPPUNIT_ASSERT_EQUAL(LoopCount + 1, dl1.count());
+    CPPUNIT_ASSERT_EQUAL(ts::DID(ts::DID_LANGUAGE), dl1.tag(LoopCount));
+    CPPUNIT_ASSERT(*dl1[3] == *dl1[LoopCount]);
+}
+
+void DescriptorListTest::testAddList()
+{
+    ts::DescriptorList dl1(0);
+    dl1.add(ts::PrivateDataSpecifierDescriptor(0x1234));
+    dl1.add(Loop, 8);
+
+    ts::DescriptorList dl2(0);
+    dl2.add(Loop + 8, LoopSize - 8);
+    CPPUNIT_ASSERT(!dl2[1].isNull());
+
+    dl1.add(dl2);
+    ts::DescriptorList objects(0);
+    objects.add(ts::PrivateDataSpecifierDescriptor(0x1234));
+    BuildObjects(objects);
+    CPPUNIT_ASSERT(dl1 == objects);
+    CPPUNIT_ASSERT(Serialize(dl1) == Serialize(objects));
+
+    dl1.add(dl1);
+    CPPUNIT_ASSERT_EQUAL(2 * (LoopCount + 1), dl1.count());
+    CPPUNIT_ASSERT_EQUAL(ts::DID(0x88), dl1.tag(2 * LoopCount + 1));
+}
+
+void DescriptorListTest::testRemove()
+{
+    ts::DescriptorList dl(0);
+    dl.add(Loop, sizeof(Loop));
+
+    // The first private_data_specifier is required by the private descriptor.
+    CPPUNIT_ASSERT(!dl.removeByIndex(1));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), dl.removeByTag(0x87, 0x28));
+    CPPUNIT_ASSERT(dl.removeByIndex(1));
+    CPPUNIT_ASSERT_EQUAL(LoopCount - 2, dl.count());
+    CPPUNIT_ASSERT_EQUAL(ts::DID(ts::DID_LANGUAGE), dl.tag(1));
+    CPPUNIT_ASSERT_EQUAL(ts::PDS(0), dl.privateDataSpecifier(1));
+    CPPUNIT_ASSERT_EQUAL(ts::PDS(0x02), dl.privateDataSpecifier(3));
+    CPPUNIT_ASSERT_EQUAL(size_t(22), dl.binarySize());
+}
+
+void DescriptorListTest::testSDT()
+{
+    ts::SDT sdt1(true, 3, true, 0x0010, 0x0020);
+    for (uint16_t id = 1; id <= 50; ++id) {
+        ts::SDT::Service& srv(sdt1.services[id]);
+        srv.descs.add(ts::ServiceDescriptor(0x01, u"Provider", ts::UString::Format(u"Service %d", {id})));
+        srv.descs.add(ts::PrivateDataSpecifierDescriptor(0x28));
+        srv.descs.add(ts::EacemPreferredNameIdentifierDescriptor(uint8_t(id)));
+    }
+    ts::BinaryTable bin;
+    sdt1.serialize(bin);
+    CPPUNIT_ASSERT(bin.isValid());
+
+    ts::SDT sdt2(bin);
+    CPPUNIT_ASSERT(sdt2.isValid());
+    CPPUNIT_ASSERT_EQUAL(size_t(50), sdt2.services.size());
+    for (ts::SDT::ServiceMap::const_iterator it = sdt2.services.begin(); it != sdt2.services.end(); ++it) {
+        CPPUNIT_ASSERT(it->second.descs == sdt1.services[it->first].descs);
+        CPPUNIT_ASSERT_EQUAL(ts::PDS(0x28), it->second.descs.privateDataSpecifier(2));
+        CPPUNIT_ASSERT_USTRINGS_EQUAL(ts::UString::Format(u"Service %d", {it->first}), it->second.serviceName());
+    }
+
+    // Serialize the deserialized table again.
+    ts::BinaryTable bin2;
+    sdt2.serialize(bin2);
+    CPPUNIT_ASSERT(bin == bin2);
+}
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  CppUnit test suite for memory utilities.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMemoryUtils.h"
+#include "tsByteBlock.h"
+#include "tsMonotonic.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class MemoryUtilsTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testLocatePattern();
+    void testLocateZeroZero();
+    void testLocateZeroZeroBenchmark();
+
+    CPPUNIT_TEST_SUITE(MemoryUtilsTest);
+    CPPUNIT_TEST(testLocatePattern);
+    CPPUNIT_TEST(testLocateZeroZero);
+    CPPUNIT_TEST(testLocateZeroZeroBenchmark);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MemoryUtilsTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void MemoryUtilsTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void MemoryUtilsTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Pseudo-random data. One byte out of 'zeroes' is zero, one out of 'ones' is one.
+    void RandomData(ts::ByteBlock& data, size_t size, uint32_t seed, uint32_t zeroes, uint32_t ones)
+    {
+        data.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            seed = seed * 1103515245 + 12345;
+            const uint32_t r = seed >> 8;
+            data[i] = r % zeroes == 0 ? 0x00 : (r / zeroes) % ones == 0 ? 0x01 : uint8_t(2 + (r >> 16) % 254);
+        }
+    }
+}
+
+void MemoryUtilsTest::testLocatePattern()
+{
+    const uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x02, 0x03, 0x05};
+    const uint8_t pat1[] = {0x02, 0x03};
+    const uint8_t pat2[] = {0x02, 0x03, 0x05};
+    const uint8_t pat3[] = {0x03, 0x02};
+
+    CPPUNIT_ASSERT(ts::LocatePattern(data, sizeof(data), pat1, sizeof(pat1)) == data + 1);
+    CPPUNIT_ASSERT(ts::LocatePattern(data, sizeof(data), pat2, sizeof(pat2)) == data + 4);
+    CPPUNIT_ASSERT(ts::LocatePattern(data, sizeof(data), pat3, sizeof(pat3)) == 0);
+    CPPUNIT_ASSERT(ts::LocatePattern(data, 5, pat2, sizeof(pat2)) == 0);
+}
+
+void MemoryUtilsTest::testLocateZeroZero()
+{
+    // All sizes and alignments, compared with a generic pattern search.
+    ts::ByteBlock data;
+    for (uint32_t seed = 1; seed <= 8; ++seed) {
+        RandomData(data, 600, seed, 3 + seed, 5);
+        for (size_t start = 0; start < 40; ++start) {
+            for (size_t size = 0; start + size <= data.size(); size += (size < 100 ? 1 : 7)) {
+                const uint8_t* const area = data.data() + start;
+                for (uint8_t third = 0; third < 4; ++third) {
+                    const uint8_t pattern[] = {0x00, 0x00, third};
+                    const void* expected = ts::LocatePattern(area, size, pattern, sizeof(pattern));
+                    CPPUNIT_ASSERT(ts::LocateZeroZero(area, size, third) == expected);
+                }
+            }
+        }
+    }
+
+    // Sequences at the very end and overlapping zeroes.
+    const uint8_t zeroes[] = {0x12, 0x00, 0x00, 0x00, 0x00, 0x01};
+    CPPUNIT_ASSERT(ts::LocateZeroZero(zeroes, sizeof(zeroes), 0x01) == zeroes + 3);
+    CPPUNIT_ASSERT(ts::LocateZeroZero(zeroes, sizeof(zeroes), 0x00) == zeroes + 1);
+    CPPUNIT_ASSERT(ts::LocateZeroZero(zeroes, sizeof(zeroes) - 1, 0x01) == 0);
+    CPPUNIT_ASSERT(ts::LocateZeroZero(zeroes, 0, 0x00) == 0);
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: start code search in video-like data, 00 00 01 every 20 kB.
+//----------------------------------------------------------------------------
+
+void MemoryUtilsTest::testLocateZeroZeroBenchmark()
+{
+    if (!utest::DebugMode()) {
+        return;
+    }
+
+    const size_t SIZE = 16 * 1024 * 1024;
+    const uint8_t prefix[] = {0x00, 0x00, 0x01};
+
+    ts::ByteBlock data;
+    RandomData(data, SIZE, 47, 150, 256);
+    for (size_t i = 0; i + 3 < SIZE; i += 20000) {
+        data[i] = data[i+1] = 0x00;
+        data[i+2] = 0x01;
+    }
+
+    size_t count[2] = {0, 0};
+    ts::NanoSecond duration[2] = {0, 0};
+    for (size_t mode = 0; mode < 2; ++mode) {
+        ts::Monotonic start;
+        start.getSystemTime();
+        for (const uint8_t* p = data.data(); p != 0; ) {
+            const size_t remain = data.data() + SIZE - p;
+            p = mode == 0 ? reinterpret_cast<const uint8_t*>(ts::LocatePattern(p, remain, prefix, sizeof(prefix))) : ts::LocateZeroZero(p, remain, 0x01);
+            if (p != 0) {
+                count[mode]++;
+                p++;
+            }
+        }
+        ts::Monotonic end;
+        end.getSystemTime();
+        duration[mode] = end - start;
+    }
+    CPPUNIT_ASSERT_EQUAL(count[0], count[1]);
+    CPPUNIT_ASSERT(count[0] >= SIZE / 20000);
+
+    utest::Out() << "MemoryUtilsTest: start code search, LocatePattern: "
+                 << utest::Rate(SIZE, duration[0], 1024 * 1024) << " MB/s, LocateZeroZero: "
+                 << utest::Rate(SIZE, duration[1], 1024 * 1024) << " MB/s" << std::endl;
+}
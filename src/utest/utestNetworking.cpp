@@ -65,6 +65,7 @@ public:
     void testSocketAddress();
     void testTCPSocket();
     void testUDPSocket();
+    void testUDPSocketBatch();
 
     CPPUNIT_TEST_SUITE(NetworkingTest);
     CPPUNIT_TEST(testIPAddressConstructors);
@@ -75,6 +76,7 @@ public:
     CPPUNIT_TEST(testSocketAddress);
     CPPUNIT_TEST(testTCPSocket);
     CPPUNIT_TEST(testUDPSocket);
+    CPPUNIT_TEST(testUDPSocketBatch);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -609,3 +611,63 @@ void NetworkingTest::testUDPSocket()
     CPPUNIT_ASSERT(sock.send(buffer, size, sender, CERR));
     CERR.debug(u"UDPSocketTest: main thread: reply sent");
 }
+
+// Receive a batch of messages.
+void NetworkingTest::testUDPSocketBatch()
+{
+    CPPUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t portNumber = 12346;
+    const size_t msgCount = 5;
+
+    // Create receiver socket
+    ts::UDPSocket receiver(true);
+    CPPUNIT_ASSERT(receiver.isOpen());
+    CPPUNIT_ASSERT(receiver.reusePort(true, CERR));
+    CPPUNIT_ASSERT(receiver.bind(ts::SocketAddress(ts::IPAddress::LocalHost, portNumber), CERR));
+#if defined(TS_UNIX)
+    CPPUNIT_ASSERT(receiver.setReceiveTimestamps(true, CERR));
+#endif
+
+    // Send all messages before receiving, so that they can be received in one batch.
+    ts::UDPSocket sender(true);
+    CPPUNIT_ASSERT(sender.isOpen());
+    CPPUNIT_ASSERT(sender.bind(ts::SocketAddress(ts::IPAddress::LocalHost, ts::SocketAddress::AnyPort), CERR));
+    CPPUNIT_ASSERT(sender.setDefaultDestination(ts::SocketAddress(ts::IPAddress::LocalHost, portNumber), CERR));
+    // All messages are sent using one single system call when possible.
+    uint8_t messages[msgCount][4];
+    ts::UDPSocket::OutgoingMessage outmsgs[msgCount];
+    for (size_t i = 0; i < msgCount; ++i) {
+        messages[i][0] = uint8_t(i);
+        messages[i][1] = 0x01;
+        messages[i][2] = 0x02;
+        messages[i][3] = 0x03;
+        outmsgs[i] = ts::UDPSocket::OutgoingMessage(messages[i], i + 1);
+    }
+    CPPUNIT_ASSERT(sender.send(outmsgs, msgCount, CERR));
+
+    // Receive messages.
+    uint8_t buffer[10][256];
+    ts::UDPSocket::ReceivedMessage msgs[10];
+    for (size_t i = 0; i < 10; ++i) {
+        msgs[i] = ts::UDPSocket::ReceivedMessage(buffer[i], sizeof(buffer[i]));
+    }
+
+    size_t received = 0;
+    while (received < msgCount) {
+        size_t count = 0;
+        CPPUNIT_ASSERT(receiver.receive(msgs, 10, count, 0, CERR));
+        CERR.debug(u"UDPSocketTest: received batch of %d messages", {count});
+        CPPUNIT_ASSERT(count > 0);
+        CPPUNIT_ASSERT(received + count <= msgCount);
+        for (size_t i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT_EQUAL(received + 1, msgs[i].size);
+            CPPUNIT_ASSERT_EQUAL(uint8_t(received), buffer[i][0]);
+            CPPUNIT_ASSERT(ts::IPAddress(msgs[i].sender) == ts::IPAddress::LocalHost);
+#if defined(TS_LINUX)
+            CPPUNIT_ASSERT(msgs[i].timestamp > 0);
+#endif
+            received++;
+        }
+    }
+}
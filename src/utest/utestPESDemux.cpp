@@ -0,0 +1,451 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  CppUnit test suite for class ts::PESDemux
+//
+//----------------------------------------------------------------------------
+
+#include "tsPESDemux.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PESDemuxTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testAVCAccessUnits();
+    void testStreaming();
+
+    CPPUNIT_TEST_SUITE(PESDemuxTest);
+    CPPUNIT_TEST(testAVCAccessUnits);
+    CPPUNIT_TEST(testStreaming);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PESDemuxTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PESDemuxTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void PESDemuxTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Synthetic audio/video streams.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    const ts::PID PID_MPEG2 = 0x0100;
+    const ts::PID PID_AVC   = 0x0200;
+    const ts::PID PID_AUDIO = 0x0300;
+
+    // Deterministic pseudo-random generator.
+    class Random
+    {
+    public:
+        Random(uint32_t seed) : _state(seed) {}
+        uint32_t next(uint32_t max)
+        {
+            _state = _state * 1103515245 + 12345;
+            return (_state >> 8) % max;
+        }
+        // Video data with many zeroes, to get many start codes and 00 00 00 sequences.
+        void fill(ts::ByteBlock& bb, size_t size)
+        {
+            for (size_t i = 0; i < size; ++i) {
+                bb.appendUInt8(next(4) == 0 ? 0x00 : uint8_t(next(3)));
+            }
+        }
+    private:
+        uint32_t _state;
+    };
+
+    // Bit writer for AVC sequence parameter sets.
+    class BitWriter
+    {
+    public:
+        BitWriter() : _data(), _bits(0) {}
+        void bits(uint32_t value, size_t count)
+        {
+            while (count-- > 0) {
+                if (_bits % 8 == 0) {
+                    _data.appendUInt8(0);
+                }
+                _data[_bits / 8] |= uint8_t(((value >> count) & 1) << (7 - _bits % 8));
+                _bits++;
+            }
+        }
+        void ue(uint32_t value)
+        {
+            size_t len = 0;
+            while (((value + 1) >> len) > 1) {
+                len++;
+            }
+            bits(0, len);
+            bits(value + 1, len + 1);
+        }
+        const ts::ByteBlock& data() const { return _data; }
+    private:
+        ts::ByteBlock _data;
+        size_t _bits;
+    };
+
+    // Build an AVC sequence parameter set NALunit, baseline profile.
+    ts::ByteBlock AVCSequenceParameterSet(size_t width, size_t height)
+    {
+        BitWriter bw;
+        bw.bits(0x67, 8);        // nal_ref_idc = 3, nal_unit_type = 7
+        bw.bits(66, 8);          // profile_idc
+        bw.bits(0xC0, 8);        // constraint flags
+        bw.bits(30, 8);          // level_idc
+        bw.ue(0);                // seq_parameter_set_id
+        bw.ue(0);                // log2_max_frame_num_minus4
+        bw.ue(2);                // pic_order_cnt_type
+        bw.ue(1);                // max_num_ref_frames
+        bw.bits(0, 1);           // gaps_in_frame_num_value_allowed_flag
+        bw.ue(uint32_t(width / 16 - 1));
+        bw.ue(uint32_t(height / 16 - 1));
+        bw.bits(1, 1);           // frame_mbs_only_flag
+        bw.bits(1, 1);           // direct_8x8_inference_flag
+        bw.bits(0, 1);           // frame_cropping_flag
+        bw.bits(0, 1);           // vui_parameters_present_flag
+        bw.bits(1, 1);           // rbsp_stop_one_bit
+        return bw.data();
+    }
+
+    // Build a PES packet with a long header.
+    ts::ByteBlock PESPacket(uint8_t stream_id, const ts::ByteBlock& payload)
+    {
+        ts::ByteBlock pes;
+        pes.appendUInt24(0x000001);
+        pes.appendUInt8(stream_id);
+        pes.appendUInt16(uint16_t(payload.size() + 8 > 0xFFFF ? 0 : payload.size() + 8));
+        pes.appendUInt8(0x80);
+        pes.appendUInt8(0x80);   // PTS only
+        pes.appendUInt8(5);
+        pes.appendUInt8(0x21);
+        pes.appendUInt32(0x00010001);
+        pes.append(payload);
+        return pes;
+    }
+
+    // MPEG-2 video PES packet. Sequence header + extension when width is not zero.
+    ts::ByteBlock MPEG2Video(Random& rnd, size_t width, size_t height, bool mpeg1, size_t slices)
+    {
+        ts::ByteBlock es;
+        if (width != 0) {
+            es.appendUInt32(0x000001B3);
+            es.appendUInt24(uint32_t((width << 12) | height));
+            es.appendUInt8(0x23);     // aspect ratio, frame rate
+            es.appendUInt32(0x17D4A3C0);
+            if (!mpeg1) {
+                es.appendUInt32(0x000001B5);
+                es.appendUInt32(0x14820001);
+                es.appendUInt16(0x0000);
+            }
+            es.appendUInt32(0x000001B8);
+            rnd.fill(es, 4);
+        }
+        es.appendUInt32(0x00000100);
+        rnd.fill(es, 8);
+        for (size_t i = 1; i <= slices; ++i) {
+            es.appendUInt32(0x00000100 | uint32_t(i));
+            rnd.fill(es, 50 + rnd.next(2000));
+        }
+        return PESPacket(0xE0, es);
+    }
+
+    // AVC video PES packet. Sequence parameter set when width is not zero.
+    ts::ByteBlock AVCVideo(Random& rnd, size_t width, size_t height, size_t slices)
+    {
+        ts::ByteBlock es;
+        es.appendUInt32(0x00000001);
+        es.appendUInt16(0x09F0);          // access unit delimiter
+        if (width != 0) {
+            es.appendUInt32(0x00000001);
+            es.append(AVCSequenceParameterSet(width, height));
+            es.appendUInt16(0x0000);      // trailing zero bytes
+        }
+        for (size_t i = 0; i < slices; ++i) {
+            es.appendUInt24(0x000001);
+            es.appendUInt8(0x65);
+            rnd.fill(es, 50 + rnd.next(4000));
+        }
+        return PESPacket(0xE0, es);
+    }
+
+    // MPEG audio PES packet.
+    ts::ByteBlock Audio(Random& rnd, uint32_t header)
+    {
+        ts::ByteBlock es;
+        es.appendUInt32(header);
+        rnd.fill(es, 400 + rnd.next(400));
+        return PESPacket(0xC0, es);
+    }
+
+    // Packetize a PES packet with random payload sizes in TS packets.
+    void Packetize(ts::TSPacketVector& packets, Random& rnd, ts::PID pid, uint8_t& cc, const ts::ByteBlock& pes)
+    {
+        for (size_t offset = 0; offset < pes.size(); ) {
+            // The PES header must be in the first TS packet.
+            size_t size = std::min<size_t>(pes.size() - offset, rnd.next(4) == 0 ? (offset == 0 ? 32 : 1) + rnd.next(152) : 184);
+            ts::TSPacket pkt;
+            pkt.b[0] = ts::SYNC_BYTE;
+            pkt.b[1] = offset == 0 ? 0x40 : 0x00;
+            pkt.b[3] = uint8_t(0x10 | cc);
+            pkt.setPID(pid);
+            size_t header = 4;
+            if (size < 184) {
+                // Adaptation field with stuffing.
+                pkt.b[3] |= 0x20;
+                pkt.b[4] = uint8_t(183 - size);
+                if (size < 183) {
+                    pkt.b[5] = 0x00;
+                    ::memset(pkt.b + 6, 0xFF, 182 - size);
+                }
+                header = 188 - size;
+            }
+            ::memcpy(pkt.b + header, pes.data() + offset, size);
+            packets.push_back(pkt);
+            offset += size;
+            cc = (cc + 1) & 0x0F;
+        }
+    }
+
+    // Build a multiplex of MPEG-2 video, AVC video and audio.
+    void BuildStream(ts::TSPacketVector& packets, uint32_t seed, size_t count)
+    {
+        Random rnd(seed);
+        uint8_t cc[3] = {0, 0, 0};
+        const size_t sizes[][2] = {{720, 576}, {1920, 1088}, {352, 288}};
+        for (size_t i = 0; i < count; ++i) {
+            const size_t* wh = sizes[(i / 7) % 3];
+            const bool with_header = i % 3 == 0;
+            Packetize(packets, rnd, PID_MPEG2, cc[0], MPEG2Video(rnd, with_header ? wh[0] : 0, wh[1], (i / 11) % 2 == 1, 1 + rnd.next(30)));
+            Packetize(packets, rnd, PID_AVC, cc[1], AVCVideo(rnd, with_header ? wh[0] : 0, wh[1], 1 + rnd.next(30)));
+            Packetize(packets, rnd, PID_AUDIO, cc[2], Audio(rnd, (i / 5) % 2 == 0 ? 0xFFFD9444 : 0xFFFDA444));
+        }
+    }
+
+    // A PES handler which logs everything which must be identical in full and streaming modes.
+    class Handler: public ts::PESHandlerInterface
+    {
+    public:
+        Handler() : log(), units(0) {}
+        ts::UStringList log;
+        size_t units;
+
+        virtual void handlePESPacket(ts::PESDemux&, const ts::PESPacket& pkt) override
+        {
+            log.push_back(ts::UString::Format(u"PES: PID 0x%X, stream id 0x%X, header %d, packets %d-%d",
+                                              {pkt.getSourcePID(), pkt.getStreamId(), pkt.headerSize(), pkt.getFirstTSPacketIndex(), pkt.getLastTSPacketIndex()}));
+        }
+        virtual void handleVideoStartCode(ts::PESDemux&, const ts::PESPacket&, uint8_t, size_t, size_t) override
+        {
+            units++;
+        }
+        virtual void handleAVCAccessUnit(ts::PESDemux&, const ts::PESPacket&, uint8_t, size_t, size_t) override
+        {
+            units++;
+        }
+        virtual void handleNewVideoAttributes(ts::PESDemux&, const ts::PESPacket& pkt, const ts::VideoAttributes& attr) override
+        {
+            log.push_back(ts::UString::Format(u"Video: PID 0x%X, %s", {pkt.getSourcePID(), attr.toString()}));
+        }
+        virtual void handleNewAVCAttributes(ts::PESDemux&, const ts::PESPacket& pkt, const ts::AVCAttributes& attr) override
+        {
+            log.push_back(ts::UString::Format(u"AVC: PID 0x%X, %s", {pkt.getSourcePID(), attr.toString()}));
+        }
+        virtual void handleNewAudioAttributes(ts::PESDemux&, const ts::PESPacket& pkt, const ts::AudioAttributes& attr) override
+        {
+            log.push_back(ts::UString::Format(u"Audio: PID 0x%X, %s", {pkt.getSourcePID(), attr.toString()}));
+        }
+    };
+
+    // Count log lines starting with a prefix.
+    size_t CountLines(const ts::UStringList& log, const ts::UString& prefix)
+    {
+        size_t count = 0;
+        for (ts::UStringList::const_iterator it = log.begin(); it != log.end(); ++it) {
+            if (it->startWith(prefix)) {
+                count++;
+            }
+        }
+        return count;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+namespace {
+    // A PES handler which logs AVC access units.
+    class AccessUnitHandler: public ts::PESHandlerInterface
+    {
+    public:
+        AccessUnitHandler() : log() {}
+        ts::UStringList log;
+
+        virtual void handleAVCAccessUnit(ts::PESDemux&, const ts::PESPacket&, uint8_t nal_unit_type, size_t offset, size_t size) override
+        {
+            log.push_back(ts::UString::Format(u"type %d, offset %d, size %d", {nal_unit_type, offset, size}));
+        }
+    };
+}
+
+void PESDemuxTest::testAVCAccessUnits()
+{
+    // AVC video PES packet. The NALunits are terminated by 00 00 01, by 00 00 00
+    // (zero stuffing after the second one) or by the end of the PES packet.
+    // There is no 00 00 00 after the second NALunit. The size of the third one,
+    // terminated by 00 00 01, must not be computed from a missing 00 00 00.
+    ts::ByteBlock es;
+    es.appendUInt32(0x00000001);
+    es.appendUInt16(0x09F0);             // access unit delimiter, offset 4, size 2
+    es.appendUInt24(0x000001);
+    es.appendUInt8(0x65);                // IDR slice, offset 9, size 41
+    es.append(ts::ByteBlock(40, 0xAA));
+    es.appendUInt32(0x00000000);         // zero stuffing
+    es.appendUInt24(0x000001);
+    es.appendUInt8(0x41);                // non-IDR slice, offset 57, size 31
+    es.append(ts::ByteBlock(30, 0x55));
+    es.appendUInt24(0x000001);
+    es.appendUInt8(0x01);                // non-IDR slice, offset 91, size 21
+    es.append(ts::ByteBlock(20, 0x77));
+
+    // PES packet with a long header and a PTS.
+    ts::ByteBlock pes;
+    pes.appendUInt24(0x000001);
+    pes.appendUInt8(0xE0);
+    pes.appendUInt16(uint16_t(es.size() + 8));
+    pes.appendUInt8(0x80);
+    pes.appendUInt8(0x80);
+    pes.appendUInt8(5);
+    pes.appendUInt8(0x21);
+    pes.appendUInt32(0x00010001);
+    pes.append(es);
+    CPPUNIT_ASSERT(pes.size() <= 184);
+
+    // One TS packet with PES packet, stuffed in adaptation field.
+    ts::TSPacket pkt;
+    pkt.b[0] = ts::SYNC_BYTE;
+    pkt.b[1] = 0x40;
+    pkt.b[3] = 0x30;
+    pkt.setPID(0x0100);
+    pkt.b[4] = uint8_t(183 - pes.size());
+    pkt.b[5] = 0x00;
+    ::memset(pkt.b + 6, 0xFF, 182 - pes.size());
+    ::memcpy(pkt.b + ts::PKT_SIZE - pes.size(), pes.data(), pes.size());
+
+    // The PES packet is processed when the next one starts.
+    AccessUnitHandler handler;
+    ts::PESDemux demux(&handler);
+    demux.feedPacket(pkt);
+    CPPUNIT_ASSERT(handler.log.empty());
+    pkt.setCC(1);
+    demux.feedPacket(pkt);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(4), handler.log.size());
+    ts::UStringList::const_iterator it = handler.log.begin();
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"type 9, offset 4, size 2", *it++);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"type 5, offset 9, size 41", *it++);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"type 1, offset 57, size 31", *it++);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"type 1, offset 91, size 21", *it++);
+}
+
+
+void PESDemuxTest::testStreaming()
+{
+    // Several streams with distinct packetizations to get start codes across TS packets.
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        ts::TSPacketVector packets;
+        BuildStream(packets, seed, 40);
+
+        Handler full;
+        ts::PESDemux full_demux(&full);
+        CPPUNIT_ASSERT(!full_demux.streamingMode());
+
+        Handler streaming;
+        ts::PESDemux streaming_demux(&streaming);
+        streaming_demux.setStreamingMode(true);
+        CPPUNIT_ASSERT(streaming_demux.streamingMode());
+
+        for (size_t i = 0; i < packets.size(); ++i) {
+            full_demux.feedPacket(packets[i]);
+            streaming_demux.feedPacket(packets[i]);
+        }
+
+        // Same PES packets and same attributes, in the same order.
+        CPPUNIT_ASSERT(full.log.size() > 100);
+        CPPUNIT_ASSERT(CountLines(full.log, u"Video:") >= 4);
+        CPPUNIT_ASSERT(CountLines(full.log, u"AVC:") >= 3);
+        CPPUNIT_ASSERT(CountLines(full.log, u"Audio:") >= 2);
+        CPPUNIT_ASSERT_EQUAL(full.log.size(), streaming.log.size());
+        ts::UStringList::const_iterator it1 = full.log.begin();
+        ts::UStringList::const_iterator it2 = streaming.log.begin();
+        while (it1 != full.log.end()) {
+            CPPUNIT_ASSERT_USTRINGS_EQUAL(*it1++, *it2++);
+        }
+
+        // Video units are reported in full mode only.
+        CPPUNIT_ASSERT(full.units > 0);
+        CPPUNIT_ASSERT_EQUAL(size_t(0), streaming.units);
+
+        ts::VideoAttributes v1, v2;
+        full_demux.getVideoAttributes(PID_MPEG2, v1);
+        streaming_demux.getVideoAttributes(PID_MPEG2, v2);
+        CPPUNIT_ASSERT(v1.isValid());
+        CPPUNIT_ASSERT_USTRINGS_EQUAL(v1.toString(), v2.toString());
+
+        ts::AVCAttributes a1, a2;
+        full_demux.getAVCAttributes(PID_AVC, a1);
+        streaming_demux.getAVCAttributes(PID_AVC, a2);
+        CPPUNIT_ASSERT(a1.isValid());
+        CPPUNIT_ASSERT_USTRINGS_EQUAL(a1.toString(), a2.toString());
+    }
+}
@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  CppUnit test suite for class ts::PIDContextTable
+//
+//----------------------------------------------------------------------------
+
+#include "tsPIDContextTable.h"
+#include "tsTSAnalyzer.h"
+#include "tsMonotonic.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PIDContextTableTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testAccess();
+    void testIterator();
+    void testBenchmark();
+
+    CPPUNIT_TEST_SUITE(PIDContextTableTest);
+    CPPUNIT_TEST(testAccess);
+    CPPUNIT_TEST(testIterator);
+    CPPUNIT_TEST(testBenchmark);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PIDContextTableTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PIDContextTableTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void PIDContextTableTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void PIDContextTableTest::testAccess()
+{
+    ts::PIDContextTable<int> table;
+    CPPUNIT_ASSERT(table.empty());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), table.size());
+    CPPUNIT_ASSERT(table.find(100) == table.end());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), table.count(100));
+
+    // Contexts are value-initialized on first access.
+    CPPUNIT_ASSERT_EQUAL(0, table[100]);
+    table[100] = 12;
+    table[ts::PID_NULL] = 47;
+    CPPUNIT_ASSERT_EQUAL(size_t(2), table.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), table.count(100));
+    CPPUNIT_ASSERT_EQUAL(12, table[100]);
+    CPPUNIT_ASSERT_EQUAL(47, table.find(ts::PID_NULL)->second);
+    CPPUNIT_ASSERT_EQUAL(ts::PID(100), table.find(100)->first);
+
+    // References remain valid when other contexts are created.
+    int& ref(table[100]);
+    for (ts::PID pid = 0; pid < ts::PID_MAX; pid += 3) {
+        table[pid]++;
+    }
+    ref = 5;
+    CPPUNIT_ASSERT_EQUAL(5, table.find(100)->second);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(1), table.erase(100));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), table.erase(100));
+    CPPUNIT_ASSERT(table.find(100) == table.end());
+
+    table.clear();
+    CPPUNIT_ASSERT(table.empty());
+    CPPUNIT_ASSERT(table.begin() == table.end());
+}
+
+void PIDContextTableTest::testIterator()
+{
+    ts::PIDContextTable<ts::UString> table;
+    table[0x1FFF] = u"null";
+    table[0x0000] = u"pat";
+    table[0x0100] = u"video";
+    table[0x0012] = u"eit";
+
+    // Iteration is in increasing PID order, like in a std::map.
+    const ts::PID expected[] = {0x0000, 0x0012, 0x0100, 0x1FFF};
+    size_t index = 0;
+    for (ts::PIDContextTable<ts::UString>::const_iterator it = table.begin(); it != table.end(); ++it) {
+        CPPUNIT_ASSERT(index < 4);
+        CPPUNIT_ASSERT_EQUAL(expected[index++], it->first);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(4), index);
+
+    // Modification through iterator.
+    for (ts::PIDContextTable<ts::UString>::iterator it = table.begin(); it != table.end(); ++it) {
+        it->second.append(u"!");
+    }
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"eit!", table[0x0012]);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"null!", table[0x1FFF]);
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: per-packet PID lookup in a std::map and in a PIDContextTable,
+// then a TSAnalyzer on an 80-PID multiplex.
+//----------------------------------------------------------------------------
+
+namespace {
+    const size_t BENCH_PIDS = 80;
+    const size_t BENCH_PACKETS = 2000000;
+
+    // Pseudo-random PID sequence, similar to a multiplex of 80 PID's.
+    ts::PID BenchPID(size_t index)
+    {
+        return ts::PID(0x0100 + ((index * 37) % BENCH_PIDS) * 17);
+    }
+}
+
+void PIDContextTableTest::testBenchmark()
+{
+    if (!utest::DebugMode()) {
+        return;
+    }
+
+    struct Context {
+        uint64_t count;
+        uint8_t  cc;
+        Context() : count(0), cc(0) {}
+    };
+
+    // Before: per-packet lookup in a std::map.
+    std::map<ts::PID, Context> map;
+    ts::Monotonic start;
+    start.getSystemTime();
+    for (size_t i = 0; i < BENCH_PACKETS; ++i) {
+        Context& c(map[BenchPID(i)]);
+        c.count++;
+        c.cc = uint8_t((c.cc + 1) & 0x0F);
+    }
+    ts::Monotonic end;
+    end.getSystemTime();
+    const ts::NanoSecond map_duration = end - start;
+
+    // After: per-packet lookup in a PIDContextTable.
+    ts::PIDContextTable<Context> table;
+    start.getSystemTime();
+    for (size_t i = 0; i < BENCH_PACKETS; ++i) {
+        Context& c(table[BenchPID(i)]);
+        c.count++;
+        c.cc = uint8_t((c.cc + 1) & 0x0F);
+    }
+    end.getSystemTime();
+    const ts::NanoSecond table_duration = end - start;
+
+    // Both containers must have the same content.
+    CPPUNIT_ASSERT_EQUAL(map.size(), table.size());
+    for (std::map<ts::PID, Context>::const_iterator it = map.begin(); it != map.end(); ++it) {
+        CPPUNIT_ASSERT_EQUAL(it->second.count, table[it->first].count);
+    }
+
+    utest::Out() << "PIDContextTableTest: " << BENCH_PIDS << " PID's, lookup in std::map: " << utest::Rate(BENCH_PACKETS, map_duration)
+                 << " packets/s, in PIDContextTable: " << utest::Rate(BENCH_PACKETS, table_duration) << " packets/s" << std::endl;
+
+    // Complete analyzer on an 80-PID multiplex, with PES packets.
+    ts::TSPacketVector packets(BENCH_PIDS * 100);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        ts::TSPacket& pkt(packets[i]);
+        pkt = ts::NullPacket;
+        pkt.setPID(BenchPID(i));
+        pkt.setCC(uint8_t((i / BENCH_PIDS) & 0x0F));
+        if ((i / BENCH_PIDS) % 10 == 0) {
+            // Start of a PES packet every 10 TS packets in each PID.
+            pkt.setPUSI();
+            pkt.b[4] = pkt.b[5] = 0x00;
+            pkt.b[6] = 0x01;
+            pkt.b[7] = 0xE0;
+        }
+    }
+    ts::TSAnalyzer analyzer;
+    const size_t loops = BENCH_PACKETS / packets.size();
+    start.getSystemTime();
+    for (size_t n = 0; n < loops; ++n) {
+        for (size_t i = 0; i < packets.size(); ++i) {
+            analyzer.feedPacket(packets[i]);
+        }
+    }
+    end.getSystemTime();
+
+    std::vector<ts::PID> pids;
+    analyzer.getPIDs(pids);
+    CPPUNIT_ASSERT_EQUAL(BENCH_PIDS, pids.size());
+
+    utest::Out() << "PIDContextTableTest: TSAnalyzer on " << BENCH_PIDS << " PID's: " << utest::Rate(loops * packets.size(), end - start) << " packets/s" << std::endl;
+}
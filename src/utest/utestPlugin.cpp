@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsPluginSharedLibrary.h"
+#include "tsPlugin.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
 
@@ -49,11 +50,13 @@ public:
     void testInput();
     void testOutput();
     void testProcessor();
+    void testPacketBatch();
 
     CPPUNIT_TEST_SUITE(PluginTest);
     CPPUNIT_TEST(testInput);
     CPPUNIT_TEST(testOutput);
     CPPUNIT_TEST(testProcessor);
+    CPPUNIT_TEST(testPacketBatch);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -123,3 +126,79 @@ void PluginTest::testProcessor()
     CPPUNIT_ASSERT(plugin.new_output == 0);
     CPPUNIT_ASSERT(plugin.new_processor != 0);
 }
+
+namespace {
+    // A minimal tsp environment for plugins.
+    class TestTSP: public ts::TSP
+    {
+    public:
+        TestTSP() : ts::TSP(ts::Severity::Info) {}
+        virtual void useJointTermination(bool) override {}
+        virtual void jointTerminate() override {}
+        virtual bool useJointTermination() const override { return false; }
+        virtual bool thisJointTerminated() const override { return false; }
+    protected:
+        virtual void writeLog(int severity, const ts::UString& msg) override { utest::Out() << "TestTSP: " << msg << std::endl; }
+    };
+
+    // A processor plugin which requests a flush or signals a new bitrate on specific packets.
+    // The packet to process is identified by its first payload byte.
+    class TestProcessor: public ts::ProcessorPlugin
+    {
+    public:
+        TestProcessor(ts::TSP* tsp_) : ts::ProcessorPlugin(tsp_, u"test", u"[options]"), count(0) {}
+        size_t count;
+        virtual Status processPacket(ts::TSPacket& pkt, bool& flush, bool& bitrate_changed) override
+        {
+            count++;
+            switch (pkt.b[4]) {
+                case 1: flush = true; break;
+                case 2: bitrate_changed = true; break;
+                case 3: return TSP_END;
+                default: break;
+            }
+            return TSP_OK;
+        }
+    };
+}
+
+void PluginTest::testPacketBatch()
+{
+    TestTSP tsp;
+    TestProcessor proc(&tsp);
+
+    ts::TSPacket pkt[10];
+    ts::ProcessorPlugin::Status status[10];
+    for (size_t i = 0; i < 10; ++i) {
+        pkt[i] = ts::NullPacket;
+        pkt[i].b[4] = 0;
+    }
+    pkt[3].b[4] = 1;  // flush
+    pkt[5].b[0] = 0;  // dropped by a previous plugin
+    pkt[6].b[4] = 2;  // bitrate changed
+    pkt[8].b[4] = 3;  // end
+
+    bool flush = false;
+    bool bitrate_changed = false;
+    CPPUNIT_ASSERT_EQUAL(size_t(4), proc.processPacketBatch(pkt, status, 10, flush, bitrate_changed));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), proc.count);
+    CPPUNIT_ASSERT(flush);
+    CPPUNIT_ASSERT(!bitrate_changed);
+
+    flush = false;
+    CPPUNIT_ASSERT_EQUAL(size_t(3), proc.processPacketBatch(pkt + 4, status + 4, 6, flush, bitrate_changed));
+    CPPUNIT_ASSERT_EQUAL(size_t(6), proc.count);
+    CPPUNIT_ASSERT(!flush);
+    CPPUNIT_ASSERT(bitrate_changed);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_DROP, status[5]);
+
+    bitrate_changed = false;
+    CPPUNIT_ASSERT_EQUAL(size_t(2), proc.processPacketBatch(pkt + 7, status + 7, 3, flush, bitrate_changed));
+    CPPUNIT_ASSERT_EQUAL(size_t(8), proc.count);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_END, status[8]);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(1), proc.processPacketBatch(pkt + 9, status + 9, 1, flush, bitrate_changed));
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[9]);
+    CPPUNIT_ASSERT(!flush);
+    CPPUNIT_ASSERT(!bitrate_changed);
+}
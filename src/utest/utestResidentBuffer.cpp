@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsResidentBuffer.h"
+#include "tsSysInfo.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
 
@@ -47,9 +48,11 @@ public:
     virtual void tearDown() override;
 
     void testResidentBuffer();
+    void testHugePages();
 
     CPPUNIT_TEST_SUITE(ResidentBufferTest);
     CPPUNIT_TEST(testResidentBuffer);
+    CPPUNIT_TEST(testHugePages);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -86,4 +89,27 @@ void ResidentBufferTest::testResidentBuffer()
 
     CPPUNIT_ASSERT(buf.isLocked());
     CPPUNIT_ASSERT(buf.count() >= buf_size);
+    CPPUNIT_ASSERT(buf.pageType() == ts::NORMAL_PAGES);
+    CPPUNIT_ASSERT(buf.pageSize() == ts::SysInfo::Instance()->memoryPageSize());
+}
+
+void ResidentBufferTest::testHugePages()
+{
+    // Huge pages may be unavailable, the buffer must be usable in all cases.
+    const size_t buf_size = 3 * 1024 * 1024;
+
+    ts::ResidentBuffer<uint32_t> buf(buf_size, true);
+
+    utest::Out() << "ResidentBufferTest: huge pages: pageType() = " << ts::MemoryPageTypeEnum.name(buf.pageType())
+                 << ", pageSize() = " << buf.pageSize() << ", isLocked() = " << buf.isLocked() << std::endl;
+
+    CPPUNIT_ASSERT(buf.count() >= buf_size);
+    CPPUNIT_ASSERT(buf.pageSize() >= ts::SysInfo::Instance()->memoryPageSize());
+    CPPUNIT_ASSERT(buf.pageSize() % ts::SysInfo::Instance()->memoryPageSize() == 0);
+    CPPUNIT_ASSERT(uint64_t(buf.base()) % buf.pageSize() == 0);
+
+    for (size_t i = 0; i < buf_size; ++i) {
+        buf.base()[i] = uint32_t(i);
+    }
+    CPPUNIT_ASSERT_EQUAL(uint32_t(buf_size - 1), buf.base()[buf_size - 1]);
 }
@@ -32,6 +32,8 @@
 //----------------------------------------------------------------------------
 
 #include "tsScrambling.h"
+#include "tsParallelScrambling.h"
+#include "tsScramblingCache.h"
 #include "tsTSPacket.h"
 #include "tsNames.h"
 #include "utestCppUnitTest.h"
@@ -49,9 +51,15 @@ public:
     virtual void tearDown() override;
 
     void testScrambling();
+    void testBatch();
+    void testParallel();
+    void testCache();
 
     CPPUNIT_TEST_SUITE(ScramblingTest);
     CPPUNIT_TEST(testScrambling);
+    CPPUNIT_TEST(testBatch);
+    CPPUNIT_TEST(testParallel);
+    CPPUNIT_TEST(testCache);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -211,3 +219,222 @@ void ScramblingTest::testScrambling()
         CPPUNIT_ASSERT(::memcmp(pkt.b + header_size, vec->cipher.b + header_size, payload_size) == 0);
     }
 }
+
+// Same test vectors with the batch interface, many copies of each packet in one batch.
+void ScramblingTest::testBatch()
+{
+    const ScramblingTestVector* vec = scrambling_test_vectors;
+    const size_t count = sizeof(scrambling_test_vectors) / sizeof(ScramblingTestVector);
+    const size_t copies = 300;
+    ts::Scrambling scrambler;
+
+    for (size_t ti = 0; ti < count; ++ti, ++vec) {
+
+        const size_t header_size = vec->plain.getHeaderSize();
+        const size_t payload_size = vec->plain.getPayloadSize();
+        const uint8_t scv = vec->cipher.getScrambling();
+        scrambler.init(scv == ts::SC_EVEN_KEY ? vec->cw_even : vec->cw_odd, ts::Scrambling::REDUCE_ENTROPY);
+
+        ts::TSPacketVector packets(copies);
+        std::vector<uint8_t*> data(copies);
+        std::vector<size_t> size(copies, payload_size);
+        for (size_t i = 0; i < copies; ++i) {
+            data[i] = packets[i].b + header_size;
+        }
+
+        // Check all batch sizes around the number of blocks per slice word.
+        const size_t batches[] = {1, 7, 8, 63, 64, 65, 128, 129, 256, 257, copies};
+        for (size_t bi = 0; bi < sizeof(batches) / sizeof(batches[0]); ++bi) {
+            const size_t batch = batches[bi];
+
+            for (size_t i = 0; i < batch; ++i) {
+                packets[i] = vec->cipher;
+            }
+            scrambler.decryptBatch(&data[0], &size[0], batch);
+            for (size_t i = 0; i < batch; ++i) {
+                CPPUNIT_ASSERT(::memcmp(packets[i].b + header_size, vec->plain.b + header_size, payload_size) == 0);
+            }
+
+            scrambler.encryptBatch(&data[0], &size[0], batch);
+            for (size_t i = 0; i < batch; ++i) {
+                CPPUNIT_ASSERT(::memcmp(packets[i].b + header_size, vec->cipher.b + header_size, payload_size) == 0);
+            }
+        }
+    }
+
+    // Random data blocks of all sizes, compared with the packet-per-packet implementation.
+    uint32_t seed = 0x12345678;
+    for (size_t loop = 0; loop < 5; ++loop) {
+
+        uint8_t cw[ts::CW_BYTES];
+        for (size_t i = 0; i < sizeof(cw); ++i) {
+            seed = seed * 1103515245 + 12345;
+            cw[i] = uint8_t(seed >> 16);
+        }
+        scrambler.init(cw, loop % 2 == 0 ? ts::Scrambling::REDUCE_ENTROPY : ts::Scrambling::FULL_CW);
+
+        const size_t batch = 50 + loop * 60;
+        ts::TSPacketVector plain(batch);
+        ts::TSPacketVector ref(batch);
+        ts::TSPacketVector packets(batch);
+        std::vector<uint8_t*> data(batch);
+        std::vector<size_t> size(batch);
+
+        for (size_t i = 0; i < batch; ++i) {
+            for (size_t b = 0; b < ts::PKT_SIZE; ++b) {
+                seed = seed * 1103515245 + 12345;
+                plain[i].b[b] = uint8_t(seed >> 16);
+            }
+            size[i] = i % (ts::PKT_SIZE - 4 + 1);
+            data[i] = packets[i].b + 4;
+            ref[i] = packets[i] = plain[i];
+            scrambler.encrypt(ref[i].b + 4, size[i]);
+        }
+
+        scrambler.encryptBatch(&data[0], &size[0], batch);
+        for (size_t i = 0; i < batch; ++i) {
+            CPPUNIT_ASSERT(::memcmp(packets[i].b, ref[i].b, ts::PKT_SIZE) == 0);
+        }
+
+        scrambler.decryptBatch(&data[0], &size[0], batch);
+        for (size_t i = 0; i < batch; ++i) {
+            CPPUNIT_ASSERT(::memcmp(packets[i].b, plain[i].b, ts::PKT_SIZE) == 0);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Parallel scrambling with control word changes.
+//----------------------------------------------------------------------------
+
+void ScramblingTest::testParallel()
+{
+    const size_t count = 3000;
+    const size_t cw_period = 700;  // change control word every 700 packets
+    uint32_t seed = 0x87654321;
+
+    ts::TSPacketVector plain(count);
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t b = 0; b < ts::PKT_SIZE; ++b) {
+            seed = seed * 1103515245 + 12345;
+            plain[i].b[b] = uint8_t(seed >> 16);
+        }
+    }
+
+    // Reference: packet per packet.
+    ts::TSPacketVector ref(plain);
+    ts::Scrambling key;
+    uint8_t cw[ts::CW_BYTES];
+    for (size_t i = 0; i < count; ++i) {
+        if (i % cw_period == 0) {
+            ::memset(cw, int(i / cw_period), sizeof(cw));
+            key.init(cw, ts::Scrambling::FULL_CW);
+        }
+        key.encrypt(ref[i].b + 4, ts::PKT_SIZE - 4 - i % 100);
+    }
+
+    for (size_t threads = 0; threads <= 3; ++threads) {
+        ts::ParallelScrambling pool(threads);
+        CPPUNIT_ASSERT_EQUAL(threads, pool.threads());
+
+        // The key is reinitialized immediately after each submission.
+        ts::TSPacketVector packets(plain);
+        for (size_t i = 0; i < count; ++i) {
+            if (i % cw_period == 0) {
+                pool.encrypt(key);
+                ::memset(cw, int(i / cw_period), sizeof(cw));
+                key.init(cw, ts::Scrambling::FULL_CW);
+            }
+            pool.add(packets[i].b + 4, ts::PKT_SIZE - 4 - i % 100);
+        }
+        CPPUNIT_ASSERT(pool.pending() > 0);
+        pool.encrypt(key);
+        CPPUNIT_ASSERT_EQUAL(size_t(0), pool.pending());
+        pool.wait();
+        for (size_t i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT(packets[i] == ref[i]);
+        }
+
+        // Decrypt in one submission per crypto-period.
+        for (size_t i = 0; i < count; ++i) {
+            if (i % cw_period == 0 && i > 0) {
+                ::memset(cw, int(i / cw_period - 1), sizeof(cw));
+                key.init(cw, ts::Scrambling::FULL_CW);
+                pool.decrypt(key);
+            }
+            pool.add(packets[i].b + 4, ts::PKT_SIZE - 4 - i % 100);
+        }
+        ::memset(cw, int((count - 1) / cw_period), sizeof(cw));
+        key.init(cw, ts::Scrambling::FULL_CW);
+        pool.decrypt(key);
+        pool.wait();
+        for (size_t i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT(packets[i] == plain[i]);
+        }
+    }
+}
+
+void ScramblingTest::testCache()
+{
+    ts::ScramblingCache cache(3);
+    uint8_t cw[ts::CW_BYTES] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+    const ts::ScramblingPtr k1(cache.get(cw, ts::Scrambling::FULL_CW));
+    CPPUNIT_ASSERT(!k1.isNull());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), cache.size());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), cache.hits());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), cache.misses());
+
+    // Same control word, same context.
+    CPPUNIT_ASSERT(cache.get(cw, ts::Scrambling::FULL_CW) == k1);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), cache.hits());
+
+    // The entropy mode is part of the key.
+    const ts::ScramblingPtr k2(cache.get(cw, ts::Scrambling::REDUCE_ENTROPY));
+    CPPUNIT_ASSERT(k2 != k1);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), cache.size());
+
+    // The preprocessed contexts are identical to directly initialized ones.
+    ts::Scrambling ref1;
+    ts::Scrambling ref2;
+    ref1.init(cw, ts::Scrambling::FULL_CW);
+    ref2.init(cw, ts::Scrambling::REDUCE_ENTROPY);
+    uint8_t data0[ts::PKT_SIZE - 4];
+    for (size_t i = 0; i < sizeof(data0); ++i) {
+        data0[i] = uint8_t(i * 7);
+    }
+    uint8_t data1[sizeof(data0)];
+    uint8_t data2[sizeof(data0)];
+    ::memcpy(data1, data0, sizeof(data0));
+    ::memcpy(data2, data0, sizeof(data0));
+    k1->encrypt(data1, sizeof(data1));
+    ref1.encrypt(data2, sizeof(data2));
+    CPPUNIT_ASSERT(::memcmp(data1, data2, sizeof(data1)) == 0);
+    ::memcpy(data1, data0, sizeof(data0));
+    ::memcpy(data2, data0, sizeof(data0));
+    k2->encrypt(data1, sizeof(data1));
+    ref2.encrypt(data2, sizeof(data2));
+    CPPUNIT_ASSERT(::memcmp(data1, data2, sizeof(data1)) == 0);
+
+    // Evict the least recently used context: k2, since k1 was used after.
+    cache.get(cw, ts::Scrambling::FULL_CW);
+    cw[0] = 0x11;
+    cache.prefetch(cw, ts::Scrambling::FULL_CW);
+    cw[0] = 0x21;
+    cache.prefetch(cw, ts::Scrambling::FULL_CW);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), cache.size());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), cache.misses());
+    cw[0] = 0x01;
+    CPPUNIT_ASSERT(cache.get(cw, ts::Scrambling::FULL_CW) == k1);
+    CPPUNIT_ASSERT(cache.get(cw, ts::Scrambling::REDUCE_ENTROPY) != k2);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5), cache.misses());
+
+    // An evicted context remains valid.
+    ::memcpy(data1, data0, sizeof(data0));
+    k2->encrypt(data1, sizeof(data1));
+    CPPUNIT_ASSERT(::memcmp(data1, data2, sizeof(data1)) == 0);
+
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+}
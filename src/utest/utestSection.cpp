@@ -55,6 +55,7 @@ public:
     void testBAT();
     void testNIT();
     void testReload();
+    void testReloadShared();
     void testAssign();
 
     CPPUNIT_TEST_SUITE(SectionTest);
@@ -63,6 +64,7 @@ public:
     CPPUNIT_TEST(testNIT);
     CPPUNIT_TEST(testReload);
     CPPUNIT_TEST(testReload);
+    CPPUNIT_TEST(testReloadShared);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -135,6 +137,35 @@ void SectionTest::testReload()
     CPPUNIT_ASSERT(sec.isLongSection());
 }
 
+void SectionTest::testReloadShared()
+{
+    ts::Section sec(psi_tot_tnt_sections, sizeof(psi_tot_tnt_sections), ts::PID_TOT, ts::CRC32::CHECK);
+    CPPUNIT_ASSERT(sec.isValid());
+
+    {
+        // The content is shared, reloading must not modify the other section.
+        ts::Section shared(sec, ts::SHARE);
+        CPPUNIT_ASSERT(shared.content() == sec.content());
+
+        sec.reload(psi_bat_tvnum_sections, sizeof(psi_bat_tvnum_sections), ts::PID_BAT, ts::CRC32::CHECK);
+        CPPUNIT_ASSERT(sec.isValid());
+        CPPUNIT_ASSERT_EQUAL(ts::TID(ts::TID_BAT), sec.tableId());
+        CPPUNIT_ASSERT(shared.content() != sec.content());
+        CPPUNIT_ASSERT(shared.isValid());
+        CPPUNIT_ASSERT_EQUAL(ts::TID(ts::TID_TOT), shared.tableId());
+        CPPUNIT_ASSERT_EQUAL(sizeof(psi_tot_tnt_sections), shared.size());
+        CPPUNIT_ASSERT(::memcmp(psi_tot_tnt_sections, shared.content(), shared.size()) == 0);
+    }
+
+    // The content is no longer shared, reloading reuses the same memory.
+    const uint8_t* const content = sec.content();
+    sec.reload(psi_bat_tvnum_sections, sizeof(psi_bat_tvnum_sections), ts::PID_BAT, ts::CRC32::CHECK);
+    CPPUNIT_ASSERT(sec.isValid());
+    CPPUNIT_ASSERT(sec.content() == content);
+    CPPUNIT_ASSERT_EQUAL(sizeof(psi_bat_tvnum_sections), sec.size());
+    CPPUNIT_ASSERT(::memcmp(psi_bat_tvnum_sections, sec.content(), sec.size()) == 0);
+}
+
 void SectionTest::testAssign()
 {
     ts::Section sec(psi_tot_tnt_sections, sizeof(psi_tot_tnt_sections), ts::PID_TOT, ts::CRC32::CHECK);
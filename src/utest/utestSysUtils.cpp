@@ -673,7 +673,8 @@ void SysUtilsTest::testSysInfo()
                  << "    systemVersion = \"" << ts::SysInfo::Instance()->systemVersion() << '"' << std::endl
                  << "    systemName = \"" << ts::SysInfo::Instance()->systemName() << '"' << std::endl
                  << "    hostName = \"" << ts::SysInfo::Instance()->hostName() << '"' << std::endl
-                 << "    memoryPageSize = " << ts::SysInfo::Instance()->memoryPageSize() << std::endl;
+                 << "    memoryPageSize = " << ts::SysInfo::Instance()->memoryPageSize() << std::endl
+                 << "    cpuCount = " << ts::SysInfo::Instance()->cpuCount() << std::endl;
 
 #if defined(TS_WINDOWS)
     CPPUNIT_ASSERT(ts::SysInfo::Instance()->isWindows());
@@ -692,4 +693,5 @@ void SysUtilsTest::testSysInfo()
     // We can't predict the memory page size, except that it must be a multiple of 256.
     CPPUNIT_ASSERT(ts::SysInfo::Instance()->memoryPageSize() > 0);
     CPPUNIT_ASSERT(ts::SysInfo::Instance()->memoryPageSize() % 256 == 0);
+    CPPUNIT_ASSERT(ts::SysInfo::Instance()->cpuCount() > 0);
 }
@@ -0,0 +1,278 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::TSAnalyzer
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSAnalyzerReport.h"
+#include "tsTSAnalyzerOptions.h"
+#include "tsOneShotPacketizer.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+#include "tsTDT.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSAnalyzerTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testParallel();
+    void testParallelSwitch();
+
+    CPPUNIT_TEST_SUITE(TSAnalyzerTest);
+    CPPUNIT_TEST(testParallel);
+    CPPUNIT_TEST(testParallelSwitch);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    ts::TSPacketVector _stream;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TSAnalyzerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Append all packets of a table in a vector of packets.
+    void AddTable(ts::TSPacketVector& packets, ts::PID pid, const ts::AbstractTable& table)
+    {
+        ts::BinaryTable bin;
+        table.serialize(bin);
+        ts::OneShotPacketizer pzer(pid);
+        pzer.addTable(bin);
+        ts::TSPacketVector tp;
+        pzer.getPackets(tp);
+        packets.insert(packets.end(), tp.begin(), tp.end());
+    }
+}
+
+// Test suite initialization method.
+// Build a synthetic transport stream with PSI/SI, PES, PCR's, scrambling and errors.
+void TSAnalyzerTest::setUp()
+{
+    ts::TSPacketVector psi;
+
+    ts::PAT pat(0, true, 0x0001);
+    pat.pmts[0x0101] = 0x0100;
+    pat.pmts[0x0201] = 0x0200;
+    AddTable(psi, ts::PID_PAT, pat);
+
+    ts::PMT pmt1(0, true, 0x0101, 0x0110);
+    pmt1.streams[0x0110].stream_type = ts::ST_MPEG2_VIDEO;
+    pmt1.streams[0x0111].stream_type = ts::ST_MPEG1_AUDIO;
+    AddTable(psi, 0x0100, pmt1);
+
+    ts::PMT pmt2(0, true, 0x0201, 0x0210);
+    pmt2.streams[0x0210].stream_type = ts::ST_AVC_VIDEO;
+    pmt2.streams[0x0211].stream_type = ts::ST_MPEG2_AUDIO;
+    AddTable(psi, 0x0200, pmt2);
+
+    ts::SDT sdt(true, 0, true, 0x0001, 0x0002);
+    sdt.services[0x0101].setName(u"Service 1");
+    sdt.services[0x0101].setProvider(u"Provider");
+    sdt.services[0x0201].setName(u"Service 2");
+    sdt.services[0x0201].setProvider(u"Provider");
+    AddTable(psi, ts::PID_SDT, sdt);
+
+    const ts::PID pes_pids[] = {0x0110, 0x0111, 0x0210, 0x0211, 0x0300};
+    const size_t pes_count = sizeof(pes_pids) / sizeof(pes_pids[0]);
+    uint8_t cc[pes_count] = {0, 0, 0, 0, 0};
+    uint8_t psi_cc[ts::PID_MAX];
+    ::memset(psi_cc, 0, sizeof(psi_cc));
+    uint64_t pcr = 1000000;
+
+    _stream.clear();
+    for (size_t i = 0; i < 150000; ++i) {
+        ts::TSPacket pkt(ts::NullPacket);
+        if (i % 500 == 0) {
+            // Insert all PSI packets, with a TDT from time to time.
+            ts::TSPacketVector tp(psi);
+            if (i % 5000 == 0) {
+                AddTable(tp, ts::PID_TDT, ts::TDT(ts::Time(2018, 1, 1, 0, 0, 0) + ts::MilliSecond(i) * 2));
+            }
+            for (size_t n = 0; n < tp.size(); ++n) {
+                tp[n].setCC(psi_cc[tp[n].getPID()]++ & 0x0F);
+                _stream.push_back(tp[n]);
+            }
+        }
+        else if (i % 7 != 0) {
+            // PES packets.
+            const size_t index = (i / 3) % pes_count;
+            pkt.setPID(pes_pids[index]);
+            pkt.setCC(cc[index]++ & 0x0F);
+            if (index == 0 && i % 40 == 1) {
+                // PCR in adaptation field.
+                pkt.b[3] = (pkt.b[3] & 0xCF) | 0x30;
+                pkt.b[4] = 7;
+                pkt.b[5] = 0x10;
+                pkt.setPCR(pcr);
+                pcr += 40 * 100000;
+            }
+            if (i % 61 == 4) {
+                // Start of a PES packet.
+                const size_t hs = pkt.getHeaderSize();
+                pkt.setPUSI();
+                pkt.b[hs] = pkt.b[hs + 1] = 0x00;
+                pkt.b[hs + 2] = 0x01;
+                pkt.b[hs + 3] = index < 2 ? 0xE0 : 0xC0;
+            }
+            if (pes_pids[index] >= 0x0200) {
+                // Scrambled PID's with crypto-periods.
+                pkt.setScrambling((i / 20000) % 2 == 0 ? ts::SC_EVEN_KEY : ts::SC_ODD_KEY);
+            }
+            if (i % 1013 == 0) {
+                // Lost packet.
+                cc[index]++;
+            }
+            else if (i % 1409 == 0) {
+                // Duplicated packet.
+                _stream.push_back(pkt);
+            }
+        }
+        if (i % 997 == 0) {
+            // Corrupted packet, followed by a suspect packet in an unknown PID.
+            pkt.setTEI();
+            _stream.push_back(pkt);
+            pkt = ts::NullPacket;
+            pkt.setPID(ts::PID(0x1000 + i % 50));
+        }
+        else if (i % 1601 == 0) {
+            // Invalid sync byte, followed by a packet in an existing PID.
+            pkt.b[0] = 0x48;
+        }
+        _stream.push_back(pkt);
+    }
+}
+
+// Test suite cleanup method.
+void TSAnalyzerTest::tearDown()
+{
+    _stream.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Build a full report of the analysis, without the system times.
+    std::string Report(ts::TSAnalyzerReport& analyzer)
+    {
+        ts::TSAnalyzerOptions opt(u"test");
+        opt.ts_analysis = opt.service_analysis = opt.pid_analysis = opt.table_analysis = opt.error_analysis = opt.normalized = true;
+        std::ostringstream strm;
+        analyzer.report(strm, opt);
+
+        std::istringstream in(strm.str());
+        std::string result;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.find(":system:") == std::string::npos) {
+                result.append(line);
+                result.append("\n");
+            }
+        }
+        return result;
+    }
+
+    // Analyze a stream and return the report.
+    std::string Analyze(const ts::TSPacketVector& stream, size_t threads)
+    {
+        ts::TSAnalyzerReport analyzer;
+        analyzer.setWorkerThreads(threads);
+        for (size_t i = 0; i < stream.size(); ++i) {
+            analyzer.feedPacket(stream[i]);
+        }
+        return Report(analyzer);
+    }
+}
+
+void TSAnalyzerTest::testParallel()
+{
+    const std::string reference(Analyze(_stream, 0));
+    utest::Out() << "TSAnalyzerTest: sequential analysis:" << std::endl << reference << std::endl;
+
+    // Make sure that the stream exercises the various parts of the analysis.
+    CPPUNIT_ASSERT(reference.find(":suspectignored=0:") == std::string::npos);
+    CPPUNIT_ASSERT(reference.find("Service 2") != std::string::npos);
+    CPPUNIT_ASSERT(reference.find(":cryptoperiod=0:") == std::string::npos && reference.find("ts:id=") != std::string::npos);
+
+    for (size_t threads = 1; threads <= 5; ++threads) {
+        const std::string report(Analyze(_stream, threads));
+        CPPUNIT_ASSERT_EQUAL(reference, report);
+    }
+}
+
+void TSAnalyzerTest::testParallelSwitch()
+{
+    ts::TSAnalyzerReport seq;
+    ts::TSAnalyzerReport par;
+    par.setWorkerThreads(3);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), par.workerThreads());
+
+    // Intermediate reports and changes of threads during the analysis.
+    for (size_t i = 0; i < _stream.size(); ++i) {
+        seq.feedPacket(_stream[i]);
+        par.feedPacket(_stream[i]);
+        if (i % 40000 == 39999) {
+            CPPUNIT_ASSERT_EQUAL(Report(seq), Report(par));
+            par.setWorkerThreads((par.workerThreads() + 1) % 4);
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(Report(seq), Report(par));
+
+    // Reset in parallel mode.
+    seq.reset();
+    par.setWorkerThreads(2);
+    par.reset();
+    for (size_t i = 0; i < _stream.size() / 2; ++i) {
+        seq.feedPacket(_stream[i]);
+        par.feedPacket(_stream[i]);
+    }
+    CPPUNIT_ASSERT_EQUAL(Report(seq), Report(par));
+
+    par.setWorkerThreads(ts::TSAnalyzer::MAX_WORKER_THREADS + 10);
+    CPPUNIT_ASSERT_EQUAL(ts::TSAnalyzer::MAX_WORKER_THREADS, par.workerThreads());
+    par.setWorkerThreads(0);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), par.workerThreads());
+}
@@ -32,7 +32,9 @@
 //----------------------------------------------------------------------------
 
 #include "tsTSPacket.h"
+#include "tsTSPacketHeaders.h"
 #include "tsMemoryUtils.h"
+#include "tsMonotonic.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
 
@@ -48,9 +50,13 @@ public:
     virtual void tearDown() override;
 
     void testPacket();
+    void testHeaders();
+    void testHeadersBenchmark();
 
     CPPUNIT_TEST_SUITE(TSPacketTest);
     CPPUNIT_TEST(testPacket);
+    CPPUNIT_TEST(testHeaders);
+    CPPUNIT_TEST(testHeadersBenchmark);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -88,3 +94,153 @@ void TSPacketTest::testPacket()
 
     CPPUNIT_ASSERT_EQUAL(size_t(7 * ts::PKT_SIZE), sizeof(packets));
 }
+
+namespace {
+    // Build pseudo-random packet headers.
+    void RandomHeaders(ts::TSPacketVector& packets)
+    {
+        uint32_t seed = 0x87654321;
+        for (size_t i = 0; i < packets.size(); ++i) {
+            seed = seed * 1103515245 + 12345;
+            packets[i] = ts::NullPacket;
+            ts::PutUInt32(packets[i].b, seed);
+            // Most packets start with a sync byte.
+            if ((seed & 0x0700) != 0) {
+                packets[i].b[0] = ts::SYNC_BYTE;
+            }
+        }
+    }
+}
+
+void TSPacketTest::testHeaders()
+{
+    utest::Out() << "TSPacketTest: headers decoding acceleration: " << ts::TSPacketHeaders::Acceleration() << std::endl;
+
+    ts::TSPacketVector packets(100);
+    RandomHeaders(packets);
+
+    // All sizes and alignments, to check the SIMD and scalar parts.
+    ts::TSPacketHeaders headers;
+    for (size_t start = 0; start < 9; ++start) {
+        for (size_t count = 0; start + count <= packets.size(); ++count) {
+            headers.decode(&packets[start], count);
+            CPPUNIT_ASSERT_EQUAL(count, headers.size());
+            for (size_t i = 0; i < count; ++i) {
+                const ts::TSPacket& pkt(packets[start + i]);
+                CPPUNIT_ASSERT_EQUAL(pkt.getPID(), headers.getPID(i));
+                CPPUNIT_ASSERT_EQUAL(pkt.getCC(), headers.getCC(i));
+                CPPUNIT_ASSERT_EQUAL(pkt.getScrambling(), headers.getScrambling(i));
+                CPPUNIT_ASSERT_EQUAL(pkt.hasValidSync(), headers.hasValidSync(i));
+                CPPUNIT_ASSERT_EQUAL(pkt.getTEI(), headers.getTEI(i));
+                CPPUNIT_ASSERT_EQUAL(pkt.getPUSI(), headers.getPUSI(i));
+                CPPUNIT_ASSERT_EQUAL(pkt.getPriority(), headers.getPriority(i));
+                CPPUNIT_ASSERT_EQUAL(pkt.hasAF(), headers.hasAF(i));
+                CPPUNIT_ASSERT_EQUAL(pkt.hasPayload(), headers.hasPayload(i));
+            }
+        }
+    }
+
+    // Batched PID lookups.
+    ts::PIDSet filter;
+    for (ts::PID pid = 0; pid < ts::PID_MAX; pid += 3) {
+        filter.set(pid);
+    }
+    headers.decode(&packets[0], packets.size());
+    std::vector<uint8_t> match(headers.size());
+    std::vector<size_t> indexes;
+    size_t expected = 0;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        expected += filter[packets[i].getPID()];
+    }
+    CPPUNIT_ASSERT_EQUAL(expected, headers.matchPIDs(filter, &match[0]));
+    CPPUNIT_ASSERT_EQUAL(expected, headers.selectPIDs(filter, indexes));
+    CPPUNIT_ASSERT_EQUAL(expected, indexes.size());
+    for (size_t i = 0, next = 0; i < packets.size(); ++i) {
+        const bool in = filter[packets[i].getPID()];
+        CPPUNIT_ASSERT_EQUAL(uint8_t(in), match[i]);
+        if (in) {
+            CPPUNIT_ASSERT_EQUAL(i, indexes[next++]);
+        }
+    }
+}
+
+void TSPacketTest::testHeadersBenchmark()
+{
+    if (!utest::DebugMode()) {
+        return;
+    }
+
+    const size_t batch = 512;
+    const size_t loops = 20000;
+    ts::TSPacketVector packets(batch);
+    RandomHeaders(packets);
+    ts::PIDSet filter;
+    filter.set(0x0100);
+    filter.set(0x1FFF);
+
+    // Decoding all header fields, packet by packet using the accessors.
+    std::vector<ts::PID> pid(batch);
+    std::vector<uint8_t> flags(batch);
+    std::vector<uint8_t> cc(batch);
+    std::vector<uint8_t> scrambling(batch);
+    ts::Monotonic start;
+    start.getSystemTime();
+    for (size_t n = 0; n < loops; ++n) {
+        for (size_t i = 0; i < batch; ++i) {
+            const ts::TSPacket& pkt(packets[i]);
+            pid[i] = pkt.getPID();
+            cc[i] = pkt.getCC();
+            scrambling[i] = pkt.getScrambling();
+            flags[i] = uint8_t((pkt.getTEI() ? ts::TSPacketHeaders::TEI : 0) |
+                               (pkt.getPUSI() ? ts::TSPacketHeaders::PUSI : 0) |
+                               (pkt.getPriority() ? ts::TSPacketHeaders::PRIORITY : 0) |
+                               (pkt.hasValidSync() ? ts::TSPacketHeaders::VALID_SYNC : 0) |
+                               (pkt.hasAF() ? ts::TSPacketHeaders::HAS_AF : 0) |
+                               (pkt.hasPayload() ? ts::TSPacketHeaders::HAS_PAYLOAD : 0));
+        }
+    }
+    ts::Monotonic end;
+    end.getSystemTime();
+    const ts::NanoSecond access_duration = end - start;
+
+    // Decoding all header fields by batch.
+    ts::TSPacketHeaders headers;
+    start.getSystemTime();
+    for (size_t n = 0; n < loops; ++n) {
+        headers.decode(&packets[0], batch);
+    }
+    end.getSystemTime();
+    const ts::NanoSecond batch_duration = end - start;
+    CPPUNIT_ASSERT(::memcmp(&pid[0], headers.pids(), batch * sizeof(ts::PID)) == 0);
+    CPPUNIT_ASSERT(::memcmp(&flags[0], headers.flags(), batch) == 0);
+
+    utest::Out() << "TSPacketTest: header decoding, accessors: " << utest::Rate(batch * loops, access_duration)
+                 << " packets/s, by batch (" << ts::TSPacketHeaders::Acceleration() << "): "
+                 << utest::Rate(batch * loops, batch_duration) << " packets/s" << std::endl;
+
+    // PID filtering, packet by packet.
+    size_t found1 = 0;
+    start.getSystemTime();
+    for (size_t n = 0; n < loops; ++n) {
+        for (size_t i = 0; i < batch; ++i) {
+            found1 += filter[packets[i].getPID()];
+        }
+    }
+    end.getSystemTime();
+    const ts::NanoSecond access_filter = end - start;
+
+    // PID filtering by batch.
+    size_t found2 = 0;
+    std::vector<uint8_t> match(batch);
+    start.getSystemTime();
+    for (size_t n = 0; n < loops; ++n) {
+        headers.decode(&packets[0], batch);
+        found2 += headers.matchPIDs(filter, &match[0]);
+    }
+    end.getSystemTime();
+    const ts::NanoSecond batch_filter = end - start;
+    CPPUNIT_ASSERT_EQUAL(found1, found2);
+
+    utest::Out() << "TSPacketTest: PID filtering, accessors: " << utest::Rate(batch * loops, access_filter)
+                 << " packets/s, by batch: " << utest::Rate(batch * loops, batch_filter) << " packets/s" << std::endl;
+}
@@ -61,11 +61,13 @@ public:
     void testStackSize();
     void testDeleteWhenTerminated();
     void testPriority();
+    void testCPUAffinity();
 
     CPPUNIT_TEST_SUITE (ThreadAttributesTest);
     CPPUNIT_TEST (testStackSize);
     CPPUNIT_TEST (testDeleteWhenTerminated);
     CPPUNIT_TEST (testPriority);
+    CPPUNIT_TEST (testCPUAffinity);
     CPPUNIT_TEST_SUITE_END ();
 };
 
@@ -134,3 +136,15 @@ void ThreadAttributesTest::testPriority()
     attr.setPriority (ts::ThreadAttributes::GetNormalPriority());
     CPPUNIT_ASSERT(attr.getPriority() == ts::ThreadAttributes::GetNormalPriority());
 }
+
+void ThreadAttributesTest::testCPUAffinity()
+{
+    ts::ThreadAttributes attr;
+    CPPUNIT_ASSERT(attr.getCPUAffinity().empty()); // default value
+
+    std::set<size_t> cpus;
+    cpus.insert(0);
+    cpus.insert(3);
+    CPPUNIT_ASSERT(attr.setCPUAffinity(cpus).getCPUAffinity() == cpus);
+    CPPUNIT_ASSERT(attr.setCPUAffinity(std::set<size_t>()).getCPUAffinity().empty());
+}